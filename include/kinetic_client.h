@@ -99,6 +99,39 @@ KineticStatus KineticClient_DestroySession(KineticSession * const session);
  */
 KineticStatus KineticClient_GetTerminationStatus(KineticSession * const session);
 
+/**
+ * @brief Reports the session's read cache statistics (see
+ * `KineticSessionConfig.readCacheBytes`).
+ *
+ * @param session       The KineticSession to query.
+ * @param stats         Receives the statistics.
+ *
+ * @return              Returns KINETIC_STATUS_INVALID_REQUEST if the session
+ *                      has no read cache.
+ */
+KineticStatus KineticClient_GetCacheStats(KineticSession * const session,
+                                          KineticCacheStats * stats);
+
+/**
+ * @brief Takes the events of completed asynchronous operations from a
+ * completion queue (see kinetic_completion_queue.h), oldest first.
+ *
+ * Operations are submitted to a queue by passing a closure with `queue`
+ * set and `clientData` as the tag to report. Their completions are then
+ * handled in batches on the polling thread, rather than by callbacks on
+ * kinetic-c threads.
+ *
+ * @param queue         The KineticCompletionQueue to poll.
+ * @param events        Receives the events.
+ * @param max           Most events to take.
+ * @param timeoutMillis Time to wait for an event if there are none: 0 to
+ *                      return at once, or negative to wait indefinitely.
+ *
+ * @return              Returns the number of events taken, or 0 on timeout.
+ */
+size_t KineticClient_PollCompletions(KineticCompletionQueue * const queue,
+    KineticCompletionEvent events[], size_t max, int timeoutMillis);
+
 /**
  * @brief Executes a `NOOP` operation to test whether the Kinetic Device is operational.
  *
@@ -151,6 +184,7 @@ KineticStatus KineticClient_Flush(KineticSession* const session,
  * @param closure       Optional closure. If specified, operation will be
  *                      executed in asynchronous mode, and closure callback
  *                      will be called upon completion in another thread.
+ *                      Only synchronous GETs use the session's read cache.
  *
  * @return              Returns the resulting KineticStatus.
  */
@@ -218,6 +252,172 @@ KineticStatus KineticClient_Delete(KineticSession* const session,
                                    KineticEntry* const entry,
                                    KineticCompletionClosure* closure);
 
+/**
+ * @brief Executes a `PUT` operation for each of several entries, pipelining
+ * the requests and completing once for the whole batch.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param entries       Array of key/value entries to store, as for
+ *                      KineticClient_Put. If a closure is provided the array
+ *                      must remain valid until the closure callback is called.
+ * @param count         Number of entries in the array.
+ * @param statuses      Optional array of `count` statuses, which receives the
+ *                      status of each entry's operation. If a closure is
+ *                      provided it must remain valid until the closure
+ *                      callback is called.
+ * @param closure       Optional closure. If specified, the batch will be
+ *                      executed in asynchronous mode, and closure callback
+ *                      will be called once, after every entry has completed,
+ *                      with the status of the first entry that failed (or
+ *                      success), unless no entry could be sent, in which
+ *                      case that failure is returned and closure is not
+ *                      called.
+ *
+ * @return              Returns the resulting KineticStatus of the batch.
+ */
+KineticStatus KineticClient_PutBatch(KineticSession* const session,
+                                     KineticEntry* const entries,
+                                     size_t count,
+                                     KineticStatus* statuses,
+                                     KineticCompletionClosure* closure);
+
+/**
+ * @brief Executes a `GET` operation for each of several entries, pipelining
+ * the requests and completing once for the whole batch.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param entries       Array of key/value entries to retrieve, as for
+ *                      KineticClient_Get. Every entry is checked before any
+ *                      request is sent.
+ * @param count         Number of entries in the array.
+ * @param statuses      Optional array of `count` per-entry statuses.
+ * @param closure       Optional closure, as for KineticClient_PutBatch.
+ *
+ * @return              Returns the resulting KineticStatus of the batch.
+ */
+KineticStatus KineticClient_GetBatch(KineticSession* const session,
+                                     KineticEntry* const entries,
+                                     size_t count,
+                                     KineticStatus* statuses,
+                                     KineticCompletionClosure* closure);
+
+/**
+ * @brief Executes a `DELETE` operation for each of several entries,
+ * pipelining the requests and completing once for the whole batch.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param entries       Array of key/value entries to delete, as for
+ *                      KineticClient_Delete.
+ * @param count         Number of entries in the array.
+ * @param statuses      Optional array of `count` per-entry statuses.
+ * @param closure       Optional closure, as for KineticClient_PutBatch.
+ *
+ * @return              Returns the resulting KineticStatus of the batch.
+ */
+KineticStatus KineticClient_DeleteBatch(KineticSession* const session,
+                                        KineticEntry* const entries,
+                                        size_t count,
+                                        KineticStatus* statuses,
+                                        KineticCompletionClosure* closure);
+
+/**
+ * @brief Stores an object of any size under a single key, streaming it to
+ * the Kinetic Device in chunks of up to `KINETIC_OBJ_SIZE` bytes.
+ *
+ * Chunks are stored under the key followed by a 0x00 byte, an 8-byte
+ * big-endian generation picked for this PUT, and the 8-byte big-endian chunk
+ * index. A small manifest naming the generation is stored under the key
+ * itself once every chunk has been written, and only then are the chunks of
+ * the object it replaces deleted. Each chunk and the manifest carry a CRC32
+ * tag. Blocks until the whole object has been stored.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param key           Key to store the object under.
+ * @param io            Source of the object's data. Its `read` function is
+ *                      called from this thread until it reports the end of
+ *                      the object.
+ * @param config        Optional transfer options (chunk size, chunks in
+ *                      flight, synchronization). NULL selects the defaults.
+ *
+ * @return              Returns the resulting KineticStatus, or
+ *                      `KINETIC_STATUS_INVALID_FILE` if `read` failed.
+ */
+KineticStatus KineticClient_PutObject(KineticSession* const session,
+                                      ByteArray const key,
+                                      KineticObjectIO const* io,
+                                      KineticObjectConfig const* config);
+
+/**
+ * @brief Retrieves an object stored by KineticClient_PutObject, keeping
+ * several chunk `GET`s outstanding and writing the data out in order.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param key           Key the object was stored under.
+ * @param io            Sink for the object's data. Its `write` function is
+ *                      called from this thread with the data in order.
+ * @param config        Optional transfer options (chunks in flight). NULL
+ *                      selects the defaults.
+ *
+ * @return              Returns the resulting KineticStatus,
+ *                      `KINETIC_STATUS_DATA_ERROR` if the key does not hold an
+ *                      object manifest or a chunk is missing or corrupt, or
+ *                      `KINETIC_STATUS_INVALID_FILE` if `write` failed.
+ */
+KineticStatus KineticClient_GetObject(KineticSession* const session,
+                                      ByteArray const key,
+                                      KineticObjectIO const* io,
+                                      KineticObjectConfig const* config);
+
+/**
+ * @brief Deletes an object stored by KineticClient_PutObject: its manifest
+ * first, then every chunk, keeping several chunk `DELETE`s outstanding.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param key           Key the object was stored under.
+ * @param config        Optional transfer options (chunks in flight,
+ *                      synchronization). NULL selects the defaults.
+ *
+ * @return              Returns the resulting KineticStatus,
+ *                      `KINETIC_STATUS_NOT_FOUND` if there is no object under
+ *                      the key, or `KINETIC_STATUS_DATA_ERROR` if the key does
+ *                      not hold an object manifest.
+ */
+KineticStatus KineticClient_DeleteObject(KineticSession* const session,
+                                         ByteArray const key,
+                                         KineticObjectConfig const* config);
+
+/**
+ * @brief Stores everything read from a file descriptor as an object, as
+ * KineticClient_PutObject does.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param key           Key to store the object under.
+ * @param fd            File descriptor to read the object from until EOF.
+ * @param config        Optional transfer options. NULL selects the defaults.
+ *
+ * @return              Returns the resulting KineticStatus.
+ */
+KineticStatus KineticClient_PutObjectFromFd(KineticSession* const session,
+                                            ByteArray const key,
+                                            int fd,
+                                            KineticObjectConfig const* config);
+
+/**
+ * @brief Retrieves an object into a file descriptor, as
+ * KineticClient_GetObject does.
+ *
+ * @param session       The connected KineticSession to use for the operation.
+ * @param key           Key the object was stored under.
+ * @param fd            File descriptor to write the object to.
+ * @param config        Optional transfer options. NULL selects the defaults.
+ *
+ * @return              Returns the resulting KineticStatus.
+ */
+KineticStatus KineticClient_GetObjectToFd(KineticSession* const session,
+                                          ByteArray const key,
+                                          int fd,
+                                          KineticObjectConfig const* config);
+
 /**
  * @brief Executes a `GETKEYRANGE` operation to retrieve a set of keys in the range
  * specified range from the Kinetic Device
@@ -239,6 +439,30 @@ KineticStatus KineticClient_GetKeyRange(KineticSession* const session,
                                         KineticKeyRange* range, ByteBufferArray* keys,
                                         KineticCompletionClosure* closure);
 
+/**
+ * @brief Executes a `GETKEYRANGE` operation, handing each key retrieved to a
+ * callback instead of copying it into a preallocated buffer.
+ *
+ * @param session       The connected KineticSession to use for the operation
+ * @param range         KineticKeyRange specifying keys to return
+ * @param keyCallback   Called with each key, in order, upon success, from the
+ *                      thread completing the operation, and before it completes.
+ *                      Keys are not copied, so no key buffers need be
+ *                      allocated up front.
+ * @param clientData    Optional pointer passed to keyCallback.
+ * @param closure       Optional closure. If specified, operation will be
+ *                      executed in asynchronous mode, and closure callback
+ *                      will be called upon completion in another thread.
+ *
+ * @return              Returns 0 upon success, -1 or the Kinetic status code
+ *                      upon failure
+ */
+KineticStatus KineticClient_GetKeyRangeStream(KineticSession* const session,
+                                              KineticKeyRange* range,
+                                              KineticKeyCallback keyCallback,
+                                              void* clientData,
+                                              KineticCompletionClosure* closure);
+
 /**
  * @brief Executes a `PEER2PEERPUSH` operation allows a client to instruct a Kinetic
  * Device to copy a set of keys (and associated value and metadata) to another
@@ -0,0 +1,184 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_CLUSTER_H
+#define _KINETIC_CLUSTER_H
+
+#include "kinetic_types.h"
+
+#define KINETIC_CLUSTER_DEFAULT_VIRTUAL_NODES (160) ///< Default ring points per unit of drive weight
+
+/**
+ * @brief A set of sessions, one per drive, with keys placed on them by a
+ *        consistent-hash ring.
+ *
+ * Each drive owns `weight * virtualNodes` points on the ring, derived from
+ * its host and port, and a key belongs to the drive owning the first point
+ * at or after the key's hash. Placement therefore depends only on which
+ * drives are in the cluster and their weights, not on the order they were
+ * added, and adding or removing a drive only moves the keys it gains or
+ * loses. Sessions are created and destroyed by the client; a session must
+ * stay connected while it is in the cluster.
+ */
+typedef struct _KineticCluster KineticCluster;
+
+/**
+ * @brief Creates an empty KineticCluster.
+ *
+ * @param virtualNodes  Ring points per unit of drive weight. Zero selects
+ *                      `KINETIC_CLUSTER_DEFAULT_VIRTUAL_NODES`.
+ *
+ * @return              Returns the new cluster, or NULL on allocation failure.
+ */
+KineticCluster * KineticCluster_Create(uint32_t virtualNodes);
+
+/**
+ * @brief Destroys a KineticCluster. Its sessions are left connected.
+ *
+ * @param cluster       The cluster to destroy.
+ */
+void KineticCluster_Destroy(KineticCluster * cluster);
+
+/**
+ * @brief Adds a drive's session to the cluster.
+ *
+ * @param cluster       The cluster to add the session to.
+ * @param session       Connected session for the drive.
+ * @param weight        Relative share of keys the drive should own (e.g. its
+ *                      capacity in TB). Must be greater than zero.
+ *
+ * @return              Returns `KINETIC_STATUS_INVALID_REQUEST` if the weight
+ *                      is zero or a session for the same host and port is
+ *                      already in the cluster.
+ */
+KineticStatus KineticCluster_AddSession(KineticCluster * const cluster,
+                                        KineticSession * const session,
+                                        uint32_t weight);
+
+/**
+ * @brief Removes a drive's session from the cluster. Keys it owned are
+ *        placed on the remaining drives; see KineticCluster_Rebalance to
+ *        move the data stored on it.
+ *
+ * @param cluster       The cluster to remove the session from.
+ * @param session       Session previously added with KineticCluster_AddSession.
+ *
+ * @return              Returns `KINETIC_STATUS_INVALID_REQUEST` if the session
+ *                      is not in the cluster.
+ */
+KineticStatus KineticCluster_RemoveSession(KineticCluster * const cluster,
+                                           KineticSession * const session);
+
+/**
+ * @brief Returns the session for the drive that owns a key.
+ *
+ * @param cluster       The cluster to search.
+ * @param key           The key to place.
+ *
+ * @return              Returns the owning session, or NULL if the cluster is empty.
+ */
+KineticSession * KineticCluster_Locate(KineticCluster * const cluster, ByteArray const key);
+
+/**
+ * @brief Executes a `PUT` on the drive that owns the entry's key, as
+ *        KineticClient_Put does. Returns `KINETIC_STATUS_SESSION_INVALID` if
+ *        the cluster is empty.
+ */
+KineticStatus KineticCluster_Put(KineticCluster * const cluster,
+                                 KineticEntry * const entry,
+                                 KineticCompletionClosure * closure);
+
+/**
+ * @brief Executes a `GET` on the drive that owns the entry's key, as
+ *        KineticClient_Get does. Returns `KINETIC_STATUS_SESSION_INVALID` if
+ *        the cluster is empty.
+ */
+KineticStatus KineticCluster_Get(KineticCluster * const cluster,
+                                 KineticEntry * const entry,
+                                 KineticCompletionClosure * closure);
+
+/**
+ * @brief Executes a `DELETE` on the drive that owns the entry's key, as
+ *        KineticClient_Delete does. Returns `KINETIC_STATUS_SESSION_INVALID`
+ *        if the cluster is empty.
+ */
+KineticStatus KineticCluster_Delete(KineticCluster * const cluster,
+                                    KineticEntry * const entry,
+                                    KineticCompletionClosure * closure);
+
+/**
+ * @brief Executes a batch of `PUT`s, sending each drive its share of the
+ *        entries as one KineticClient_PutBatch, with all drives in parallel.
+ *
+ * @param cluster       The cluster to store the entries in.
+ * @param entries       Array of entries, as for KineticClient_PutBatch.
+ * @param count         Number of entries in the array.
+ * @param statuses      Optional array of `count` per-entry statuses.
+ * @param closure       Optional closure, called once when every drive's
+ *                      batch has completed, as for KineticClient_PutBatch.
+ *
+ * @return              Returns the resulting KineticStatus of the batch.
+ */
+KineticStatus KineticCluster_PutBatch(KineticCluster * const cluster,
+                                      KineticEntry * const entries,
+                                      size_t count,
+                                      KineticStatus * statuses,
+                                      KineticCompletionClosure * closure);
+
+/**
+ * @brief Executes a batch of `GET`s across the cluster, as
+ *        KineticCluster_PutBatch does for `PUT`s.
+ */
+KineticStatus KineticCluster_GetBatch(KineticCluster * const cluster,
+                                      KineticEntry * const entries,
+                                      size_t count,
+                                      KineticStatus * statuses,
+                                      KineticCompletionClosure * closure);
+
+/**
+ * @brief Executes a batch of `DELETE`s across the cluster, as
+ *        KineticCluster_PutBatch does for `PUT`s.
+ */
+KineticStatus KineticCluster_DeleteBatch(KineticCluster * const cluster,
+                                         KineticEntry * const entries,
+                                         size_t count,
+                                         KineticStatus * statuses,
+                                         KineticCompletionClosure * closure);
+
+/**
+ * @brief Moves every entry stored on a drive that the ring no longer places
+ *        there to the drive that now owns it, preserving its version and tag.
+ *
+ * After adding a drive, rebalance each of the other drives; before
+ * disconnecting a removed drive, rebalance it. Entries are read, written to
+ * their new owner and then deleted from the drive, one at a time, so
+ * concurrent writers to the keys being moved should be paused.
+ *
+ * @param cluster       The cluster the entries should be placed by.
+ * @param session       Connected session for the drive to move entries off.
+ * @param moved         Optional, receives the number of entries moved.
+ *
+ * @return              Returns the resulting KineticStatus.
+ */
+KineticStatus KineticCluster_Rebalance(KineticCluster * const cluster,
+                                       KineticSession * const session,
+                                       size_t * moved);
+
+#endif // _KINETIC_CLUSTER_H
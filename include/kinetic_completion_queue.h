@@ -0,0 +1,78 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_COMPLETION_QUEUE_H
+#define _KINETIC_COMPLETION_QUEUE_H
+
+#include "kinetic_types.h"
+
+/**
+ * @brief Creates a completion queue.
+ *
+ * An asynchronous operation whose closure has `queue` set appends a
+ * KineticCompletionEvent, tagged with the closure's `clientData`, instead
+ * of calling back on a kinetic-c thread. The application drains events in
+ * batches on a thread of its own with KineticClient_PollCompletions. Any
+ * number of sessions and operations may share a queue.
+ *
+ * @param capacity  Events held before being polled, rounded up to a power
+ *                  of 2. A full queue holds up the thread completing
+ *                  operations until it is polled, so size it for the
+ *                  operations outstanding against it.
+ *
+ * @return          Returns the queue, or NULL if out of memory.
+ */
+KineticCompletionQueue * KineticCompletionQueue_Create(size_t capacity);
+
+/**
+ * @brief Destroys a completion queue. No operations may be outstanding
+ *        against it, and no thread polling it.
+ *
+ * @param queue     The queue to destroy.
+ */
+void KineticCompletionQueue_Destroy(KineticCompletionQueue * const queue);
+
+/**
+ * @brief Appends an event to a completion queue, waiting for room if it is
+ *        full. Called by kinetic-c as operations complete.
+ *
+ * @param queue     The queue to append to.
+ * @param tag       `clientData` of the completed operation's closure.
+ * @param status    Resultant status of the operation.
+ */
+void KineticCompletionQueue_Push(KineticCompletionQueue * const queue,
+    void * tag, KineticStatus status);
+
+/**
+ * @brief Takes events from a completion queue, oldest first (see
+ *        KineticClient_PollCompletions).
+ *
+ * @param queue         The queue to take events from.
+ * @param events        Receives the events.
+ * @param max           Most events to take.
+ * @param timeoutMillis Time to wait for an event if there are none: 0 to
+ *                      return at once, or negative to wait indefinitely.
+ *
+ * @return              Returns the number of events taken, or 0 on timeout.
+ */
+size_t KineticCompletionQueue_Poll(KineticCompletionQueue * const queue,
+    KineticCompletionEvent events[], size_t max, int timeoutMillis);
+
+#endif // _KINETIC_COMPLETION_QUEUE_H
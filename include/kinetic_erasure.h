@@ -0,0 +1,114 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_ERASURE_H
+#define _KINETIC_ERASURE_H
+
+#include "kinetic_types.h"
+
+#define KINETIC_ERASURE_MAX_FRAGMENTS (32)  ///< Max data plus parity fragments, i.e. drives per entry
+#define KINETIC_ERASURE_HEADER_LEN    (24)  ///< Bytes stored ahead of each fragment
+
+/*
+ * Erasure-coded entries: a value is split into `dataFragments` equal
+ * fragments and Reed-Solomon coded with `parityFragments` more, and
+ * fragment i is stored under the entry's key on `sessions[i]`. Any
+ * `dataFragments` of the fragments recover the value, so up to
+ * `parityFragments` drives may be lost, at a capacity cost of
+ * (data + parity) / data rather than one copy per replica.
+ *
+ * Each fragment is stored with a CRC32 tag and a header giving the code
+ * parameters, its index, the value's length and a generation picked for
+ * each PUT, so a corrupt or mismatched fragment is treated as lost. A GET
+ * only decodes from fragments of one PUT, so fragments left by a PUT that
+ * failed part way are never mixed with those of another. The same
+ * sessions, in the same order, must be given for every call on an entry.
+ */
+
+/**
+ * @brief Executes a `PUT` of every fragment of an entry's value, in
+ *        parallel, and waits for them all.
+ *
+ * @param sessions          `dataFragments + parityFragments` connected
+ *                          sessions, one per drive.
+ * @param dataFragments     Number of fragments the value is split into.
+ * @param parityFragments   Number of parity fragments added.
+ * @param entry             Key and value to store. `dbVersion`,
+ *                          `newVersion`, `force` and `synchronization`
+ *                          apply to every fragment; the entry's tag is not
+ *                          used, and the entry is not modified.
+ *
+ * @return                  Returns `KINETIC_STATUS_SUCCESS` once every
+ *                          fragment is stored, `KINETIC_STATUS_INVALID_REQUEST`
+ *                          for bad fragment counts or an oversized key or
+ *                          version, `KINETIC_STATUS_BUFFER_OVERRUN` if a
+ *                          fragment would exceed `KINETIC_OBJ_SIZE`, or the
+ *                          status of the first fragment that failed.
+ */
+KineticStatus KineticErasure_Put(KineticSession * const sessions[],
+                                 size_t dataFragments,
+                                 size_t parityFragments,
+                                 KineticEntry * const entry);
+
+/**
+ * @brief Executes a `GET` of every fragment of an entry in parallel, and
+ *        decodes the value from the first `dataFragments` valid fragments
+ *        of one `PUT` to arrive, without waiting for the rest.
+ *
+ * @param sessions          As for KineticErasure_Put.
+ * @param dataFragments     As for KineticErasure_Put.
+ * @param parityFragments   As for KineticErasure_Put.
+ * @param entry             Key to read; the value is appended to `value`,
+ *                          whose capacity also bounds the fragment size
+ *                          read. Other fields are not modified.
+ *
+ * @return                  Returns `KINETIC_STATUS_SUCCESS` if the value was
+ *                          recovered, `KINETIC_STATUS_BUFFER_OVERRUN` if it
+ *                          does not fit, or else the status of the first
+ *                          fragment that could not be read
+ *                          (`KINETIC_STATUS_DATA_ERROR` for a corrupt one, or
+ *                          if every fragment was read but no
+ *                          `dataFragments` of them are from one `PUT`).
+ */
+KineticStatus KineticErasure_Get(KineticSession * const sessions[],
+                                 size_t dataFragments,
+                                 size_t parityFragments,
+                                 KineticEntry * const entry);
+
+/**
+ * @brief Executes a `DELETE` of every fragment of an entry in parallel,
+ *        and waits for them all. Fragments already missing are ignored.
+ *
+ * @param sessions          As for KineticErasure_Put.
+ * @param dataFragments     As for KineticErasure_Put.
+ * @param parityFragments   As for KineticErasure_Put.
+ * @param entry             Key to delete. `dbVersion`, `force` and
+ *                          `synchronization` apply to every fragment.
+ *
+ * @return                  Returns `KINETIC_STATUS_NOT_FOUND` if no fragment
+ *                          was found, or the status of the first fragment
+ *                          that could not be deleted.
+ */
+KineticStatus KineticErasure_Delete(KineticSession * const sessions[],
+                                    size_t dataFragments,
+                                    size_t parityFragments,
+                                    KineticEntry * const entry);
+
+#endif // _KINETIC_ERASURE_H
@@ -0,0 +1,143 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_FUTURE_H
+#define _KINETIC_FUTURE_H
+
+#include "kinetic_types.h"
+
+#define KINETIC_FUTURE_DEFAULT_POOL_SIZE (256) ///< Default futures preallocated by KineticFuturePool_Create
+
+/**
+ * @brief The result of an asynchronous operation, to be waited for.
+ *
+ * A future is taken from a pool with KineticFuture_Create, and passed to
+ * an asynchronous call as its closure (see KineticFuture_Closure):
+ *
+ *     KineticFuture * future = KineticFuture_Create(pool);
+ *     status = KineticClient_Put(session, &entry, KineticFuture_Closure(future));
+ *     ...
+ *     status = KineticFuture_Wait(future);
+ *     KineticFuture_Release(future);
+ *
+ * Futures need no mutex or condition variable of their own: all the
+ * threads waiting on a pool's futures sleep on a single futex, which each
+ * completion advances.
+ */
+typedef struct _KineticFuture KineticFuture;
+
+/**
+ * @brief Futures, and the futex their waiters sleep on.
+ */
+typedef struct _KineticFuturePool KineticFuturePool;
+
+/**
+ * @brief Creates a pool of futures.
+ *
+ * @param count     Futures to preallocate. If 0, use the default
+ *                  (`KINETIC_FUTURE_DEFAULT_POOL_SIZE`). Further futures
+ *                  are allocated as needed.
+ *
+ * @return          Returns the pool, or NULL if out of memory.
+ */
+KineticFuturePool * KineticFuturePool_Create(size_t count);
+
+/**
+ * @brief Destroys a pool. Its futures must all have been released.
+ *
+ * @param pool      The pool to destroy.
+ */
+void KineticFuturePool_Destroy(KineticFuturePool * const pool);
+
+/**
+ * @brief Takes a future from a pool, ready to pass to an asynchronous call.
+ *
+ * @param pool      The pool to take the future from.
+ *
+ * @return          Returns the future, or NULL if out of memory.
+ */
+KineticFuture * KineticFuture_Create(KineticFuturePool * const pool);
+
+/**
+ * @brief Returns the closure completing a future, to pass to an
+ *        asynchronous call. A future may only be passed to one call.
+ *        If the call fails, it will not complete the future, which should
+ *        then be released without waiting for it.
+ *
+ * @param future    The future to complete.
+ *
+ * @return          Returns a pointer to the closure, owned by the future.
+ */
+KineticCompletionClosure * KineticFuture_Closure(KineticFuture * const future);
+
+/**
+ * @brief Reports whether a future's operation has completed.
+ *
+ * @param future    The future to check.
+ *
+ * @return          Returns true if completed.
+ */
+bool KineticFuture_IsDone(KineticFuture const * const future);
+
+/**
+ * @brief Waits for a future's operation to complete.
+ *
+ * @param future    The future to wait for.
+ *
+ * @return          Returns the resulting status of the operation.
+ */
+KineticStatus KineticFuture_Wait(KineticFuture * const future);
+
+/**
+ * @brief Waits for the operations of a set of futures, from the same pool,
+ *        to complete.
+ *
+ * @param futures   The futures to wait for.
+ * @param count     Number of futures.
+ *
+ * @return          Returns KINETIC_STATUS_SUCCESS if all of the operations
+ *                  succeeded, or else the status of the first to fail (in
+ *                  `futures` order).
+ */
+KineticStatus KineticFuture_WaitAll(KineticFuture * const futures[], size_t count);
+
+/**
+ * @brief Waits for the operation of any of a set of futures, from the same
+ *        pool, to complete.
+ *
+ * @param futures   The futures to wait for.
+ * @param count     Number of futures (at least 1).
+ * @param status    If not NULL, receives the resulting status of the
+ *                  completed operation.
+ *
+ * @return          Returns the index of a completed future, the first in
+ *                  `futures` order if several have completed.
+ */
+size_t KineticFuture_WaitAny(KineticFuture * const futures[], size_t count,
+    KineticStatus * status);
+
+/**
+ * @brief Returns a completed or unsubmitted future to its pool.
+ *
+ * @param future    The future to release.
+ */
+void KineticFuture_Release(KineticFuture * const future);
+
+#endif // _KINETIC_FUTURE_H
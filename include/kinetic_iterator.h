@@ -0,0 +1,102 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_ITERATOR_H
+#define _KINETIC_ITERATOR_H
+
+#include "kinetic_types.h"
+
+#define KINETIC_ITERATOR_DEFAULT_PAGE_KEYS      (128) ///< Keys requested per `GETKEYRANGE` if `maxReturned` is 0
+#define KINETIC_ITERATOR_DEFAULT_PREFETCH_PAGES (2)   ///< Default pages of keys held ahead of the caller
+#define KINETIC_ITERATOR_DEFAULT_VALUES         (16)  ///< Default values fetched ahead of the caller
+
+/**
+ * @brief Iterates over the keys in a range, a page of keys per
+ *        `GETKEYRANGE`.
+ *
+ * The next page is requested as soon as the last one arrives, while the
+ * caller is still working through earlier pages, and values (if wanted)
+ * are fetched in parallel ahead of the caller. A scan therefore waits on
+ * the device only when the caller consumes keys faster than they can be
+ * listed. Iterators are not thread-safe; use one per thread.
+ */
+typedef struct _KineticKeyIterator KineticKeyIterator;
+
+/**
+ * @brief Key iterator options. Zeroed fields select the defaults.
+ */
+typedef struct _KineticKeyIteratorConfig {
+    size_t prefetchPages;   ///< Pages of keys listed ahead of the caller, including the one being read (default `KINETIC_ITERATOR_DEFAULT_PREFETCH_PAGES`)
+    bool fetchValues;       ///< Set to `true' to also `GET` the value of each key
+    size_t prefetchValues;  ///< Values fetched at once, ahead of the caller (default `KINETIC_ITERATOR_DEFAULT_VALUES`)
+    size_t maxValueLen;     ///< Largest value expected (default `KINETIC_OBJ_SIZE`); larger ones fail with `KINETIC_STATUS_BUFFER_OVERRUN`
+} KineticKeyIteratorConfig;
+
+/**
+ * @brief Opens an iterator over a range of keys, and requests the first
+ *        page of keys.
+ *
+ * @param session       The connected KineticSession to use.
+ * @param range         Range to iterate over, in reverse if `reverse` is
+ *                      set. `maxReturned` sets the keys per page, and 0
+ *                      selects `KINETIC_ITERATOR_DEFAULT_PAGE_KEYS`. The
+ *                      range is copied.
+ * @param config        Options, or NULL for the defaults.
+ * @param iterator      Receives the new iterator.
+ *
+ * @return              Returns `KINETIC_STATUS_INVALID_REQUEST` if a key
+ *                      in the range is too long, or
+ *                      `KINETIC_STATUS_MEMORY_ERROR`.
+ */
+KineticStatus KineticKeyIterator_Open(KineticSession * const session,
+                                      KineticKeyRange const * const range,
+                                      KineticKeyIteratorConfig const * const config,
+                                      KineticKeyIterator ** iterator);
+
+/**
+ * @brief Returns the next key in the range, waiting for it to be listed
+ *        (and its value read) if need be.
+ *
+ * Keys deleted between being listed and their value being read are
+ * skipped.
+ *
+ * @param iterator      The iterator.
+ * @param key           Receives the key.
+ * @param value         Receives the value if `fetchValues` is set, and is
+ *                      otherwise emptied; may be NULL. The key and value
+ *                      are valid until the next call on the iterator.
+ *
+ * @return              Returns `KINETIC_STATUS_NOT_FOUND` once every key
+ *                      in the range has been returned, or the status of
+ *                      the first request that failed, after which the
+ *                      iterator returns that status on every call.
+ */
+KineticStatus KineticKeyIterator_Next(KineticKeyIterator * const iterator,
+                                      ByteArray * key,
+                                      ByteArray * value);
+
+/**
+ * @brief Closes an iterator, waiting for any requests it has outstanding.
+ *
+ * @param iterator      The iterator, which may be NULL.
+ */
+void KineticKeyIterator_Close(KineticKeyIterator * iterator);
+
+#endif // _KINETIC_ITERATOR_H
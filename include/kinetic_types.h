@@ -45,6 +45,11 @@
 #define KINETIC_DEFAULT_KEY_LEN (1024)                  ///< Default key length
 #define KINETIC_MAX_KEY_LEN     (4096)                  ///< Max key length
 #define KINETIC_OBJ_SIZE        (1024 * 1024)           ///< Max object/value size
+#define KINETIC_DEFAULT_QUEUE_DEPTH (10)                ///< Default max outstanding operations per session
+#define KINETIC_MAX_QUEUE_DEPTH (1024)                  ///< Max outstanding operations per session
+#define KINETIC_OBJECT_DEFAULT_IN_FLIGHT (8)           ///< Default chunk operations outstanding per object transfer
+#define KINETIC_MAX_CONNECTIONS (16)                    ///< Max connections per session
+#define KINETIC_DEFAULT_STRIPE_THRESHOLD (64 * 1024)    ///< Default value size striped over extra connections
 
 // Define max host name length
 // Some Linux environments require this, although not all, but it's benign.
@@ -142,8 +147,56 @@ typedef struct _KineticSessionConfig {
 
     /// Operation timeout. If 0, use the default (10 seconds).
     uint16_t timeoutSeconds;
+
+    /// Maximum number of operations in flight on this session. Further
+    /// requests block until an earlier one completes. If 0, use the default
+    /// (`KINETIC_DEFAULT_QUEUE_DEPTH`); capped at `KINETIC_MAX_QUEUE_DEPTH`.
+    uint32_t queueDepth;
+
+    /// Set to `true' to size the in-flight window adaptively, between 1 and
+    /// `queueDepth`. The window grows while response latency stays near the
+    /// lowest seen, and is halved when latency spikes or the device reports
+    /// it is busy.
+    bool adaptiveQueueDepth;
+
+    /// If nonzero, synchronous GETs of entries with a `dbVersion` are cached
+    /// in memory, up to this many bytes, least recently used first out.
+    /// Local PUTs and DELETEs of a key invalidate it.
+    size_t readCacheBytes;
+
+    /// Cached entries are served without asking the device for this long
+    /// after they were last read or revalidated. After that, or if 0, a hit
+    /// is revalidated with a `metadataOnly` GET, and the value is only
+    /// transferred again if its version has changed.
+    uint32_t readCacheTtlMillis;
+
+    /// Number of connections to open to the device. With more than one,
+    /// PUTs and GETs moving at least `stripeThreshold` value bytes are sent
+    /// round robin over the extra connections, and everything else on the
+    /// first, so small requests do not queue behind large transfers. Each
+    /// connection has its own `queueDepth`, and operations sent on different
+    /// connections may complete out of order. If 0, 1 is used; capped at
+    /// `KINETIC_MAX_CONNECTIONS`.
+    uint32_t connections;
+
+    /// Value size from which transfers are striped (see `connections`).
+    /// If 0, use the default (`KINETIC_DEFAULT_STRIPE_THRESHOLD`).
+    size_t stripeThreshold;
 } KineticSessionConfig;
 
+/**
+ * @brief Read cache statistics for a session; see KineticClient_GetCacheStats.
+ */
+typedef struct _KineticCacheStats {
+    uint64_t hits;              ///< GETs served from the cache within the TTL
+    uint64_t revalidatedHits;   ///< GETs served from the cache after a `metadataOnly` GET confirmed the version
+    uint64_t misses;            ///< GETs that transferred the value: not cached, or its version had changed
+    uint64_t evictions;         ///< Entries dropped to make room
+    uint64_t invalidations;     ///< Entries dropped by local PUTs and DELETEs
+    size_t entries;             ///< Entries currently cached
+    size_t bytes;               ///< Bytes currently cached, including keys, versions and tags
+} KineticCacheStats;
+
 /**
  * @brief An instance of a session with a Kinetic device.
  */
@@ -219,12 +272,28 @@ typedef struct _KineticCompletionData {
 typedef void (*KineticCompletionCallback)(KineticCompletionData* kinetic_data, void* client_data);
 
 
+/**
+ * @brief Queue of completed asynchronous operations, drained by the
+ *        application with KineticClient_PollCompletions (see
+ *        kinetic_completion_queue.h).
+ */
+typedef struct _KineticCompletionQueue KineticCompletionQueue;
+
+/**
+ * @brief A completed operation, as reported by KineticClient_PollCompletions.
+ */
+typedef struct _KineticCompletionEvent {
+    void* tag;                          ///< `clientData` of the operation's closure
+    KineticStatus status;               ///< Resultant status of the operation
+} KineticCompletionEvent;
+
 /**
  * @brief Closure which can be specified for operations which support asynchronous mode
  */
 typedef struct _KineticCompletionClosure {
     KineticCompletionCallback callback; ///< Function to be called upon completion
     void* clientData;                   ///< Optional client-supplied data which will be supplied to callback
+    KineticCompletionQueue* queue;      ///< If set, completion is appended to this queue, tagged with `clientData`, instead of calling `callback`
 } KineticCompletionClosure;
 
 /**
@@ -245,10 +314,33 @@ typedef struct _KineticEntry {
     ByteBuffer newVersion;      ///< New version for the object to assume once written to disk (optional)
     bool metadataOnly;          ///< If set for a GET request, will return only the metadata for the specified object (`value` will not be retrieved)
     bool force;                 ///< If set for a GET/DELETE request, will override `version` checking
-    bool computeTag;            ///< If set and an algorithm is specified, the tag will be populated with the calculated hash for integrity checking
+    bool computeTag;            ///< If set and a supported algorithm is specified, a PUT populates the tag with the calculated hash (SHA1, SHA2, CRC32 or CRC64), and a GET checks the returned value against the returned tag, failing with `KINETIC_STATUS_DATA_ERROR` on a mismatch
     KineticSynchronization synchronization; ///< Synchronization method to use for PUT/DELETE requests.
 } KineticEntry;
 
+/**
+ * @brief Source or sink of a large object's data, for KineticClient_PutObject
+ * and KineticClient_GetObject
+ */
+typedef struct _KineticObjectIO {
+    /// PUT: reads up to `len` bytes into `buf`, returning the number read,
+    /// 0 at the end of the object, or -1 on error
+    ssize_t (*read)(void* context, void* buf, size_t len);
+    /// GET: consumes all `len` bytes of `buf`, returning false on error.
+    /// Called with the object's data in order.
+    bool (*write)(void* context, void const* buf, size_t len);
+    void* context;              ///< Optional client-supplied data passed to `read` and `write`
+} KineticObjectIO;
+
+/**
+ * @brief Large object transfer options. Zeroed fields select the defaults.
+ */
+typedef struct _KineticObjectConfig {
+    size_t chunkSize;           ///< PUT: bytes stored per chunk, up to (and by default) `KINETIC_OBJ_SIZE`. GET uses the size the object was stored with.
+    size_t maxInFlight;         ///< Chunk operations kept outstanding at once (default `KINETIC_OBJECT_DEFAULT_IN_FLIGHT`)
+    KineticSynchronization synchronization; ///< PUT: synchronization method for the chunks and manifest
+} KineticObjectConfig;
+
 /**
  * @brief Kinetic Key Range request structure
  */ 
@@ -281,6 +373,17 @@ typedef struct _KineticKeyRange {
     bool reverse;
 } KineticKeyRange;
 
+/**
+ * @brief Receives each key listed by KineticClient_GetKeyRangeStream, in order.
+ *
+ * @param key           The key. It points into the response, and is only valid
+ *                      for the duration of the call.
+ * @param client_data   Optional pointer to arbitrary client-supplied data.
+ *
+ * @return              Returns `false' to skip the rest of the keys listed.
+ */
+typedef bool (*KineticKeyCallback)(ByteArray const key, void* client_data);
+
 // Kinetic GetLog data types
 
 /**
@@ -501,7 +604,9 @@ typedef struct {
     const char *logFile;            ///< Path to log file. Specify 'stdout' to log to STDOUT or NULL to disable logging.
     int logLevel;                   ///< Logging level (-1:none, 0:error, 1:info, 2:verbose, 3:full)
     uint8_t readerThreads;          ///< Number of threads used for handling incoming responses and status messages
-    uint8_t maxThreadpoolThreads;   ///< Max number of threads to use for the threadpool that handles response callbacks.
+    uint16_t maxThreadpoolThreads;  ///< Max number of threads to use for the threadpool that handles response callbacks.
+    uint16_t minThreadpoolThreads;  ///< Threadpool threads kept alive while idle; others are reaped after `threadpoolIdleTimeout`.
+    size_t threadpoolIdleTimeout;   ///< Milliseconds before an idle threadpool thread above the minimum exits (0 uses the default).
 } KineticClientConfig;
 
 /**
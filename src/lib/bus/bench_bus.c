@@ -0,0 +1,523 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <assert.h>
+#include <string.h>
+#include <err.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#ifdef __Linux__
+// some Linux distros put this in a nonstandard place.
+#include <getopt.h>
+#endif
+
+#include "bus.h"
+#include "atomic.h"
+#include "socket99.h"
+#include "util.h"
+
+/* Benchmark driver for the message bus. Uses the same framing as
+ * bus_example.c and runs against echosrv, sending a fixed number of
+ * messages with a bounded number in flight, then prints one JSON
+ * object with throughput, latency percentiles, and CPU per message. */
+
+typedef struct {
+    uint32_t magic_number;
+    uint32_t size;
+    int64_t seq_id;
+} prot_header_t;
+
+#define MAGIC_NUMBER 3
+
+#define MAX_SOCKETS 1000
+#define DEFAULT_PAYLOAD_SIZE 64
+#define DEFAULT_MSG_COUNT 100000
+#define DEFAULT_WINDOW 64
+#define MAX_SEND_FAILURES 100
+
+enum socket_state {
+    STATE_UNINIT = 0,
+    STATE_AWAITING_HEADER,
+    STATE_AWAITING_BODY,
+};
+
+typedef struct {
+    enum socket_state state;
+    size_t cur_payload_size;
+    size_t used;
+    uint8_t buf[];
+} socket_info;
+
+typedef struct {
+    const char *name;
+    int port_low;
+    int port_high;
+    int verbosity;
+    int socket_count;
+    int listener_count;
+    bool use_tls;
+    size_t payload_size;
+    size_t msg_count;
+    size_t window;
+
+    int sockets[MAX_SOCKETS];
+    socket_info *info[MAX_SOCKETS];
+
+    /* Send timestamps, indexed by seq_id - 1, and measured latencies,
+     * in completion order. */
+    int64_t *send_usec;
+    uint32_t *latency_usec;
+
+    size_t sent_msgs;
+    size_t completed_deliveries;
+    size_t failed_deliveries;
+
+    /* Sender blocks here while the window is full. */
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t in_flight;
+} bench_state;
+
+static bench_state state;
+
+#define LOG(VERBOSITY, ...)                     \
+    do { if (state.verbosity >= VERBOSITY) { fprintf(stderr, __VA_ARGS__); } } while(0)
+
+static const char *executable_name = NULL;
+
+static int64_t now_usec(void) {
+    struct timeval tv;
+    if (!Util_Timestamp(&tv, true)) { assert(false); }
+    return 1000000L * tv.tv_sec + tv.tv_usec;
+}
+
+static int64_t cpu_usec(void) {
+    struct rusage ru;
+    if (0 != getrusage(RUSAGE_SELF, &ru)) { err(1, "getrusage"); }
+    return 1000000L * (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)
+      + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static void log_cb(log_event_t event, int log_level, const char *msg, void *udata) {
+    (void)udata;
+    fprintf(stderr, "%s[%d] -- %s\n", Bus_LogEventStr(event), log_level, msg);
+}
+
+static bus_sink_cb_res_t reset_transfer(socket_info *si) {
+    bus_sink_cb_res_t res = { /* prime pump with header size */
+        .next_read = sizeof(prot_header_t),
+    };
+
+    si->state = STATE_AWAITING_HEADER;
+    si->used = 0;
+    return res;
+}
+
+static bus_sink_cb_res_t sink_cb(uint8_t *read_buf,
+        size_t read_size, void *socket_udata) {
+    socket_info *si = (socket_info *)socket_udata;
+    assert(si);
+
+    switch (si->state) {
+    case STATE_UNINIT:
+        assert(read_size == 0);
+        return reset_transfer(si);
+    case STATE_AWAITING_HEADER:
+    {
+        size_t header_rem = sizeof(prot_header_t) - si->used;
+        assert(read_size <= header_rem);
+        memcpy(&si->buf[si->used], read_buf, read_size);
+        si->used += read_size;
+
+        if (si->used < sizeof(prot_header_t)) {
+            bus_sink_cb_res_t res = {
+                .next_read = sizeof(prot_header_t) - si->used,
+            };
+            return res;
+        }
+
+        prot_header_t *header = (prot_header_t *)&si->buf[0];
+        if (header->magic_number != MAGIC_NUMBER) {
+            fprintf(stderr, "INVALID HEADER: magic number 0x%08x\n", header->magic_number);
+            assert(false);
+            return reset_transfer(si);
+        }
+
+        si->cur_payload_size = header->size;
+        if (si->cur_payload_size == 0) {
+            bus_sink_cb_res_t res = {
+                .next_read = sizeof(prot_header_t),
+                .full_msg_buffer = read_buf,
+            };
+            si->used = 0;
+            return res;
+        }
+
+        bus_sink_cb_res_t res = {
+            .next_read = header->size,
+        };
+        si->state = STATE_AWAITING_BODY;
+        return res;
+    }
+    case STATE_AWAITING_BODY:
+    {
+        assert(state.payload_size + sizeof(prot_header_t) - si->used >= read_size);
+        memcpy(&si->buf[si->used], read_buf, read_size);
+        si->used += read_size;
+        size_t rem = si->cur_payload_size + sizeof(prot_header_t) - si->used;
+
+        if (rem == 0) {
+            bus_sink_cb_res_t res = {
+                .next_read = sizeof(prot_header_t),
+                .full_msg_buffer = read_buf,
+            };
+            si->state = STATE_AWAITING_HEADER;
+            si->used = 0;
+            return res;
+        } else {
+            bus_sink_cb_res_t res = {
+                .next_read = rem,
+            };
+            return res;
+        }
+    }
+    default:
+        assert(false);
+        return reset_transfer(si);
+    }
+}
+
+static bus_unpack_cb_res_t unpack_cb(void *msg, void *socket_udata) {
+    socket_info *si = (socket_info *)socket_udata;
+    prot_header_t *header = (prot_header_t *)&si->buf[0];
+    (void)msg;
+
+    bus_unpack_cb_res_t res = {
+        .ok = true,
+        .u.success = {
+            .seq_id = header->seq_id,
+            .msg = &si->buf[sizeof(prot_header_t)],
+        },
+    };
+    return res;
+}
+
+static void unexpected_msg_cb(void *msg,
+        int64_t seq_id, void *bus_udata, void *socket_udata) {
+    fprintf(stderr, "UNEXPECTED MESSAGE: %p, seq_id %lld, bus_udata %p, socket_udata %p\n",
+        msg, (long long)seq_id, bus_udata, socket_udata);
+    assert(false);
+}
+
+static void release_window_slot(bench_state *s) {
+    pthread_mutex_lock(&s->lock);
+    s->in_flight--;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void completion_cb(bus_msg_result_t *res, void *udata) {
+    bench_state *s = &state;
+    (void)udata;
+
+    if (res->status == BUS_SEND_SUCCESS) {
+        int64_t seq_id = res->u.response.seq_id;
+        assert(seq_id > 0 && (size_t)seq_id <= s->msg_count);
+        int64_t latency = now_usec() - s->send_usec[seq_id - 1];
+        if (latency < 0) { latency = 0; }
+
+        for (;;) {
+            size_t cur = s->completed_deliveries;
+            if (ATOMIC_BOOL_COMPARE_AND_SWAP(&s->completed_deliveries, cur, cur + 1)) {
+                s->latency_usec[cur] = (uint32_t)latency;
+                break;
+            }
+        }
+    } else {
+        LOG(1, "send failed: %d\n", res->status);
+        SPIN_ADJ(s->failed_deliveries, 1);
+    }
+
+    release_window_slot(s);
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "Usage: %s [-l LOW_PORT] [-h HIGH_PORT] [-c SOCKETS] [-L LISTENERS]\n"
+        "          [-p PAYLOAD_SIZE] [-n MESSAGES] [-w WINDOW] [-N NAME] [-t] [-v]\n"
+        "    If only one of -l or -h are specified, it will use just that one port.\n"
+        "    Sockets are spread round-robin over the ports (default: one per port).\n"
+        "    -w bounds the number of messages in flight across all sockets.\n"
+        "    -t connects with TLS; the echo server must also be run with -t.\n"
+        "    -v can be used multiple times to increase verbosity.\n"
+        , executable_name);
+    exit(1);
+}
+
+static void parse_args(int argc, char **argv, bench_state *s) {
+    int a = 0;
+
+    s->name = "bench";
+    s->payload_size = DEFAULT_PAYLOAD_SIZE;
+    s->msg_count = DEFAULT_MSG_COUNT;
+    s->window = DEFAULT_WINDOW;
+    s->listener_count = 1;
+
+    while ((a = getopt(argc, argv, "c:l:h:L:n:N:p:tw:v")) != -1) {
+        switch (a) {
+        case 'c':               /* socket count */
+            s->socket_count = atoi(optarg);
+            break;
+        case 'l':               /* low port */
+            s->port_low = atoi(optarg);
+            break;
+        case 'h':               /* high port */
+            s->port_high = atoi(optarg);
+            break;
+        case 'L':               /* listener count */
+            s->listener_count = atoi(optarg);
+            break;
+        case 'n':               /* message count */
+            s->msg_count = strtoul(optarg, NULL, 10);
+            break;
+        case 'N':               /* scenario name, for output */
+            s->name = optarg;
+            break;
+        case 'p':               /* payload size */
+            s->payload_size = strtoul(optarg, NULL, 10);
+            break;
+        case 't':               /* TLS */
+            s->use_tls = true;
+            break;
+        case 'w':               /* max messages in flight */
+            s->window = strtoul(optarg, NULL, 10);
+            break;
+        case 'v':               /* verbosity */
+            s->verbosity++;
+            break;
+        default:
+            fprintf(stderr, "illegal option: -- %c\n", a);
+            usage();
+        }
+    }
+
+    if (s->port_low == 0) { s->port_low = s->port_high; }
+    if (s->port_high == 0) { s->port_high = s->port_low; }
+    if (s->port_high < s->port_low || s->port_low == 0) { usage(); }
+    if (s->socket_count == 0) { s->socket_count = s->port_high - s->port_low + 1; }
+    if (s->socket_count < 1 || s->socket_count > MAX_SOCKETS) { usage(); }
+    if (s->listener_count < 1) { usage(); }
+    if (s->msg_count == 0 || s->window == 0) { usage(); }
+    if (s->payload_size > UINT32_MAX) { usage(); }
+}
+
+static void open_sockets(bench_state *s, struct bus *b) {
+    int port_count = s->port_high - s->port_low + 1;
+    size_t info_size = sizeof(socket_info) + sizeof(prot_header_t) + s->payload_size;
+    bus_socket_t type = s->use_tls ? BUS_SOCKET_SSL : BUS_SOCKET_PLAIN;
+
+    for (int i = 0; i < s->socket_count; i++) {
+        socket99_config cfg = {
+            .host = "127.0.0.1",
+            .port = s->port_low + (i % port_count),
+            .nonblocking = true,
+        };
+        socket99_result res;
+
+        if (!socket99_open(&cfg, &res)) {
+            socket99_fprintf(stderr, &res);
+            exit(1);
+        }
+
+        socket_info *si = calloc(1, info_size);
+        assert(si);
+        s->sockets[i] = res.fd;
+        s->info[i] = si;
+
+        if (!Bus_RegisterSocket(b, type, res.fd, si)) {
+            fprintf(stderr, "failed to register socket %d\n", res.fd);
+            exit(1);
+        }
+    }
+}
+
+static void close_sockets(bench_state *s, struct bus *b) {
+    for (int i = 0; i < s->socket_count; i++) {
+        Bus_ReleaseSocket(b, s->sockets[i], NULL);
+        close(s->sockets[i]);
+        free(s->info[i]);
+    }
+}
+
+static void acquire_window_slot(bench_state *s) {
+    pthread_mutex_lock(&s->lock);
+    while (s->in_flight >= s->window) {
+        pthread_cond_wait(&s->cond, &s->lock);
+    }
+    s->in_flight++;
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void drain_window(bench_state *s) {
+    pthread_mutex_lock(&s->lock);
+    while (s->in_flight > 0) {
+        pthread_cond_wait(&s->cond, &s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted SAMPLES, with P in per-mille. */
+static uint32_t percentile(const uint32_t *samples, size_t count, size_t p) {
+    if (count == 0) { return 0; }
+    size_t rank = (p * count + 999) / 1000;
+    if (rank == 0) { rank = 1; }
+    return samples[rank - 1];
+}
+
+static void run_bench(bench_state *s, struct bus *b) {
+    size_t msg_size = sizeof(prot_header_t) + s->payload_size;
+    uint8_t *msg_buf = malloc(msg_size);
+    assert(msg_buf);
+    for (size_t i = 0; i < s->payload_size; i++) {
+        msg_buf[sizeof(prot_header_t) + i] = (uint8_t)(0xFF & i);
+    }
+    prot_header_t *header = (prot_header_t *)msg_buf;
+    header->magic_number = MAGIC_NUMBER;
+    header->size = (uint32_t)s->payload_size;
+
+    int cur_socket_i = 0;
+    int dropped = 0;
+
+    int64_t start_wall = now_usec();
+    int64_t start_cpu = cpu_usec();
+
+    for (size_t i = 0; i < s->msg_count; i++) {
+        int64_t seq_id = i + 1;
+        header->seq_id = seq_id;
+
+        acquire_window_slot(s);
+
+        bus_user_msg msg = {
+            .fd = s->sockets[cur_socket_i],
+            .type = s->use_tls ? BUS_SOCKET_SSL : BUS_SOCKET_PLAIN,
+            .seq_id = seq_id,
+            .msg = msg_buf,
+            .msg_size = msg_size,
+            .cb = completion_cb,
+            .udata = s->info[cur_socket_i],
+        };
+
+        s->send_usec[i] = now_usec();
+        s->sent_msgs++;
+        if (!Bus_SendRequest(b, &msg)) {
+            LOG(1, " @@@ Bus_SendRequest failed!\n");
+            SPIN_ADJ(s->failed_deliveries, 1);
+            release_window_slot(s);
+            if (++dropped >= MAX_SEND_FAILURES) {
+                LOG(0, " @@@ more than %d send failures, halting\n", MAX_SEND_FAILURES);
+                break;
+            }
+        }
+
+        cur_socket_i++;
+        if (cur_socket_i == s->socket_count) { cur_socket_i = 0; }
+    }
+
+    drain_window(s);
+
+    int64_t elapsed = now_usec() - start_wall;
+    int64_t cpu = cpu_usec() - start_cpu;
+    if (elapsed <= 0) { elapsed = 1; }
+    free(msg_buf);
+
+    size_t done = s->completed_deliveries;
+    qsort(s->latency_usec, done, sizeof(s->latency_usec[0]), cmp_u32);
+    double secs = elapsed / 1000000.0;
+
+    printf("{\"scenario\":\"%s\",\"payload_bytes\":%zd,\"sockets\":%d,"
+        "\"listeners\":%d,\"tls\":%s,\"window\":%zd,"
+        "\"sent\":%zd,\"completed\":%zd,\"failed\":%zd,"
+        "\"elapsed_sec\":%.3f,\"msgs_per_sec\":%.1f,\"mb_per_sec\":%.2f,"
+        "\"p50_usec\":%u,\"p99_usec\":%u,\"p999_usec\":%u,\"max_usec\":%u,"
+        "\"cpu_usec_per_msg\":%.2f}\n",
+        s->name, s->payload_size, s->socket_count,
+        s->listener_count, s->use_tls ? "true" : "false", s->window,
+        s->sent_msgs, done, s->failed_deliveries,
+        secs, done / secs, (done * (double)s->payload_size) / secs / (1024 * 1024),
+        percentile(s->latency_usec, done, 500),
+        percentile(s->latency_usec, done, 990),
+        percentile(s->latency_usec, done, 999),
+        done > 0 ? s->latency_usec[done - 1] : 0,
+        done > 0 ? (double)cpu / done : 0.0);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    executable_name = argv[0];
+    parse_args(argc, argv, &state);
+
+    if (SIG_ERR == signal(SIGPIPE, SIG_IGN)) { err(1, "signal"); }
+
+    state.send_usec = calloc(state.msg_count, sizeof(state.send_usec[0]));
+    state.latency_usec = calloc(state.msg_count, sizeof(state.latency_usec[0]));
+    if (state.send_usec == NULL || state.latency_usec == NULL) {
+        err(1, "calloc");
+    }
+    if (0 != pthread_mutex_init(&state.lock, NULL)) { err(1, "pthread_mutex_init"); }
+    if (0 != pthread_cond_init(&state.cond, NULL)) { err(1, "pthread_cond_init"); }
+
+    bus_config cfg = {
+        .listener_count = state.listener_count,
+        .log_cb = log_cb,
+        .log_level = state.verbosity,
+        .sink_cb = sink_cb,
+        .unpack_cb = unpack_cb,
+        .unexpected_msg_cb = unexpected_msg_cb,
+        .bus_udata = &state,
+    };
+    bus_result res = {0};
+    if (!Bus_Init(&cfg, &res)) {
+        LOG(0, "failed to init bus: %d\n", res.status);
+        return 1;
+    }
+
+    struct bus *b = res.bus;
+    open_sockets(&state, b);
+    run_bench(&state, b);
+    close_sockets(&state, b);
+
+    Bus_Shutdown(b);
+    Bus_Free(b);
+
+    free(state.send_usec);
+    free(state.latency_usec);
+    return state.failed_deliveries == 0 ? 0 : 1;
+}
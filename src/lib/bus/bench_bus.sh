@@ -0,0 +1,74 @@
+#! /usr/bin/env bash
+# Run the message bus benchmark scenarios against local echo servers.
+# Each scenario prints one line of JSON, which is also appended to
+# $BENCH_OUT. Exits non-zero if any scenario failed.
+BASE_DIR=`dirname "$0"`
+cd "$BASE_DIR"
+
+BASE_PORT=${BASE_PORT:-19100}
+BASE_TLS_PORT=${BASE_TLS_PORT:-19443}
+PORT_COUNT=${PORT_COUNT:-4}
+SMALL_MSGS=${SMALL_MSGS:-100000}
+LARGE_MSGS=${LARGE_MSGS:-2000}
+SOCKET_COUNTS=${SOCKET_COUNTS:-"1 10 100 1000"}
+LISTENER_COUNTS=${LISTENER_COUNTS:-"1 2 4 8"}
+BENCH_OUT=${BENCH_OUT:-bench_bus.json}
+
+let HIGH_PORT=BASE_PORT+PORT_COUNT-1
+let HIGH_TLS_PORT=BASE_TLS_PORT+PORT_COUNT-1
+
+# Both sides may hold 1000 sockets, plus the bus's internal pipes.
+ulimit -n 4096 2>/dev/null
+
+PEM=`mktemp -t bench_bus_pem.XXXXXX`
+PIDS=""
+
+cleanup() {
+    for pid in $PIDS; do kill $pid 2>/dev/null; done
+    rm -f "$PEM" "$PEM.key" "$PEM.crt"
+}
+trap cleanup EXIT
+
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj "/CN=localhost" \
+    -keyout "$PEM.key" -out "$PEM.crt" 2>/dev/null || exit 1
+cat "$PEM.crt" "$PEM.key" > "$PEM"
+
+./echosrv -l $BASE_PORT -h $HIGH_PORT &
+PIDS="$PIDS $!"
+./echosrv -l $BASE_TLS_PORT -h $HIGH_TLS_PORT -t "$PEM" &
+PIDS="$PIDS $!"
+sleep 1
+
+: > "$BENCH_OUT"
+FAILED=0
+
+run() {
+    ./bench_bus "$@" | tee -a "$BENCH_OUT"
+    if [ ${PIPESTATUS[0]} -ne 0 ]; then
+        echo "scenario failed: $*" >&2
+        FAILED=1
+    fi
+}
+
+plain() { run -l $BASE_PORT -h $HIGH_PORT "$@"; }
+tls() { run -t -l $BASE_TLS_PORT -h $HIGH_TLS_PORT "$@"; }
+
+# Message size
+plain -N small_msgs -c 1 -p 64 -n $SMALL_MSGS
+plain -N large_msgs -c 1 -p 1048576 -n $LARGE_MSGS -w 4
+
+# Socket fan-out, one listener
+for c in $SOCKET_COUNTS; do
+    plain -N sockets_$c -c $c -p 64 -n $SMALL_MSGS -w 256
+done
+
+# Listener scaling
+for l in $LISTENER_COUNTS; do
+    plain -N listeners_$l -c 64 -L $l -p 64 -n $SMALL_MSGS -w 256
+done
+
+# TLS on (compare with small_msgs and large_msgs above)
+tls -N tls_small_msgs -c 1 -p 64 -n $SMALL_MSGS
+tls -N tls_large_msgs -c 1 -p 1048576 -n $LARGE_MSGS -w 4
+
+exit $FAILED
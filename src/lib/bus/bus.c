@@ -291,6 +291,7 @@ static boxed_msg *box_msg(struct bus *b, bus_user_msg *msg) {
 
     box->cb = msg->cb;
     box->udata = msg->udata;
+    box->inline_cb = msg->inline_cb;
     return box;
 }
 
@@ -575,13 +576,19 @@ static void box_cleanup_cb(void *udata) {
     free(box);
 }
 
-/* Deliver a boxed message to the thread pool to execute.
- * The boxed message will be freed by the threadpool. */
+/* Deliver a boxed message to the thread pool to execute, or execute it
+ * right away if it asked to be called inline. Either way, the boxed
+ * message will be freed. */
 bool Bus_ProcessBoxedMessage(struct bus *b,
         struct boxed_msg *box, size_t *backpressure) {
     assert(box);
     assert(box->result.status != BUS_SEND_UNDEFINED);
 
+    if (box->inline_cb) {
+        box_execute_cb(box);
+        return true;
+    }
+
     struct threadpool_task task = {
         .task = box_execute_cb,
         .cleanup = box_cleanup_cb,
@@ -593,6 +600,49 @@ bool Bus_ProcessBoxedMessage(struct bus *b,
     return Threadpool_Schedule(b->threadpool, &task, backpressure);
 }
 
+/* How many boxed messages to hand to the thread pool per batch. */
+#define BOX_BATCH_SIZE 32
+
+size_t Bus_ProcessBoxedMessages(struct bus *b,
+        struct boxed_msg **boxes, size_t count, size_t *backpressure) {
+    assert(boxes);
+    size_t delivered = 0;
+
+    while (delivered < count) {
+        /* Inline messages are executed in order with the rest, so that
+         * everything before the first one not delivered has been. */
+        assert(boxes[delivered]);
+        if (boxes[delivered]->inline_cb) {
+            box_execute_cb(boxes[delivered]);
+            delivered++;
+            continue;
+        }
+
+        struct threadpool_task tasks[BOX_BATCH_SIZE];
+        size_t batch = 0;
+        while (batch < BOX_BATCH_SIZE && delivered + batch < count
+                && !boxes[delivered + batch]->inline_cb) {
+            struct boxed_msg *box = boxes[delivered + batch];
+            assert(box);
+            assert(box->result.status != BUS_SEND_UNDEFINED);
+            tasks[batch++] = (struct threadpool_task) {
+                .task = box_execute_cb,
+                .cleanup = box_cleanup_cb,
+                .udata = box,
+            };
+        }
+
+        size_t scheduled = Threadpool_ScheduleBatch(b->threadpool,
+            tasks, batch, backpressure);
+        BUS_LOG_SNPRINTF(b, 3, LOG_MEMORY, b->udata, 128,
+            "Scheduled %zd of %zd boxed messages, where they will be freed",
+            scheduled, batch);
+        delivered += scheduled;
+        if (scheduled < batch) { break; }
+    }
+    return delivered;
+}
+
 /* How many seconds should it give the thread pool to shut down? */
 #define THREAD_SHUTDOWN_SECONDS 5
 
@@ -610,6 +660,16 @@ void Bus_Free(bus *b) {
     }
     free(b->listeners);
 
+    struct threadpool_info tp_info = {
+        .active_threads = 0,
+    };
+    Threadpool_Stats(b->threadpool, &tp_info);
+    BUS_LOG_SNPRINTF(b, 2, LOG_SHUTDOWN, b->udata, 256,
+        "Threadpool sizing -- peak %u, spawned %zd, reaped %zd, "
+        "grown for backlog %zd, for latency %zd, avg task %zd usec",
+        tp_info.peak_threads, tp_info.spawned_threads, tp_info.reaped_threads,
+        tp_info.backlog_grows, tp_info.latency_grows, tp_info.avg_task_usec);
+
     int limit = (1000 * THREAD_SHUTDOWN_SECONDS)/10;
     for (int i = 0; i < limit; i++) {
         BUS_LOG_SNPRINTF(b, 3, LOG_SHUTDOWN, b->udata, 128,
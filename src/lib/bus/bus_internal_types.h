@@ -45,6 +45,7 @@ typedef struct boxed_msg {
     /** Callback and userdata to which the bus_msg_result_t above will be sunk. */
     bus_msg_cb *cb;
     void *udata;
+    bool inline_cb;             ///< call cb directly instead of via the thread pool
 
     /** Event timestamps to track timeouts. */
     struct timeval tv_send_start;
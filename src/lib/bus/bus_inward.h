@@ -33,6 +33,12 @@ struct listener *Bus_GetListenerForSocket(struct bus *b, int fd);
 bool Bus_ProcessBoxedMessage(struct bus *b,
     struct boxed_msg *box, size_t *backpressure);
 
+/** Deliver several boxed messages to the thread pool at once. Returns
+ * how many of BOXES, in order, were accepted; the rest still belong
+ * to the caller. */
+size_t Bus_ProcessBoxedMessages(struct bus *b,
+    struct boxed_msg **boxes, size_t count, size_t *backpressure);
+
 /** Provide backpressure by sleeping for (backpressure >> shift) msec, if
  * the value is greater than 0. */
 void Bus_BackpressureDelay(struct bus *b, size_t backpressure, uint8_t shift);
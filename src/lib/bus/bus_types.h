@@ -244,6 +244,11 @@ typedef struct {
 
     bus_msg_cb *cb;
     void *udata;
+
+    /* Call cb on the listener thread, rather than handing it to the
+     * thread pool. Only for quick callbacks that never block. Send
+     * failures are still handed to the thread pool. */
+    bool inline_cb;
 } bus_user_msg;
 
 /* This opaque bus struct represents the only user-facing interface to
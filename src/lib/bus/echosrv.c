@@ -24,12 +24,17 @@
 #include <assert.h>
 #include <err.h>
 #include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
 #include <sys/time.h>
 #include <sys/socket.h>
 
 // For TCP_NODELAY
 #include <netinet/tcp.h>
 
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
 #include "socket99.h"
 #include "util.h"
 
@@ -37,7 +42,7 @@
 #include <poll.h>
 
 #define BUF_SZ (2 * 1024L * 1024)
-#define MAX_CLIENTS 10
+#define MAX_CLIENTS 1024
 
 #define NO_CLIENT ((int)-1)
 
@@ -52,11 +57,14 @@ static uint8_t read_buf[BUF_SZ];
     while(0)
 
 
+/* Per-client output buffer. The backing storage is allocated when the
+ * client connects, so idle slots don't cost 2 * BUF_SZ each. */
 typedef struct {
     int fd;
+    SSL *ssl;                   /* NULL unless running with -t */
     size_t out_bytes;
     size_t written_bytes;
-    uint8_t buf[2*BUF_SZ];
+    uint8_t *buf;
 } out_buf;
 
 typedef struct {
@@ -64,6 +72,8 @@ typedef struct {
     int port_high;
     int port_count;
     int verbosity;
+    const char *tls_pem;
+    SSL_CTX *ssl_ctx;
 
     int ticks;
     time_t last_second;
@@ -87,11 +97,15 @@ static void register_client(config *cfg, int cfd,
 static void disconnect_client(config *cfg, int fd);
 static void enqueue_write(config *cfg, int fd,
     uint8_t *buf, size_t write_size);
+static void init_tls(config *cfg);
+static bool accept_tls(config *cfg, out_buf *out);
+static void read_client(config *cfg, int i);
 
 static void usage(void) {
     fprintf(stderr,
-        "Usage: echosrv [-l LOW_PORT] [-h HIGH_PORT] [-v] \n"
+        "Usage: echosrv [-l LOW_PORT] [-h HIGH_PORT] [-t CERT_AND_KEY_PEM] [-v] \n"
         "    If only one of -l or -h are specified, it will use just that one port.\n"
+        "    -t accepts TLS connections, using the certificate and private key in the file.\n"
         "    -v can be used multiple times to increase verbosity.\n");
     exit(1);
 }
@@ -99,7 +113,7 @@ static void usage(void) {
 static void parse_args(int argc, char **argv, config *cfg) {
     int a = 0;
     
-    while ((a = getopt(argc, argv, "l:h:v")) != -1) {
+    while ((a = getopt(argc, argv, "l:h:t:v")) != -1) {
         switch (a) {
         case 'l':               /* low port */
             cfg->port_low = atoi(optarg);
@@ -107,6 +121,9 @@ static void parse_args(int argc, char **argv, config *cfg) {
         case 'h':               /* high port */
             cfg->port_high = atoi(optarg);
             break;
+        case 't':               /* TLS certificate and key */
+            cfg->tls_pem = optarg;
+            break;
         case 'v':               /* verbosity */
             cfg->verbosity++;
             break;
@@ -128,6 +145,7 @@ int main(int argc, char **argv) {
     parse_args(argc, argv, &cfg);
         
     init_polling(&cfg);
+    if (cfg.tls_pem) { init_tls(&cfg); }
     open_ports(&cfg);
     listen_loop_poll(&cfg);
 
@@ -153,6 +171,8 @@ static void init_polling(config *cfg) {
         cfg->client_fds[i].fd = NO_CLIENT;
     }
 
+    signal(SIGPIPE, SIG_IGN);
+
     size_t out_bufs_sz = MAX_CLIENTS * sizeof(out_buf);
     cfg->out_bufs = malloc(out_bufs_sz);
     assert(cfg->out_bufs);
@@ -282,7 +302,7 @@ static void handle_incoming_connections(config *cfg, int available) {
         } else if (fd->revents & POLLIN) {
             checked++;
             struct sockaddr address;
-            socklen_t addr_len;
+            socklen_t addr_len = sizeof(address);
             int client_fd = accept(fd->fd, &address, &addr_len);
             if (client_fd == -1) {
                 if (errno == EWOULDBLOCK) {
@@ -303,6 +323,8 @@ static void handle_incoming_connections(config *cfg, int available) {
 
 static void register_client(config *cfg, int cfd,
         struct sockaddr *addr, socklen_t addr_len) {
+    (void)addr;
+    (void)addr_len;
 
     /* assign to first empty slot */
     int client_index = 0;
@@ -314,14 +336,34 @@ static void register_client(config *cfg, int cfd,
     LOG(3, " -- assigning client in slot %d\n", client_index);
 
     out_buf *out = &cfg->out_bufs[client_index];
+    if (out->buf == NULL) {
+        out->buf = malloc(2*BUF_SZ);
+        assert(out->buf);
+    }
     out->fd = cfd;
+    out->ssl = NULL;
     out->out_bytes = 0;
+    out->written_bytes = 0;
 
     int flag = 1;
     if (0 != setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(int))) {
         err(1, "setsockopt");
     }
 
+    /* Linux's accept(2) doesn't carry O_NONBLOCK over from the
+     * listening socket, and draining TLS records relies on it. */
+    int fl = fcntl(cfd, F_GETFL, 0);
+    if (fl == -1 || -1 == fcntl(cfd, F_SETFL, fl | O_NONBLOCK)) {
+        err(1, "fcntl");
+    }
+
+    if (cfg->ssl_ctx && !accept_tls(cfg, out)) {
+        LOG(1, "TLS handshake failed for client %d\n", cfd);
+        out->fd = NO_CLIENT;
+        close(cfd);
+        return;
+    }
+
     struct pollfd *fd = &cfg->client_fds[client_index];
     fd->fd = cfd;
     fd->events = (POLLIN);
@@ -331,7 +373,9 @@ static void register_client(config *cfg, int cfd,
 
 static void handle_client_io(config *cfg, int available) {
     int checked = 0;
-    for (int i = 0; i < cfg->client_count; i++) {
+    /* Walk backward: disconnect_client moves the last client into the
+     * freed slot, and that client has already been handled. */
+    for (int i = cfg->client_count - 1; i >= 0; i--) {
         if (checked == available) { break; }
         struct pollfd *fd = &cfg->client_fds[i];
 
@@ -345,11 +389,26 @@ static void handle_client_io(config *cfg, int available) {
             out_buf *buf = &cfg->out_bufs[i];
             LOG(2, "writing %zd bytes to %d\n", buf->out_bytes, buf->fd);
             size_t wr_size = buf->out_bytes - buf->written_bytes;
-            ssize_t wres = write(buf->fd, &buf->buf[buf->written_bytes], wr_size);
+            ssize_t wres = 0;
+            if (buf->ssl) {
+                wres = SSL_write(buf->ssl, &buf->buf[buf->written_bytes], wr_size);
+                if (wres <= 0) {
+                    int reason = SSL_get_error(buf->ssl, wres);
+                    if (reason == SSL_ERROR_WANT_WRITE || reason == SSL_ERROR_WANT_READ) {
+                        wres = 0;
+                    } else {
+                        disconnect_client(cfg, fd->fd);
+                        continue;
+                    }
+                }
+            } else {
+                wres = write(buf->fd, &buf->buf[buf->written_bytes], wr_size);
+            }
+
             if (wres == -1) {
                 if (Util_IsResumableIOError(errno)) {
                     errno = 0;
-                } else if (errno == EPIPE) {
+                } else if (errno == EPIPE || errno == ECONNRESET) {
                     disconnect_client(cfg, fd->fd);
                 } else {
                     err(1, "write");
@@ -361,31 +420,66 @@ static void handle_client_io(config *cfg, int available) {
                     buf->written_bytes = 0;
                     cfg->successful_writes++;
                     fd->events = POLLIN;
+
+                    /* OpenSSL may already hold the rest of a record, which
+                     * poll(2) won't report as readable. */
+                    if (buf->ssl && SSL_pending(buf->ssl) > 0) {
+                        read_client(cfg, i);
+                    }
                 }
             }
         } else if (fd->revents & POLLIN) {
             checked++;
-            /* if we can read, then queue up same as a write */
-            out_buf *buf = &cfg->out_bufs[i];
-            ssize_t rres = read(buf->fd, read_buf, BUF_SZ - 1);
+            read_client(cfg, i);
+        }
+    }
+}
 
-            if (rres == -1) {
-                if (Util_IsResumableIOError(errno)) {
-                    errno = 0;
-                } else if (errno == EPIPE) {
-                    disconnect_client(cfg, fd->fd);
-                } else {
-                    err(1, "read");
-                }
-            } else if (rres > 0) {
-                /* enqueue outgoing write */
-                LOG(2, "%ld -- got %zd bytes\n",
-                    cfg->last_second, rres);
-                enqueue_write(cfg, buf->fd, read_buf, rres);
-            } else {
-                LOG(2, "else, rres %zd\n", rres);
+/* Read whatever client I has sent, and queue it up to be echoed back. */
+static void read_client(config *cfg, int i) {
+    out_buf *buf = &cfg->out_bufs[i];
+    ssize_t rres = 0;
+
+    if (buf->ssl) {
+        bool closed = false;
+        size_t total = 0;
+        while (total < BUF_SZ - 1) {
+            int res = SSL_read(buf->ssl, &read_buf[total], BUF_SZ - 1 - total);
+            if (res > 0) {
+                total += res;
+                continue;
+            }
+            int reason = SSL_get_error(buf->ssl, res);
+            if (reason != SSL_ERROR_WANT_READ && reason != SSL_ERROR_WANT_WRITE) {
+                closed = true;
             }
+            break;
+        }
+        if (total == 0) {
+            if (closed) { disconnect_client(cfg, buf->fd); }
+            return;
         }
+        rres = total;
+    } else {
+        rres = read(buf->fd, read_buf, BUF_SZ - 1);
+    }
+
+    if (rres == -1) {
+        if (Util_IsResumableIOError(errno)) {
+            errno = 0;
+        } else if (errno == EPIPE || errno == ECONNRESET) {
+            disconnect_client(cfg, buf->fd);
+        } else {
+            err(1, "read");
+        }
+    } else if (rres > 0) {
+        /* enqueue outgoing write */
+        LOG(2, "%ld -- got %zd bytes\n",
+            cfg->last_second, rres);
+        enqueue_write(cfg, buf->fd, read_buf, rres);
+    } else {
+        LOG(2, "else, rres %zd\n", rres);
+        disconnect_client(cfg, buf->fd);
     }
 }
 
@@ -414,13 +508,31 @@ static void enqueue_write(config *cfg, int fd,
 }
 
 static void disconnect_client(config *cfg, int fd) {
-    for (int i = 0; i < MAX_CLIENTS; i++) {
+    for (int i = 0; i < cfg->client_count; i++) {
         if (cfg->client_fds[i].fd == fd) {
             LOG(3, "disconnecting client %d\n", fd);
-            cfg->client_fds[i].fd = NO_CLIENT;
+            out_buf *out = &cfg->out_bufs[i];
+            if (out->ssl) {
+                SSL_free(out->ssl);
+                out->ssl = NULL;
+            }
             close(fd);
-            cfg->out_bufs[i].fd = NO_CLIENT;
-            cfg->out_bufs[i].out_bytes = 0;
+
+            /* Move the last client into this slot, so the first
+             * client_count entries passed to poll(2) stay dense. */
+            int last = cfg->client_count - 1;
+            uint8_t *freed_buf = out->buf;
+            cfg->client_fds[i] = cfg->client_fds[last];
+            cfg->out_bufs[i] = cfg->out_bufs[last];
+
+            cfg->client_fds[last].fd = NO_CLIENT;
+            cfg->client_fds[last].events = 0;
+            cfg->client_fds[last].revents = 0;
+            cfg->out_bufs[last].fd = NO_CLIENT;
+            cfg->out_bufs[last].ssl = NULL;
+            cfg->out_bufs[last].out_bytes = 0;
+            cfg->out_bufs[last].written_bytes = 0;
+            cfg->out_bufs[last].buf = freed_buf;
             cfg->client_count--;
             return;
         }
@@ -428,3 +540,65 @@ static void disconnect_client(config *cfg, int fd) {
 
     assert(false);              /* not found */
 }
+
+static void init_tls(config *cfg) {
+    SSL_library_init();
+    SSL_load_error_strings();
+
+    SSL_CTX *ctx = SSL_CTX_new(SSLv23_server_method());
+    if (ctx == NULL) {
+        ERR_print_errors_fp(stderr);
+        exit(1);
+    }
+
+    if (1 != SSL_CTX_use_certificate_chain_file(ctx, cfg->tls_pem)
+        || 1 != SSL_CTX_use_PrivateKey_file(ctx, cfg->tls_pem, SSL_FILETYPE_PEM)) {
+        ERR_print_errors_fp(stderr);
+        exit(1);
+    }
+
+    /* Writes resume from wherever the last partial write left off. */
+    SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE
+        | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    cfg->ssl_ctx = ctx;
+}
+
+/* Do the server side of the TLS handshake. Blocking. */
+static bool accept_tls(config *cfg, out_buf *out) {
+    SSL *ssl = SSL_new(cfg->ssl_ctx);
+    if (ssl == NULL || !SSL_set_fd(ssl, out->fd)) {
+        ERR_print_errors_fp(stderr);
+        SSL_free(ssl);
+        return false;
+    }
+
+    struct pollfd fds[1];
+    fds[0].fd = out->fd;
+    fds[0].events = POLLIN;
+
+    for (;;) {
+        int res = SSL_accept(ssl);
+        if (res == 1) {
+            out->ssl = ssl;
+            return true;
+        }
+
+        int reason = SSL_get_error(ssl, res);
+        if (reason == SSL_ERROR_WANT_READ) {
+            fds[0].events = POLLIN;
+        } else if (reason == SSL_ERROR_WANT_WRITE) {
+            fds[0].events = POLLOUT;
+        } else {
+            ERR_print_errors_fp(stderr);
+            SSL_free(ssl);
+            return false;
+        }
+
+        int pres = poll(fds, 1, MAX_TIMEOUT);
+        if (pres == 0 || (pres == -1 && !Util_IsResumableIOError(errno))) {
+            SSL_free(ssl);
+            return false;
+        }
+        errno = 0;
+    }
+}
@@ -123,6 +123,10 @@ typedef struct rx_info_t {
 
 /** Max number of unprocessed queue messages */
 #define MAX_QUEUE_MESSAGES (32)
+
+/** Max number of responses read in one poll cycle to queue up before
+ * handing them to the threadpool together. */
+#define MAX_DELIVERY_BATCH (32)
 typedef uint32_t msg_flag_t;
 
 /** Special value meaning poll should block indefinitely. */
@@ -160,6 +164,11 @@ typedef struct listener {
 
     size_t upstream_backpressure;
 
+    /** Responses ready for delivery, to schedule as one batch after
+     * the current round of reads. */
+    rx_info_t *delivery_batch[MAX_DELIVERY_BATCH];
+    uint16_t delivery_batch_count;
+
     uint16_t tracked_fds;       ///< FDs currently tracked by listener
     /** File descriptors that are inactive due to errors, but have not
      * yet been explicitly removed/closed by the client. */
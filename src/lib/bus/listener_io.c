@@ -284,8 +284,11 @@ static void set_error_for_socket(listener *l, int id, int fd, rx_error_t err) {
             break;
         case RIS_EXPECT:
         {
+            /* A response already received and queued for delivery
+             * keeps its result; only still-pending ones fail. */
             struct boxed_msg *box = info->u.expect.box;
-            if (box && box->fd == fd) {
+            if (box && box->fd == fd &&
+                    info->u.expect.error != RX_ERROR_READY_FOR_DELIVERY) {
                 info->u.expect.error = err;
             }
             break;
@@ -360,7 +363,7 @@ static void process_unpacked_message(listener *l,
                 BUS_ASSERT(b, b->udata, !info->u.hold.has_result);
                 info->u.expect.has_result = true;
                 info->u.expect.result = result;
-                ListenerTask_AttemptDelivery(l, info);
+                ListenerTask_QueueDelivery(l, info);
                 break;
             }
             case RIS_INACTIVE:
@@ -41,6 +41,10 @@ static void tick_handler(listener *l);
 static void clean_up_completed_info(listener *l, rx_info_t *info);
 static void retry_delivery(listener *l, rx_info_t *info);
 static void observe_backpressure(listener *l, size_t backpressure);
+static boxed_msg *prepare_delivery(listener *l, rx_info_t *info);
+static void finish_delivery(listener *l, rx_info_t *info,
+    boxed_msg *box, bool delivered);
+static void flush_deliveries(listener *l);
 
 void *ListenerTask_MainLoop(void *arg) {
     listener *self = (listener *)arg;
@@ -94,6 +98,9 @@ void *ListenerTask_MainLoop(void *arg) {
             if (poll_res > 0) {
                 ListenerIO_AttemptRecv(self, poll_res);
             }
+            if (self->delivery_batch_count > 0) {
+                flush_deliveries(self);
+            }
         } else {
             /* nothing to do */
         }
@@ -465,6 +472,56 @@ bool ListenerTask_GrowReadBuf(listener *l, size_t nsize) {
 
 void ListenerTask_AttemptDelivery(listener *l, struct rx_info_t *info) {
     struct bus *b = l->bus;
+    struct boxed_msg *box = prepare_delivery(l, info);
+
+    #ifndef TEST
+    size_t backpressure = 0;
+    #endif
+    bool delivered = Bus_ProcessBoxedMessage(b, box, &backpressure);
+    finish_delivery(l, info, box, delivered);
+    observe_backpressure(l, backpressure);
+}
+
+void ListenerTask_QueueDelivery(listener *l, struct rx_info_t *info) {
+    struct bus *b = l->bus;
+    BUS_ASSERT(b, b->udata, info->state == RIS_EXPECT);
+    BUS_ASSERT(b, b->udata, l->delivery_batch_count < MAX_DELIVERY_BATCH);
+
+    l->delivery_batch[l->delivery_batch_count++] = info;
+    if (l->delivery_batch_count == MAX_DELIVERY_BATCH) {
+        flush_deliveries(l);
+    }
+}
+
+/* Schedule every queued delivery with a single threadpool batch. Any
+ * the threadpool cannot take yet keep their box, and are retried in
+ * tick_handler. */
+static void flush_deliveries(listener *l) {
+    struct bus *b = l->bus;
+    uint16_t count = l->delivery_batch_count;
+    boxed_msg *boxes[MAX_DELIVERY_BATCH];
+
+    BUS_LOG_SNPRINTF(b, 3, LOG_LISTENER, b->udata, 64,
+        "attempting delivery of %u queued messages", count);
+    for (uint16_t i = 0; i < count; i++) {
+        boxes[i] = prepare_delivery(l, l->delivery_batch[i]);
+    }
+
+    #ifndef TEST
+    size_t backpressure = 0;
+    #endif
+    size_t delivered = Bus_ProcessBoxedMessages(b, boxes, count, &backpressure);
+    for (uint16_t i = 0; i < count; i++) {
+        finish_delivery(l, l->delivery_batch[i], boxes[i], i < delivered);
+        l->delivery_batch[i] = NULL;
+    }
+    l->delivery_batch_count = 0;
+    observe_backpressure(l, backpressure);
+}
+
+/* Release the box from INFO, filling in its result for delivery. */
+static boxed_msg *prepare_delivery(listener *l, rx_info_t *info) {
+    struct bus *b = l->bus;
 
     struct boxed_msg *box = info->u.expect.box;
     info->u.expect.box = NULL;  /* release */
@@ -500,26 +557,29 @@ void ListenerTask_AttemptDelivery(listener *l, struct rx_info_t *info) {
     void *opaque_msg = unpacked_result.u.success.msg;
     result->u.response.seq_id = seq_id;
     result->u.response.opaque_msg = opaque_msg;
+    return box;
+}
 
-    #ifndef TEST
-    size_t backpressure = 0;
-    #endif
-    if (Bus_ProcessBoxedMessage(b, box, &backpressure)) {
+/* Mark INFO as DONE if its BOX was delivered, otherwise return the box
+ * to it so delivery is retried in tick_handler. */
+static void finish_delivery(listener *l, rx_info_t *info,
+        boxed_msg *box, bool delivered) {
+    struct bus *b = l->bus;
+
+    if (delivered) {
         /* success */
         BUS_LOG_SNPRINTF(b, 3, LOG_MEMORY, b->udata, 256,
             "successfully delivered box %p (seq_id:%lld), marking info %d as DONE",
-            (void*)box, (long long)seq_id, info->id);
+            (void*)box, (long long)info->u.expect.result.u.success.seq_id, info->id);
         info->u.expect.error = RX_ERROR_DONE;
         BUS_LOG_SNPRINTF(b, 4, LOG_LISTENER, b->udata, 128,
             "initial clean-up attempt for completed RX event at info +%d", info->id);
         clean_up_completed_info(l, info);
-        info = NULL; /* drop out of scope, likely to be stale */
     } else {
         BUS_LOG_SNPRINTF(b, 3, LOG_MEMORY, b->udata, 128,
             "returning box %p at line %d", (void*)box, __LINE__);
         info->u.expect.box = box; /* retry in tick_handler */
     }
-    observe_backpressure(l, backpressure);
 }
 
 static void observe_backpressure(listener *l, size_t backpressure) {
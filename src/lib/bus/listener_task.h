@@ -39,6 +39,11 @@ bool ListenerTask_GrowReadBuf(listener *l, size_t nsize);
 /** Attempt delivery of the message boxed in INFO. */
 void ListenerTask_AttemptDelivery(listener *l, struct rx_info_t *info);
 
+/** Queue delivery of the message boxed in INFO. Queued messages are
+ * scheduled together once the listener finishes the current round of
+ * reads, or as soon as the batch fills up. */
+void ListenerTask_QueueDelivery(listener *l, struct rx_info_t *info);
+
 /** Notify the client that the event in INFO has failed with STATUS. */
 void ListenerTask_NotifyMessageFailure(listener *l,
     rx_info_t *info, bus_send_status_t status);
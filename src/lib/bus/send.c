@@ -214,6 +214,10 @@ void Send_HandleFailure(struct bus *b, boxed_msg *box, bus_send_status_t status)
     box->result = (bus_msg_result_t){
         .status = status,
     };
+
+    /* This runs on the thread sending the request, which may still hold
+     * its caller's send lock, so never execute the callback here. */
+    box->inline_cb = false;
     
     #ifndef TEST
     size_t backpressure = 0;
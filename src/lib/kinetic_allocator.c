@@ -59,13 +59,16 @@ void KineticAllocator_FreeSession(KineticSession* session)
     }
 }
 
-KineticResponse * KineticAllocator_NewKineticResponse(size_t const valueLength)
+KineticResponse * KineticAllocator_NewKineticResponse(size_t const protobufLength,
+    size_t const valueLength)
 {
-    KineticResponse * response = KineticCalloc(1, sizeof(*response) + valueLength);
+    // The packed message is kept after the value, for unpacking on demand
+    KineticResponse * response = KineticCalloc(1, sizeof(*response) + valueLength + protobufLength);
     if (response == NULL) {
         LOG0("Failed allocating new response!");
         return NULL;
     }
+    response->protoBytes = &response->value[valueLength];
     return response;
 }
 
@@ -73,6 +76,14 @@ void KineticAllocator_FreeKineticResponse(KineticResponse * response)
 {
     KINETIC_ASSERT(response != NULL);
 
+    if (response->arena != NULL) {
+        // proto and command were unpacked into the arena; drop them all at once
+        KineticArena_Release(response->arena);
+        response->arena = NULL;
+        KineticFree(response);
+        return;
+    }
+
     if (response->command != NULL) {
         protobuf_c_message_free_unpacked(&response->command->base, NULL);
     }
@@ -82,10 +93,80 @@ void KineticAllocator_FreeKineticResponse(KineticResponse * response)
     KineticFree(response);
 }
 
+bool KineticAllocator_NewOperationPool(KineticSession* const session, size_t count)
+{
+    KINETIC_ASSERT(session != NULL);
+    KineticOperationPool * const pool = &session->operationPool;
+
+    KineticOperationSlot * slots = KineticCalloc(count, sizeof(KineticOperationSlot));
+    if (slots == NULL) {
+        LOGF0("Failed allocating %zu pooled operations on session %p", count, (void*)session);
+        return false;
+    }
+    if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+        KineticFree(slots);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        KineticRequest_Init(&slots[i].request, session);
+        slots[i].next = (i + 1 < count) ? &slots[i + 1] : NULL;
+    }
+    pool->slots = slots;
+    pool->count = count;
+    pool->freeList = slots;
+    return true;
+}
+
+void KineticAllocator_FreeOperationPool(KineticSession* const session)
+{
+    KINETIC_ASSERT(session != NULL);
+    KineticOperationPool * const pool = &session->operationPool;
+    if (pool->slots != NULL) {
+        pthread_mutex_destroy(&pool->mutex);
+        KineticFree(pool->slots);
+        pool->slots = NULL;
+        pool->freeList = NULL;
+        pool->count = 0;
+    }
+}
+
+static KineticOperationSlot * take_pooled_slot(KineticOperationPool * const pool)
+{
+    if (pool->slots == NULL) { return NULL; }
+    pthread_mutex_lock(&pool->mutex);
+    KineticOperationSlot * slot = pool->freeList;
+    if (slot != NULL) {
+        pool->freeList = slot->next;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return slot;
+}
+
+static bool is_pooled(KineticOperationPool const * const pool, KineticOperation const * const op)
+{
+    KineticOperationSlot const * const slot = (KineticOperationSlot const *)op;
+    return pool->slots != NULL && slot >= pool->slots && slot < &pool->slots[pool->count];
+}
+
 KineticOperation* KineticAllocator_NewOperation(KineticSession* const session)
 {
     KINETIC_ASSERT(session != NULL);
 
+    /* Operations beyond the queue depth can exist while their callers wait
+     * for a slot to send, so fall back to the heap when the pool is empty. */
+    KineticOperationSlot * slot = take_pooled_slot(&session->operationPool);
+    if (slot != NULL) {
+        LOGF3("Reusing pooled operation %p on session %p", (void*)slot, (void*)session);
+        slot->operation = (KineticOperation) {
+            .session = session,
+            .pool = &session->operationPool,
+            .request = &slot->request,
+            .timeoutSeconds = session->timeoutSeconds,
+        };
+        KineticRequest_Reset(&slot->request, session);
+        return &slot->operation;
+    }
+
     LOGF3("Allocating new operation on session %p", (void*)session);
     KineticOperation* newOperation =
         (KineticOperation*)KineticCalloc(1, sizeof(KineticOperation));
@@ -109,14 +190,27 @@ void KineticAllocator_FreeOperation(KineticOperation* operation)
 {
     KINETIC_ASSERT(operation != NULL);
     LOGF3("Freeing operation %p on session %p", (void*)operation, (void*)operation->session);
-    if (operation->request != NULL) {
-        KineticFree(operation->request);
-        operation->request = NULL;
-    }
     if (operation->response != NULL) {
         KineticAllocator_FreeKineticResponse(operation->response);
         operation->response = NULL;
     }
+
+    /* Checked against the pool the operation was taken from, which is not
+     * its session's when it was moved to another connection to be sent. */
+    KineticOperationPool * const pool = operation->pool;
+    if (pool != NULL && is_pooled(pool, operation)) {
+        KineticOperationSlot * const slot = (KineticOperationSlot *)operation;
+        pthread_mutex_lock(&pool->mutex);
+        slot->next = pool->freeList;
+        pool->freeList = slot;
+        pthread_mutex_unlock(&pool->mutex);
+        return;
+    }
+
+    if (operation->request != NULL) {
+        KineticFree(operation->request);
+        operation->request = NULL;
+    }
     KineticFree(operation);
 }
 
@@ -29,7 +29,11 @@ void KineticAllocator_FreeSession(KineticSession* session);
 KineticOperation* KineticAllocator_NewOperation(KineticSession* const session);
 void KineticAllocator_FreeOperation(KineticOperation* operation);
 
-KineticResponse * KineticAllocator_NewKineticResponse(size_t const valueLength);
+bool KineticAllocator_NewOperationPool(KineticSession* const session, size_t count);
+void KineticAllocator_FreeOperationPool(KineticSession* const session);
+
+KineticResponse * KineticAllocator_NewKineticResponse(size_t const protobufLength,
+    size_t const valueLength);
 void KineticAllocator_FreeKineticResponse(KineticResponse * response);
 
 void KineticAllocator_FreeP2PProtobuf(Com__Seagate__Kinetic__Proto__Command__P2POperation* proto_p2pOp);
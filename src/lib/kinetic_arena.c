@@ -0,0 +1,177 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include "kinetic_arena.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/* Smallest first block, the largest first block kept on reuse, and the
+ * most arenas kept for reuse. */
+#define KINETIC_ARENA_BLOCK_SIZE (4 * 1024)
+#define KINETIC_ARENA_KEEP_MAX (64 * 1024)
+#define KINETIC_ARENA_POOL_MAX (64)
+
+/* Unpacked protobuf-c messages hold pointers, int64s, and doubles. */
+#define KINETIC_ARENA_ALIGN (sizeof(union { void *p; int64_t i; double d; long double ld; }))
+#define ALIGN_UP(X) (((X) + KINETIC_ARENA_ALIGN - 1) & ~(KINETIC_ARENA_ALIGN - 1))
+
+typedef struct _KineticArenaBlock {
+    struct _KineticArenaBlock * next;
+    size_t capacity;
+    size_t used;
+    uint8_t data[];
+} KineticArenaBlock;
+
+struct _KineticArena {
+    ProtobufCAllocator allocator;
+    KineticArena * nextFree;
+    KineticArenaBlock * first;      // kept across reuse
+    KineticArenaBlock * overflow;   // freed on release
+};
+
+static pthread_mutex_t PoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static KineticArena * PoolHead = NULL;
+static size_t PoolCount = 0;
+
+static KineticArenaBlock * new_block(size_t capacity)
+{
+    KineticArenaBlock * block = malloc(ALIGN_UP(sizeof(KineticArenaBlock)) + capacity);
+    if (block == NULL) { return NULL; }
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+static void * block_alloc(KineticArenaBlock * const block, size_t size)
+{
+    /* The header is padded so that data starts aligned. */
+    uint8_t * base = (uint8_t *)block + ALIGN_UP(sizeof(KineticArenaBlock));
+    if (block->capacity - block->used < size) { return NULL; }
+    void * ptr = &base[block->used];
+    block->used += size;
+    return ptr;
+}
+
+static void * arena_alloc(void * allocator_data, size_t size)
+{
+    KineticArena * const arena = allocator_data;
+    size = ALIGN_UP(size > 0 ? size : 1);
+
+    void * ptr = NULL;
+    if (arena->overflow != NULL) {
+        ptr = block_alloc(arena->overflow, size);
+    } else {
+        ptr = block_alloc(arena->first, size);
+    }
+    if (ptr != NULL) { return ptr; }
+
+    /* Grow geometrically, so a large message needs only a few blocks. */
+    size_t capacity = (arena->overflow != NULL ? arena->overflow : arena->first)->capacity * 2;
+    if (capacity < size) { capacity = size; }
+    KineticArenaBlock * block = new_block(capacity);
+    if (block == NULL) {
+        LOGF0("Failed growing response arena by %zu bytes", capacity);
+        return NULL;
+    }
+    block->next = arena->overflow;
+    arena->overflow = block;
+    return block_alloc(block, size);
+}
+
+static void arena_free(void * allocator_data, void * pointer)
+{
+    (void)allocator_data;
+    (void)pointer;
+}
+
+KineticArena * KineticArena_Take(size_t size_hint)
+{
+    size_t capacity = ALIGN_UP(size_hint);
+    if (capacity < KINETIC_ARENA_BLOCK_SIZE) { capacity = KINETIC_ARENA_BLOCK_SIZE; }
+
+    pthread_mutex_lock(&PoolMutex);
+    KineticArena * arena = PoolHead;
+    if (arena != NULL) {
+        PoolHead = arena->nextFree;
+        PoolCount--;
+    }
+    pthread_mutex_unlock(&PoolMutex);
+
+    if (arena == NULL) {
+        arena = malloc(sizeof(KineticArena));
+        if (arena == NULL) { return NULL; }
+        arena->first = NULL;
+        arena->overflow = NULL;
+        arena->allocator = (ProtobufCAllocator) {
+            .alloc = arena_alloc,
+            .free = arena_free,
+            .allocator_data = arena,
+        };
+    }
+
+    if (arena->first == NULL || arena->first->capacity < capacity) {
+        free(arena->first);
+        arena->first = new_block(capacity);
+        if (arena->first == NULL) {
+            free(arena);
+            return NULL;
+        }
+    }
+    arena->nextFree = NULL;
+    return arena;
+}
+
+ProtobufCAllocator * KineticArena_Allocator(KineticArena * const arena)
+{
+    return (arena != NULL) ? &arena->allocator : NULL;
+}
+
+void KineticArena_Release(KineticArena * const arena)
+{
+    if (arena == NULL) { return; }
+
+    while (arena->overflow != NULL) {
+        KineticArenaBlock * next = arena->overflow->next;
+        free(arena->overflow);
+        arena->overflow = next;
+    }
+    arena->first->used = 0;
+    if (arena->first->capacity > KINETIC_ARENA_KEEP_MAX) {
+        /* Don't let one huge response pin its memory in the pool. */
+        free(arena->first);
+        arena->first = NULL;
+    }
+
+    pthread_mutex_lock(&PoolMutex);
+    bool pooled = (PoolCount < KINETIC_ARENA_POOL_MAX);
+    if (pooled) {
+        arena->nextFree = PoolHead;
+        PoolHead = arena;
+        PoolCount++;
+    }
+    pthread_mutex_unlock(&PoolMutex);
+
+    if (!pooled) {
+        free(arena->first);
+        free(arena);
+    }
+}
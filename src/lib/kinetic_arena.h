@@ -0,0 +1,46 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_ARENA_H
+#define _KINETIC_ARENA_H
+
+#include <stddef.h>
+#include "protobuf-c/protobuf-c.h"
+
+/* Bump allocator for unpacking one response. Every allocation protobuf-c
+ * makes while unpacking comes out of the arena, and releasing the arena
+ * frees all of it at once, instead of walking the message with
+ * protobuf_c_message_free_unpacked. Released arenas are kept in a pool
+ * and reused. */
+typedef struct _KineticArena KineticArena;
+
+/* Take an arena from the pool (or allocate one), with room for at least
+ * SIZE_HINT bytes before it has to grow. Returns NULL on allocation
+ * failure. */
+KineticArena * KineticArena_Take(size_t size_hint);
+
+/* Allocator that carves from ARENA; its free is a no-op. Returns NULL
+ * (protobuf-c's default allocator) if ARENA is NULL. */
+ProtobufCAllocator * KineticArena_Allocator(KineticArena * const arena);
+
+/* Free everything allocated from ARENA and return it to the pool. */
+void KineticArena_Release(KineticArena * const arena);
+
+#endif // _KINETIC_ARENA_H
@@ -20,6 +20,8 @@
 
 #include "kinetic_auth.h"
 #include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
+#include "kinetic_signingqueue.h"
 #include "kinetic.pb-c.h"
 #include "kinetic_logger.h"
 
@@ -30,15 +32,9 @@ KineticStatus KineticAuth_EnsureSslEnabled(KineticSessionConfig const * const co
     return KINETIC_STATUS_SUCCESS;
 }
 
-KineticStatus KineticAuth_PopulateHmac(KineticSessionConfig const * const config, KineticRequest * const pdu)
+/* Point the request's message at its HMAC auth fields, ready to sign. */
+static void prepare_hmac(KineticSessionConfig const * const config, KineticRequest * const pdu)
 {
-    KINETIC_ASSERT(config);
-    KINETIC_ASSERT(pdu);
-
-    LOG3("Adding HMAC auth info");
-
-    if (config->hmacKey.data == NULL) { return KINETIC_STATUS_HMAC_REQUIRED; }
-
     Com__Seagate__Kinetic__Proto__Message* msg = &pdu->message.message;
 
     // Add HMAC authentication struct
@@ -64,11 +60,72 @@ KineticStatus KineticAuth_PopulateHmac(KineticSessionConfig const * const config
     msg->hmacauth->has_hmac = true;
     msg->hmacauth->identity = config->identity;
     msg->hmacauth->has_identity = true;
+}
+
+KineticStatus KineticAuth_PopulateHmac(KineticSessionConfig const * const config, KineticRequest * const pdu)
+{
+    KINETIC_ASSERT(config);
+    KINETIC_ASSERT(pdu);
+
+    LOG3("Adding HMAC auth info");
+
+    if (config->hmacKey.data == NULL) { return KINETIC_STATUS_HMAC_REQUIRED; }
+
+    prepare_hmac(config, pdu);
 
     // Populate with hashed HMAC
     KineticHMAC hmac;
     KineticHMAC_Init(&hmac, COM__SEAGATE__KINETIC__PROTO__COMMAND__SECURITY__ACL__HMACALGORITHM__HmacSHA1);
-    KineticHMAC_Populate(&hmac, &pdu->message.message, config->hmacKey);
+    if (pdu->signingQueue != NULL) {
+        KineticSigningQueue_Sign(pdu->signingQueue, &hmac, &pdu->message.message);
+    }
+    else if (pdu->hmacKey != NULL) {
+        KineticHMAC_PopulateWithKey(&hmac, &pdu->message.message, pdu->hmacKey);
+    }
+    else {
+        KineticHMAC_Populate(&hmac, &pdu->message.message, config->hmacKey);
+    }
+
+    return KINETIC_STATUS_SUCCESS;
+}
+
+KineticStatus KineticAuth_PopulateHmacBatch(KineticSessionConfig const * const config,
+                                            KineticRequest * const pdus[], size_t count)
+{
+    KINETIC_ASSERT(config);
+    KINETIC_ASSERT(pdus);
+
+    LOGF3("Adding HMAC auth info to %zu requests", count);
+
+    if (config->hmacKey.data == NULL) { return KINETIC_STATUS_HMAC_REQUIRED; }
+
+    // The caller already holds every request, so sign them together
+    // directly rather than through the session's signing queue
+    size_t n = 0;
+    for (size_t i = 0; i < count; i += n) {
+        n = count - i;
+        if (n > KINETIC_HMAC_MB_MAX_LANES) { n = KINETIC_HMAC_MB_MAX_LANES; }
+
+        KineticHMAC hmacs[KINETIC_HMAC_MB_MAX_LANES];
+        KineticHMAC* hmacPtrs[KINETIC_HMAC_MB_MAX_LANES];
+        Com__Seagate__Kinetic__Proto__Message* msgs[KINETIC_HMAC_MB_MAX_LANES];
+        for (size_t j = 0; j < n; j++) {
+            KINETIC_ASSERT(pdus[i + j]);
+            prepare_hmac(config, pdus[i + j]);
+            KineticHMAC_Init(&hmacs[j], COM__SEAGATE__KINETIC__PROTO__COMMAND__SECURITY__ACL__HMACALGORITHM__HmacSHA1);
+            hmacPtrs[j] = &hmacs[j];
+            msgs[j] = &pdus[i + j]->message.message;
+        }
+
+        if (pdus[i]->hmacKey != NULL) {
+            KineticHMAC_PopulateBatch(hmacPtrs, msgs, n, pdus[i]->hmacKey);
+        }
+        else {
+            for (size_t j = 0; j < n; j++) {
+                KineticHMAC_Populate(hmacPtrs[j], msgs[j], config->hmacKey);
+            }
+        }
+    }
 
     return KINETIC_STATUS_SUCCESS;
 }
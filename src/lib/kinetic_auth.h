@@ -25,6 +25,7 @@
 
 KineticStatus KineticAuth_EnsureSslEnabled(KineticSessionConfig const * const config);
 KineticStatus KineticAuth_PopulateHmac(KineticSessionConfig const * const config, KineticRequest * const request);
+KineticStatus KineticAuth_PopulateHmacBatch(KineticSessionConfig const * const config, KineticRequest * const requests[], size_t count);
 KineticStatus KineticAuth_PopulatePin(KineticSessionConfig const * const config, KineticRequest * const request, ByteArray pin);
 KineticStatus KineticAuth_PopulateTag(ByteBuffer * const tag, KineticAlgorithm algorithm, ByteArray const * const key);
 
@@ -30,6 +30,7 @@
 #include "kinetic_request.h"
 #include "kinetic_acl.h"
 #include "kinetic_callbacks.h"
+#include "kinetic_tag.h"
 
 #include <stdlib.h>
 #include <errno.h>
@@ -61,6 +62,17 @@ KineticStatus KineticBuilder_BuildPut(KineticOperation* const op,
         return KINETIC_STATUS_BUFFER_OVERRUN;
     }
 
+    // As on GET, an algorithm without a tag to compute (e.g. SHA3) leaves
+    // the caller's tag as it is
+    if (entry->computeTag && KineticTag_Length(entry->algorithm) > 0) {
+        KineticStatus status = KineticTag_Compute(entry->algorithm,
+            (ByteArray){.data = entry->value.array.data, .len = entry->value.bytesUsed},
+            &entry->tag);
+        if (status != KINETIC_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
     op->request->message.command.header->messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT;
     op->request->message.command.header->has_messagetype = true;
     op->entry = entry;
@@ -175,6 +187,25 @@ KineticStatus KineticBuilder_BuildGetKeyRange(KineticOperation* const op,
     return KINETIC_STATUS_SUCCESS;
 }
 
+KineticStatus KineticBuilder_BuildGetKeyRangeStream(KineticOperation* const op,
+    KineticKeyRange* range, KineticKeyCallback keyCallback, void* keyClientData)
+{
+    KineticOperation_ValidateOperation(op);
+    KINETIC_ASSERT(range != NULL);
+    KINETIC_ASSERT(keyCallback != NULL);
+
+    op->request->command->header->messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETKEYRANGE;
+    op->request->command->header->has_messagetype = true;
+
+    KineticMessage_ConfigureKeyRange(&op->request->message, range);
+
+    op->keyCallback = keyCallback;
+    op->keyClientData = keyClientData;
+    op->opCallback = &KineticCallbacks_GetKeyRangeStream;
+
+    return KINETIC_STATUS_SUCCESS;
+}
+
 Com__Seagate__Kinetic__Proto__Command__P2POperation* build_p2pOp(uint32_t nestingLevel, KineticP2P_Operation const * const p2pOp)
 {
     // limit nesting level to KINETIC_P2P_MAX_NESTING
@@ -48,6 +48,8 @@ KineticStatus KineticBuilder_BuildDelete(KineticOperation* const op,
     KineticEntry* const entry);
 KineticStatus KineticBuilder_BuildGetKeyRange(KineticOperation* const op,
     KineticKeyRange* range, ByteBufferArray* buffers);
+KineticStatus KineticBuilder_BuildGetKeyRangeStream(KineticOperation* const op,
+    KineticKeyRange* range, KineticKeyCallback keyCallback, void* keyClientData);
 KineticStatus KineticBuilder_BuildP2POperation(KineticOperation* const op,
     KineticP2P_Operation* const p2pOp);
 
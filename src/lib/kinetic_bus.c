@@ -185,7 +185,8 @@ STATIC bus_unpack_cb_res_t unpack_cb(void *msg, void *socket_udata) {
         };
     }
 
-    KineticResponse * response = KineticAllocator_NewKineticResponse(si->header.valueLength);
+    KineticResponse * response = KineticAllocator_NewKineticResponse(
+        si->header.protobufLength, si->header.valueLength);
 
     if (response == NULL) {
         bus_unpack_cb_res_t res = {
@@ -195,16 +196,15 @@ STATIC bus_unpack_cb_res_t unpack_cb(void *msg, void *socket_udata) {
         return res;
     } else {
         response->header = si->header;
-        
-        response->proto = KineticPDU_unpack_message(NULL, si->header.protobufLength, si->buf);
-        if (response->proto->has_commandbytes &&
-            response->proto->commandbytes.data != NULL &&
-            response->proto->commandbytes.len > 0)
-        {
-            response->command = KineticPDU_unpack_command(NULL,
-                response->proto->commandbytes.len, response->proto->commandbytes.data);
-        } else {
-            response->command = NULL;
+
+        /* Only read what is needed to route the response here; the message
+         * and command are unpacked later, and only if a callback asks for
+         * them (see KineticResponse_GetCommand). A message that can't be
+         * read is passed on without a sequence ID, as before. */
+        memcpy(response->protoBytes, si->buf, si->header.protobufLength);
+        KineticResponseSummary * summary = &response->summary;
+        if (!KineticPDU_unpack_summary(si->header.protobufLength, response->protoBytes, summary)) {
+            LOGF1("Failed to read response header (fd %d)", session->socket);
         }
 
         if (response->header.valueLength > 0)
@@ -213,17 +213,16 @@ STATIC bus_unpack_cb_res_t unpack_cb(void *msg, void *socket_udata) {
         }
 
         int64_t seq_id = BUS_NO_SEQ_ID;
-        if (response->command != NULL &&
-            response->command->header != NULL)
+        if (summary->hasHeader)
         {
-            if (response->proto->has_authtype &&
-                response->proto->authtype == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS
+            if (summary->hasAuthType &&
+                summary->authType == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS
                 && KineticSession_GetConnectionID(session) == 0)
             {
                 /* Ignore the unsolicited status message on connect. */
                 seq_id = BUS_NO_SEQ_ID;
             } else {
-                seq_id = response->command->header->acksequence;
+                seq_id = summary->ackSequence;
             }
             log_response_seq_id(session->socket, seq_id);
         }
@@ -252,7 +251,9 @@ bool KineticBus_Init(KineticClient * client, KineticClientConfig * config)
         .bus_udata = NULL,
         .listener_count = config->readerThreads,
         .threadpool_cfg = {
+            .min_threads = config->minThreadpoolThreads,
             .max_threads = config->maxThreadpoolThreads,
+            .idle_timeout = config->threadpoolIdleTimeout,
         },
     };
     bus_result res;
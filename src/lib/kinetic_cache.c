@@ -0,0 +1,366 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_cache.h"
+#include "kinetic_logger.h"
+#include "byte_array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define CACHE_MIN_BUCKETS (64)
+
+typedef struct _CacheEntry CacheEntry;
+
+struct _CacheEntry {
+    CacheEntry * next;          // In the bucket's chain
+    CacheEntry * newer;         // In the shard's LRU list
+    CacheEntry * older;
+    uint64_t hash;
+    size_t cost;
+    int64_t validatedMillis;    // Last read or revalidated
+    KineticAlgorithm algorithm;
+    size_t keyLen;
+    size_t valueLen;
+    size_t versionLen;
+    size_t tagLen;
+    uint8_t data[];             // Key, value, version, then tag
+};
+
+typedef struct {
+    pthread_mutex_t mutex;
+    CacheEntry ** buckets;
+    size_t bucketCount;         // A power of 2
+    CacheEntry * newest;
+    CacheEntry * oldest;
+    size_t capacity;
+    uint64_t generation;        // Bumped by each invalidation
+    KineticCacheStats stats;
+} CacheShard;
+
+struct _KineticCache {
+    uint32_t ttlMillis;
+    CacheShard shards[KINETIC_CACHE_SHARDS];
+};
+
+static uint64_t hash_key(ByteArray const key)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < key.len; i++) {
+        h ^= key.data[i];
+        h *= 0x100000001b3ull;
+    }
+    return h ^ (h >> 32);
+}
+
+static int64_t now_millis(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static ByteArray entry_key(KineticEntry const * const entry)
+{
+    return (ByteArray) {.data = entry->key.array.data, .len = entry->key.bytesUsed};
+}
+
+static uint8_t * cached_value(CacheEntry * e) { return &e->data[e->keyLen]; }
+static uint8_t * cached_version(CacheEntry * e) { return &e->data[e->keyLen + e->valueLen]; }
+static uint8_t * cached_tag(CacheEntry * e) { return &e->data[e->keyLen + e->valueLen + e->versionLen]; }
+
+static CacheShard * shard_for(KineticCache * const cache, uint64_t hash)
+{
+    // The low bits pick the bucket within a shard
+    return &cache->shards[(hash >> 56) % KINETIC_CACHE_SHARDS];
+}
+
+static CacheEntry ** find(CacheShard * shard, uint64_t hash, ByteArray const key)
+{
+    CacheEntry ** link = &shard->buckets[hash & (shard->bucketCount - 1)];
+    while (*link != NULL) {
+        CacheEntry * e = *link;
+        if (e->hash == hash && e->keyLen == key.len &&
+            memcmp(e->data, key.data, key.len) == 0) {
+            break;
+        }
+        link = &e->next;
+    }
+    return link;
+}
+
+static void unlink_lru(CacheShard * shard, CacheEntry * e)
+{
+    if (e->newer != NULL) { e->newer->older = e->older; } else { shard->newest = e->older; }
+    if (e->older != NULL) { e->older->newer = e->newer; } else { shard->oldest = e->newer; }
+    e->newer = e->older = NULL;
+}
+
+static void push_newest(CacheShard * shard, CacheEntry * e)
+{
+    e->older = shard->newest;
+    e->newer = NULL;
+    if (shard->newest != NULL) { shard->newest->newer = e; } else { shard->oldest = e; }
+    shard->newest = e;
+}
+
+/* Unlink the entry at LINK from its chain and the LRU list, and free it. */
+static void remove_entry(CacheShard * shard, CacheEntry ** link)
+{
+    CacheEntry * e = *link;
+    *link = e->next;
+    unlink_lru(shard, e);
+    shard->stats.entries--;
+    shard->stats.bytes -= e->cost;
+    free(e);
+}
+
+/* Double the bucket array once chains average more than two entries.
+ * Failing to grow only makes the chains longer. */
+static void maybe_grow(CacheShard * shard)
+{
+    if (shard->stats.entries <= 2 * shard->bucketCount) { return; }
+    size_t count = 2 * shard->bucketCount;
+    CacheEntry ** buckets = calloc(count, sizeof(*buckets));
+    if (buckets == NULL) { return; }
+    for (size_t b = 0; b < shard->bucketCount; b++) {
+        CacheEntry * e = shard->buckets[b];
+        while (e != NULL) {
+            CacheEntry * next = e->next;
+            e->next = buckets[e->hash & (count - 1)];
+            buckets[e->hash & (count - 1)] = e;
+            e = next;
+        }
+    }
+    free(shard->buckets);
+    shard->buckets = buckets;
+    shard->bucketCount = count;
+}
+
+KineticCache * KineticCache_Create(size_t capacityBytes, uint32_t ttlMillis)
+{
+    KineticCache * cache = calloc(1, sizeof(*cache));
+    if (cache == NULL) { return NULL; }
+    cache->ttlMillis = ttlMillis;
+    for (size_t s = 0; s < KINETIC_CACHE_SHARDS; s++) {
+        CacheShard * shard = &cache->shards[s];
+        shard->capacity = capacityBytes / KINETIC_CACHE_SHARDS;
+        shard->bucketCount = CACHE_MIN_BUCKETS;
+        shard->buckets = calloc(shard->bucketCount, sizeof(shard->buckets[0]));
+        if (shard->buckets == NULL) {
+            for (size_t i = 0; i < s; i++) {
+                pthread_mutex_destroy(&cache->shards[i].mutex);
+                free(cache->shards[i].buckets);
+            }
+            free(cache);
+            return NULL;
+        }
+        pthread_mutex_init(&shard->mutex, NULL);
+    }
+    return cache;
+}
+
+void KineticCache_Destroy(KineticCache * cache)
+{
+    if (cache == NULL) { return; }
+    for (size_t s = 0; s < KINETIC_CACHE_SHARDS; s++) {
+        CacheShard * shard = &cache->shards[s];
+        while (shard->oldest != NULL) {
+            CacheEntry * e = shard->oldest;
+            shard->oldest = e->newer;
+            free(e);
+        }
+        free(shard->buckets);
+        pthread_mutex_destroy(&shard->mutex);
+    }
+    free(cache);
+}
+
+/* Copy a cached entry into ENTRY as a GET would, if it all fits. */
+static bool serve(CacheEntry * e, KineticEntry * const entry)
+{
+    if (ByteBuffer_BytesRemaining(entry->value) < (long)e->valueLen ||
+        entry->dbVersion.array.len < e->versionLen ||
+        entry->tag.array.len < e->tagLen) {
+        return false;
+    }
+    ByteBuffer_Reset(&entry->dbVersion);
+    ByteBuffer_Reset(&entry->tag);
+    if (e->valueLen > 0) { ByteBuffer_Append(&entry->value, cached_value(e), e->valueLen); }
+    ByteBuffer_Append(&entry->dbVersion, cached_version(e), e->versionLen);
+    if (e->tagLen > 0) { ByteBuffer_Append(&entry->tag, cached_tag(e), e->tagLen); }
+    entry->algorithm = e->algorithm;
+    return true;
+}
+
+KineticCacheResult KineticCache_Lookup(KineticCache * const cache,
+                                       KineticEntry * const entry,
+                                       uint64_t * generation)
+{
+    KINETIC_ASSERT(cache != NULL);
+    ByteArray const key = entry_key(entry);
+    uint64_t const hash = hash_key(key);
+    CacheShard * shard = shard_for(cache, hash);
+    KineticCacheResult result = KINETIC_CACHE_MISS;
+
+    pthread_mutex_lock(&shard->mutex);
+    *generation = shard->generation;
+    CacheEntry * e = *find(shard, hash, key);
+    if (e != NULL) {
+        unlink_lru(shard, e);
+        push_newest(shard, e);
+        if (now_millis() - e->validatedMillis < (int64_t)cache->ttlMillis) {
+            if (serve(e, entry)) {
+                result = KINETIC_CACHE_HIT;
+                shard->stats.hits++;
+            }
+        } else if (entry->dbVersion.array.len >= e->versionLen) {
+            ByteBuffer_Reset(&entry->dbVersion);
+            ByteBuffer_Append(&entry->dbVersion, cached_version(e), e->versionLen);
+            result = KINETIC_CACHE_STALE;
+        }
+    }
+    if (result == KINETIC_CACHE_MISS) { shard->stats.misses++; }
+    pthread_mutex_unlock(&shard->mutex);
+    return result;
+}
+
+bool KineticCache_Revalidate(KineticCache * const cache,
+                             KineticEntry * const entry,
+                             ByteArray const version)
+{
+    KINETIC_ASSERT(cache != NULL);
+    ByteArray const key = entry_key(entry);
+    uint64_t const hash = hash_key(key);
+    CacheShard * shard = shard_for(cache, hash);
+    bool served = false;
+
+    pthread_mutex_lock(&shard->mutex);
+    CacheEntry ** link = find(shard, hash, key);
+    CacheEntry * e = *link;
+    if (e != NULL) {
+        if (e->versionLen == version.len &&
+            memcmp(cached_version(e), version.data, version.len) == 0) {
+            served = serve(e, entry);
+            if (served) {
+                e->validatedMillis = now_millis();
+                shard->stats.revalidatedHits++;
+            }
+        } else {
+            remove_entry(shard, link);
+        }
+    }
+    if (!served) { shard->stats.misses++; }
+    pthread_mutex_unlock(&shard->mutex);
+    return served;
+}
+
+void KineticCache_Insert(KineticCache * const cache,
+                         KineticEntry const * const entry,
+                         uint64_t generation)
+{
+    KINETIC_ASSERT(cache != NULL);
+    ByteArray const key = entry_key(entry);
+    size_t const valueLen = entry->value.bytesUsed;
+    size_t const versionLen = entry->dbVersion.bytesUsed;
+    size_t const tagLen = entry->tag.bytesUsed;
+    size_t const cost = sizeof(CacheEntry) + key.len + valueLen + versionLen + tagLen;
+    if (versionLen == 0 || entry->metadataOnly) { return; }
+
+    uint64_t const hash = hash_key(key);
+    CacheShard * shard = shard_for(cache, hash);
+    if (cost > shard->capacity) { return; }
+
+    CacheEntry * e = malloc(cost);
+    if (e == NULL) { return; }
+    *e = (CacheEntry) {
+        .hash = hash,
+        .cost = cost,
+        .validatedMillis = now_millis(),
+        .algorithm = entry->algorithm,
+        .keyLen = key.len,
+        .valueLen = valueLen,
+        .versionLen = versionLen,
+        .tagLen = tagLen,
+    };
+    memcpy(e->data, key.data, key.len);
+    if (valueLen > 0) { memcpy(cached_value(e), entry->value.array.data, valueLen); }
+    memcpy(cached_version(e), entry->dbVersion.array.data, versionLen);
+    if (tagLen > 0) { memcpy(cached_tag(e), entry->tag.array.data, tagLen); }
+
+    pthread_mutex_lock(&shard->mutex);
+    if (shard->generation != generation) {
+        // A local write may have replaced what was read
+        pthread_mutex_unlock(&shard->mutex);
+        free(e);
+        return;
+    }
+    CacheEntry ** link = find(shard, hash, key);
+    if (*link != NULL) { remove_entry(shard, link); }
+    while (shard->stats.bytes + cost > shard->capacity) {
+        CacheEntry * oldest = shard->oldest;
+        remove_entry(shard, find(shard, oldest->hash,
+            (ByteArray) {.data = oldest->data, .len = oldest->keyLen}));
+        shard->stats.evictions++;
+    }
+    CacheEntry ** bucket = &shard->buckets[hash & (shard->bucketCount - 1)];
+    e->next = *bucket;
+    *bucket = e;
+    push_newest(shard, e);
+    shard->stats.entries++;
+    shard->stats.bytes += cost;
+    maybe_grow(shard);
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+void KineticCache_Invalidate(KineticCache * const cache, ByteArray const key)
+{
+    KINETIC_ASSERT(cache != NULL);
+    uint64_t const hash = hash_key(key);
+    CacheShard * shard = shard_for(cache, hash);
+
+    pthread_mutex_lock(&shard->mutex);
+    shard->generation++;
+    CacheEntry ** link = find(shard, hash, key);
+    if (*link != NULL) {
+        remove_entry(shard, link);
+        shard->stats.invalidations++;
+    }
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+void KineticCache_GetStats(KineticCache * const cache, KineticCacheStats * const stats)
+{
+    KINETIC_ASSERT(cache != NULL);
+    memset(stats, 0, sizeof(*stats));
+    for (size_t s = 0; s < KINETIC_CACHE_SHARDS; s++) {
+        CacheShard * shard = &cache->shards[s];
+        pthread_mutex_lock(&shard->mutex);
+        stats->hits += shard->stats.hits;
+        stats->revalidatedHits += shard->stats.revalidatedHits;
+        stats->misses += shard->stats.misses;
+        stats->evictions += shard->stats.evictions;
+        stats->invalidations += shard->stats.invalidations;
+        stats->entries += shard->stats.entries;
+        stats->bytes += shard->stats.bytes;
+        pthread_mutex_unlock(&shard->mutex);
+    }
+}
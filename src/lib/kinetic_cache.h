@@ -0,0 +1,74 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_CACHE_H
+#define _KINETIC_CACHE_H
+
+#include "kinetic_types_internal.h"
+
+/* Client-side read cache of entries keyed by key, bounded in bytes and
+ * split into shards by key hash, each with its own lock and LRU list.
+ * Entries carry the dbVersion they were read with, so a hit can be
+ * revalidated against the device without transferring the value.
+ *
+ * A GET that misses takes a generation token from the lookup, and only
+ * inserts its result if no key in the shard was invalidated since, so a
+ * read racing a local write can never cache the value it replaced. */
+
+#define KINETIC_CACHE_SHARDS (16)
+
+typedef enum {
+    KINETIC_CACHE_MISS,     // Not cached, or cached without room to return it
+    KINETIC_CACHE_HIT,      // Copied into the entry; no request needed
+    KINETIC_CACHE_STALE,    // Cached, but must be revalidated first
+} KineticCacheResult;
+
+KineticCache * KineticCache_Create(size_t capacityBytes, uint32_t ttlMillis);
+void KineticCache_Destroy(KineticCache * cache);
+
+/* Look up ENTRY's key. On a HIT, the value is appended to ENTRY's value
+ * and its dbVersion, tag and algorithm are replaced, as a GET would. On
+ * STALE, only the cached version is copied to ENTRY's dbVersion (which
+ * must have room for it), to revalidate with. GENERATION receives the
+ * token for KineticCache_Insert. */
+KineticCacheResult KineticCache_Lookup(KineticCache * const cache,
+                                       KineticEntry * const entry,
+                                       uint64_t * generation);
+
+/* Complete a STALE lookup once the device has reported VERSION for the
+ * entry's key: if it matches the cached version, serve the entry as for a
+ * HIT and restart its TTL, and return true. Otherwise drop it. */
+bool KineticCache_Revalidate(KineticCache * const cache,
+                             KineticEntry * const entry,
+                             ByteArray const version);
+
+/* Cache an entry just read with a full GET, unless it has no dbVersion,
+ * would take more than a shard's capacity, or the shard has seen an
+ * invalidation since GENERATION was taken. */
+void KineticCache_Insert(KineticCache * const cache,
+                         KineticEntry const * const entry,
+                         uint64_t generation);
+
+/* Drop KEY, ahead of a local PUT or DELETE of it. */
+void KineticCache_Invalidate(KineticCache * const cache, ByteArray const key);
+
+void KineticCache_GetStats(KineticCache * const cache, KineticCacheStats * const stats);
+
+#endif // _KINETIC_CACHE_H
@@ -28,6 +28,7 @@
 #include "kinetic_logger.h"
 #include "kinetic_request.h"
 #include "kinetic_acl.h"
+#include "kinetic_tag.h"
 
 #include <stdlib.h>
 #include <errno.h>
@@ -97,10 +98,20 @@ KineticStatus KineticCallbacks_Get(KineticOperation* const operation, KineticSta
         if (!operation->entry->metadataOnly &&
             !ByteBuffer_IsNull(operation->entry->value))
         {
-            ByteBuffer_AppendArray(&operation->entry->value, (ByteArray){
+            ByteArray value = {
                 .data = operation->response->value,
                 .len = operation->response->header.valueLength,
-            });
+            };
+
+            // Check the value against the returned tag as it is copied
+            KineticEntry* entry = operation->entry;
+            if (entry->computeTag && keyValue != NULL && keyValue->has_tag &&
+                KineticTag_Length(entry->algorithm) > 0)
+            {
+                return KineticTag_AppendAndVerify(entry->algorithm, &entry->value, value,
+                    (ByteArray){.data = keyValue->tag.data, .len = keyValue->tag.len});
+            }
+            ByteBuffer_AppendArray(&entry->value, value);
         }
     }
 
@@ -136,6 +147,27 @@ KineticStatus KineticCallbacks_GetKeyRange(KineticOperation* const operation, Ki
     return status;
 }
 
+KineticStatus KineticCallbacks_GetKeyRangeStream(KineticOperation* const operation, KineticStatus const status)
+{
+    KINETIC_ASSERT(operation != NULL);
+    KINETIC_ASSERT(operation->session != NULL);
+    KINETIC_ASSERT(operation->keyCallback != NULL);
+
+    if (status == KINETIC_STATUS_SUCCESS)
+    {
+        KINETIC_ASSERT(operation->response != NULL);
+        // Hand each key over straight from the decoded response
+        Com__Seagate__Kinetic__Proto__Command__Range* keyRange = KineticResponse_GetKeyRange(operation->response);
+        if (keyRange != NULL) {
+            for (size_t i = 0; i < keyRange->n_keys; i++) {
+                ByteArray key = ProtobufCBinaryData_to_ByteArray(keyRange->keys[i]);
+                if (!operation->keyCallback(key, operation->keyClientData)) { break; }
+            }
+        }
+    }
+    return status;
+}
+
 static void populateP2PStatusCodes(KineticP2P_Operation* const p2pOp, Com__Seagate__Kinetic__Proto__Command__P2POperation const * const p2pOperation)
 {
     if (p2pOperation == NULL) { return; }
@@ -173,11 +205,12 @@ KineticStatus KineticCallbacks_P2POperation(KineticOperation* const operation, K
 
     if (status == KINETIC_STATUS_SUCCESS)
     {
-        if ((operation->response != NULL) &&
-            (operation->response->command != NULL) &&
-            (operation->response->command->body != NULL) &&
-            (operation->response->command->body->p2poperation != NULL)) {
-            populateP2PStatusCodes(p2pOp, operation->response->command->body->p2poperation);
+        Com__Seagate__Kinetic__Proto__Command* command = (operation->response != NULL) ?
+            KineticResponse_GetCommand(operation->response) : NULL;
+        if ((command != NULL) &&
+            (command->body != NULL) &&
+            (command->body->p2poperation != NULL)) {
+            populateP2PStatusCodes(p2pOp, command->body->p2poperation);
         }
     }
 
@@ -201,11 +234,12 @@ KineticStatus KineticCallbacks_GetLog(KineticOperation* const operation, Kinetic
     {
         KINETIC_ASSERT(operation->response != NULL);
         // Copy the data from the response protobuf into a new info struct
-        if (operation->response->command->body->getlog == NULL) {
+        Com__Seagate__Kinetic__Proto__Command* command = KineticResponse_GetCommand(operation->response);
+        if (command == NULL || command->body == NULL || command->body->getlog == NULL) {
             return KINETIC_STATUS_OPERATION_FAILED;
         }
         else {
-            *operation->deviceInfo = KineticLogInfo_Create(operation->response->command->body->getlog);
+            *operation->deviceInfo = KineticLogInfo_Create(command->body->getlog);
             return KINETIC_STATUS_SUCCESS;
         }
     }
@@ -32,6 +32,7 @@ KineticStatus KineticCallbacks_Put(KineticOperation* const operation, KineticSta
 KineticStatus KineticCallbacks_Get(KineticOperation* const operation, KineticStatus const status);
 KineticStatus KineticCallbacks_Delete(KineticOperation* const operation, KineticStatus const status);
 KineticStatus KineticCallbacks_GetKeyRange(KineticOperation* const operation, KineticStatus const status);
+KineticStatus KineticCallbacks_GetKeyRangeStream(KineticOperation* const operation, KineticStatus const status);
 KineticStatus KineticCallbacks_P2POperation(KineticOperation* const operation, KineticStatus const status);
 
 /*******************************************************************************
@@ -30,6 +30,9 @@
 #include "kinetic_response.h"
 #include "kinetic_bus.h"
 #include "kinetic_memory.h"
+#include "kinetic_object.h"
+#include "kinetic_cache.h"
+#include "kinetic_completion_queue.h"
 #include <stdlib.h>
 #include <sys/time.h>
 
@@ -73,6 +76,62 @@ void KineticClient_Shutdown(KineticClient * const client)
     KineticLogger_Close();
 }
 
+static void destroy_lanes(KineticSession* const session)
+{
+    if (session->lanes == NULL) { return; }
+    for (size_t i = 0; i < session->laneCount; i++) {
+        (void)KineticSession_Disconnect(session->lanes[i]);
+        KineticSession_Destroy(session->lanes[i]);
+    }
+    KineticFree(session->lanes);
+    session->lanes = NULL;
+    session->laneCount = 0;
+}
+
+/* Open the extra connections of a session configured with more than one
+ * (see KineticSessionConfig.connections). Each is a session of its own,
+ * with the same configuration, which the controller sends large transfers
+ * on. */
+static KineticStatus connect_lanes(KineticSession* const session, KineticClient * const client)
+{
+    uint32_t connections = session->config.connections;
+    if (connections > KINETIC_MAX_CONNECTIONS) { connections = KINETIC_MAX_CONNECTIONS; }
+    if (connections <= 1) { return KINETIC_STATUS_SUCCESS; }
+
+    session->lanes = KineticCalloc(connections - 1, sizeof(session->lanes[0]));
+    if (session->lanes == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+
+    KineticSessionConfig config = session->config;
+    config.connections = 1;
+    config.readCacheBytes = 0;
+    for (uint32_t i = 1; i < connections; i++) {
+        KineticSession* lane = KineticAllocator_NewSession(client->bus, &config);
+        if (lane == NULL) {
+            destroy_lanes(session);
+            return KINETIC_STATUS_MEMORY_ERROR;
+        }
+        KineticStatus status = KineticSession_Create(lane, client);
+        if (status == KINETIC_STATUS_SUCCESS) {
+            status = KineticSession_Connect(lane);
+            if (status != KINETIC_STATUS_SUCCESS) {
+                KineticSession_Destroy(lane);
+                lane = NULL;
+            }
+        }
+        else {
+            KineticAllocator_FreeSession(lane);
+            lane = NULL;
+        }
+        if (lane == NULL) {
+            LOGF0("Failed creating connection %u to %s:%d", i, config.host, config.port);
+            destroy_lanes(session);
+            return status;
+        }
+        session->lanes[session->laneCount++] = lane;
+    }
+    return KINETIC_STATUS_SUCCESS;
+}
+
 KineticStatus KineticClient_CreateSession(KineticSessionConfig* const config,
     KineticClient * const client, KineticSession** session)
 {
@@ -118,6 +177,13 @@ KineticStatus KineticClient_CreateSession(KineticSessionConfig* const config,
         return status;
     }
 
+    status = connect_lanes(s, client);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        (void)KineticSession_Disconnect(s);
+        KineticSession_Destroy(s);
+        return status;
+    }
+
     *session = s;
 
     return status;
@@ -130,6 +196,7 @@ KineticStatus KineticClient_DestroySession(KineticSession* const session)
         return KINETIC_STATUS_SESSION_INVALID;
     }
 
+    destroy_lanes(session);
     KineticStatus status = KineticSession_Disconnect(session);
     if (status != KINETIC_STATUS_SUCCESS) {LOG0("Disconnection failed!");}
     KineticSession_Destroy(session);
@@ -142,6 +209,104 @@ KineticStatus KineticClient_GetTerminationStatus(KineticSession * const session)
     return KineticSession_GetTerminationStatus(session);
 }
 
+KineticStatus KineticClient_GetCacheStats(KineticSession * const session,
+                                          KineticCacheStats * stats)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(stats);
+    if (session->readCache == NULL) {return KINETIC_STATUS_INVALID_REQUEST;}
+    KineticCache_GetStats(session->readCache, stats);
+    return KINETIC_STATUS_SUCCESS;
+}
+
+size_t KineticClient_PollCompletions(KineticCompletionQueue * const queue,
+    KineticCompletionEvent events[], size_t max, int timeoutMillis)
+{
+    KINETIC_ASSERT(queue);
+    return KineticCompletionQueue_Poll(queue, events, max, timeoutMillis);
+}
+
+static void invalidate_cached(KineticSession* const session,
+                              KineticEntry const * const entry)
+{
+    if (session->readCache != NULL && entry->key.array.data != NULL) {
+        KineticCache_Invalidate(session->readCache, (ByteArray) {
+            .data = entry->key.array.data, .len = entry->key.bytesUsed});
+    }
+}
+
+/* The caller's closure for an asynchronous write, wrapped so the keys
+ * written are invalidated again once it completes. */
+typedef struct {
+    KineticSession* session;
+    KineticEntry const* entries;
+    size_t count;
+    KineticCompletionClosure closure;
+} InvalidatingClosure;
+
+static void invalidate_on_completion(KineticCompletionData* kinetic_data, void* client_data)
+{
+    InvalidatingClosure* wrapper = client_data;
+    for (size_t i = 0; i < wrapper->count; i++) {
+        invalidate_cached(wrapper->session, &wrapper->entries[i]);
+    }
+    KineticCompletionClosure closure = wrapper->closure;
+    free(wrapper);
+
+    if (closure.queue != NULL) {
+        KineticCompletionQueue_Push(closure.queue, closure.clientData, kinetic_data->status);
+    }
+    else if (closure.callback != NULL) {
+        closure.callback(kinetic_data, closure.clientData);
+    }
+}
+
+/* Invalidate the COUNT ENTRIES about to be written, and point *CLOSURE at
+ * WRAPPED if it is asynchronous and there is a read cache, so they are
+ * invalidated again once the write is done. */
+static KineticStatus begin_write(KineticSession* const session,
+                                 KineticEntry const* entries, size_t count,
+                                 KineticCompletionClosure** closure,
+                                 KineticCompletionClosure* wrapped)
+{
+    if (session->readCache == NULL) {return KINETIC_STATUS_SUCCESS;}
+
+    if (*closure != NULL) {
+        InvalidatingClosure* wrapper = malloc(sizeof(*wrapper));
+        if (wrapper == NULL) {return KINETIC_STATUS_MEMORY_ERROR;}
+        *wrapper = (InvalidatingClosure) {
+            .session = session,
+            .entries = entries,
+            .count = count,
+            .closure = **closure,
+        };
+        *wrapped = (KineticCompletionClosure) {
+            .callback = invalidate_on_completion,
+            .clientData = wrapper,
+        };
+        *closure = wrapped;
+    }
+    for (size_t i = 0; i < count; i++) {invalidate_cached(session, &entries[i]);}
+    return KINETIC_STATUS_SUCCESS;
+}
+
+/* Invalidating again once a write is done drops anything a concurrent GET
+ * cached while it was in flight: now for a synchronous write, or from the
+ * completion of an asynchronous one, unless it was never started. */
+static void end_write(KineticSession* const session,
+                      KineticEntry const* entries, size_t count,
+                      KineticCompletionClosure* closure,
+                      KineticCompletionClosure* wrapped,
+                      KineticStatus status)
+{
+    if (closure == NULL) {
+        for (size_t i = 0; i < count; i++) {invalidate_cached(session, &entries[i]);}
+    }
+    else if (closure == wrapped && status != KINETIC_STATUS_SUCCESS) {
+        free(wrapped->clientData);
+    }
+}
+
 KineticStatus KineticClient_NoOp(KineticSession* const session)
 {
     KINETIC_ASSERT(session);
@@ -177,7 +342,14 @@ KineticStatus KineticClient_Put(KineticSession* const session,
     }
 
     // Execute the operation
+    KineticCompletionClosure wrapped;
+    status = begin_write(session, entry, 1, &closure, &wrapped);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        KineticAllocator_FreeOperation(operation);
+        return status;
+    }
     KineticStatus res = KineticController_ExecuteOperation(operation, closure);
+    end_write(session, entry, 1, closure, &wrapped, res);
     return res;
 }
 
@@ -250,10 +422,71 @@ static KineticStatus handle_get_command(GET_COMMAND cmd,
     return KineticController_ExecuteOperation(operation, closure);
 }
 
+/* Revalidate a stale cached entry by asking the device for just its
+ * version, and serve it from the cache if that is unchanged. */
+static bool revalidate_cached(KineticSession* const session,
+                              KineticEntry* const entry)
+{
+    uint8_t version[KINETIC_DEFAULT_KEY_LEN];
+    uint8_t tag[KINETIC_DEFAULT_KEY_LEN];
+    KineticEntry probe = {
+        .key = entry->key,
+        .dbVersion = ByteBuffer_Create(version, sizeof(version), 0),
+        .tag = ByteBuffer_Create(tag, sizeof(tag), 0),
+        .value = BYTE_BUFFER_NONE,
+        .metadataOnly = true,
+    };
+
+    KineticStatus status = handle_get_command(CMD_GET, session, &probe, NULL);
+    if (status == KINETIC_STATUS_NOT_FOUND) {
+        invalidate_cached(session, entry);
+        return false;
+    }
+    return status == KINETIC_STATUS_SUCCESS &&
+        KineticCache_Revalidate(session->readCache, entry, (ByteArray) {
+            .data = probe.dbVersion.array.data, .len = probe.dbVersion.bytesUsed});
+}
+
+static KineticStatus cached_get(KineticSession* const session,
+                                KineticEntry* const entry)
+{
+    if (!has_key(entry)) {return KINETIC_STATUS_MISSING_KEY;}
+    if (!has_value_buffer(entry)) {return KINETIC_STATUS_MISSING_VALUE_BUFFER;}
+
+    uint64_t generation;
+    switch (KineticCache_Lookup(session->readCache, entry, &generation)) {
+    case KINETIC_CACHE_HIT:
+        return KINETIC_STATUS_SUCCESS;
+    case KINETIC_CACHE_STALE:
+        if (revalidate_cached(session, entry)) {return KINETIC_STATUS_SUCCESS;}
+        break;
+    default:
+        break;
+    }
+
+    // The value is appended to what the buffer already holds, so cache
+    // only the part this GET read
+    size_t const offset = entry->value.bytesUsed;
+    KineticStatus status = handle_get_command(CMD_GET, session, entry, NULL);
+    if (status == KINETIC_STATUS_SUCCESS) {
+        KineticEntry read = *entry;
+        read.value.array.data += offset;
+        read.value.array.len -= offset;
+        read.value.bytesUsed -= offset;
+        KineticCache_Insert(session->readCache, &read, generation);
+    }
+    return status;
+}
+
 KineticStatus KineticClient_Get(KineticSession* const session,
                                 KineticEntry* const entry,
                                 KineticCompletionClosure* closure)
 {
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(entry);
+    if (session->readCache != NULL && closure == NULL && !entry->metadataOnly) {
+        return cached_get(session, entry);
+    }
     return handle_get_command(CMD_GET, session, entry, closure);
 }
 
@@ -285,7 +518,126 @@ KineticStatus KineticClient_Delete(KineticSession* const session,
     KineticBuilder_BuildDelete(operation, entry);
 
     // Execute the operation
-    return KineticController_ExecuteOperation(operation, closure);
+    KineticCompletionClosure wrapped;
+    KineticStatus status = begin_write(session, entry, 1, &closure, &wrapped);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        KineticAllocator_FreeOperation(operation);
+        return status;
+    }
+    status = KineticController_ExecuteOperation(operation, closure);
+    end_write(session, entry, 1, closure, &wrapped, status);
+    return status;
+}
+
+KineticStatus KineticClient_PutBatch(KineticSession* const session,
+                                     KineticEntry* const entries,
+                                     size_t count,
+                                     KineticStatus* statuses,
+                                     KineticCompletionClosure* closure)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(entries);
+    KINETIC_ASSERT(count > 0);
+
+    for (size_t i = 0; i < count; i++) {
+        if (entries[i].value.array.len > 0) {
+            KINETIC_ASSERT(entries[i].value.array.data);
+        }
+    }
+
+    KineticCompletionClosure wrapped;
+    KineticStatus status = begin_write(session, entries, count, &closure, &wrapped);
+    if (status != KINETIC_STATUS_SUCCESS) {return status;}
+    status = KineticController_ExecuteBatch(session, entries, count,
+        KineticBuilder_BuildPut, statuses, closure);
+    end_write(session, entries, count, closure, &wrapped, status);
+    return status;
+}
+
+KineticStatus KineticClient_GetBatch(KineticSession* const session,
+                                     KineticEntry* const entries,
+                                     size_t count,
+                                     KineticStatus* statuses,
+                                     KineticCompletionClosure* closure)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(entries);
+    KINETIC_ASSERT(count > 0);
+
+    for (size_t i = 0; i < count; i++) {
+        if (!has_key(&entries[i])) {return KINETIC_STATUS_MISSING_KEY;}
+        if (!has_value_buffer(&entries[i]) && !entries[i].metadataOnly) {
+            return KINETIC_STATUS_MISSING_VALUE_BUFFER;
+        }
+    }
+
+    return KineticController_ExecuteBatch(session, entries, count,
+        KineticBuilder_BuildGet, statuses, closure);
+}
+
+KineticStatus KineticClient_DeleteBatch(KineticSession* const session,
+                                        KineticEntry* const entries,
+                                        size_t count,
+                                        KineticStatus* statuses,
+                                        KineticCompletionClosure* closure)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(entries);
+    KINETIC_ASSERT(count > 0);
+
+    KineticCompletionClosure wrapped;
+    KineticStatus status = begin_write(session, entries, count, &closure, &wrapped);
+    if (status != KINETIC_STATUS_SUCCESS) {return status;}
+    status = KineticController_ExecuteBatch(session, entries, count,
+        KineticBuilder_BuildDelete, statuses, closure);
+    end_write(session, entries, count, closure, &wrapped, status);
+    return status;
+}
+
+KineticStatus KineticClient_PutObject(KineticSession* const session,
+                                      ByteArray const key,
+                                      KineticObjectIO const* io,
+                                      KineticObjectConfig const* config)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(io);
+    return KineticObject_Put(session, key, io, config);
+}
+
+KineticStatus KineticClient_GetObject(KineticSession* const session,
+                                      ByteArray const key,
+                                      KineticObjectIO const* io,
+                                      KineticObjectConfig const* config)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(io);
+    return KineticObject_Get(session, key, io, config);
+}
+
+KineticStatus KineticClient_DeleteObject(KineticSession* const session,
+                                         ByteArray const key,
+                                         KineticObjectConfig const* config)
+{
+    KINETIC_ASSERT(session);
+    return KineticObject_Delete(session, key, config);
+}
+
+KineticStatus KineticClient_PutObjectFromFd(KineticSession* const session,
+                                            ByteArray const key,
+                                            int fd,
+                                            KineticObjectConfig const* config)
+{
+    KineticObjectIO io = KineticObject_FileIO(&fd);
+    return KineticClient_PutObject(session, key, &io, config);
+}
+
+KineticStatus KineticClient_GetObjectToFd(KineticSession* const session,
+                                          ByteArray const key,
+                                          int fd,
+                                          KineticObjectConfig const* config)
+{
+    KineticObjectIO io = KineticObject_FileIO(&fd);
+    return KineticClient_GetObject(session, key, &io, config);
 }
 
 KineticStatus KineticClient_GetKeyRange(KineticSession* const session,
@@ -309,6 +661,26 @@ KineticStatus KineticClient_GetKeyRange(KineticSession* const session,
     return KineticController_ExecuteOperation(operation, closure);
 }
 
+KineticStatus KineticClient_GetKeyRangeStream(KineticSession* const session,
+                                              KineticKeyRange* range,
+                                              KineticKeyCallback keyCallback,
+                                              void* clientData,
+                                              KineticCompletionClosure* closure)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(range);
+    KINETIC_ASSERT(keyCallback);
+
+    KineticOperation* operation = KineticAllocator_NewOperation(session);
+    if (operation == NULL) {return KINETIC_STATUS_MEMORY_ERROR;}
+
+    // Initialize request
+    KineticBuilder_BuildGetKeyRangeStream(operation, range, keyCallback, clientData);
+
+    // Execute the operation
+    return KineticController_ExecuteOperation(operation, closure);
+}
+
 KineticStatus KineticClient_P2POperation(KineticSession* const session,
                                          KineticP2P_Operation* const p2pOp,
                                          KineticCompletionClosure* closure)
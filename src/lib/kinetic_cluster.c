@@ -0,0 +1,674 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_cluster.h"
+#include "kinetic_client.h"
+#include "kinetic_completion_queue.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Keys listed per GETKEYRANGE while rebalancing
+#define REBALANCE_KEYS_PER_RANGE (64)
+
+// Room for the tag and version of an entry being moved
+#define REBALANCE_METADATA_LEN (KINETIC_DEFAULT_KEY_LEN)
+
+typedef struct {
+    KineticSession * session;
+    uint32_t weight;
+} ClusterMember;
+
+typedef struct {
+    uint64_t point;
+    size_t member;
+} RingPoint;
+
+struct _KineticCluster {
+    pthread_mutex_t mutex;
+    uint32_t virtualNodes;
+    ClusterMember * members;
+    size_t memberCount;
+    RingPoint * ring;       // Sorted by point
+    size_t ringCount;
+};
+
+/* FNV-1a, finished with MurmurHash3's 64-bit mix so that similar keys and
+ * point names still land evenly around the ring. */
+static uint64_t hash_bytes(uint8_t const * data, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static int compare_points(void const * a, void const * b)
+{
+    RingPoint const * pa = a;
+    RingPoint const * pb = b;
+    if (pa->point != pb->point) { return (pa->point < pb->point) ? -1 : 1; }
+    return (pa->member < pb->member) ? -1 : (pa->member > pb->member);
+}
+
+/* Build the ring for the first COUNT members, leaving out SKIP (or none if
+ * SKIP >= COUNT). A drive's points are named for its host and port, so
+ * every client places keys the same way. */
+static bool build_ring(KineticCluster * cluster, size_t count, size_t skip,
+                       RingPoint ** ring, size_t * ringCount)
+{
+    size_t points = 0;
+    for (size_t m = 0; m < count; m++) {
+        if (m == skip) { continue; }
+        points += (size_t)cluster->members[m].weight * cluster->virtualNodes;
+    }
+
+    *ring = NULL;
+    *ringCount = 0;
+    if (points == 0) { return true; }
+
+    RingPoint * newRing = malloc(points * sizeof(*newRing));
+    if (newRing == NULL) { return false; }
+
+    size_t n = 0;
+    for (size_t m = 0; m < count; m++) {
+        if (m == skip) { continue; }
+        KineticSession const * session = cluster->members[m].session;
+        size_t memberPoints = (size_t)cluster->members[m].weight * cluster->virtualNodes;
+        for (size_t v = 0; v < memberPoints; v++) {
+            char name[HOST_NAME_MAX + 32];
+            int len = snprintf(name, sizeof(name), "%s:%d-%zu",
+                session->config.host, session->config.port, v);
+            newRing[n++] = (RingPoint) {
+                .point = hash_bytes((uint8_t const *)name, (size_t)len),
+                .member = (m > skip) ? m - 1 : m,
+            };
+        }
+    }
+    qsort(newRing, points, sizeof(*newRing), compare_points);
+
+    *ring = newRing;
+    *ringCount = points;
+    return true;
+}
+
+/* Index of the member owning KEY. Called with the mutex held, on a
+ * non-empty cluster. */
+static size_t locate_member(KineticCluster const * cluster, ByteArray const key)
+{
+    uint64_t h = hash_bytes(key.data, key.len);
+    size_t lo = 0;
+    size_t hi = cluster->ringCount;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cluster->ring[mid].point < h) { lo = mid + 1; }
+        else { hi = mid; }
+    }
+    if (lo == cluster->ringCount) { lo = 0; }  // Wrap around the ring
+    return cluster->ring[lo].member;
+}
+
+static ByteArray entry_key(KineticEntry const * const entry)
+{
+    return (ByteArray) {.data = entry->key.array.data, .len = entry->key.bytesUsed};
+}
+
+KineticCluster * KineticCluster_Create(uint32_t virtualNodes)
+{
+    KineticCluster * cluster = calloc(1, sizeof(*cluster));
+    if (cluster == NULL) { return NULL; }
+    cluster->virtualNodes = (virtualNodes > 0)
+        ? virtualNodes : KINETIC_CLUSTER_DEFAULT_VIRTUAL_NODES;
+    pthread_mutex_init(&cluster->mutex, NULL);
+    return cluster;
+}
+
+void KineticCluster_Destroy(KineticCluster * cluster)
+{
+    if (cluster == NULL) { return; }
+    pthread_mutex_destroy(&cluster->mutex);
+    free(cluster->ring);
+    free(cluster->members);
+    free(cluster);
+}
+
+KineticStatus KineticCluster_AddSession(KineticCluster * const cluster,
+                                        KineticSession * const session,
+                                        uint32_t weight)
+{
+    KINETIC_ASSERT(cluster);
+    KINETIC_ASSERT(session);
+
+    if (weight == 0) { return KINETIC_STATUS_INVALID_REQUEST; }
+
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    pthread_mutex_lock(&cluster->mutex);
+
+    for (size_t m = 0; m < cluster->memberCount; m++) {
+        KineticSessionConfig const * config = &cluster->members[m].session->config;
+        if (config->port == session->config.port &&
+            strcmp(config->host, session->config.host) == 0) {
+            status = KINETIC_STATUS_INVALID_REQUEST;
+            goto cleanup;
+        }
+    }
+
+    ClusterMember * members = realloc(cluster->members,
+        (cluster->memberCount + 1) * sizeof(*members));
+    if (members == NULL) {
+        status = KINETIC_STATUS_MEMORY_ERROR;
+        goto cleanup;
+    }
+    cluster->members = members;
+    members[cluster->memberCount] = (ClusterMember) {.session = session, .weight = weight};
+
+    RingPoint * ring;
+    size_t ringCount;
+    if (!build_ring(cluster, cluster->memberCount + 1, SIZE_MAX, &ring, &ringCount)) {
+        status = KINETIC_STATUS_MEMORY_ERROR;
+        goto cleanup;
+    }
+    free(cluster->ring);
+    cluster->ring = ring;
+    cluster->ringCount = ringCount;
+    cluster->memberCount++;
+    LOGF2("Added %s:%d to cluster w/weight %u (%zu drives)",
+        session->config.host, session->config.port, weight, cluster->memberCount);
+
+cleanup:
+    pthread_mutex_unlock(&cluster->mutex);
+    return status;
+}
+
+KineticStatus KineticCluster_RemoveSession(KineticCluster * const cluster,
+                                           KineticSession * const session)
+{
+    KINETIC_ASSERT(cluster);
+    KINETIC_ASSERT(session);
+
+    KineticStatus status = KINETIC_STATUS_INVALID_REQUEST;
+    pthread_mutex_lock(&cluster->mutex);
+
+    for (size_t m = 0; m < cluster->memberCount; m++) {
+        if (cluster->members[m].session != session) { continue; }
+
+        RingPoint * ring;
+        size_t ringCount;
+        if (!build_ring(cluster, cluster->memberCount, m, &ring, &ringCount)) {
+            status = KINETIC_STATUS_MEMORY_ERROR;
+            break;
+        }
+        free(cluster->ring);
+        cluster->ring = ring;
+        cluster->ringCount = ringCount;
+        memmove(&cluster->members[m], &cluster->members[m + 1],
+            (cluster->memberCount - m - 1) * sizeof(cluster->members[0]));
+        cluster->memberCount--;
+        LOGF2("Removed %s:%d from cluster (%zu drives)",
+            session->config.host, session->config.port, cluster->memberCount);
+        status = KINETIC_STATUS_SUCCESS;
+        break;
+    }
+
+    pthread_mutex_unlock(&cluster->mutex);
+    return status;
+}
+
+KineticSession * KineticCluster_Locate(KineticCluster * const cluster, ByteArray const key)
+{
+    KINETIC_ASSERT(cluster);
+
+    KineticSession * session = NULL;
+    pthread_mutex_lock(&cluster->mutex);
+    if (cluster->ringCount > 0) {
+        session = cluster->members[locate_member(cluster, key)].session;
+    }
+    pthread_mutex_unlock(&cluster->mutex);
+    return session;
+}
+
+KineticStatus KineticCluster_Put(KineticCluster * const cluster,
+                                 KineticEntry * const entry,
+                                 KineticCompletionClosure * closure)
+{
+    KINETIC_ASSERT(entry);
+    KineticSession * session = KineticCluster_Locate(cluster, entry_key(entry));
+    if (session == NULL) { return KINETIC_STATUS_SESSION_INVALID; }
+    return KineticClient_Put(session, entry, closure);
+}
+
+KineticStatus KineticCluster_Get(KineticCluster * const cluster,
+                                 KineticEntry * const entry,
+                                 KineticCompletionClosure * closure)
+{
+    KINETIC_ASSERT(entry);
+    KineticSession * session = KineticCluster_Locate(cluster, entry_key(entry));
+    if (session == NULL) { return KINETIC_STATUS_SESSION_INVALID; }
+    return KineticClient_Get(session, entry, closure);
+}
+
+KineticStatus KineticCluster_Delete(KineticCluster * const cluster,
+                                    KineticEntry * const entry,
+                                    KineticCompletionClosure * closure)
+{
+    KINETIC_ASSERT(entry);
+    KineticSession * session = KineticCluster_Locate(cluster, entry_key(entry));
+    if (session == NULL) { return KINETIC_STATUS_SESSION_INVALID; }
+    return KineticClient_Delete(session, entry, closure);
+}
+
+typedef KineticStatus (*ClusterBatchFn)(KineticSession* const session,
+    KineticEntry* const entries, size_t count, KineticStatus* statuses,
+    KineticCompletionClosure* closure);
+
+typedef struct _ClusterBatch ClusterBatch;
+
+/* One drive's share of a batch, with copies of its entries kept
+ * contiguous for KineticClient_*Batch. */
+typedef struct {
+    ClusterBatch * batch;
+    KineticSession * session;
+    size_t count;
+    KineticEntry * entries;
+    size_t * indexes;           // Of each entry in the caller's array
+    KineticStatus * statuses;
+} ClusterBatchPart;
+
+struct _ClusterBatch {
+    pthread_mutex_t mutex;
+    pthread_cond_t complete;
+    size_t remaining;           // Parts outstanding, plus one for the sender
+    KineticStatus status;
+    KineticEntry * entries;     // The caller's
+    KineticStatus * statuses;   // The caller's, if any
+    size_t count;
+    KineticCompletionClosure closure;
+    bool async;
+    size_t partCount;
+    ClusterBatchPart * parts;
+    KineticEntry * partEntries;
+    size_t * partIndexes;
+    KineticStatus * partStatuses;
+    KineticStatus * results;    // Of each entry, in the caller's order
+};
+
+static void free_cluster_batch(ClusterBatch * batch)
+{
+    pthread_cond_destroy(&batch->complete);
+    pthread_mutex_destroy(&batch->mutex);
+    free(batch);
+}
+
+/* Copy every entry's result out to the caller, and set the batch status:
+ * the status of the lowest-indexed entry that failed, if any. */
+static void report_results(ClusterBatch * batch)
+{
+    batch->status = KINETIC_STATUS_SUCCESS;
+    for (size_t i = 0; i < batch->count; i++) {
+        KineticStatus status = batch->results[i];
+        if (batch->statuses != NULL) { batch->statuses[i] = status; }
+        if (status != KINETIC_STATUS_SUCCESS && batch->status == KINETIC_STATUS_SUCCESS) {
+            batch->status = status;
+        }
+    }
+}
+
+/* Drop one reference to BATCH. The last one reports the batch status. */
+static void release_cluster_batch(ClusterBatch * batch)
+{
+    pthread_mutex_lock(&batch->mutex);
+    bool last = (--batch->remaining == 0);
+    bool async = batch->async;
+    if (last) {
+        report_results(batch);
+        if (!async) { pthread_cond_signal(&batch->complete); }
+    }
+    pthread_mutex_unlock(&batch->mutex);
+
+    if (last && async) {
+        KineticCompletionData completionData = {.status = batch->status};
+        KineticCompletionClosure closure = batch->closure;
+        free_cluster_batch(batch);
+        if (closure.queue != NULL) {
+            KineticCompletionQueue_Push(closure.queue, closure.clientData, completionData.status);
+        }
+        else if (closure.callback != NULL) {
+            closure.callback(&completionData, closure.clientData);
+        }
+    }
+}
+
+/* Hand a finished part's results back to the caller's entries. Parts
+ * cover disjoint entries, so this needs no lock. */
+static void finish_part(ClusterBatchPart * part)
+{
+    ClusterBatch * batch = part->batch;
+    for (size_t j = 0; j < part->count; j++) {
+        size_t i = part->indexes[j];
+        batch->entries[i] = part->entries[j];
+        batch->results[i] = part->statuses[j];
+    }
+    release_cluster_batch(batch);
+}
+
+static void part_done(KineticCompletionData* kinetic_data, void* client_data)
+{
+    (void)kinetic_data;
+    finish_part(client_data);
+}
+
+/* Allocate a batch, and group the caller's entries into one part per
+ * drive that owns any of them. */
+static KineticStatus new_cluster_batch(KineticCluster * const cluster,
+                                       KineticEntry * const entries, size_t count,
+                                       ClusterBatch ** batchOut)
+{
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    ClusterBatch * batch = NULL;
+    size_t * owners = malloc(count * sizeof(*owners));
+    if (owners == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+
+    pthread_mutex_lock(&cluster->mutex);
+    size_t memberCount = cluster->memberCount;
+    if (cluster->ringCount == 0) {
+        status = KINETIC_STATUS_SESSION_INVALID;
+        goto cleanup;
+    }
+
+    // Each array's element size is a multiple of the next one's alignment
+    size_t size = sizeof(*batch)
+        + memberCount * sizeof(batch->parts[0])
+        + count * (sizeof(batch->partEntries[0]) + sizeof(batch->partIndexes[0])
+                   + 2 * sizeof(batch->partStatuses[0]));
+    batch = calloc(1, size);
+    if (batch == NULL) {
+        status = KINETIC_STATUS_MEMORY_ERROR;
+        goto cleanup;
+    }
+    batch->parts = (ClusterBatchPart *)(batch + 1);
+    batch->partEntries = (KineticEntry *)(batch->parts + memberCount);
+    batch->partIndexes = (size_t *)(batch->partEntries + count);
+    batch->partStatuses = (KineticStatus *)(batch->partIndexes + count);
+    batch->results = batch->partStatuses + count;
+    batch->partCount = memberCount;
+
+    for (size_t i = 0; i < count; i++) {
+        owners[i] = locate_member(cluster, entry_key(&entries[i]));
+        batch->parts[owners[i]].count++;
+    }
+    for (size_t m = 0; m < memberCount; m++) {
+        batch->parts[m].session = cluster->members[m].session;
+    }
+
+cleanup:
+    pthread_mutex_unlock(&cluster->mutex);
+
+    if (batch != NULL) {
+        size_t start = 0;
+        for (size_t m = 0; m < memberCount; m++) {
+            ClusterBatchPart * part = &batch->parts[m];
+            part->batch = batch;
+            part->entries = &batch->partEntries[start];
+            part->indexes = &batch->partIndexes[start];
+            part->statuses = &batch->partStatuses[start];
+            start += part->count;
+            part->count = 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            ClusterBatchPart * part = &batch->parts[owners[i]];
+            part->entries[part->count] = entries[i];
+            part->indexes[part->count] = i;
+            part->statuses[part->count] = KINETIC_STATUS_INVALID;
+            part->count++;
+        }
+    }
+    free(owners);
+    *batchOut = batch;
+    return status;
+}
+
+static KineticStatus execute_cluster_batch(KineticCluster * const cluster,
+                                           KineticEntry * const entries,
+                                           size_t count,
+                                           KineticStatus * statuses,
+                                           KineticCompletionClosure * closure,
+                                           ClusterBatchFn execute)
+{
+    KINETIC_ASSERT(cluster);
+    KINETIC_ASSERT(entries);
+    KINETIC_ASSERT(count > 0);
+
+    ClusterBatch * batch;
+    KineticStatus status = new_cluster_batch(cluster, entries, count, &batch);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    pthread_mutex_init(&batch->mutex, NULL);
+    pthread_cond_init(&batch->complete, NULL);
+    batch->entries = entries;
+    batch->statuses = statuses;
+    batch->count = count;
+    batch->async = (closure != NULL);
+    if (closure != NULL) { batch->closure = *closure; }
+
+    // Every drive's part is sent asynchronously, so the drives work in
+    // parallel; the sender's reference keeps the batch until all are sent
+    batch->remaining = 1;
+    for (size_t m = 0; m < batch->partCount; m++) {
+        if (batch->parts[m].count > 0) { batch->remaining++; }
+    }
+    size_t sentParts = 0;
+    for (size_t m = 0; m < batch->partCount; m++) {
+        ClusterBatchPart * part = &batch->parts[m];
+        if (part->count == 0) { continue; }
+        KineticCompletionClosure partClosure = {
+            .callback = part_done,
+            .clientData = part,
+        };
+        status = execute(part->session, part->entries, part->count,
+            part->statuses, &partClosure);
+        if (status != KINETIC_STATUS_SUCCESS) {
+            // Nothing was sent, so it will not complete. Keep the status of
+            // any entry that got as far as being built or sent.
+            for (size_t j = 0; j < part->count; j++) {
+                if (part->statuses[j] == KINETIC_STATUS_INVALID) {
+                    part->statuses[j] = status;
+                }
+            }
+            finish_part(part);
+        }
+        else {
+            sentParts++;
+        }
+    }
+
+    if (closure != NULL && sentParts == 0) {
+        // As for KineticClient_PutBatch, report the failure here rather
+        // than through the closure. Every part is done, so only the
+        // sender's reference is left.
+        report_results(batch);
+        status = batch->status;
+        free_cluster_batch(batch);
+        return status;
+    }
+
+    release_cluster_batch(batch);
+    if (closure != NULL) { return KINETIC_STATUS_SUCCESS; }
+
+    pthread_mutex_lock(&batch->mutex);
+    while (batch->remaining > 0) {
+        pthread_cond_wait(&batch->complete, &batch->mutex);
+    }
+    status = batch->status;
+    pthread_mutex_unlock(&batch->mutex);
+    free_cluster_batch(batch);
+    return status;
+}
+
+KineticStatus KineticCluster_PutBatch(KineticCluster * const cluster,
+                                      KineticEntry * const entries,
+                                      size_t count,
+                                      KineticStatus * statuses,
+                                      KineticCompletionClosure * closure)
+{
+    return execute_cluster_batch(cluster, entries, count, statuses, closure,
+        KineticClient_PutBatch);
+}
+
+KineticStatus KineticCluster_GetBatch(KineticCluster * const cluster,
+                                      KineticEntry * const entries,
+                                      size_t count,
+                                      KineticStatus * statuses,
+                                      KineticCompletionClosure * closure)
+{
+    return execute_cluster_batch(cluster, entries, count, statuses, closure,
+        KineticClient_GetBatch);
+}
+
+KineticStatus KineticCluster_DeleteBatch(KineticCluster * const cluster,
+                                         KineticEntry * const entries,
+                                         size_t count,
+                                         KineticStatus * statuses,
+                                         KineticCompletionClosure * closure)
+{
+    return execute_cluster_batch(cluster, entries, count, statuses, closure,
+        KineticClient_DeleteBatch);
+}
+
+typedef struct {
+    uint8_t keys[REBALANCE_KEYS_PER_RANGE][KINETIC_MAX_KEY_LEN];
+    uint8_t startKey[KINETIC_MAX_KEY_LEN];
+    uint8_t endKey[KINETIC_MAX_KEY_LEN];
+    uint8_t value[KINETIC_OBJ_SIZE];
+    uint8_t tag[REBALANCE_METADATA_LEN];
+    uint8_t version[REBALANCE_METADATA_LEN];
+} RebalanceBuffers;
+
+/* Copy the entry at KEY from SESSION to OWNER, then delete it from
+ * SESSION. An entry deleted since it was listed is skipped. */
+static KineticStatus move_entry(KineticSession * const session,
+                                KineticSession * const owner,
+                                ByteBuffer key,
+                                RebalanceBuffers * buffers,
+                                bool * moved)
+{
+    *moved = false;
+
+    KineticEntry entry = {
+        .key = key,
+        .value = ByteBuffer_Create(buffers->value, sizeof(buffers->value), 0),
+        .tag = ByteBuffer_Create(buffers->tag, sizeof(buffers->tag), 0),
+        .dbVersion = ByteBuffer_Create(buffers->version, sizeof(buffers->version), 0),
+    };
+    KineticStatus status = KineticClient_Get(session, &entry, NULL);
+    if (status == KINETIC_STATUS_NOT_FOUND) { return KINETIC_STATUS_SUCCESS; }
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    KineticEntry put = {
+        .key = key,
+        .value = entry.value,
+        .tag = entry.tag,
+        .algorithm = entry.algorithm,
+        .newVersion = entry.dbVersion,
+        .force = true,
+        .synchronization = KINETIC_SYNCHRONIZATION_WRITETHROUGH,
+    };
+    status = KineticClient_Put(owner, &put, NULL);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    KineticEntry delete = {
+        .key = key,
+        .force = true,
+        .synchronization = KINETIC_SYNCHRONIZATION_WRITETHROUGH,
+    };
+    status = KineticClient_Delete(session, &delete, NULL);
+    if (status == KINETIC_STATUS_NOT_FOUND) { status = KINETIC_STATUS_SUCCESS; }
+    *moved = (status == KINETIC_STATUS_SUCCESS);
+    return status;
+}
+
+KineticStatus KineticCluster_Rebalance(KineticCluster * const cluster,
+                                       KineticSession * const session,
+                                       size_t * moved)
+{
+    KINETIC_ASSERT(cluster);
+    KINETIC_ASSERT(session);
+
+    if (moved != NULL) { *moved = 0; }
+
+    RebalanceBuffers * buffers = malloc(sizeof(*buffers));
+    if (buffers == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+
+    ByteBuffer keyBuffers[REBALANCE_KEYS_PER_RANGE];
+    ByteBufferArray keys = {
+        .buffers = keyBuffers,
+        .count = REBALANCE_KEYS_PER_RANGE,
+    };
+
+    // Every key sorts after the empty key and no later than the longest
+    // key of all 0xFF bytes
+    memset(buffers->endKey, 0xFF, sizeof(buffers->endKey));
+    KineticKeyRange range = {
+        .startKey = ByteBuffer_Create(buffers->startKey, sizeof(buffers->startKey), 1),
+        .endKey = ByteBuffer_Create(buffers->endKey, sizeof(buffers->endKey), sizeof(buffers->endKey)),
+        .startKeyInclusive = true,
+        .endKeyInclusive = true,
+        .maxReturned = REBALANCE_KEYS_PER_RANGE,
+    };
+    buffers->startKey[0] = 0x00;
+
+    KineticStatus status;
+    for (;;) {
+        for (size_t i = 0; i < REBALANCE_KEYS_PER_RANGE; i++) {
+            keyBuffers[i] = ByteBuffer_Create(buffers->keys[i], sizeof(buffers->keys[i]), 0);
+        }
+        keys.used = 0;
+        status = KineticClient_GetKeyRange(session, &range, &keys, NULL);
+        if (status != KINETIC_STATUS_SUCCESS) { break; }
+
+        for (size_t i = 0; i < keys.used && status == KINETIC_STATUS_SUCCESS; i++) {
+            ByteArray key = {.data = keyBuffers[i].array.data, .len = keyBuffers[i].bytesUsed};
+            KineticSession * owner = KineticCluster_Locate(cluster, key);
+            if (owner == NULL || owner == session) { continue; }
+            bool entryMoved;
+            status = move_entry(session, owner, keyBuffers[i], buffers, &entryMoved);
+            if (entryMoved && moved != NULL) { (*moved)++; }
+        }
+        if (status != KINETIC_STATUS_SUCCESS || keys.used < REBALANCE_KEYS_PER_RANGE) { break; }
+
+        // Continue after the last key listed
+        ByteBuffer const * last = &keyBuffers[keys.used - 1];
+        memcpy(buffers->startKey, last->array.data, last->bytesUsed);
+        range.startKey.bytesUsed = last->bytesUsed;
+        range.startKeyInclusive = false;
+    }
+
+    free(buffers);
+    return status;
+}
@@ -0,0 +1,215 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_completion_queue.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+
+#define CACHE_LINE (64)
+
+/* A bounded multi-producer, multi-consumer ring. Each cell's sequence
+ * says whose turn it is: equal to its position when free for the push of
+ * that position, and one more when it holds the event for the poll of it.
+ * Pushes and polls claim positions by advancing tail and head, so neither
+ * takes the mutex unless the queue is full or empty. */
+typedef struct {
+    size_t sequence;
+    KineticCompletionEvent event;
+} CompletionCell;
+
+struct _KineticCompletionQueue {
+    CompletionCell * cells;
+    size_t mask;
+    uint8_t pad0[CACHE_LINE];
+    size_t tail;                // Next position to push
+    uint8_t pad1[CACHE_LINE];
+    size_t head;                // Next position to poll
+    uint8_t pad2[CACHE_LINE];
+
+    // Only used to sleep on an empty or full queue
+    pthread_mutex_t mutex;
+    pthread_cond_t readable;
+    pthread_cond_t writable;
+    int pollers;                // Threads waiting for events
+    int pushers;                // Threads waiting for room
+};
+
+KineticCompletionQueue * KineticCompletionQueue_Create(size_t capacity)
+{
+    size_t count = 2;
+    while (count < capacity) { count <<= 1; }
+
+    KineticCompletionQueue * queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) { return NULL; }
+    queue->cells = calloc(count, sizeof(queue->cells[0]));
+    if (queue->cells == NULL) {
+        free(queue);
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        queue->cells[i].sequence = i;
+    }
+    queue->mask = count - 1;
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->readable, NULL);
+    pthread_cond_init(&queue->writable, NULL);
+    return queue;
+}
+
+void KineticCompletionQueue_Destroy(KineticCompletionQueue * const queue)
+{
+    if (queue == NULL) { return; }
+    pthread_cond_destroy(&queue->writable);
+    pthread_cond_destroy(&queue->readable);
+    pthread_mutex_destroy(&queue->mutex);
+    free(queue->cells);
+    free(queue);
+}
+
+static bool try_push(KineticCompletionQueue * const queue, KineticCompletionEvent event)
+{
+    size_t pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    CompletionCell * cell;
+    for (;;) {
+        cell = &queue->cells[pos & queue->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { break; }
+        }
+        else if (diff < 0) {
+            return false;   // full
+        }
+        else {
+            pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+    cell->event = event;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static bool try_poll(KineticCompletionQueue * const queue, KineticCompletionEvent * event)
+{
+    size_t pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    CompletionCell * cell;
+    for (;;) {
+        cell = &queue->cells[pos & queue->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->head, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) { break; }
+        }
+        else if (diff < 0) {
+            return false;   // empty
+        }
+        else {
+            pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+        }
+    }
+    *event = cell->event;
+    __atomic_store_n(&cell->sequence, pos + queue->mask + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Sleepers announce themselves before checking the ring again, and wakers
+ * check for them after changing it, both behind full barriers, so either
+ * the sleeper sees the change or the waker sees the sleeper. */
+static void wake(KineticCompletionQueue * const queue, int * waiting, pthread_cond_t * cond)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiting, __ATOMIC_RELAXED) > 0) {
+        pthread_mutex_lock(&queue->mutex);
+        pthread_cond_broadcast(cond);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+}
+
+void KineticCompletionQueue_Push(KineticCompletionQueue * const queue,
+    void * tag, KineticStatus status)
+{
+    KINETIC_ASSERT(queue != NULL);
+    KineticCompletionEvent event = {.tag = tag, .status = status};
+
+    if (!try_push(queue, event)) {
+        pthread_mutex_lock(&queue->mutex);
+        __atomic_add_fetch(&queue->pushers, 1, __ATOMIC_SEQ_CST);
+        while (!try_push(queue, event)) {
+            pthread_cond_wait(&queue->writable, &queue->mutex);
+        }
+        __atomic_sub_fetch(&queue->pushers, 1, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+    wake(queue, &queue->pollers, &queue->readable);
+}
+
+static size_t poll_events(KineticCompletionQueue * const queue,
+    KineticCompletionEvent events[], size_t max)
+{
+    size_t count = 0;
+    while (count < max && try_poll(queue, &events[count])) {
+        count++;
+    }
+    return count;
+}
+
+size_t KineticCompletionQueue_Poll(KineticCompletionQueue * const queue,
+    KineticCompletionEvent events[], size_t max, int timeoutMillis)
+{
+    KINETIC_ASSERT(queue != NULL);
+    KINETIC_ASSERT(events != NULL || max == 0);
+    if (max == 0) { return 0; }
+
+    size_t count = poll_events(queue, events, max);
+    if (count == 0 && timeoutMillis != 0) {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        int64_t expireNanos = (int64_t)now.tv_usec * 1000 + (int64_t)timeoutMillis * 1000000;
+        struct timespec expire = {
+            .tv_sec = now.tv_sec + (time_t)(expireNanos / 1000000000),
+            .tv_nsec = (long)(expireNanos % 1000000000),
+        };
+
+        pthread_mutex_lock(&queue->mutex);
+        __atomic_add_fetch(&queue->pollers, 1, __ATOMIC_SEQ_CST);
+        int rc = 0;
+        while ((count = poll_events(queue, events, max)) == 0 && rc == 0) {
+            if (timeoutMillis < 0) {
+                pthread_cond_wait(&queue->readable, &queue->mutex);
+            }
+            else {
+                rc = pthread_cond_timedwait(&queue->readable, &queue->mutex, &expire);
+            }
+        }
+        __atomic_sub_fetch(&queue->pollers, 1, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+
+    if (count > 0) {
+        wake(queue, &queue->pushers, &queue->writable);
+    }
+    return count;
+}
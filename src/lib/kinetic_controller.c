@@ -27,35 +27,151 @@
 #include "kinetic_socket.h"
 #include "kinetic_allocator.h"
 #include "kinetic_resourcewaiter.h"
+#include "kinetic_completion_queue.h"
+#include "kinetic_futex.h"
 #include "kinetic_logger.h"
 #include <pthread.h>
+#include <stdlib.h>
 #include "bus.h"
 
+/* Largest GET value a blocking caller's operation is completed with on the
+ * bus listener. Copying more would hold up every other response on it. */
+#define INLINE_COMPLETION_MAX_VALUE (16 * 1024)
+
+/* Blocking callers wait on a waiter of their own thread's, reused from one
+ * operation to the next, so that waiting needs no allocation, nor a mutex
+ * and condition variable set up and torn down per operation. */
+typedef enum {
+    WAITER_PENDING = 0,
+    WAITER_SLEEPING,    // Set by the caller before sleeping, so it must be woken
+    WAITER_DONE,
+} WaiterState;
+
 typedef struct {
-    pthread_mutex_t receiveCompleteMutex;
-    pthread_cond_t receiveComplete;
-    bool completed;
+    int state;
     KineticStatus status;
-} DefaultCallbackData;
+} SyncWaiter;
+
+static pthread_key_t SyncWaiterKey;
+static pthread_once_t SyncWaiterOnce = PTHREAD_ONCE_INIT;
+
+static void create_sync_waiter_key(void)
+{
+    (void)pthread_key_create(&SyncWaiterKey, free);
+}
+
+static SyncWaiter * thread_sync_waiter(void)
+{
+    pthread_once(&SyncWaiterOnce, create_sync_waiter_key);
+    SyncWaiter * waiter = pthread_getspecific(SyncWaiterKey);
+    if (waiter == NULL) {
+        waiter = calloc(1, sizeof(*waiter));
+        if (waiter != NULL && pthread_setspecific(SyncWaiterKey, waiter) != 0) {
+            free(waiter);
+            waiter = NULL;
+        }
+    }
+    return waiter;
+}
 
 static void DefaultCallback(KineticCompletionData* kinetic_data, void* client_data)
 {
-    DefaultCallbackData * data = client_data;
-    pthread_mutex_lock(&data->receiveCompleteMutex);
-    data->status = kinetic_data->status;
-    data->completed = true;
-    pthread_cond_signal(&data->receiveComplete);
-    pthread_mutex_unlock(&data->receiveCompleteMutex);
+    SyncWaiter * waiter = client_data;
+    waiter->status = kinetic_data->status;
+    if (__atomic_exchange_n(&waiter->state, WAITER_DONE, __ATOMIC_ACQ_REL) == WAITER_SLEEPING) {
+        KineticFutex_WakeOne(&waiter->state);
+    }
 }
 
-STATIC KineticCompletionClosure DefaultClosure(DefaultCallbackData * const data)
+static KineticStatus wait_for_completion(SyncWaiter * waiter)
+{
+    int state = __atomic_load_n(&waiter->state, __ATOMIC_ACQUIRE);
+    while (state != WAITER_DONE) {
+        if (state == WAITER_SLEEPING || __atomic_compare_exchange_n(&waiter->state,
+                &state, WAITER_SLEEPING, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+            KineticFutex_Wait(&waiter->state, WAITER_SLEEPING);
+            state = __atomic_load_n(&waiter->state, __ATOMIC_ACQUIRE);
+        }
+    }
+    return waiter->status;
+}
+
+STATIC KineticCompletionClosure DefaultClosure(SyncWaiter * const waiter)
 {
     return (KineticCompletionClosure) {
         .callback = DefaultCallback,
-        .clientData = data,
+        .clientData = waiter,
     };
 }
 
+/* Value bytes an operation moves: the value of a PUT, or the room left
+ * for the value of a GET. */
+static size_t transfer_len(KineticOperation const * const operation)
+{
+    KineticEntry const * const entry = operation->entry;
+    if (entry == NULL) { return 0; }
+    switch (operation->request->message.header.messagetype) {
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT:
+        return entry->value.bytesUsed;
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETNEXT:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETPREVIOUS:
+        if (entry->metadataOnly || entry->value.array.len < entry->value.bytesUsed) { return 0; }
+        return entry->value.array.len - entry->value.bytesUsed;
+    default:
+        return 0;
+    }
+}
+
+/* Whether completing a blocking operation is quick enough to do on the bus
+ * listener: it runs no caller code, and copies no large or tag-checked
+ * value. Otherwise it goes to the bus thread pool like any other. */
+static bool completes_quickly(KineticOperation const * const operation)
+{
+    if (operation->keyCallback != NULL) { return false; }
+    switch (operation->request->message.header.messagetype) {
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETNEXT:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETPREVIOUS:
+        if (operation->entry != NULL && operation->entry->computeTag) { return false; }
+        return transfer_len(operation) <= INLINE_COMPLETION_MAX_VALUE;
+    default:
+        return true;
+    }
+}
+
+/* The connection to send operations moving `len` value bytes on: one of
+ * the session's extra connections, round robin, for large transfers, and
+ * the session itself otherwise or if that connection has been lost. */
+static KineticSession * select_lane(KineticSession * const session, size_t len)
+{
+    if (session->laneCount == 0) { return session; }
+    size_t threshold = session->config.stripeThreshold;
+    if (threshold == 0) { threshold = KINETIC_DEFAULT_STRIPE_THRESHOLD; }
+    if (len < threshold) { return session; }
+
+    uint32_t turn = __sync_fetch_and_add(&session->nextLane, 1);
+    KineticSession * const lane = session->lanes[turn % session->laneCount];
+
+    // A lane's state changes on its own bus thread, so read it atomically
+    if (!__atomic_load_n(&lane->connected, __ATOMIC_ACQUIRE) ||
+        __atomic_load_n(&lane->terminationStatus, __ATOMIC_ACQUIRE) != KINETIC_STATUS_SUCCESS) {
+        return session;
+    }
+    return lane;
+}
+
+/* Move a built operation to another connection of its session. The
+ * request's sequence is bound when it is sent, so only its connection ID
+ * and header template change; it still returns to the pool it came from. */
+static void move_to_lane(KineticOperation * const operation, KineticSession * const lane)
+{
+    KineticRequest * const request = operation->request;
+    operation->session = lane;
+    request->message.header.connectionid = lane->connectionID;
+    request->encoderTemplate = lane->requestTemplate.ready ? &lane->requestTemplate : NULL;
+}
+
 KineticStatus KineticController_ExecuteOperation(KineticOperation* operation, KineticCompletionClosure* const closure)
 {
     KINETIC_ASSERT(operation != NULL);
@@ -67,34 +183,43 @@ KineticStatus KineticController_ExecuteOperation(KineticOperation* operation, Ki
         return KINETIC_STATUS_SESSION_TERMINATED;
     }
 
+    KineticSession * const lane = select_lane(session, transfer_len(operation));
+    if (lane != session) {
+        move_to_lane(operation, lane);
+    }
+
     if (closure != NULL) {
         operation->closure = *closure;
         return KineticOperation_SendRequest(operation);
     }
     else {
-        DefaultCallbackData data;
-        pthread_mutex_init(&data.receiveCompleteMutex, NULL);
-        pthread_cond_init(&data.receiveComplete, NULL);
-        data.status = KINETIC_STATUS_INVALID;
-        data.completed = false;
+        // A thread waits on one operation at a time, so its waiter is free.
+        // The completion may still be waking the waiter after this call
+        // returns, so it cannot live on the stack.
+        SyncWaiter * const waiter = thread_sync_waiter();
+        if (waiter == NULL) {
+            KineticAllocator_FreeOperation(operation);
+            return KINETIC_STATUS_MEMORY_ERROR;
+        }
+        waiter->state = WAITER_PENDING;
+        waiter->status = KINETIC_STATUS_INVALID;
+
+        operation->closure = DefaultClosure(waiter);
 
-        operation->closure = DefaultClosure(&data);
+        // Waking the caller is all that is left to do on completion of
+        // most operations, so do it from the bus listener rather than
+        // handing it to a thread
+        operation->completeInline = completes_quickly(operation);
 
         // Send the request
         status = KineticOperation_SendRequest(operation);
 
         if (status == KINETIC_STATUS_SUCCESS) {
-            pthread_mutex_lock(&data.receiveCompleteMutex);
-            while(data.completed == false) {
-                pthread_cond_wait(&data.receiveComplete, &data.receiveCompleteMutex);
-            }
-            status = data.status;
-            pthread_mutex_unlock(&data.receiveCompleteMutex);
+            status = wait_for_completion(waiter);
         }
 
-        pthread_cond_destroy(&data.receiveComplete);
-        pthread_mutex_destroy(&data.receiveCompleteMutex);
-
+        // Only the session itself is torn down here: a lane that was lost
+        // is left to the session, and skipped by select_lane until then
         if (status != KINETIC_STATUS_SUCCESS) {
             if (KineticSession_GetTerminationStatus(session) != KINETIC_STATUS_SUCCESS) {
                 (void)KineticSession_Disconnect(session);
@@ -108,6 +233,210 @@ KineticStatus KineticController_ExecuteOperation(KineticOperation* operation, Ki
     }
 }
 
+typedef struct _BatchData BatchData;
+
+typedef struct {
+    BatchData * batch;
+    size_t index;
+} BatchSlot;
+
+struct _BatchData {
+    pthread_mutex_t mutex;
+    pthread_cond_t complete;
+    size_t remaining;
+    size_t failedIndex;
+    KineticStatus status;
+    KineticStatus * statuses;
+    KineticCompletionClosure closure;
+    bool async;
+    BatchSlot slots[];
+};
+
+static void free_batch(BatchData * batch)
+{
+    pthread_cond_destroy(&batch->complete);
+    pthread_mutex_destroy(&batch->mutex);
+    free(batch);
+}
+
+/* Call an async batch's closure with the batch status, and free it. */
+static void finish_async_batch(BatchData * batch)
+{
+    KineticCompletionData completionData = {.status = batch->status};
+    KineticCompletionClosure closure = batch->closure;
+    free_batch(batch);
+    if (closure.queue != NULL) {
+        KineticCompletionQueue_Push(closure.queue, closure.clientData, completionData.status);
+    }
+    else if (closure.callback != NULL) {
+        closure.callback(&completionData, closure.clientData);
+    }
+}
+
+/* Count one entry of BATCH as done, with its mutex held, and unlock. */
+static void end_batch_entry(BatchData * batch)
+{
+    bool last = (--batch->remaining == 0);
+    bool async = batch->async;
+    if (last && !async) {
+        pthread_cond_signal(&batch->complete);
+    }
+    pthread_mutex_unlock(&batch->mutex);
+
+    if (last && async) { finish_async_batch(batch); }
+}
+
+/* Record one entry's status. Whoever completes the last entry of an async
+ * batch frees it and calls the client's closure; a sync batch is freed by
+ * the thread waiting on it. The thread sending the batch holds one extra
+ * entry of its own until every entry has been sent. */
+static void complete_batch_slot(BatchSlot * slot, KineticStatus status)
+{
+    BatchData * batch = slot->batch;
+
+    pthread_mutex_lock(&batch->mutex);
+    if (batch->statuses != NULL) {
+        batch->statuses[slot->index] = status;
+    }
+    if (status != KINETIC_STATUS_SUCCESS && slot->index < batch->failedIndex) {
+        batch->failedIndex = slot->index;
+        batch->status = status;
+    }
+    end_batch_entry(batch);
+}
+
+static void BatchCallback(KineticCompletionData* kinetic_data, void* client_data)
+{
+    complete_batch_slot(client_data, kinetic_data->status);
+}
+
+KineticStatus KineticController_ExecuteBatch(KineticSession* const session,
+                                             KineticEntry* const entries, size_t count,
+                                             KineticBatchBuilder build,
+                                             KineticStatus statuses[],
+                                             KineticCompletionClosure* const closure)
+{
+    KINETIC_ASSERT(session != NULL);
+    KINETIC_ASSERT(entries != NULL);
+    KINETIC_ASSERT(build != NULL);
+    KINETIC_ASSERT(count > 0);
+
+    if (KineticSession_GetTerminationStatus(session) != KINETIC_STATUS_SUCCESS) {
+        return KINETIC_STATUS_SESSION_TERMINATED;
+    }
+
+    BatchData * batch = calloc(1, sizeof(*batch) + count * sizeof(batch->slots[0]));
+    if (batch == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    pthread_mutex_init(&batch->mutex, NULL);
+    pthread_cond_init(&batch->complete, NULL);
+    batch->remaining = count + 1;       // Released once all are sent
+    batch->failedIndex = count;
+    batch->status = KINETIC_STATUS_SUCCESS;
+    batch->statuses = statuses;
+    batch->async = (closure != NULL);
+    if (closure != NULL) { batch->closure = *closure; }
+    for (size_t i = 0; i < count; i++) {
+        batch->slots[i] = (BatchSlot) {.batch = batch, .index = i};
+    }
+
+    // Entries may complete while later ones are still being sent; the
+    // extra entry held here keeps the batch alive until all are sent
+    size_t done = 0;
+    size_t sent = 0;
+    while (done < count) {
+        size_t n = count - done;
+        if (n > KINETIC_OPERATION_MAX_BATCH) { n = KINETIC_OPERATION_MAX_BATCH; }
+
+        KineticOperation * ops[KINETIC_OPERATION_MAX_BATCH];
+        BatchSlot * slots[KINETIC_OPERATION_MAX_BATCH];
+        KineticStatus sendStatuses[KINETIC_OPERATION_MAX_BATCH];
+        size_t built = 0;
+
+        for (size_t i = 0; i < n; i++) {
+            BatchSlot * slot = &batch->slots[done + i];
+            KineticOperation * op = KineticAllocator_NewOperation(session);
+            if (op == NULL) {
+                complete_batch_slot(slot, KINETIC_STATUS_MEMORY_ERROR);
+                continue;
+            }
+            KineticStatus status = build(op, &entries[done + i]);
+            if (status != KINETIC_STATUS_SUCCESS) {
+                KineticAllocator_FreeOperation(op);
+                complete_batch_slot(slot, status);
+                continue;
+            }
+            op->closure = (KineticCompletionClosure) {
+                .callback = BatchCallback,
+                .clientData = slot,
+            };
+            ops[built] = op;
+            slots[built] = slot;
+            sendStatuses[built] = KINETIC_STATUS_INVALID;
+            built++;
+        }
+        done += n;
+
+        // A run of operations is sent on one connection, so the largest
+        // transfer in it decides which
+        size_t runLen = 0;
+        for (size_t i = 0; i < built; i++) {
+            size_t len = transfer_len(ops[i]);
+            if (len > runLen) { runLen = len; }
+        }
+        KineticSession * const lane = select_lane(session, runLen);
+        if (lane != session) {
+            for (size_t i = 0; i < built; i++) { move_to_lane(ops[i], lane); }
+        }
+
+        if (built > 0) {
+            KineticOperation_SendRequests(ops, sendStatuses, built);
+            for (size_t i = 0; i < built; i++) {
+                if (sendStatuses[i] != KINETIC_STATUS_SUCCESS) {
+                    KineticAllocator_FreeOperation(ops[i]);
+                    complete_batch_slot(slots[i], sendStatuses[i]);
+                }
+                else {
+                    sent++;
+                }
+            }
+        }
+    }
+
+    if (closure != NULL) {
+        if (sent > 0) {
+            pthread_mutex_lock(&batch->mutex);
+            end_batch_entry(batch);
+            return KINETIC_STATUS_SUCCESS;
+        }
+
+        // Nothing is in flight, so as for a single operation, report the
+        // failure here rather than through the closure
+        KineticStatus status = batch->status;
+        free_batch(batch);
+        return status;
+    }
+
+    pthread_mutex_lock(&batch->mutex);
+    batch->remaining--;                 // Nothing else is left to send
+    while (batch->remaining > 0) {
+        pthread_cond_wait(&batch->complete, &batch->mutex);
+    }
+    KineticStatus status = batch->status;
+    pthread_mutex_unlock(&batch->mutex);
+    free_batch(batch);
+
+    if (status != KINETIC_STATUS_SUCCESS) {
+        if (KineticSession_GetTerminationStatus(session) != KINETIC_STATUS_SUCCESS) {
+            (void)KineticSession_Disconnect(session);
+            if (status == KINETIC_STATUS_SOCKET_ERROR) {
+                status = KINETIC_STATUS_SESSION_TERMINATED;
+            }
+        }
+    }
+
+    return status;
+}
+
 KineticStatus bus_to_kinetic_status(bus_send_status_t const status)
 {
     KineticStatus res = KINETIC_STATUS_INVALID;
@@ -196,7 +525,8 @@ void KineticController_HandleUnexpectedResponse(void *msg,
     (void)bus_udata;
 
     // Handle unsolicited status PDUs
-    if (response->proto->authtype == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS) {
+    if (response->summary.hasAuthType &&
+        response->summary.authType == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS) {
         int64_t connectionID = KineticResponse_GetConnectionID(response);
         if (connectionID != 0)
         {
@@ -232,7 +562,9 @@ void KineticController_HandleUnexpectedResponse(void *msg,
         session->socket, (long long)seq_id,
         KineticResponse_GetProtobufLength(response),
         KineticResponse_GetValueLength(response));
-    KineticLogger_LogProtobuf(protoLogAtLevel, response->proto);
+    if (KineticLogger_IsLevelEnabled(protoLogAtLevel)) {
+        KineticLogger_LogProtobuf(protoLogAtLevel, KineticResponse_GetMessage(response));
+    }
 
     KineticAllocator_FreeKineticResponse(response);
 
@@ -258,13 +590,15 @@ void KineticController_HandleResult(bus_msg_result_t *res, void *udata)
             "fd: %6d, seq: %8lld, protoLen: %8u, valueLen: %8u, op: %p, status: %s",
             (void*)response,
             (void*)op->session, (void*)op->session->messageBus,
-            op->session->socket, response->command->header->acksequence,
+            op->session->socket, (long long)response->summary.ackSequence,
             KineticResponse_GetProtobufLength(response),
             KineticResponse_GetValueLength(response),
             (void*)op,
             Kinetic_GetStatusDescription(status));
         KineticLogger_LogHeader(3, &response->header);
-        KineticLogger_LogProtobuf(3, response->proto);
+        if (KineticLogger_IsLevelEnabled(3)) {
+            KineticLogger_LogProtobuf(3, KineticResponse_GetMessage(response));
+        }
 
         if (op->response == NULL) {
             op->response = response;
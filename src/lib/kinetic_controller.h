@@ -27,6 +27,20 @@
 KineticStatus KineticController_Init(KineticSession * const session);
 KineticStatus KineticController_ExecuteOperation(KineticOperation* operation, KineticCompletionClosure* closure);
 
+/* Builds one entry's request into a new operation. */
+typedef KineticStatus (*KineticBatchBuilder)(KineticOperation* const op, KineticEntry* const entry);
+
+/* Build and send one request per entry, completing once for the batch.
+ * STATUSES (if non-NULL) receives each entry's status; the batch status is
+ * the failure of the lowest-indexed entry that failed, if any. If CLOSURE
+ * is given but no entry could be sent, that status is returned and CLOSURE
+ * is not called. */
+KineticStatus KineticController_ExecuteBatch(KineticSession* const session,
+                                             KineticEntry* const entries, size_t count,
+                                             KineticBatchBuilder build,
+                                             KineticStatus statuses[],
+                                             KineticCompletionClosure* const closure);
+
 void KineticController_HandleUnexpectedResponse(void *msg,
                                                 int64_t seq_id,
                                                 void *bus_udata,
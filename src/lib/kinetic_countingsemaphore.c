@@ -31,6 +31,7 @@ KineticCountingSemaphore * KineticCountingSemaphore_Create(uint32_t counts)
     pthread_cond_init(&sem->available, NULL);
     sem->count = counts;
     sem->max = counts;
+    sem->limit = counts;
     sem->num_waiting = 0;
     return sem;
 }
@@ -42,7 +43,8 @@ void KineticCountingSemaphore_Take(KineticCountingSemaphore * const sem) // WAIT
 
     sem->num_waiting++;
 
-    while (sem->count == 0) {
+    // Wait for both a free count and room under the current limit
+    while (sem->max - sem->count >= sem->limit) {
         pthread_cond_wait(&sem->available, &sem->mutex);
     }
 
@@ -57,16 +59,45 @@ void KineticCountingSemaphore_Take(KineticCountingSemaphore * const sem) // WAIT
     LOGF3("Concurrent ops throttle -- TAKE: %u => %u (waiting=%u)", before, after, waiting);
 }
 
+/* Wait for at least one count, as Take does, then take as many more as
+ * are free under the limit, up to WANTED, without waiting again. Returns
+ * the number of counts taken. Never holding some counts while waiting for
+ * others means concurrent takers cannot starve each other. */
+uint32_t KineticCountingSemaphore_TakeUpTo(KineticCountingSemaphore * const sem, uint32_t wanted) // WAIT
+{
+    KINETIC_ASSERT(sem != NULL);
+    KINETIC_ASSERT(wanted > 0);
+    pthread_mutex_lock(&sem->mutex);
+
+    sem->num_waiting++;
+    while (sem->max - sem->count >= sem->limit) {
+        pthread_cond_wait(&sem->available, &sem->mutex);
+    }
+    sem->num_waiting--;
+
+    uint32_t const room = sem->limit - (sem->max - sem->count);
+    uint32_t const taken = (wanted < room) ? wanted : room;
+    uint32_t before = sem->count;
+    sem->count -= taken;
+    uint32_t after = sem->count;
+    uint32_t waiting = sem->num_waiting;
+
+    pthread_mutex_unlock(&sem->mutex);
+
+    LOGF3("Concurrent ops throttle -- TAKE %u: %u => %u (waiting=%u)", taken, before, after, waiting);
+    return taken;
+}
+
 void KineticCountingSemaphore_Give(KineticCountingSemaphore * const sem) // SIGNAL
 {
     KINETIC_ASSERT(sem != NULL);
     pthread_mutex_lock(&sem->mutex);
     
-    if (sem->count == 0 && sem->num_waiting > 0) {
+    uint32_t before = sem->count++;
+    if (sem->num_waiting > 0 && sem->max - sem->count < sem->limit) {
         pthread_cond_signal(&sem->available);
     }
 
-    uint32_t before = sem->count++;
     uint32_t after = sem->count;
     uint32_t waiting = sem->num_waiting;
     
@@ -76,6 +107,29 @@ void KineticCountingSemaphore_Give(KineticCountingSemaphore * const sem) // SIGN
     KINETIC_ASSERT(sem->max >= after);
 }
 
+void KineticCountingSemaphore_SetLimit(KineticCountingSemaphore * const sem, uint32_t limit)
+{
+    KINETIC_ASSERT(sem != NULL);
+    if (limit < 1) { limit = 1; }
+    if (limit > sem->max) { limit = sem->max; }
+
+    pthread_mutex_lock(&sem->mutex);
+
+    // Lowering the limit never revokes counts already taken; takers
+    // simply block until enough have been given back.
+    uint32_t before = sem->limit;
+    sem->limit = limit;
+    if (limit > before && sem->num_waiting > 0) {
+        pthread_cond_broadcast(&sem->available);
+    }
+
+    pthread_mutex_unlock(&sem->mutex);
+
+    if (limit != before) {
+        LOGF3("Concurrent ops throttle -- LIMIT: %u => %u", before, limit);
+    }
+}
+
 void KineticCountingSemaphore_Destroy(KineticCountingSemaphore * const sem)
 {
     KINETIC_ASSERT(sem != NULL);
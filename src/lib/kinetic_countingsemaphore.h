@@ -26,7 +26,9 @@ typedef struct _KineticCountingSemaphore KineticCountingSemaphore;
 
 KineticCountingSemaphore * KineticCountingSemaphore_Create(uint32_t max);
 void KineticCountingSemaphore_Take(KineticCountingSemaphore * const sem);
+uint32_t KineticCountingSemaphore_TakeUpTo(KineticCountingSemaphore * const sem, uint32_t wanted);
 void KineticCountingSemaphore_Give(KineticCountingSemaphore * const sem);
+void KineticCountingSemaphore_SetLimit(KineticCountingSemaphore * const sem, uint32_t limit);
 void KineticCountingSemaphore_Destroy(KineticCountingSemaphore * const sem);
 
 #endif // _KINETIC_COUNTINGSEMAPHORE_H
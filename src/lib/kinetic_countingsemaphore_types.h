@@ -28,6 +28,7 @@ struct _KineticCountingSemaphore {
     pthread_cond_t available;
     uint32_t count;
     uint32_t max;
+    uint32_t limit;
     uint32_t num_waiting;
 };
 
@@ -0,0 +1,413 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include "kinetic_encoder.h"
+#include "kinetic_types_internal.h"
+#include <string.h>
+
+/* Protobuf wire types, and the one-byte tag for fields numbered below 16. */
+#define WIRETYPE_VARINT (0)
+#define WIRETYPE_LENGTH_PREFIXED (2)
+#define TAG(FIELD, WIRETYPE) ((uint8_t)(((FIELD) << 3) | (WIRETYPE)))
+
+/* Field numbers, from kinetic.proto. */
+enum {
+    HEADER_CLUSTER_VERSION = 1,
+    HEADER_CONNECTION_ID = 3,
+    HEADER_SEQUENCE = 4,
+    HEADER_ACK_SEQUENCE = 6,
+    HEADER_MESSAGE_TYPE = 7,
+    HEADER_TIMEOUT = 9,
+    HEADER_EARLY_EXIT = 10,
+    HEADER_PRIORITY = 12,
+    HEADER_TIME_QUANTA = 13,
+
+    KEY_VALUE_NEW_VERSION = 2,
+    KEY_VALUE_KEY = 3,
+    KEY_VALUE_DB_VERSION = 4,
+    KEY_VALUE_TAG = 5,
+    KEY_VALUE_ALGORITHM = 6,
+    KEY_VALUE_METADATA_ONLY = 7,
+    KEY_VALUE_FORCE = 8,
+    KEY_VALUE_SYNCHRONIZATION = 9,
+
+    BODY_KEY_VALUE = 1,
+
+    COMMAND_HEADER = 1,
+    COMMAND_BODY = 2,
+
+    HMAC_AUTH_IDENTITY = 1,
+    HMAC_AUTH_HMAC = 2,
+
+    PIN_AUTH_PIN = 1,
+
+    MESSAGE_AUTH_TYPE = 4,
+    MESSAGE_HMAC_AUTH = 5,
+    MESSAGE_PIN_AUTH = 6,
+    MESSAGE_COMMAND_BYTES = 7,
+};
+
+static size_t varint_size(uint64_t v)
+{
+    size_t size = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/* Negative enum values are sign-extended to 64 bits, as for int32. */
+static uint64_t enum_bits(int32_t v)
+{
+    return (v < 0) ? (uint64_t)(int64_t)v : (uint64_t)(uint32_t)v;
+}
+
+static size_t int64_field_size(bool has, int64_t v)
+{
+    return has ? 1 + varint_size((uint64_t)v) : 0;
+}
+
+static size_t enum_field_size(bool has, int32_t v)
+{
+    return has ? 1 + varint_size(enum_bits(v)) : 0;
+}
+
+static size_t bool_field_size(bool has)
+{
+    return has ? 2 : 0;
+}
+
+static size_t bytes_field_size(bool has, size_t len)
+{
+    return has ? 1 + varint_size(len) + len : 0;
+}
+
+static size_t submessage_field_size(size_t len)
+{
+    return 1 + varint_size(len) + len;
+}
+
+static uint8_t* put_varint(uint8_t* out, uint64_t v)
+{
+    while (v >= 0x80) {
+        *out++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = (uint8_t)v;
+    return out;
+}
+
+static uint8_t* put_int64(uint8_t* out, bool has, int field, int64_t v)
+{
+    if (!has) { return out; }
+    *out++ = TAG(field, WIRETYPE_VARINT);
+    return put_varint(out, (uint64_t)v);
+}
+
+static uint8_t* put_enum(uint8_t* out, bool has, int field, int32_t v)
+{
+    if (!has) { return out; }
+    *out++ = TAG(field, WIRETYPE_VARINT);
+    return put_varint(out, enum_bits(v));
+}
+
+static uint8_t* put_bool(uint8_t* out, bool has, int field, bool v)
+{
+    if (!has) { return out; }
+    *out++ = TAG(field, WIRETYPE_VARINT);
+    *out++ = v ? 1 : 0;
+    return out;
+}
+
+static uint8_t* put_bytes(uint8_t* out, bool has, int field,
+    const ProtobufCBinaryData* bytes)
+{
+    if (!has) { return out; }
+    *out++ = TAG(field, WIRETYPE_LENGTH_PREFIXED);
+    out = put_varint(out, bytes->len);
+    if (bytes->len > 0) { memcpy(out, bytes->data, bytes->len); }
+    return out + bytes->len;
+}
+
+static uint8_t* put_submessage_prefix(uint8_t* out, int field, size_t len)
+{
+    *out++ = TAG(field, WIRETYPE_LENGTH_PREFIXED);
+    return put_varint(out, len);
+}
+
+static bool header_matches(const Com__Seagate__Kinetic__Proto__Command__Header* h,
+    const KineticEncoderTemplate* tmpl)
+{
+    return tmpl != NULL && tmpl->ready
+        && h->has_clusterversion && h->clusterversion == tmpl->clusterVersion
+        && h->has_connectionid && h->connectionid == tmpl->connectionID;
+}
+
+/* Size of the fields after connectionID, which are set per request. */
+static size_t header_tail_size(const Com__Seagate__Kinetic__Proto__Command__Header* h)
+{
+    return int64_field_size(h->has_sequence, h->sequence)
+        + int64_field_size(h->has_acksequence, h->acksequence)
+        + enum_field_size(h->has_messagetype, h->messagetype)
+        + int64_field_size(h->has_timeout, h->timeout)
+        + bool_field_size(h->has_earlyexit)
+        + enum_field_size(h->has_priority, h->priority)
+        + int64_field_size(h->has_timequanta, h->timequanta);
+}
+
+static size_t header_size(const Com__Seagate__Kinetic__Proto__Command__Header* h,
+    const KineticEncoderTemplate* tmpl)
+{
+    if (header_matches(h, tmpl)) {
+        return tmpl->headerLen + header_tail_size(h);
+    }
+    return int64_field_size(h->has_clusterversion, h->clusterversion)
+        + int64_field_size(h->has_connectionid, h->connectionid)
+        + header_tail_size(h);
+}
+
+static uint8_t* put_header(uint8_t* out,
+    const Com__Seagate__Kinetic__Proto__Command__Header* h,
+    const KineticEncoderTemplate* tmpl)
+{
+    if (header_matches(h, tmpl)) {
+        memcpy(out, tmpl->header, tmpl->headerLen);
+        out += tmpl->headerLen;
+    } else {
+        out = put_int64(out, h->has_clusterversion, HEADER_CLUSTER_VERSION, h->clusterversion);
+        out = put_int64(out, h->has_connectionid, HEADER_CONNECTION_ID, h->connectionid);
+    }
+    out = put_int64(out, h->has_sequence, HEADER_SEQUENCE, h->sequence);
+    out = put_int64(out, h->has_acksequence, HEADER_ACK_SEQUENCE, h->acksequence);
+    out = put_enum(out, h->has_messagetype, HEADER_MESSAGE_TYPE, h->messagetype);
+    out = put_int64(out, h->has_timeout, HEADER_TIMEOUT, h->timeout);
+    out = put_bool(out, h->has_earlyexit, HEADER_EARLY_EXIT, h->earlyexit);
+    out = put_enum(out, h->has_priority, HEADER_PRIORITY, h->priority);
+    out = put_int64(out, h->has_timequanta, HEADER_TIME_QUANTA, h->timequanta);
+    return out;
+}
+
+static size_t key_value_size(const Com__Seagate__Kinetic__Proto__Command__KeyValue* kv)
+{
+    return bytes_field_size(kv->has_newversion, kv->newversion.len)
+        + bytes_field_size(kv->has_key, kv->key.len)
+        + bytes_field_size(kv->has_dbversion, kv->dbversion.len)
+        + bytes_field_size(kv->has_tag, kv->tag.len)
+        + enum_field_size(kv->has_algorithm, kv->algorithm)
+        + bool_field_size(kv->has_metadataonly)
+        + bool_field_size(kv->has_force)
+        + enum_field_size(kv->has_synchronization, kv->synchronization);
+}
+
+static uint8_t* put_key_value(uint8_t* out,
+    const Com__Seagate__Kinetic__Proto__Command__KeyValue* kv)
+{
+    out = put_bytes(out, kv->has_newversion, KEY_VALUE_NEW_VERSION, &kv->newversion);
+    out = put_bytes(out, kv->has_key, KEY_VALUE_KEY, &kv->key);
+    out = put_bytes(out, kv->has_dbversion, KEY_VALUE_DB_VERSION, &kv->dbversion);
+    out = put_bytes(out, kv->has_tag, KEY_VALUE_TAG, &kv->tag);
+    out = put_enum(out, kv->has_algorithm, KEY_VALUE_ALGORITHM, kv->algorithm);
+    out = put_bool(out, kv->has_metadataonly, KEY_VALUE_METADATA_ONLY, kv->metadataonly);
+    out = put_bool(out, kv->has_force, KEY_VALUE_FORCE, kv->force);
+    out = put_enum(out, kv->has_synchronization, KEY_VALUE_SYNCHRONIZATION, kv->synchronization);
+    return out;
+}
+
+/* Sizes of the nested messages, so they are only walked once per pack. */
+typedef struct {
+    size_t header;
+    size_t keyValue;
+    size_t body;
+    size_t total;
+} CommandLayout;
+
+static void layout_command(const Com__Seagate__Kinetic__Proto__Command* cmd,
+    const KineticEncoderTemplate* tmpl, CommandLayout* layout)
+{
+    *layout = (CommandLayout){.total = 0};
+    if (cmd->header != NULL) {
+        layout->header = header_size(cmd->header, tmpl);
+        layout->total += submessage_field_size(layout->header);
+    }
+    if (cmd->body != NULL) {
+        if (cmd->body->keyvalue != NULL) {
+            layout->keyValue = key_value_size(cmd->body->keyvalue);
+            layout->body = submessage_field_size(layout->keyValue);
+        }
+        layout->total += submessage_field_size(layout->body);
+    }
+}
+
+bool KineticEncoder_CanPackCommand(const Com__Seagate__Kinetic__Proto__Command* cmd)
+{
+    if (cmd == NULL || cmd->base.n_unknown_fields > 0 || cmd->status != NULL) {
+        return false;
+    }
+    if (cmd->header != NULL && cmd->header->base.n_unknown_fields > 0) {
+        return false;
+    }
+
+    const Com__Seagate__Kinetic__Proto__Command__Body* body = cmd->body;
+    if (body == NULL) { return true; }
+    if (body->base.n_unknown_fields > 0
+        || body->range != NULL
+        || body->setup != NULL
+        || body->p2poperation != NULL
+        || body->getlog != NULL
+        || body->security != NULL
+        || body->pinop != NULL) {
+        return false;
+    }
+    return body->keyvalue == NULL || body->keyvalue->base.n_unknown_fields == 0;
+}
+
+size_t KineticEncoder_CommandSize(const Com__Seagate__Kinetic__Proto__Command* cmd,
+    const KineticEncoderTemplate* tmpl)
+{
+    CommandLayout layout;
+    layout_command(cmd, tmpl, &layout);
+    return layout.total;
+}
+
+size_t KineticEncoder_PackCommand(const Com__Seagate__Kinetic__Proto__Command* cmd,
+    const KineticEncoderTemplate* tmpl, uint8_t* out)
+{
+    CommandLayout layout;
+    layout_command(cmd, tmpl, &layout);
+
+    uint8_t* p = out;
+    if (cmd->header != NULL) {
+        p = put_submessage_prefix(p, COMMAND_HEADER, layout.header);
+        p = put_header(p, cmd->header, tmpl);
+    }
+    if (cmd->body != NULL) {
+        p = put_submessage_prefix(p, COMMAND_BODY, layout.body);
+        if (cmd->body->keyvalue != NULL) {
+            p = put_submessage_prefix(p, BODY_KEY_VALUE, layout.keyValue);
+            p = put_key_value(p, cmd->body->keyvalue);
+        }
+    }
+    return (size_t)(p - out);
+}
+
+static size_t hmac_auth_size(const Com__Seagate__Kinetic__Proto__Message__HMACauth* auth)
+{
+    return int64_field_size(auth->has_identity, auth->identity)
+        + bytes_field_size(auth->has_hmac, auth->hmac.len);
+}
+
+static size_t pin_auth_size(const Com__Seagate__Kinetic__Proto__Message__PINauth* auth)
+{
+    return bytes_field_size(auth->has_pin, auth->pin.len);
+}
+
+bool KineticEncoder_CanPackMessage(const Com__Seagate__Kinetic__Proto__Message* msg)
+{
+    if (msg == NULL || msg->base.n_unknown_fields > 0) { return false; }
+    if (msg->hmacauth != NULL && msg->hmacauth->base.n_unknown_fields > 0) { return false; }
+    if (msg->pinauth != NULL && msg->pinauth->base.n_unknown_fields > 0) { return false; }
+    return true;
+}
+
+/* The template covers authType, the hmacAuth prefix, identity, and the
+ * tag and length of a SHA1 HMAC; the HMAC itself is copied in after. */
+static bool auth_matches(const Com__Seagate__Kinetic__Proto__Message* msg,
+    const KineticEncoderTemplate* tmpl)
+{
+    return tmpl != NULL && tmpl->ready
+        && msg->has_authtype
+        && msg->authtype == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH
+        && msg->hmacauth != NULL && msg->pinauth == NULL
+        && msg->hmacauth->has_identity && msg->hmacauth->identity == tmpl->identity
+        && msg->hmacauth->has_hmac && msg->hmacauth->hmac.len == KINETIC_HMAC_SHA1_LEN;
+}
+
+size_t KineticEncoder_MessageSize(const Com__Seagate__Kinetic__Proto__Message* msg,
+    const KineticEncoderTemplate* tmpl)
+{
+    size_t size;
+    if (auth_matches(msg, tmpl)) {
+        size = tmpl->authLen + KINETIC_HMAC_SHA1_LEN;
+    } else {
+        size = enum_field_size(msg->has_authtype, msg->authtype);
+        if (msg->hmacauth != NULL) {
+            size += submessage_field_size(hmac_auth_size(msg->hmacauth));
+        }
+        if (msg->pinauth != NULL) {
+            size += submessage_field_size(pin_auth_size(msg->pinauth));
+        }
+    }
+    return size + bytes_field_size(msg->has_commandbytes, msg->commandbytes.len);
+}
+
+size_t KineticEncoder_PackMessage(const Com__Seagate__Kinetic__Proto__Message* msg,
+    const KineticEncoderTemplate* tmpl, uint8_t* out)
+{
+    uint8_t* p = out;
+    if (auth_matches(msg, tmpl)) {
+        memcpy(p, tmpl->auth, tmpl->authLen);
+        p += tmpl->authLen;
+        memcpy(p, msg->hmacauth->hmac.data, KINETIC_HMAC_SHA1_LEN);
+        p += KINETIC_HMAC_SHA1_LEN;
+    } else {
+        p = put_enum(p, msg->has_authtype, MESSAGE_AUTH_TYPE, msg->authtype);
+        if (msg->hmacauth != NULL) {
+            const Com__Seagate__Kinetic__Proto__Message__HMACauth* auth = msg->hmacauth;
+            p = put_submessage_prefix(p, MESSAGE_HMAC_AUTH, hmac_auth_size(auth));
+            p = put_int64(p, auth->has_identity, HMAC_AUTH_IDENTITY, auth->identity);
+            p = put_bytes(p, auth->has_hmac, HMAC_AUTH_HMAC, &auth->hmac);
+        }
+        if (msg->pinauth != NULL) {
+            const Com__Seagate__Kinetic__Proto__Message__PINauth* auth = msg->pinauth;
+            p = put_submessage_prefix(p, MESSAGE_PIN_AUTH, pin_auth_size(auth));
+            p = put_bytes(p, auth->has_pin, PIN_AUTH_PIN, &auth->pin);
+        }
+    }
+    p = put_bytes(p, msg->has_commandbytes, MESSAGE_COMMAND_BYTES, &msg->commandbytes);
+    return (size_t)(p - out);
+}
+
+void KineticEncoder_InitTemplate(KineticEncoderTemplate* tmpl,
+    int64_t clusterVersion, int64_t connectionID, int64_t identity)
+{
+    *tmpl = (KineticEncoderTemplate){
+        .clusterVersion = clusterVersion,
+        .connectionID = connectionID,
+        .identity = identity,
+    };
+
+    uint8_t* p = tmpl->header;
+    p = put_int64(p, true, HEADER_CLUSTER_VERSION, clusterVersion);
+    p = put_int64(p, true, HEADER_CONNECTION_ID, connectionID);
+    tmpl->headerLen = (size_t)(p - tmpl->header);
+
+    size_t hmacAuthLen = int64_field_size(true, identity)
+        + bytes_field_size(true, KINETIC_HMAC_SHA1_LEN);
+    p = tmpl->auth;
+    p = put_enum(p, true, MESSAGE_AUTH_TYPE,
+        COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH);
+    p = put_submessage_prefix(p, MESSAGE_HMAC_AUTH, hmacAuthLen);
+    p = put_int64(p, true, HMAC_AUTH_IDENTITY, identity);
+    *p++ = TAG(HMAC_AUTH_HMAC, WIRETYPE_LENGTH_PREFIXED);
+    p = put_varint(p, KINETIC_HMAC_SHA1_LEN);
+    tmpl->authLen = (size_t)(p - tmpl->auth);
+
+    tmpl->ready = true;
+}
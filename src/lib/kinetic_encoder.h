@@ -0,0 +1,75 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_ENCODER_H
+#define _KINETIC_ENCODER_H
+
+#include "kinetic.pb-c.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Direct encoder for the requests that dominate our traffic.
+ *
+ * protobuf-c walks the field descriptors twice per message (once for
+ * the packed size, once to pack). Key/value commands only ever set a
+ * header and a keyValue body, and the outer message only holds the
+ * auth info and the command bytes, so these are written straight from
+ * the struct fields instead. The output is byte-for-byte what protobuf-c
+ * would produce. */
+
+/* Fields that are the same for every request on a session, encoded
+ * once. A request whose header (or HMAC identity) matches the values a
+ * template was built for gets those bytes copied in, leaving only the
+ * sequence, message type and any per-request fields to encode. */
+#define KINETIC_ENCODER_HEADER_TEMPLATE_LEN (2 * 11)
+#define KINETIC_ENCODER_AUTH_TEMPLATE_LEN (4 + 11 + 2)
+
+typedef struct _KineticEncoderTemplate {
+    bool ready;
+    int64_t clusterVersion;
+    int64_t connectionID;
+    int64_t identity;
+    size_t headerLen;
+    uint8_t header[KINETIC_ENCODER_HEADER_TEMPLATE_LEN];
+    size_t authLen;
+    uint8_t auth[KINETIC_ENCODER_AUTH_TEMPLATE_LEN];
+} KineticEncoderTemplate;
+
+void KineticEncoder_InitTemplate(KineticEncoderTemplate* tmpl,
+    int64_t clusterVersion, int64_t connectionID, int64_t identity);
+
+/* Returns true if the command only has fields the encoder knows about:
+ * a header, and a body with at most a keyValue.
+ * The template may be NULL, or not yet ready, in which case every field
+ * is encoded. */
+bool KineticEncoder_CanPackCommand(const Com__Seagate__Kinetic__Proto__Command* cmd);
+size_t KineticEncoder_CommandSize(const Com__Seagate__Kinetic__Proto__Command* cmd,
+    const KineticEncoderTemplate* tmpl);
+size_t KineticEncoder_PackCommand(const Com__Seagate__Kinetic__Proto__Command* cmd,
+    const KineticEncoderTemplate* tmpl, uint8_t* out);
+
+bool KineticEncoder_CanPackMessage(const Com__Seagate__Kinetic__Proto__Message* msg);
+size_t KineticEncoder_MessageSize(const Com__Seagate__Kinetic__Proto__Message* msg,
+    const KineticEncoderTemplate* tmpl);
+size_t KineticEncoder_PackMessage(const Com__Seagate__Kinetic__Proto__Message* msg,
+    const KineticEncoderTemplate* tmpl, uint8_t* out);
+
+#endif // _KINETIC_ENCODER_H
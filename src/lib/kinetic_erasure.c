@@ -0,0 +1,460 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_erasure.h"
+#include "kinetic_client.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_rs.h"
+#include "kinetic_tag.h"
+#include "kinetic_nbo.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define FRAGMENT_MAGIC "KEC"
+#define FRAGMENT_VERSION (2)
+
+// Room for a version an entry may have been given by other clients
+#define ERASURE_VERSION_LEN (KINETIC_DEFAULT_KEY_LEN)
+
+typedef KineticStatus (*FragmentOp)(KineticSession* const session,
+    KineticEntry* const entry, KineticCompletionClosure* closure);
+
+typedef struct _ErasureTransfer ErasureTransfer;
+
+typedef struct {
+    ErasureTransfer * transfer;
+    size_t index;
+    KineticEntry entry;
+    uint8_t key[KINETIC_MAX_KEY_LEN];
+    uint8_t tag[KINETIC_TAG_MAX_LEN];
+    uint8_t version[ERASURE_VERSION_LEN];
+    uint8_t * value;        // Header, then fragment data
+    bool done;
+    bool valid;             // GET: done, and holds a fragment of this entry
+    uint64_t length;        // GET, if valid: value length, from the header
+    uint64_t generation;    // GET, if valid: the PUT that stored it
+    KineticStatus status;
+} ErasureFragment;
+
+struct _ErasureTransfer {
+    pthread_mutex_t mutex;
+    pthread_cond_t progress;
+    size_t refs;            // Outstanding operations, plus one for the caller
+    size_t k;
+    size_t m;
+    size_t done;
+    bool get;
+    bool decodable;         // GET: K valid fragments share a generation
+    uint64_t length;        // GET, once decodable: that generation's
+    uint64_t generation;
+    ErasureFragment fragments[];
+};
+
+static size_t fragment_len(uint64_t length, size_t k)
+{
+    return (size_t)((length + k - 1) / k);
+}
+
+/* A generation no earlier PUT of the entry from any client is likely to
+ * have used: the time in nanoseconds, made distinct within this process. */
+static uint64_t new_generation(void)
+{
+    static uint64_t last = 0;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t generation = (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+
+    uint64_t prev = __atomic_load_n(&last, __ATOMIC_RELAXED);
+    do {
+        if (generation <= prev) { generation = prev + 1; }
+    } while (!__atomic_compare_exchange_n(&last, &prev, generation, false,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return generation;
+}
+
+static void encode_header(uint8_t * header, size_t k, size_t m, size_t index,
+                          uint64_t length, uint64_t generation)
+{
+    uint64_t lengthNBO = KineticNBO_FromHostU64(length);
+    uint64_t generationNBO = KineticNBO_FromHostU64(generation);
+    memcpy(header, FRAGMENT_MAGIC, 3);
+    header[3] = FRAGMENT_VERSION;
+    header[4] = (uint8_t)k;
+    header[5] = (uint8_t)m;
+    header[6] = (uint8_t)index;
+    header[7] = 0;
+    memcpy(&header[8], &lengthNBO, sizeof(lengthNBO));
+    memcpy(&header[16], &generationNBO, sizeof(generationNBO));
+}
+
+/* Whether a fragment read back belongs to TRANSFER's entry and is whole,
+ * noting the length and generation its header gives. */
+static bool check_fragment(ErasureTransfer const * transfer, ErasureFragment * fragment)
+{
+    uint8_t const * header = fragment->value;
+    if (fragment->entry.value.bytesUsed < KINETIC_ERASURE_HEADER_LEN ||
+        memcmp(header, FRAGMENT_MAGIC, 3) != 0 || header[3] != FRAGMENT_VERSION ||
+        header[4] != transfer->k || header[5] != transfer->m ||
+        header[6] != fragment->index) {
+        return false;
+    }
+
+    uint64_t lengthNBO, generationNBO;
+    memcpy(&lengthNBO, &header[8], sizeof(lengthNBO));
+    memcpy(&generationNBO, &header[16], sizeof(generationNBO));
+    fragment->length = KineticNBO_ToHostU64(lengthNBO);
+    fragment->generation = KineticNBO_ToHostU64(generationNBO);
+    return fragment->entry.value.bytesUsed ==
+        KINETIC_ERASURE_HEADER_LEN + fragment_len(fragment->length, transfer->k);
+}
+
+static bool same_write(ErasureFragment const * a, ErasureFragment const * b)
+{
+    return a->generation == b->generation && a->length == b->length;
+}
+
+/* Once K valid fragments come from one PUT, the value can be decoded from
+ * them. Fragments of other PUTs, left by a write that failed part way or
+ * raced this read, are not mixed in. Called with the mutex held. */
+static void note_valid_fragment(ErasureTransfer * transfer, ErasureFragment const * fragment)
+{
+    if (transfer->decodable) { return; }
+    size_t matching = 0;
+    for (size_t i = 0; i < transfer->k + transfer->m; i++) {
+        ErasureFragment const * other = &transfer->fragments[i];
+        if (other->valid && same_write(other, fragment)) { matching++; }
+    }
+    if (matching >= transfer->k) {
+        transfer->decodable = true;
+        transfer->length = fragment->length;
+        transfer->generation = fragment->generation;
+    }
+}
+
+static void release_transfer(ErasureTransfer * transfer)
+{
+    pthread_mutex_lock(&transfer->mutex);
+    bool last = (--transfer->refs == 0);
+    pthread_mutex_unlock(&transfer->mutex);
+    if (last) {
+        pthread_cond_destroy(&transfer->progress);
+        pthread_mutex_destroy(&transfer->mutex);
+        free(transfer);
+    }
+}
+
+static void finish_fragment(ErasureFragment * fragment, KineticStatus status)
+{
+    ErasureTransfer * transfer = fragment->transfer;
+    pthread_mutex_lock(&transfer->mutex);
+    fragment->status = status;
+    fragment->done = true;
+    transfer->done++;
+    if (transfer->get && status == KINETIC_STATUS_SUCCESS) {
+        if (check_fragment(transfer, fragment)) {
+            fragment->valid = true;
+            note_valid_fragment(transfer, fragment);
+        } else {
+            fragment->status = KINETIC_STATUS_DATA_ERROR;
+        }
+    }
+    pthread_cond_signal(&transfer->progress);
+    pthread_mutex_unlock(&transfer->mutex);
+    release_transfer(transfer);
+}
+
+static void fragment_done(KineticCompletionData* kinetic_data, void* client_data)
+{
+    finish_fragment(client_data, kinetic_data->status);
+}
+
+/* Allocate a transfer for ENTRY's fragments, each with a copy of the key
+ * and version and VALUELEN bytes of value. */
+static ErasureTransfer * new_transfer(size_t k, size_t m,
+                                      KineticEntry const * const entry,
+                                      size_t valueLen)
+{
+    size_t const count = k + m;
+    size_t header = sizeof(ErasureTransfer) + count * sizeof(ErasureFragment);
+    ErasureTransfer * transfer = calloc(1, header + count * valueLen);
+    if (transfer == NULL) { return NULL; }
+    pthread_mutex_init(&transfer->mutex, NULL);
+    pthread_cond_init(&transfer->progress, NULL);
+    transfer->k = k;
+    transfer->m = m;
+    transfer->refs = 1;
+
+    uint8_t * values = (uint8_t *)transfer + header;
+    for (size_t i = 0; i < count; i++) {
+        ErasureFragment * fragment = &transfer->fragments[i];
+        fragment->transfer = transfer;
+        fragment->index = i;
+        fragment->value = &values[i * valueLen];
+        memcpy(fragment->key, entry->key.array.data, entry->key.bytesUsed);
+        if (entry->dbVersion.bytesUsed > 0) {
+            memcpy(fragment->version, entry->dbVersion.array.data, entry->dbVersion.bytesUsed);
+        }
+        fragment->entry = (KineticEntry) {
+            .key = ByteBuffer_Create(fragment->key, sizeof(fragment->key), entry->key.bytesUsed),
+            .value = (valueLen > 0) ? ByteBuffer_Create(fragment->value, valueLen, 0) : BYTE_BUFFER_NONE,
+            .tag = ByteBuffer_Create(fragment->tag, sizeof(fragment->tag), 0),
+            .dbVersion = ByteBuffer_Create(fragment->version, sizeof(fragment->version),
+                entry->dbVersion.bytesUsed),
+            .algorithm = KINETIC_ALGORITHM_CRC32,
+            .computeTag = true,
+            .force = entry->force,
+            .synchronization = entry->synchronization,
+        };
+    }
+    return transfer;
+}
+
+/* Start OP on every fragment, each on its own drive, so they all proceed
+ * in parallel. A fragment that cannot be sent finishes at once. */
+static void start_fragments(ErasureTransfer * transfer,
+                            KineticSession * const sessions[],
+                            FragmentOp op)
+{
+    size_t const count = transfer->k + transfer->m;
+    pthread_mutex_lock(&transfer->mutex);
+    transfer->refs += count;
+    pthread_mutex_unlock(&transfer->mutex);
+
+    for (size_t i = 0; i < count; i++) {
+        ErasureFragment * fragment = &transfer->fragments[i];
+        KineticCompletionClosure closure = {
+            .callback = fragment_done,
+            .clientData = fragment,
+        };
+        KineticStatus status = op(sessions[i], &fragment->entry, &closure);
+        if (status != KINETIC_STATUS_SUCCESS) {
+            finish_fragment(fragment, status);
+        }
+    }
+}
+
+/* Wait until every fragment is done, and return the first failure,
+ * ignoring NOT_FOUND if IGNORENOTFOUND is set. */
+static KineticStatus wait_all(ErasureTransfer * transfer, bool ignoreNotFound)
+{
+    size_t const count = transfer->k + transfer->m;
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    size_t notFound = 0;
+
+    pthread_mutex_lock(&transfer->mutex);
+    while (transfer->done < count) {
+        pthread_cond_wait(&transfer->progress, &transfer->mutex);
+    }
+    pthread_mutex_unlock(&transfer->mutex);
+
+    for (size_t i = 0; i < count; i++) {
+        KineticStatus fragmentStatus = transfer->fragments[i].status;
+        if (ignoreNotFound && fragmentStatus == KINETIC_STATUS_NOT_FOUND) {
+            notFound++;
+            continue;
+        }
+        if (fragmentStatus != KINETIC_STATUS_SUCCESS && status == KINETIC_STATUS_SUCCESS) {
+            status = fragmentStatus;
+        }
+    }
+    if (notFound == count) { status = KINETIC_STATUS_NOT_FOUND; }
+    return status;
+}
+
+static bool valid_request(KineticSession * const sessions[], size_t k, size_t m,
+                          KineticEntry const * const entry)
+{
+    return sessions != NULL && k > 0 && m > 0 && k + m <= KINETIC_ERASURE_MAX_FRAGMENTS &&
+        entry->key.bytesUsed <= KINETIC_MAX_KEY_LEN &&
+        entry->dbVersion.bytesUsed <= ERASURE_VERSION_LEN &&
+        entry->newVersion.bytesUsed <= ERASURE_VERSION_LEN;
+}
+
+KineticStatus KineticErasure_Put(KineticSession * const sessions[],
+                                 size_t dataFragments,
+                                 size_t parityFragments,
+                                 KineticEntry * const entry)
+{
+    KINETIC_ASSERT(entry);
+    size_t const k = dataFragments;
+    size_t const m = parityFragments;
+    if (!valid_request(sessions, k, m, entry)) { return KINETIC_STATUS_INVALID_REQUEST; }
+
+    size_t const length = entry->value.bytesUsed;
+    size_t const fragmentLen = fragment_len(length, k);
+    size_t const valueLen = KINETIC_ERASURE_HEADER_LEN + fragmentLen;
+    if (valueLen > KINETIC_OBJ_SIZE) { return KINETIC_STATUS_BUFFER_OVERRUN; }
+
+    KineticRS * rs = KineticRS_Create(k, m);
+    if (rs == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    ErasureTransfer * transfer = new_transfer(k, m, entry, valueLen);
+    if (transfer == NULL) {
+        KineticRS_Destroy(rs);
+        return KINETIC_STATUS_MEMORY_ERROR;
+    }
+
+    // Split the value, zero-padding the last data fragment, and code it
+    uint64_t const generation = new_generation();
+    uint8_t const * data[KINETIC_ERASURE_MAX_FRAGMENTS];
+    uint8_t * parity[KINETIC_ERASURE_MAX_FRAGMENTS];
+    for (size_t i = 0; i < k + m; i++) {
+        ErasureFragment * fragment = &transfer->fragments[i];
+        uint8_t * fragmentData = &fragment->value[KINETIC_ERASURE_HEADER_LEN];
+        encode_header(fragment->value, k, m, i, length, generation);
+        fragment->entry.value.bytesUsed = valueLen;
+        fragment->entry.newVersion = entry->newVersion;
+        if (i < k) {
+            size_t offset = i * fragmentLen;
+            if (offset < length) {
+                size_t n = (length - offset < fragmentLen) ? length - offset : fragmentLen;
+                memcpy(fragmentData, &entry->value.array.data[offset], n);
+            }
+            data[i] = fragmentData;
+        } else {
+            parity[i - k] = fragmentData;
+        }
+    }
+    KineticRS_Encode(rs, data, parity, fragmentLen);
+    KineticRS_Destroy(rs);
+
+    start_fragments(transfer, sessions, KineticClient_Put);
+    KineticStatus status = wait_all(transfer, false);
+    release_transfer(transfer);
+    return status;
+}
+
+KineticStatus KineticErasure_Get(KineticSession * const sessions[],
+                                 size_t dataFragments,
+                                 size_t parityFragments,
+                                 KineticEntry * const entry)
+{
+    KINETIC_ASSERT(entry);
+    size_t const k = dataFragments;
+    size_t const m = parityFragments;
+    if (!valid_request(sessions, k, m, entry)) { return KINETIC_STATUS_INVALID_REQUEST; }
+
+    // A fragment of a value that fits the caller's buffer is no bigger
+    size_t valueLen = KINETIC_ERASURE_HEADER_LEN +
+        fragment_len(entry->value.array.len - entry->value.bytesUsed, k);
+    if (valueLen > KINETIC_OBJ_SIZE) { valueLen = KINETIC_OBJ_SIZE; }
+
+    KineticRS * rs = KineticRS_Create(k, m);
+    if (rs == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    ErasureTransfer * transfer = new_transfer(k, m, entry, valueLen);
+    if (transfer == NULL) {
+        KineticRS_Destroy(rs);
+        return KINETIC_STATUS_MEMORY_ERROR;
+    }
+    transfer->get = true;
+    start_fragments(transfer, sessions, KineticClient_Get);
+
+    // Decode from the first K valid fragments of one PUT; the rest finish
+    // unattended, and count as lost
+    bool present[KINETIC_ERASURE_MAX_FRAGMENTS] = {false};
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    pthread_mutex_lock(&transfer->mutex);
+    while (!transfer->decodable && transfer->done < k + m) {
+        pthread_cond_wait(&transfer->progress, &transfer->mutex);
+    }
+    bool const recoverable = transfer->decodable;
+    for (size_t i = 0; i < k + m; i++) {
+        ErasureFragment const * fragment = &transfer->fragments[i];
+        present[i] = recoverable && fragment->valid &&
+            fragment->generation == transfer->generation && fragment->length == transfer->length;
+        if (status == KINETIC_STATUS_SUCCESS && fragment->done &&
+            fragment->status != KINETIC_STATUS_SUCCESS) {
+            status = fragment->status;
+        }
+    }
+    uint64_t length = transfer->length;
+    pthread_mutex_unlock(&transfer->mutex);
+
+    if (recoverable) {
+        status = KINETIC_STATUS_SUCCESS;
+        if (length > (uint64_t)ByteBuffer_BytesRemaining(entry->value)) {
+            status = KINETIC_STATUS_BUFFER_OVERRUN;
+        }
+    } else if (status == KINETIC_STATUS_SUCCESS) {
+        // Every fragment was read, but no K of them are from one PUT
+        status = KINETIC_STATUS_DATA_ERROR;
+    }
+
+    uint8_t * scratch = NULL;
+    if (status == KINETIC_STATUS_SUCCESS) {
+        // Lost data fragments are rebuilt into scratch space, since their
+        // operations may still be writing to the fragments' own buffers
+        size_t const fragmentLen = fragment_len(length, k);
+        uint8_t * fragments[KINETIC_ERASURE_MAX_FRAGMENTS];
+        size_t lost = 0;
+        for (size_t i = 0; i < k; i++) {
+            if (!present[i]) { lost++; }
+        }
+        if (lost > 0) {
+            scratch = malloc(lost * fragmentLen + 1);
+            if (scratch == NULL) { status = KINETIC_STATUS_MEMORY_ERROR; }
+        }
+        lost = 0;
+        for (size_t i = 0; i < k + m && status == KINETIC_STATUS_SUCCESS; i++) {
+            if (present[i]) {
+                fragments[i] = &transfer->fragments[i].value[KINETIC_ERASURE_HEADER_LEN];
+            } else if (i < k) {
+                fragments[i] = &scratch[fragmentLen * lost++];
+            } else {
+                fragments[i] = NULL;
+            }
+        }
+        if (status == KINETIC_STATUS_SUCCESS &&
+            !KineticRS_Reconstruct(rs, fragments, present, fragmentLen)) {
+            status = KINETIC_STATUS_MEMORY_ERROR;
+        }
+        for (size_t i = 0; i < k && status == KINETIC_STATUS_SUCCESS; i++) {
+            size_t offset = i * fragmentLen;
+            if (offset >= length) { break; }
+            size_t n = (length - offset < fragmentLen) ? (size_t)length - offset : fragmentLen;
+            ByteBuffer_Append(&entry->value, fragments[i], n);
+        }
+    }
+
+    free(scratch);
+    KineticRS_Destroy(rs);
+    release_transfer(transfer);
+    return status;
+}
+
+KineticStatus KineticErasure_Delete(KineticSession * const sessions[],
+                                    size_t dataFragments,
+                                    size_t parityFragments,
+                                    KineticEntry * const entry)
+{
+    KINETIC_ASSERT(entry);
+    if (!valid_request(sessions, dataFragments, parityFragments, entry)) {
+        return KINETIC_STATUS_INVALID_REQUEST;
+    }
+
+    ErasureTransfer * transfer = new_transfer(dataFragments, parityFragments, entry, 0);
+    if (transfer == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    start_fragments(transfer, sessions, KineticClient_Delete);
+    KineticStatus status = wait_all(transfer, true);
+    release_transfer(transfer);
+    return status;
+}
@@ -0,0 +1,81 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#if defined(__linux__)
+#define _GNU_SOURCE /* for syscall() */
+#endif
+
+#include "kinetic_futex.h"
+#include <limits.h>
+
+#if defined(__linux__)
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+void KineticFutex_Wait(int * const word, int expected)
+{
+    (void)syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+void KineticFutex_WakeOne(int * const word)
+{
+    (void)syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+void KineticFutex_WakeAll(int * const word)
+{
+    (void)syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+#else
+
+#include <pthread.h>
+
+/* Waiters check the word while holding the mutex, and wakers take it after
+ * changing the word, so a change cannot slip in unnoticed between the two. */
+static pthread_mutex_t FutexMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t FutexChanged = PTHREAD_COND_INITIALIZER;
+
+void KineticFutex_Wait(int * const word, int expected)
+{
+    pthread_mutex_lock(&FutexMutex);
+    if (__atomic_load_n(word, __ATOMIC_ACQUIRE) == expected) {
+        pthread_cond_wait(&FutexChanged, &FutexMutex);
+    }
+    pthread_mutex_unlock(&FutexMutex);
+}
+
+void KineticFutex_WakeOne(int * const word)
+{
+    // Waiters on every word share the condition variable
+    KineticFutex_WakeAll(word);
+}
+
+void KineticFutex_WakeAll(int * const word)
+{
+    (void)word;
+    pthread_mutex_lock(&FutexMutex);
+    pthread_cond_broadcast(&FutexChanged);
+    pthread_mutex_unlock(&FutexMutex);
+}
+
+#endif
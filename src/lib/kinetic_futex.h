@@ -0,0 +1,32 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#ifndef _KINETIC_FUTEX_H
+#define _KINETIC_FUTEX_H
+
+/* Sleeping on a word of memory until another thread changes it: a Linux
+ * futex, or a shared mutex and condition variable elsewhere. Callers make
+ * the change before waking, and check the word again after waiting, since
+ * waits may also return early. */
+
+void KineticFutex_Wait(int * const word, int expected);
+void KineticFutex_WakeOne(int * const word);
+void KineticFutex_WakeAll(int * const word);
+
+#endif // _KINETIC_FUTEX_H
@@ -0,0 +1,239 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_future.h"
+#include "kinetic_futex.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+struct _KineticFuture {
+    KineticCompletionClosure closure;   // Completes this future
+    KineticFuturePool * pool;
+    KineticFuture * next;               // In the pool's free list
+    bool pooled;                        // Preallocated, rather than from the heap
+    int done;
+    KineticStatus status;
+};
+
+struct _KineticFuturePool {
+    pthread_mutex_t mutex;              // Guards freeList
+    KineticFuture * futures;
+    size_t count;
+    KineticFuture * freeList;
+
+    // Advanced by every completion. Waiters sleep on it until a future
+    // they are waiting for is done.
+    int epoch;
+    int waiters;
+    int completing;                     // Completions still touching the pool
+};
+
+static void future_done(KineticCompletionData* kinetic_data, void* client_data)
+{
+    KineticFuture * const future = client_data;
+    KineticFuturePool * const pool = future->pool;
+
+    // Once done, the future may be released and its pool destroyed, so
+    // hold the pool until the waiters have been woken
+    __atomic_add_fetch(&pool->completing, 1, __ATOMIC_SEQ_CST);
+    future->status = kinetic_data->status;
+    __atomic_store_n(&future->done, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool->epoch, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool->waiters, __ATOMIC_SEQ_CST) > 0) {
+        KineticFutex_WakeAll(&pool->epoch);
+    }
+    __atomic_sub_fetch(&pool->completing, 1, __ATOMIC_RELEASE);
+}
+
+static void reset_future(KineticFuture * const future, KineticFuturePool * const pool)
+{
+    future->closure = (KineticCompletionClosure) {
+        .callback = future_done,
+        .clientData = future,
+    };
+    future->pool = pool;
+    future->next = NULL;
+    future->done = 0;
+    future->status = KINETIC_STATUS_INVALID;
+}
+
+KineticFuturePool * KineticFuturePool_Create(size_t count)
+{
+    if (count == 0) { count = KINETIC_FUTURE_DEFAULT_POOL_SIZE; }
+
+    KineticFuturePool * pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) { return NULL; }
+    pool->futures = calloc(count, sizeof(pool->futures[0]));
+    if (pool->futures == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pool->count = count;
+    for (size_t i = count; i > 0; i--) {
+        KineticFuture * const future = &pool->futures[i - 1];
+        future->pooled = true;
+        future->next = pool->freeList;
+        pool->freeList = future;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    return pool;
+}
+
+void KineticFuturePool_Destroy(KineticFuturePool * const pool)
+{
+    if (pool == NULL) { return; }
+    while (__atomic_load_n(&pool->completing, __ATOMIC_ACQUIRE) > 0) {
+        sched_yield();
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->futures);
+    free(pool);
+}
+
+KineticFuture * KineticFuture_Create(KineticFuturePool * const pool)
+{
+    KINETIC_ASSERT(pool != NULL);
+
+    pthread_mutex_lock(&pool->mutex);
+    KineticFuture * future = pool->freeList;
+    if (future != NULL) {
+        pool->freeList = future->next;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (future == NULL) {
+        future = calloc(1, sizeof(*future));
+        if (future == NULL) { return NULL; }
+    }
+    reset_future(future, pool);
+    return future;
+}
+
+KineticCompletionClosure * KineticFuture_Closure(KineticFuture * const future)
+{
+    KINETIC_ASSERT(future != NULL);
+    return &future->closure;
+}
+
+bool KineticFuture_IsDone(KineticFuture const * const future)
+{
+    KINETIC_ASSERT(future != NULL);
+    return __atomic_load_n(&future->done, __ATOMIC_ACQUIRE) != 0;
+}
+
+typedef struct {
+    KineticFuture * const * futures;
+    size_t count;
+    size_t index;       // First done (any), or first not done (all)
+} FutureSet;
+
+static bool one_done(FutureSet * set)
+{
+    return KineticFuture_IsDone(set->futures[0]);
+}
+
+static bool any_done(FutureSet * set)
+{
+    for (set->index = 0; set->index < set->count; set->index++) {
+        if (KineticFuture_IsDone(set->futures[set->index])) { return true; }
+    }
+    return false;
+}
+
+static bool all_done(FutureSet * set)
+{
+    // Futures found done stay done, so only the rest are checked again
+    for (; set->index < set->count; set->index++) {
+        if (!KineticFuture_IsDone(set->futures[set->index])) { return false; }
+    }
+    return true;
+}
+
+/* Sleep on the pool's epoch until `ready` holds. Waiters are counted
+ * before the epoch is read, and completions advance the epoch before
+ * checking for waiters, so a completion either shows up in the check or
+ * changes the epoch out from under the sleep. */
+static void wait_until(bool (*ready)(FutureSet *), FutureSet * set)
+{
+    if (ready(set)) { return; }
+
+    KineticFuturePool * const pool = set->futures[0]->pool;
+    // Completions only wake waiters on their own pool's epoch
+    for (size_t i = 1; i < set->count; i++) {
+        KINETIC_ASSERT(set->futures[i]->pool == pool);
+    }
+    __atomic_add_fetch(&pool->waiters, 1, __ATOMIC_SEQ_CST);
+    for (;;) {
+        int epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+        if (ready(set)) { break; }
+        KineticFutex_Wait(&pool->epoch, epoch);
+    }
+    __atomic_sub_fetch(&pool->waiters, 1, __ATOMIC_RELAXED);
+}
+
+KineticStatus KineticFuture_Wait(KineticFuture * const future)
+{
+    KINETIC_ASSERT(future != NULL);
+    KineticFuture * const futures[] = {future};
+    FutureSet set = {.futures = futures, .count = 1};
+    wait_until(one_done, &set);
+    return future->status;
+}
+
+KineticStatus KineticFuture_WaitAll(KineticFuture * const futures[], size_t count)
+{
+    KINETIC_ASSERT(futures != NULL || count == 0);
+    if (count == 0) { return KINETIC_STATUS_SUCCESS; }
+
+    FutureSet set = {.futures = futures, .count = count};
+    wait_until(all_done, &set);
+    for (size_t i = 0; i < count; i++) {
+        if (futures[i]->status != KINETIC_STATUS_SUCCESS) { return futures[i]->status; }
+    }
+    return KINETIC_STATUS_SUCCESS;
+}
+
+size_t KineticFuture_WaitAny(KineticFuture * const futures[], size_t count,
+    KineticStatus * status)
+{
+    KINETIC_ASSERT(futures != NULL);
+    KINETIC_ASSERT(count > 0);
+
+    FutureSet set = {.futures = futures, .count = count};
+    wait_until(any_done, &set);
+    if (status != NULL) { *status = futures[set.index]->status; }
+    return set.index;
+}
+
+void KineticFuture_Release(KineticFuture * const future)
+{
+    if (future == NULL) { return; }
+    if (!future->pooled) {
+        free(future);
+        return;
+    }
+    KineticFuturePool * const pool = future->pool;
+    pthread_mutex_lock(&pool->mutex);
+    future->next = pool->freeList;
+    pool->freeList = future;
+    pthread_mutex_unlock(&pool->mutex);
+}
@@ -19,14 +19,20 @@
 */
 
 #include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
 #include "kinetic_nbo.h"
 #include "kinetic_logger.h"
 #include <string.h>
 #include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include <openssl/crypto.h>
 
 static void KineticHMAC_Compute(KineticHMAC* hmac,
                                 const Com__Seagate__Kinetic__Proto__Message* proto,
                                 const ByteArray key);
+static void KineticHMAC_ComputeWithKey(KineticHMAC* hmac,
+                                       const Com__Seagate__Kinetic__Proto__Message* msg,
+                                       KineticHMACKey const * const hmacKey);
 
 void KineticHMAC_Init(KineticHMAC* hmac,
                       Com__Seagate__Kinetic__Proto__Command__Security__ACL__HMACAlgorithm algorithm)
@@ -64,6 +70,75 @@ void KineticHMAC_Populate(KineticHMAC* hmac,
     msg->hmacauth->has_hmac = true;
 }
 
+void KineticHMAC_PopulateWithKey(KineticHMAC* hmac,
+                                 Com__Seagate__Kinetic__Proto__Message* msg,
+                                 KineticHMACKey const * const hmacKey)
+{
+    KINETIC_ASSERT(hmac != NULL);
+    KINETIC_ASSERT(msg != NULL);
+    KINETIC_ASSERT(hmacKey != NULL);
+    KINETIC_ASSERT(hmacKey->ready);
+    KINETIC_ASSERT(msg->hmacauth->hmac.data != NULL);
+
+    KineticHMAC_Init(hmac, COM__SEAGATE__KINETIC__PROTO__COMMAND__SECURITY__ACL__HMACALGORITHM__HmacSHA1);
+    KineticHMAC_ComputeWithKey(hmac, msg, hmacKey);
+
+    // Copy computed HMAC into message
+    memcpy(msg->hmacauth->hmac.data, hmac->data, hmac->len);
+    msg->hmacauth->hmac.len = hmac->len;
+    msg->hmacauth->has_hmac = true;
+}
+
+void KineticHMAC_PopulateBatch(KineticHMAC* const hmacs[],
+                               Com__Seagate__Kinetic__Proto__Message* const msgs[],
+                               size_t count,
+                               KineticHMACKey const * const hmacKey)
+{
+    KINETIC_ASSERT(hmacs != NULL);
+    KINETIC_ASSERT(msgs != NULL);
+    KINETIC_ASSERT(hmacKey != NULL);
+    KINETIC_ASSERT(hmacKey->ready);
+
+    size_t const lanes = KineticHMACMB_Lanes();
+    size_t n = 0;
+    for (size_t i = 0; i < count; i += n) {
+        n = count - i;
+        if (n > lanes) { n = lanes; }
+        if (n == 1) {
+            KineticHMAC_PopulateWithKey(hmacs[i], msgs[i], hmacKey);
+            continue;
+        }
+
+        ByteArray commands[KINETIC_HMAC_MB_MAX_LANES];
+        uint8_t digests[KINETIC_HMAC_MB_MAX_LANES][KINETIC_HMAC_SHA1_LEN];
+        for (size_t j = 0; j < n; j++) {
+            Com__Seagate__Kinetic__Proto__Message* msg = msgs[i + j];
+            KINETIC_ASSERT(msg != NULL);
+            KINETIC_ASSERT(msg->has_commandbytes);
+            KINETIC_ASSERT(msg->commandbytes.data != NULL);
+            KINETIC_ASSERT(msg->commandbytes.len > 0);
+            KINETIC_ASSERT(msg->hmacauth->hmac.data != NULL);
+            commands[j] = (ByteArray) {
+                .data = msg->commandbytes.data,
+                .len = msg->commandbytes.len,
+            };
+        }
+        KineticHMACMB_Compute(hmacKey, commands, digests, n);
+
+        for (size_t j = 0; j < n; j++) {
+            KineticHMAC* hmac = hmacs[i + j];
+            Com__Seagate__Kinetic__Proto__Message* msg = msgs[i + j];
+            KineticHMAC_Init(hmac, COM__SEAGATE__KINETIC__PROTO__COMMAND__SECURITY__ACL__HMACALGORITHM__HmacSHA1);
+            memcpy(hmac->data, digests[j], hmac->len);
+
+            // Copy computed HMAC into message
+            memcpy(msg->hmacauth->hmac.data, hmac->data, hmac->len);
+            msg->hmacauth->hmac.len = hmac->len;
+            msg->hmacauth->has_hmac = true;
+        }
+    }
+}
+
 bool KineticHMAC_Validate(const Com__Seagate__Kinetic__Proto__Message* msg,
                           const ByteArray key)
 {
@@ -145,3 +220,66 @@ static void KineticHMAC_Compute(KineticHMAC* hmac,
     HMAC_Final(&ctx, hmac->data, &hmac->len);
     HMAC_CTX_cleanup(&ctx);
 }
+
+#define HMAC_IPAD 0x36
+#define HMAC_OPAD 0x5c
+
+void KineticHMAC_InitKey(KineticHMACKey* hmacKey,
+                         const ByteArray key)
+{
+    KINETIC_ASSERT(hmacKey != NULL);
+    KINETIC_ASSERT(key.data != NULL);
+    KINETIC_ASSERT(key.len > 0);
+
+    // Keys longer than a SHA1 block are hashed first (RFC 2104)
+    uint8_t block[SHA_CBLOCK];
+    memset(block, 0, sizeof(block));
+    if (key.len > SHA_CBLOCK) {
+        SHA1(key.data, key.len, block);
+    }
+    else {
+        memcpy(block, key.data, key.len);
+    }
+
+    uint8_t pad[SHA_CBLOCK];
+    for (size_t i = 0; i < SHA_CBLOCK; i++) {
+        pad[i] = block[i] ^ HMAC_IPAD;
+    }
+    SHA1_Init(&hmacKey->inner);
+    SHA1_Update(&hmacKey->inner, pad, sizeof(pad));
+
+    for (size_t i = 0; i < SHA_CBLOCK; i++) {
+        pad[i] = block[i] ^ HMAC_OPAD;
+    }
+    SHA1_Init(&hmacKey->outer);
+    SHA1_Update(&hmacKey->outer, pad, sizeof(pad));
+
+    OPENSSL_cleanse(block, sizeof(block));
+    OPENSSL_cleanse(pad, sizeof(pad));
+    hmacKey->ready = true;
+}
+
+static void KineticHMAC_ComputeWithKey(KineticHMAC* hmac,
+                                       const Com__Seagate__Kinetic__Proto__Message* msg,
+                                       KineticHMACKey const * const hmacKey)
+{
+    KINETIC_ASSERT(hmac != NULL);
+    KINETIC_ASSERT(hmac->len == SHA_DIGEST_LENGTH);
+    KINETIC_ASSERT(msg != NULL);
+    KINETIC_ASSERT(msg->has_commandbytes);
+    KINETIC_ASSERT(msg->commandbytes.data != NULL);
+    KINETIC_ASSERT(msg->commandbytes.len > 0);
+
+    uint32_t lenNBO = KineticNBO_FromHostU32(msg->commandbytes.len);
+
+    // The key states are copied by value, so the session's stay untouched
+    // and may be shared by concurrent senders
+    SHA_CTX ctx = hmacKey->inner;
+    SHA1_Update(&ctx, (uint8_t*)&lenNBO, sizeof(uint32_t));
+    SHA1_Update(&ctx, msg->commandbytes.data, msg->commandbytes.len);
+    SHA1_Final(hmac->data, &ctx);
+
+    ctx = hmacKey->outer;
+    SHA1_Update(&ctx, hmac->data, SHA_DIGEST_LENGTH);
+    SHA1_Final(hmac->data, &ctx);
+}
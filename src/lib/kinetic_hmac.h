@@ -31,6 +31,22 @@ void KineticHMAC_Populate(KineticHMAC* hmac,
                           Com__Seagate__Kinetic__Proto__Message* msg,
                           const ByteArray key);
 
+/* Absorb the padded key into the inner and outer SHA1 states once, so
+ * KineticHMAC_PopulateWithKey only has to hash the message itself. */
+void KineticHMAC_InitKey(KineticHMACKey* hmacKey,
+                         const ByteArray key);
+
+void KineticHMAC_PopulateWithKey(KineticHMAC* hmac,
+                                 Com__Seagate__Kinetic__Proto__Message* msg,
+                                 KineticHMACKey const * const hmacKey);
+
+/* Sign COUNT independent messages with the same key, hashing them
+ * together in SIMD lanes where the CPU makes that worthwhile. */
+void KineticHMAC_PopulateBatch(KineticHMAC* const hmacs[],
+                               Com__Seagate__Kinetic__Proto__Message* const msgs[],
+                               size_t count,
+                               KineticHMACKey const * const hmacKey);
+
 bool KineticHMAC_Validate(const Com__Seagate__Kinetic__Proto__Message* msg,
                           const ByteArray key);
 
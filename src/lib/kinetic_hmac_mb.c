@@ -0,0 +1,209 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_hmac_mb.h"
+#include "kinetic_logger.h"
+#include <string.h>
+#include <pthread.h>
+#include <openssl/sha.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KINETIC_HMAC_MB_X86 1
+#include <cpuid.h>
+#endif
+
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+#define MB_PASTE2(NAME, SUFFIX) NAME##_##SUFFIX
+#define MB_PASTE(NAME, SUFFIX) MB_PASTE2(NAME, SUFFIX)
+
+static uint32_t load_be32(uint8_t const * const p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void store_be32(uint8_t * const p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static void sha1_state(uint32_t state[5], SHA_CTX const * const ctx)
+{
+    // Only whole blocks (the padded key) may have been hashed so far
+    KINETIC_ASSERT(ctx->num == 0);
+    state[0] = ctx->h0;
+    state[1] = ctx->h1;
+    state[2] = ctx->h2;
+    state[3] = ctx->h3;
+    state[4] = ctx->h4;
+}
+
+/* The inner hash covers the padded key block, then the message: the
+ * 4-byte length prefix and the command bytes, then SHA1 padding. */
+static size_t inner_block_count(ByteArray const command)
+{
+    size_t const msgLen = sizeof(uint32_t) + command.len;
+    return (msgLen + 1 + sizeof(uint64_t) + SHA_CBLOCK - 1) / SHA_CBLOCK;
+}
+
+static void fill_inner_block(uint8_t block[SHA_CBLOCK], ByteArray const command,
+                             size_t index, size_t blockCount)
+{
+    size_t const start = index * SHA_CBLOCK;
+    size_t const end = start + SHA_CBLOCK;
+    size_t const msgLen = sizeof(uint32_t) + command.len;
+    uint8_t prefix[sizeof(uint32_t)];
+    store_be32(prefix, (uint32_t)command.len);
+
+    memset(block, 0, SHA_CBLOCK);
+    for (size_t i = start; i < sizeof(prefix) && i < end; i++) {
+        block[i - start] = prefix[i];
+    }
+
+    // Command bytes start sizeof(prefix) bytes into the message
+    size_t const from = (start > sizeof(prefix)) ? start - sizeof(prefix) : 0;
+    size_t const to = (start > sizeof(prefix)) ? 0 : sizeof(prefix) - start;
+    if (from < command.len) {
+        size_t len = command.len - from;
+        if (len > SHA_CBLOCK - to) { len = SHA_CBLOCK - to; }
+        memcpy(&block[to], &command.data[from], len);
+    }
+
+    if (msgLen >= start && msgLen < end) {
+        block[msgLen - start] = 0x80;
+    }
+    if (index + 1 == blockCount) {
+        uint64_t const bits = (uint64_t)(SHA_CBLOCK + msgLen) * 8;
+        store_be32(&block[SHA_CBLOCK - 8], (uint32_t)(bits >> 32));
+        store_be32(&block[SHA_CBLOCK - 4], (uint32_t)bits);
+    }
+}
+
+static void hmac_scalar(KineticHMACKey const * const hmacKey,
+                        ByteArray const commands[],
+                        uint8_t digests[][KINETIC_HMAC_SHA1_LEN],
+                        size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        uint8_t prefix[sizeof(uint32_t)];
+        store_be32(prefix, (uint32_t)commands[i].len);
+
+        SHA_CTX ctx = hmacKey->inner;
+        SHA1_Update(&ctx, prefix, sizeof(prefix));
+        SHA1_Update(&ctx, commands[i].data, commands[i].len);
+        SHA1_Final(digests[i], &ctx);
+
+        ctx = hmacKey->outer;
+        SHA1_Update(&ctx, digests[i], SHA_DIGEST_LENGTH);
+        SHA1_Final(digests[i], &ctx);
+    }
+}
+
+#ifdef KINETIC_HMAC_MB_X86
+
+#define MB_LANES 4
+#define MB_SUFFIX sse2
+#define MB_TARGET __attribute__((target("sse2")))
+#include "kinetic_hmac_mb_lanes.h"
+#undef MB_TARGET
+#undef MB_SUFFIX
+#undef MB_LANES
+
+#define MB_LANES 8
+#define MB_SUFFIX avx2
+#define MB_TARGET __attribute__((target("avx2")))
+#include "kinetic_hmac_mb_lanes.h"
+#undef MB_TARGET
+#undef MB_SUFFIX
+#undef MB_LANES
+
+#endif
+
+static struct {
+    pthread_once_t once;
+    bool sse2;
+    bool avx2;
+    bool sha;
+} Cpu = {.once = PTHREAD_ONCE_INIT};
+
+static void detect_cpu(void)
+{
+#ifdef KINETIC_HMAC_MB_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) { return; }
+    Cpu.sse2 = (edx & bit_SSE2) != 0;
+
+    // AVX2 also needs the OS to save the YMM registers
+    bool ymm = false;
+    if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+        uint32_t xcr0, xcr0High;
+        __asm__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+        (void)xcr0High;
+        ymm = (xcr0 & 0x6) == 0x6;
+    }
+
+    if (__get_cpuid_max(0, NULL) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        Cpu.avx2 = ymm && (ebx & bit_AVX2) != 0;
+        Cpu.sha = (ebx & bit_SHA) != 0;
+    }
+#endif
+    LOGF2("HMAC multi-buffer: sse2=%d, avx2=%d, sha=%d", Cpu.sse2, Cpu.avx2, Cpu.sha);
+}
+
+size_t KineticHMACMB_Lanes(void)
+{
+    pthread_once(&Cpu.once, detect_cpu);
+    if (Cpu.sha) { return 1; }
+    if (Cpu.avx2) { return 8; }
+    if (Cpu.sse2) { return 4; }
+    return 1;
+}
+
+void KineticHMACMB_Compute(KineticHMACKey const * const hmacKey,
+                           ByteArray const commands[],
+                           uint8_t digests[][KINETIC_HMAC_SHA1_LEN],
+                           size_t count)
+{
+    KINETIC_ASSERT(hmacKey != NULL);
+    KINETIC_ASSERT(hmacKey->ready);
+    KINETIC_ASSERT(count <= KINETIC_HMAC_MB_MAX_LANES);
+    pthread_once(&Cpu.once, detect_cpu);
+
+#ifdef KINETIC_HMAC_MB_X86
+    if (Cpu.avx2 && count > 4) {
+        hmac_avx2(hmacKey, commands, digests, count);
+        return;
+    }
+    if (Cpu.sse2 && count > 1) {
+        size_t first = (count > 4) ? 4 : count;
+        hmac_sse2(hmacKey, commands, digests, first);
+        if (count > first) {
+            hmac_sse2(hmacKey, &commands[first], &digests[first], count - first);
+        }
+        return;
+    }
+#endif
+    hmac_scalar(hmacKey, commands, digests, count);
+}
@@ -0,0 +1,46 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_HMAC_MB_H
+#define _KINETIC_HMAC_MB_H
+
+#include "kinetic_types_internal.h"
+
+/* Multi-buffer HMAC-SHA1: finishes the HMACs of several independent
+ * messages at once, one message per SIMD lane, continuing from the
+ * precomputed states in a KineticHMACKey. Each message is signed the
+ * way requests are, over the 4-byte big-endian length of its command
+ * bytes followed by the command bytes. */
+
+#define KINETIC_HMAC_MB_MAX_LANES (8)
+
+/* Number of messages worth signing together on this CPU, decided once
+ * via CPUID: 8 with AVX2, 4 with SSE2, or 1 when single-buffer hashing
+ * is at least as fast (no SIMD, or SHA instructions for OpenSSL to use). */
+size_t KineticHMACMB_Lanes(void);
+
+/* Compute the HMACs of COUNT (at most KINETIC_HMAC_MB_MAX_LANES) command
+ * byte arrays into DIGESTS, using the widest SIMD lanes available. */
+void KineticHMACMB_Compute(KineticHMACKey const * const hmacKey,
+                           ByteArray const commands[],
+                           uint8_t digests[][KINETIC_HMAC_SHA1_LEN],
+                           size_t count);
+
+#endif // _KINETIC_HMAC_MB_H
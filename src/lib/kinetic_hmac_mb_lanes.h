@@ -0,0 +1,162 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+/* SHA1 compression over MB_LANES messages at once, and HMAC on top of
+ * it, for kinetic_hmac_mb.c. Not a regular header: it is included once
+ * per SIMD width, with MB_LANES, MB_SUFFIX and MB_TARGET defined, and
+ * uses the vector type MB_VEC and the helpers defined there. */
+
+#define MB_VEC          MB_NAME(vec)
+#define MB_NAME(NAME)   MB_PASTE(NAME, MB_SUFFIX)
+
+typedef uint32_t MB_VEC __attribute__((vector_size(MB_LANES * sizeof(uint32_t))));
+
+#define MB_ROTL(X, N) (((X) << (N)) | ((X) >> (32 - (N))))
+
+#define MB_ROUND(F, K)                                          \
+    do {                                                        \
+        MB_VEC const temp = MB_ROTL(a, 5) + (F) + e + (K) + w[t & 15]; \
+        e = d;                                                  \
+        d = c;                                                  \
+        c = MB_ROTL(b, 30);                                     \
+        b = a;                                                  \
+        a = temp;                                               \
+    } while (0)
+
+#define MB_SCHEDULE()                                           \
+    (w[t & 15] = MB_ROTL(w[(t - 3) & 15] ^ w[(t - 8) & 15] ^    \
+                         w[(t - 14) & 15] ^ w[t & 15], 1))
+
+MB_TARGET static void MB_NAME(broadcast_state)(MB_VEC state[5], SHA_CTX const * const ctx)
+{
+    uint32_t start[5];
+    uint32_t words[5][MB_LANES];
+    sha1_state(start, ctx);
+    for (int h = 0; h < 5; h++) {
+        for (size_t lane = 0; lane < MB_LANES; lane++) { words[h][lane] = start[h]; }
+    }
+    memcpy(state, words, sizeof(words));
+}
+
+MB_TARGET static void MB_NAME(compress)(MB_VEC state[5], MB_VEC const block[16])
+{
+    MB_VEC a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    MB_VEC w[16];
+    int t;
+
+    for (t = 0; t < 16; t++) {
+        w[t] = block[t];
+        MB_ROUND(d ^ (b & (c ^ d)), 0x5A827999u);
+    }
+    for (; t < 20; t++) {
+        MB_SCHEDULE();
+        MB_ROUND(d ^ (b & (c ^ d)), 0x5A827999u);
+    }
+    for (; t < 40; t++) {
+        MB_SCHEDULE();
+        MB_ROUND(b ^ c ^ d, 0x6ED9EBA1u);
+    }
+    for (; t < 60; t++) {
+        MB_SCHEDULE();
+        MB_ROUND((b & c) | (d & (b | c)), 0x8F1BBCDCu);
+    }
+    for (; t < 80; t++) {
+        MB_SCHEDULE();
+        MB_ROUND(b ^ c ^ d, 0xCA62C1D6u);
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+/* Lanes are filled and read back through plain word arrays, since
+ * setting vector elements one at a time is slow. */
+MB_TARGET static void MB_NAME(hmac)(KineticHMACKey const * const hmacKey,
+                                    ByteArray const commands[],
+                                    uint8_t digests[][KINETIC_HMAC_SHA1_LEN],
+                                    size_t count)
+{
+    MB_VEC state[5];
+    MB_VEC block[16];
+    uint32_t words[16][MB_LANES];
+    uint32_t inner[5][MB_LANES];
+    uint8_t bytes[SHA_CBLOCK];
+    size_t blockCount[MB_LANES];
+    size_t maxBlocks = 0;
+
+    KINETIC_ASSERT(count <= MB_LANES);
+
+    for (size_t lane = 0; lane < count; lane++) {
+        blockCount[lane] = inner_block_count(commands[lane]);
+        if (blockCount[lane] > maxBlocks) { maxBlocks = blockCount[lane]; }
+    }
+
+    // Inner hash: every lane starts from the key's ipad state, and lanes
+    // whose message ends early keep hashing filler, with results discarded
+    MB_NAME(broadcast_state)(state, &hmacKey->inner);
+    memset(words, 0, sizeof(words));
+    for (size_t i = 0; i < maxBlocks; i++) {
+        for (size_t lane = 0; lane < count; lane++) {
+            if (i < blockCount[lane]) {
+                fill_inner_block(bytes, commands[lane], i, blockCount[lane]);
+                for (int t = 0; t < 16; t++) {
+                    words[t][lane] = load_be32(&bytes[t * sizeof(uint32_t)]);
+                }
+            }
+        }
+        memcpy(block, words, sizeof(block));
+        MB_NAME(compress)(state, block);
+        for (size_t lane = 0; lane < count; lane++) {
+            if (i + 1 == blockCount[lane]) {
+                uint32_t current[5][MB_LANES];
+                memcpy(current, state, sizeof(current));
+                for (int h = 0; h < 5; h++) { inner[h][lane] = current[h][lane]; }
+            }
+        }
+    }
+
+    // Outer hash: the inner digests all fit in one padded block
+    MB_NAME(broadcast_state)(state, &hmacKey->outer);
+    memset(words, 0, sizeof(words));
+    for (size_t lane = 0; lane < count; lane++) {
+        for (int h = 0; h < 5; h++) { words[h][lane] = inner[h][lane]; }
+        words[5][lane] = 0x80000000u;
+        words[15][lane] = (SHA_CBLOCK + SHA_DIGEST_LENGTH) * 8;
+    }
+    memcpy(block, words, sizeof(block));
+    MB_NAME(compress)(state, block);
+
+    uint32_t outer[5][MB_LANES];
+    memcpy(outer, state, sizeof(outer));
+    for (size_t lane = 0; lane < count; lane++) {
+        for (int h = 0; h < 5; h++) {
+            store_be32(&digests[lane][h * sizeof(uint32_t)], outer[h][lane]);
+        }
+    }
+}
+
+#undef MB_SCHEDULE
+#undef MB_ROUND
+#undef MB_ROTL
+#undef MB_NAME
+#undef MB_VEC
@@ -0,0 +1,493 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_iterator.h"
+#include "kinetic_client.h"
+#include "kinetic_logger.h"
+#include "byte_array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+// Room for a version or tag an entry may have been given by other clients
+#define ITERATOR_VERSION_LEN (KINETIC_DEFAULT_KEY_LEN)
+#define ITERATOR_TAG_LEN (KINETIC_DEFAULT_KEY_LEN)
+
+// Initial room per key in a page, which grows to fit longer keys
+#define ITERATOR_KEY_ROOM (64)
+
+typedef struct {
+    KineticKeyIterator * iterator;
+    uint8_t * keyData;  // Keys listed, packed end to end
+    size_t keyDataLen;
+    size_t keyDataCap;
+    size_t * keyEnds;   // Offset in keyData of the end of each key
+    size_t keyCount;
+    uint64_t first;     // Ordinal of the page's first key, once listed
+    KineticStatus keyStatus;    // Failure packing the keys listed
+    bool done;          // The GETKEYRANGE has completed with STATUS
+    KineticStatus status;
+} IteratorPage;
+
+typedef struct {
+    KineticKeyIterator * iterator;
+    KineticEntry entry;
+    uint8_t key[KINETIC_MAX_KEY_LEN];
+    uint8_t version[ITERATOR_VERSION_LEN];
+    uint8_t tag[ITERATOR_TAG_LEN];
+    uint8_t * value;
+    bool done;          // The GET has completed with STATUS
+    KineticStatus status;
+} IteratorValue;
+
+struct _KineticKeyIterator {
+    KineticSession * session;
+    KineticKeyRange range;      // Moved past each page as it is listed
+    uint8_t startKey[KINETIC_MAX_KEY_LEN];
+    uint8_t endKey[KINETIC_MAX_KEY_LEN];
+    size_t pageKeys;
+    bool fetchValues;
+    size_t maxValueLen;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t completed;
+    uint64_t completions;       // Requests completed so far, to wait for another
+    size_t inFlight;
+
+    // Page P of the scan is held in pages[P % pageCount] from when it is
+    // requested until its last key has been consumed. Pages are requested
+    // one at a time, since each starts after the last key of the one before.
+    size_t pageCount;
+    IteratorPage * pages;
+    uint64_t pagesRequested;
+    uint64_t pagesListed;       // Completed, and their keys numbered
+    uint64_t pagesConsumed;
+    bool rangeListed;           // A short page has ended the range
+
+    // The value of the key numbered K is read into values[K % valueCount]
+    size_t valueCount;
+    IteratorValue * values;
+    uint64_t valuesRequested;
+
+    uint64_t keysListed;
+    uint64_t keysConsumed;      // Number of the next key to return
+    bool returned;              // Key keysConsumed is held by the caller
+
+    KineticStatus status;       // First failure, returned from then on
+};
+
+static void free_iterator(KineticKeyIterator * iterator)
+{
+    if (iterator->values != NULL) {
+        for (size_t i = 0; i < iterator->valueCount; i++) {
+            free(iterator->values[i].value);
+        }
+    }
+    if (iterator->pages != NULL) {
+        for (size_t i = 0; i < iterator->pageCount; i++) {
+            free(iterator->pages[i].keyEnds);
+            free(iterator->pages[i].keyData);
+        }
+    }
+    free(iterator->values);
+    free(iterator->pages);
+    pthread_cond_destroy(&iterator->completed);
+    pthread_mutex_destroy(&iterator->mutex);
+    free(iterator);
+}
+
+static KineticKeyIterator * new_iterator(size_t pageKeys, size_t pageCount,
+                                         size_t valueCount, size_t maxValueLen)
+{
+    KineticKeyIterator * iterator = calloc(1, sizeof(*iterator));
+    if (iterator == NULL) { return NULL; }
+    pthread_mutex_init(&iterator->mutex, NULL);
+    pthread_cond_init(&iterator->completed, NULL);
+    iterator->status = KINETIC_STATUS_SUCCESS;
+
+    iterator->pageKeys = pageKeys;
+    iterator->pageCount = pageCount;
+    iterator->pages = calloc(pageCount, sizeof(iterator->pages[0]));
+    if (iterator->pages == NULL) {
+        free_iterator(iterator);
+        return NULL;
+    }
+    for (size_t i = 0; i < pageCount; i++) {
+        IteratorPage * page = &iterator->pages[i];
+        page->iterator = iterator;
+        page->keyEnds = calloc(pageKeys, sizeof(page->keyEnds[0]));
+        page->keyDataCap = pageKeys * ITERATOR_KEY_ROOM;
+        page->keyData = malloc(page->keyDataCap);
+        if (page->keyEnds == NULL || page->keyData == NULL) {
+            free_iterator(iterator);
+            return NULL;
+        }
+    }
+
+    iterator->valueCount = valueCount;
+    iterator->maxValueLen = maxValueLen;
+    if (valueCount > 0) {
+        iterator->values = calloc(valueCount, sizeof(iterator->values[0]));
+        if (iterator->values == NULL) {
+            free_iterator(iterator);
+            return NULL;
+        }
+        for (size_t i = 0; i < valueCount; i++) {
+            iterator->values[i].iterator = iterator;
+            iterator->values[i].value = malloc(maxValueLen);
+            if (iterator->values[i].value == NULL) {
+                free_iterator(iterator);
+                return NULL;
+            }
+        }
+    }
+    return iterator;
+}
+
+/* Pack a key listed for PAGE onto the end of its key data. */
+static bool page_key(ByteArray const key, void* client_data)
+{
+    IteratorPage * page = client_data;
+    if (page->keyCount == page->iterator->pageKeys) { return false; }
+    if (key.len > KINETIC_MAX_KEY_LEN) {
+        page->keyStatus = KINETIC_STATUS_BUFFER_OVERRUN;
+        return false;
+    }
+
+    if (page->keyDataLen + key.len > page->keyDataCap) {
+        size_t cap = page->keyDataCap;
+        while (page->keyDataLen + key.len > cap) { cap *= 2; }
+        uint8_t * data = realloc(page->keyData, cap);
+        if (data == NULL) {
+            page->keyStatus = KINETIC_STATUS_MEMORY_ERROR;
+            return false;
+        }
+        page->keyData = data;
+        page->keyDataCap = cap;
+    }
+    if (key.len > 0) { memcpy(&page->keyData[page->keyDataLen], key.data, key.len); }
+    page->keyDataLen += key.len;
+    page->keyEnds[page->keyCount++] = page->keyDataLen;
+    return true;
+}
+
+static void page_done(KineticCompletionData* kinetic_data, void* client_data)
+{
+    IteratorPage * page = client_data;
+    KineticKeyIterator * iterator = page->iterator;
+
+    pthread_mutex_lock(&iterator->mutex);
+    page->status = kinetic_data->status;
+    if (page->status == KINETIC_STATUS_SUCCESS) { page->status = page->keyStatus; }
+    page->done = true;
+    iterator->inFlight--;
+    iterator->completions++;
+    pthread_cond_signal(&iterator->completed);
+    pthread_mutex_unlock(&iterator->mutex);
+}
+
+static void value_done(KineticCompletionData* kinetic_data, void* client_data)
+{
+    IteratorValue * value = client_data;
+    KineticKeyIterator * iterator = value->iterator;
+
+    pthread_mutex_lock(&iterator->mutex);
+    value->status = kinetic_data->status;
+    value->done = true;
+    iterator->inFlight--;
+    iterator->completions++;
+    pthread_cond_signal(&iterator->completed);
+    pthread_mutex_unlock(&iterator->mutex);
+}
+
+static KineticStatus start_page(KineticKeyIterator * iterator)
+{
+    IteratorPage * page = &iterator->pages[iterator->pagesRequested % iterator->pageCount];
+    page->keyDataLen = 0;
+    page->keyCount = 0;
+    page->keyStatus = KINETIC_STATUS_SUCCESS;
+
+    pthread_mutex_lock(&iterator->mutex);
+    page->done = false;
+    iterator->inFlight++;
+    pthread_mutex_unlock(&iterator->mutex);
+
+    KineticCompletionClosure closure = {
+        .callback = page_done,
+        .clientData = page,
+    };
+    KineticStatus status = KineticClient_GetKeyRangeStream(iterator->session,
+        &iterator->range, page_key, page, &closure);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        // Never sent, so it will not complete
+        pthread_mutex_lock(&iterator->mutex);
+        iterator->inFlight--;
+        pthread_mutex_unlock(&iterator->mutex);
+        return status;
+    }
+    iterator->pagesRequested++;
+    return status;
+}
+
+static ByteArray page_key_at(IteratorPage const * page, size_t index)
+{
+    size_t start = (index > 0) ? page->keyEnds[index - 1] : 0;
+    return (ByteArray) {.data = &page->keyData[start], .len = page->keyEnds[index] - start};
+}
+
+/* The listed key numbered ORDINAL. */
+static ByteArray listed_key(KineticKeyIterator * iterator, uint64_t ordinal)
+{
+    for (uint64_t p = iterator->pagesConsumed; p < iterator->pagesListed; p++) {
+        IteratorPage * page = &iterator->pages[p % iterator->pageCount];
+        if (ordinal < page->first + page->keyCount) {
+            return page_key_at(page, (size_t)(ordinal - page->first));
+        }
+    }
+    KINETIC_ASSERT(false);
+    return BYTE_ARRAY_NONE;
+}
+
+static KineticStatus start_value(KineticKeyIterator * iterator)
+{
+    IteratorValue * value = &iterator->values[iterator->valuesRequested % iterator->valueCount];
+    ByteArray key = listed_key(iterator, iterator->valuesRequested);
+
+    memcpy(value->key, key.data, key.len);
+    value->entry = (KineticEntry) {
+        .key = ByteBuffer_Create(value->key, sizeof(value->key), key.len),
+        .value = ByteBuffer_Create(value->value, iterator->maxValueLen, 0),
+        .dbVersion = ByteBuffer_Create(value->version, sizeof(value->version), 0),
+        .tag = ByteBuffer_Create(value->tag, sizeof(value->tag), 0),
+    };
+
+    pthread_mutex_lock(&iterator->mutex);
+    value->done = false;
+    iterator->inFlight++;
+    pthread_mutex_unlock(&iterator->mutex);
+
+    KineticCompletionClosure closure = {
+        .callback = value_done,
+        .clientData = value,
+    };
+    KineticStatus status = KineticClient_Get(iterator->session, &value->entry, &closure);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        pthread_mutex_lock(&iterator->mutex);
+        iterator->inFlight--;
+        pthread_mutex_unlock(&iterator->mutex);
+        return status;
+    }
+    iterator->valuesRequested++;
+    return status;
+}
+
+/* Number the keys of the page just listed, if it has completed, and move
+ * the range past it. Called with the iterator's mutex held. */
+static void list_page(KineticKeyIterator * iterator)
+{
+    if (iterator->pagesListed == iterator->pagesRequested) { return; }
+    IteratorPage * page = &iterator->pages[iterator->pagesListed % iterator->pageCount];
+    if (!page->done) { return; }
+
+    if (page->status != KINETIC_STATUS_SUCCESS) {
+        if (iterator->status == KINETIC_STATUS_SUCCESS) { iterator->status = page->status; }
+        return;
+    }
+    page->first = iterator->keysListed;
+    iterator->keysListed += page->keyCount;
+    iterator->pagesListed++;
+
+    if (page->keyCount < iterator->pageKeys) {
+        iterator->rangeListed = true;
+        return;
+    }
+    ByteArray last = page_key_at(page, page->keyCount - 1);
+    if (iterator->range.reverse) {
+        memcpy(iterator->endKey, last.data, last.len);
+        iterator->range.endKey.bytesUsed = last.len;
+        iterator->range.endKeyInclusive = false;
+    } else {
+        memcpy(iterator->startKey, last.data, last.len);
+        iterator->range.startKey.bytesUsed = last.len;
+        iterator->range.startKeyInclusive = false;
+    }
+}
+
+/* Take in completed pages, and request whatever more the prefetch depths
+ * allow: the next page once the last has been listed, and values for
+ * listed keys. */
+static KineticStatus prefetch(KineticKeyIterator * iterator)
+{
+    pthread_mutex_lock(&iterator->mutex);
+    list_page(iterator);
+    KineticStatus status = iterator->status;
+    pthread_mutex_unlock(&iterator->mutex);
+
+    if (status == KINETIC_STATUS_SUCCESS && !iterator->rangeListed &&
+        iterator->pagesRequested == iterator->pagesListed &&
+        iterator->pagesRequested < iterator->pagesConsumed + iterator->pageCount) {
+        status = start_page(iterator);
+    }
+    while (status == KINETIC_STATUS_SUCCESS && iterator->fetchValues &&
+           iterator->valuesRequested < iterator->keysListed &&
+           iterator->valuesRequested < iterator->keysConsumed + iterator->valueCount) {
+        status = start_value(iterator);
+    }
+    if (status != KINETIC_STATUS_SUCCESS && iterator->status == KINETIC_STATUS_SUCCESS) {
+        iterator->status = status;
+    }
+    return status;
+}
+
+/* Release the key last returned, and the page holding it once that was
+ * the page's last key. */
+static void consume_key(KineticKeyIterator * iterator)
+{
+    iterator->keysConsumed++;
+    while (iterator->pagesConsumed < iterator->pagesListed) {
+        IteratorPage * page = &iterator->pages[iterator->pagesConsumed % iterator->pageCount];
+        if (iterator->keysConsumed < page->first + page->keyCount) { break; }
+        iterator->pagesConsumed++;
+    }
+}
+
+KineticStatus KineticKeyIterator_Open(KineticSession * const session,
+                                      KineticKeyRange const * const range,
+                                      KineticKeyIteratorConfig const * const config,
+                                      KineticKeyIterator ** iterator)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(range);
+    KINETIC_ASSERT(iterator);
+    *iterator = NULL;
+
+    if (range->startKey.bytesUsed > KINETIC_MAX_KEY_LEN ||
+        range->endKey.bytesUsed > KINETIC_MAX_KEY_LEN || range->maxReturned < 0) {
+        return KINETIC_STATUS_INVALID_REQUEST;
+    }
+
+    KineticKeyIteratorConfig options = {.fetchValues = false};
+    if (config != NULL) { options = *config; }
+    size_t pageKeys = (range->maxReturned > 0) ?
+        (size_t)range->maxReturned : KINETIC_ITERATOR_DEFAULT_PAGE_KEYS;
+    if (options.prefetchPages == 0) { options.prefetchPages = KINETIC_ITERATOR_DEFAULT_PREFETCH_PAGES; }
+    if (options.prefetchValues == 0) { options.prefetchValues = KINETIC_ITERATOR_DEFAULT_VALUES; }
+    if (options.prefetchValues > KINETIC_MAX_QUEUE_DEPTH) { options.prefetchValues = KINETIC_MAX_QUEUE_DEPTH; }
+    if (options.maxValueLen == 0) { options.maxValueLen = KINETIC_OBJ_SIZE; }
+
+    KineticKeyIterator * iter = new_iterator(pageKeys, options.prefetchPages,
+        options.fetchValues ? options.prefetchValues : 0, options.maxValueLen);
+    if (iter == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+
+    iter->session = session;
+    iter->fetchValues = options.fetchValues;
+    iter->range = *range;
+    iter->range.maxReturned = (int32_t)pageKeys;
+    if (range->startKey.bytesUsed > 0) {
+        memcpy(iter->startKey, range->startKey.array.data, range->startKey.bytesUsed);
+    }
+    if (range->endKey.bytesUsed > 0) {
+        memcpy(iter->endKey, range->endKey.array.data, range->endKey.bytesUsed);
+    }
+    iter->range.startKey = ByteBuffer_Create(iter->startKey, sizeof(iter->startKey),
+        range->startKey.bytesUsed);
+    iter->range.endKey = ByteBuffer_Create(iter->endKey, sizeof(iter->endKey),
+        range->endKey.bytesUsed);
+
+    KineticStatus status = prefetch(iter);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        free_iterator(iter);
+        return status;
+    }
+    *iterator = iter;
+    return KINETIC_STATUS_SUCCESS;
+}
+
+KineticStatus KineticKeyIterator_Next(KineticKeyIterator * const iterator,
+                                      ByteArray * key,
+                                      ByteArray * value)
+{
+    KINETIC_ASSERT(iterator);
+    KINETIC_ASSERT(key);
+
+    if (iterator->returned) {
+        consume_key(iterator);
+        iterator->returned = false;
+    }
+
+    IteratorValue * read = NULL;
+    for (;;) {
+        pthread_mutex_lock(&iterator->mutex);
+        uint64_t completions = iterator->completions;
+        pthread_mutex_unlock(&iterator->mutex);
+
+        KineticStatus status = prefetch(iterator);
+        if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+        bool ready = false;
+        if (iterator->keysConsumed < iterator->keysListed) {
+            if (!iterator->fetchValues) { break; }
+            read = &iterator->values[iterator->keysConsumed % iterator->valueCount];
+            pthread_mutex_lock(&iterator->mutex);
+            ready = read->done;
+            status = read->status;
+            pthread_mutex_unlock(&iterator->mutex);
+            if (ready && status == KINETIC_STATUS_SUCCESS) { break; }
+            if (ready && status == KINETIC_STATUS_NOT_FOUND) {
+                // Deleted since it was listed
+                consume_key(iterator);
+                continue;
+            }
+            if (ready) {
+                iterator->status = status;
+                return status;
+            }
+        } else if (iterator->rangeListed) {
+            return KINETIC_STATUS_NOT_FOUND;
+        }
+
+        pthread_mutex_lock(&iterator->mutex);
+        while (iterator->completions == completions) {
+            pthread_cond_wait(&iterator->completed, &iterator->mutex);
+        }
+        pthread_mutex_unlock(&iterator->mutex);
+    }
+
+    *key = listed_key(iterator, iterator->keysConsumed);
+    if (value != NULL) {
+        *value = (read != NULL) ?
+            (ByteArray) {.data = read->value, .len = read->entry.value.bytesUsed} :
+            BYTE_ARRAY_NONE;
+    }
+    iterator->returned = true;
+    return KINETIC_STATUS_SUCCESS;
+}
+
+void KineticKeyIterator_Close(KineticKeyIterator * iterator)
+{
+    if (iterator == NULL) { return; }
+
+    pthread_mutex_lock(&iterator->mutex);
+    while (iterator->inFlight > 0) {
+        pthread_cond_wait(&iterator->completed, &iterator->mutex);
+    }
+    pthread_mutex_unlock(&iterator->mutex);
+    free_iterator(iterator);
+}
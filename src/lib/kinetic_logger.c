@@ -420,6 +420,11 @@ static void log_protobuf_message(int log_level, ProtobufCMessage const * msg, ch
     }
 }
 
+bool KineticLogger_IsLevelEnabled(int log_level)
+{
+    return is_level_enabled(log_level);
+}
+
 void KineticLogger_LogProtobuf(int log_level, const Com__Seagate__Kinetic__Proto__Message* msg)
 {
     if (msg == NULL || !is_level_enabled(log_level)) {
@@ -32,6 +32,7 @@
 
 void KineticLogger_Init(const char* logFile, int log_level);
 void KineticLogger_Close(void);
+bool KineticLogger_IsLevelEnabled(int log_level);
 void KineticLogger_Log(int log_level, const char* message);
 void KineticLogger_LogPrintf(int log_level, const char* format, ...);
 void KineticLogger_LogLocation(const char* filename, int line, const char * message);
@@ -0,0 +1,699 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_object.h"
+#include "kinetic_controller.h"
+#include "kinetic_allocator.h"
+#include "kinetic_builder.h"
+#include "kinetic_nbo.h"
+#include "kinetic_tag.h"
+#include "kinetic_cache.h"
+#include "kinetic_logger.h"
+#include "byte_array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#define MANIFEST_MAGIC (0x4B4F424Au)  // "KOBJ"
+#define MANIFEST_VERSION (3)
+#define GENERATION_LEN (sizeof(uint64_t))
+
+// Room for a version an entry may have been given by other clients
+#define OBJECT_VERSION_LEN (KINETIC_DEFAULT_KEY_LEN)
+
+typedef struct _ObjectTransfer ObjectTransfer;
+
+typedef struct {
+    ObjectTransfer * transfer;
+    KineticEntry entry;
+    uint8_t key[KINETIC_MAX_KEY_LEN];
+    uint8_t tag[KINETIC_TAG_MAX_LEN];
+    uint8_t version[OBJECT_VERSION_LEN];
+    uint8_t * value;
+    bool busy;  // Owned by a chunk operation, or holding undelivered data
+    bool done;  // The chunk operation has completed with STATUS
+    KineticStatus status;
+} ObjectChunk;
+
+struct _ObjectTransfer {
+    KineticSession * session;
+    ByteArray key;
+    size_t chunkSize;
+    uint8_t generation[GENERATION_LEN];  // In every chunk's key and version, BE64
+    pthread_mutex_t mutex;
+    pthread_cond_t chunkDone;
+    size_t inFlight;
+    bool writing;   // Chunks are PUT or DELETEd, so stale in the read cache
+    bool deleting;  // Chunks already gone count as deleted
+    size_t bufferCount;
+    ObjectChunk chunks[];
+};
+
+void KineticObject_EncodeManifest(KineticObjectManifest const * const manifest,
+                                  uint8_t buf[KINETIC_OBJECT_MANIFEST_LEN])
+{
+    KINETIC_ASSERT(manifest);
+    KINETIC_ASSERT(buf);
+
+    uint32_t magic = KineticNBO_FromHostU32(MANIFEST_MAGIC);
+    uint32_t version = KineticNBO_FromHostU32(MANIFEST_VERSION);
+    uint64_t length = KineticNBO_FromHostU64(manifest->length);
+    uint32_t chunkSize = KineticNBO_FromHostU32(manifest->chunkSize);
+    uint32_t reserved = 0;
+    uint64_t generation = KineticNBO_FromHostU64(manifest->generation);
+
+    memcpy(&buf[0], &magic, sizeof(magic));
+    memcpy(&buf[4], &version, sizeof(version));
+    memcpy(&buf[8], &length, sizeof(length));
+    memcpy(&buf[16], &chunkSize, sizeof(chunkSize));
+    memcpy(&buf[20], &reserved, sizeof(reserved));
+    memcpy(&buf[24], &generation, sizeof(generation));
+}
+
+KineticStatus KineticObject_DecodeManifest(ByteArray const data,
+                                           KineticObjectManifest * const manifest)
+{
+    KINETIC_ASSERT(manifest);
+
+    if (data.data == NULL || data.len != KINETIC_OBJECT_MANIFEST_LEN) {
+        return KINETIC_STATUS_DATA_ERROR;
+    }
+
+    uint32_t magic, version, chunkSize;
+    uint64_t length, generation;
+    memcpy(&magic, &data.data[0], sizeof(magic));
+    memcpy(&version, &data.data[4], sizeof(version));
+    memcpy(&length, &data.data[8], sizeof(length));
+    memcpy(&chunkSize, &data.data[16], sizeof(chunkSize));
+    memcpy(&generation, &data.data[24], sizeof(generation));
+
+    if (KineticNBO_ToHostU32(magic) != MANIFEST_MAGIC ||
+        KineticNBO_ToHostU32(version) != MANIFEST_VERSION) {
+        return KINETIC_STATUS_DATA_ERROR;
+    }
+    chunkSize = KineticNBO_ToHostU32(chunkSize);
+    if (chunkSize == 0 || chunkSize > KINETIC_OBJ_SIZE) {
+        return KINETIC_STATUS_DATA_ERROR;
+    }
+
+    *manifest = (KineticObjectManifest) {
+        .length = KineticNBO_ToHostU64(length),
+        .chunkSize = chunkSize,
+        .generation = KineticNBO_ToHostU64(generation),
+    };
+    return KINETIC_STATUS_SUCCESS;
+}
+
+uint64_t KineticObject_ChunkCount(KineticObjectManifest const * const manifest)
+{
+    KINETIC_ASSERT(manifest);
+    KINETIC_ASSERT(manifest->chunkSize > 0);
+    return manifest->length / manifest->chunkSize +
+        ((manifest->length % manifest->chunkSize) ? 1 : 0);
+}
+
+/* A generation no earlier PUT of this object from any client is likely to
+ * have used: the time in nanoseconds, made distinct within this process. */
+static uint64_t new_generation(void)
+{
+    static uint64_t last = 0;
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t generation = (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+
+    uint64_t prev = __atomic_load_n(&last, __ATOMIC_RELAXED);
+    do {
+        if (generation <= prev) { generation = prev + 1; }
+    } while (!__atomic_compare_exchange_n(&last, &prev, generation, false,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return generation;
+}
+
+static size_t max_in_flight(KineticObjectConfig const * const config)
+{
+    size_t maxInFlight = KINETIC_OBJECT_DEFAULT_IN_FLIGHT;
+    if (config != NULL && config->maxInFlight > 0) {
+        maxInFlight = config->maxInFlight;
+    }
+    return (maxInFlight > KINETIC_MAX_QUEUE_DEPTH) ? KINETIC_MAX_QUEUE_DEPTH : maxInFlight;
+}
+
+static KineticStatus check_key(ByteArray const key)
+{
+    if (key.data == NULL || key.len == 0) {
+        return KINETIC_STATUS_MISSING_KEY;
+    }
+    if (key.len > KINETIC_MAX_KEY_LEN - KINETIC_OBJECT_CHUNK_KEY_SUFFIX_LEN) {
+        LOGF2("Object key too long for chunk keys: %zu bytes", key.len);
+        return KINETIC_STATUS_INVALID_REQUEST;
+    }
+    return KINETIC_STATUS_SUCCESS;
+}
+
+static void free_transfer(ObjectTransfer * transfer)
+{
+    for (size_t i = 0; i < transfer->bufferCount; i++) {
+        free(transfer->chunks[i].value);
+    }
+    pthread_cond_destroy(&transfer->chunkDone);
+    pthread_mutex_destroy(&transfer->mutex);
+    free(transfer);
+}
+
+/* A transfer of chunks of up to CHUNKSIZE bytes, through BUFFERCOUNT chunk
+ * buffers. A CHUNKSIZE of 0 gives chunks no value buffers, for DELETEs. */
+static ObjectTransfer * new_transfer(KineticSession * const session, ByteArray const key,
+                                     size_t chunkSize, size_t bufferCount)
+{
+    ObjectTransfer * transfer = calloc(1, sizeof(*transfer) + bufferCount * sizeof(transfer->chunks[0]));
+    if (transfer == NULL) { return NULL; }
+
+    transfer->session = session;
+    transfer->key = key;
+    transfer->chunkSize = chunkSize;
+    transfer->bufferCount = bufferCount;
+    pthread_mutex_init(&transfer->mutex, NULL);
+    pthread_cond_init(&transfer->chunkDone, NULL);
+
+    for (size_t i = 0; i < bufferCount; i++) {
+        transfer->chunks[i].transfer = transfer;
+        if (chunkSize == 0) { continue; }
+        transfer->chunks[i].value = malloc(chunkSize);
+        if (transfer->chunks[i].value == NULL) {
+            free_transfer(transfer);
+            return NULL;
+        }
+    }
+    return transfer;
+}
+
+/* Point CHUNK's entry at its buffers, keyed for chunk INDEX of the
+ * transfer's generation of the object. */
+static void init_chunk_entry(ObjectTransfer * transfer, ObjectChunk * chunk,
+                             uint64_t index, size_t valueLen)
+{
+    ByteArray key = transfer->key;
+    uint64_t indexNBO = KineticNBO_FromHostU64(index);
+    memcpy(chunk->key, key.data, key.len);
+    chunk->key[key.len] = 0x00;
+    memcpy(&chunk->key[key.len + 1], transfer->generation, sizeof(transfer->generation));
+    memcpy(&chunk->key[key.len + 1 + sizeof(transfer->generation)], &indexNBO, sizeof(indexNBO));
+
+    chunk->entry = (KineticEntry) {
+        .key = ByteBuffer_Create(chunk->key, sizeof(chunk->key),
+            key.len + KINETIC_OBJECT_CHUNK_KEY_SUFFIX_LEN),
+        .value = (chunk->value != NULL) ?
+            ByteBuffer_Create(chunk->value, valueLen, 0) : BYTE_BUFFER_NONE,
+        .tag = ByteBuffer_Create(chunk->tag, sizeof(chunk->tag), 0),
+        .dbVersion = ByteBuffer_Create(chunk->version, sizeof(chunk->version), 0),
+        .algorithm = KINETIC_ALGORITHM_CRC32,
+        .computeTag = true,
+    };
+}
+
+/* Drop ENTRY from the session's read cache, as the client API does around
+ * every write. */
+static void invalidate_cached(KineticSession * const session, KineticEntry const * const entry)
+{
+    if (session->readCache != NULL) {
+        KineticCache_Invalidate(session->readCache, (ByteArray) {
+            .data = entry->key.array.data, .len = entry->key.bytesUsed});
+    }
+}
+
+static void chunk_done(KineticCompletionData* kinetic_data, void* client_data)
+{
+    ObjectChunk * chunk = client_data;
+    ObjectTransfer * transfer = chunk->transfer;
+
+    // Again, for anything a GET cached while the chunk was being written
+    if (transfer->writing) { invalidate_cached(transfer->session, &chunk->entry); }
+
+    pthread_mutex_lock(&transfer->mutex);
+    chunk->status = kinetic_data->status;
+    chunk->done = true;
+    transfer->inFlight--;
+    pthread_cond_signal(&transfer->chunkDone);
+    pthread_mutex_unlock(&transfer->mutex);
+}
+
+/* Start BUILD's request for CHUNK, to complete through chunk_done. */
+static KineticStatus start_chunk(ObjectTransfer * transfer, ObjectChunk * chunk,
+                                 KineticBatchBuilder build)
+{
+    KineticOperation * operation = KineticAllocator_NewOperation(transfer->session);
+    if (operation == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+
+    KineticStatus status = build(operation, &chunk->entry);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        KineticAllocator_FreeOperation(operation);
+        return status;
+    }
+
+    pthread_mutex_lock(&transfer->mutex);
+    chunk->busy = true;
+    chunk->done = false;
+    transfer->inFlight++;
+    pthread_mutex_unlock(&transfer->mutex);
+
+    KineticCompletionClosure closure = {
+        .callback = chunk_done,
+        .clientData = chunk,
+    };
+    if (transfer->writing) { invalidate_cached(transfer->session, &chunk->entry); }
+    status = KineticController_ExecuteOperation(operation, &closure);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        // Never sent, so it will not complete
+        KineticAllocator_FreeOperation(operation);
+        pthread_mutex_lock(&transfer->mutex);
+        chunk->busy = false;
+        transfer->inFlight--;
+        pthread_mutex_unlock(&transfer->mutex);
+    }
+    return status;
+}
+
+/* Release completed chunks, noting the first failure in STATUS.
+ * Called with the transfer's mutex held. */
+static void reap_chunks(ObjectTransfer * transfer, KineticStatus * status)
+{
+    for (size_t i = 0; i < transfer->bufferCount; i++) {
+        ObjectChunk * chunk = &transfer->chunks[i];
+        if (chunk->busy && chunk->done) {
+            bool gone = transfer->deleting && chunk->status == KINETIC_STATUS_NOT_FOUND;
+            if (chunk->status != KINETIC_STATUS_SUCCESS && !gone &&
+                *status == KINETIC_STATUS_SUCCESS) {
+                *status = chunk->status;
+            }
+            chunk->busy = false;
+        }
+    }
+}
+
+/* Wait for every outstanding chunk operation to complete. */
+static KineticStatus drain_chunks(ObjectTransfer * transfer)
+{
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    pthread_mutex_lock(&transfer->mutex);
+    while (transfer->inFlight > 0) {
+        pthread_cond_wait(&transfer->chunkDone, &transfer->mutex);
+    }
+    reap_chunks(transfer, &status);
+    pthread_mutex_unlock(&transfer->mutex);
+    return status;
+}
+
+/* Wait for a chunk buffer to be free. Returns NULL, with STATUS set, once
+ * a chunk has failed. */
+static ObjectChunk * next_free_chunk(ObjectTransfer * transfer, KineticStatus * status)
+{
+    ObjectChunk * chunk = NULL;
+    pthread_mutex_lock(&transfer->mutex);
+    for (;;) {
+        reap_chunks(transfer, status);
+        if (*status != KINETIC_STATUS_SUCCESS) { break; }
+        for (size_t i = 0; i < transfer->bufferCount && chunk == NULL; i++) {
+            if (!transfer->chunks[i].busy) { chunk = &transfer->chunks[i]; }
+        }
+        if (chunk != NULL) { break; }
+        pthread_cond_wait(&transfer->chunkDone, &transfer->mutex);
+    }
+    pthread_mutex_unlock(&transfer->mutex);
+    return chunk;
+}
+
+/* Read until BUF is full or the reader reaches the end of the object. */
+static ssize_t read_chunk(KineticObjectIO const * const io, uint8_t * buf, size_t len)
+{
+    size_t filled = 0;
+    while (filled < len) {
+        ssize_t n = io->read(io->context, &buf[filled], len - filled);
+        if (n < 0) { return -1; }
+        if (n == 0) { break; }
+        filled += (size_t)n;
+    }
+    return (ssize_t)filled;
+}
+
+/* Synchronously PUT or GET the manifest entry for KEY, from or into VALUE. */
+static KineticStatus execute_manifest(KineticSession * const session, ByteArray const key,
+                                      ByteBuffer * const value,
+                                      KineticSynchronization synchronization,
+                                      KineticBatchBuilder build)
+{
+    uint8_t keyData[KINETIC_MAX_KEY_LEN];
+    uint8_t tag[KINETIC_TAG_MAX_LEN];
+    uint8_t version[OBJECT_VERSION_LEN];
+    memcpy(keyData, key.data, key.len);
+
+    KineticEntry entry = {
+        .key = ByteBuffer_Create(keyData, sizeof(keyData), key.len),
+        .value = *value,
+        .tag = ByteBuffer_Create(tag, sizeof(tag), 0),
+        .dbVersion = ByteBuffer_Create(version, sizeof(version), 0),
+        .algorithm = KINETIC_ALGORITHM_CRC32,
+        .computeTag = true,
+        .force = true,
+        .synchronization = synchronization,
+    };
+
+    KineticOperation * operation = KineticAllocator_NewOperation(session);
+    if (operation == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+
+    KineticStatus status = build(operation, &entry);
+    if (status != KINETIC_STATUS_SUCCESS) {
+        KineticAllocator_FreeOperation(operation);
+        return status;
+    }
+    bool const writing = (build != KineticBuilder_BuildGet);
+    if (writing) { invalidate_cached(session, &entry); }
+    status = KineticController_ExecuteOperation(operation, NULL);
+    if (writing) { invalidate_cached(session, &entry); }
+    *value = entry.value;
+    return status;
+}
+
+/* Read the manifest of the object stored under KEY. */
+static KineticStatus read_manifest(KineticSession * const session, ByteArray const key,
+                                   KineticObjectManifest * const manifest)
+{
+    uint8_t manifestData[KINETIC_OBJECT_MANIFEST_LEN];
+    ByteBuffer manifestBuffer = ByteBuffer_Create(manifestData, sizeof(manifestData), 0);
+    KineticStatus status = execute_manifest(session, key, &manifestBuffer, 0,
+        KineticBuilder_BuildGet);
+    if (status == KINETIC_STATUS_BUFFER_OVERRUN) {
+        // Too big to be a manifest
+        return KINETIC_STATUS_DATA_ERROR;
+    }
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    return KineticObject_DecodeManifest((ByteArray) {
+        .data = manifestData, .len = manifestBuffer.bytesUsed}, manifest);
+}
+
+static void set_generation(ObjectTransfer * transfer, uint64_t generation)
+{
+    uint64_t generationNBO = KineticNBO_FromHostU64(generation);
+    memcpy(transfer->generation, &generationNBO, sizeof(generationNBO));
+}
+
+/* Delete chunks [FIRST, END) of GENERATION of the object stored under KEY.
+ * Chunks that are already gone are not an error. */
+static KineticStatus delete_chunks(KineticSession * const session, ByteArray const key,
+                                   uint64_t generation, uint64_t first, uint64_t end,
+                                   KineticSynchronization synchronization,
+                                   KineticObjectConfig const * const config)
+{
+    ObjectTransfer * transfer = new_transfer(session, key, 0, max_in_flight(config));
+    if (transfer == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    transfer->writing = true;
+    transfer->deleting = true;
+    set_generation(transfer, generation);
+
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    for (uint64_t index = first; index < end; index++) {
+        ObjectChunk * chunk = next_free_chunk(transfer, &status);
+        if (chunk == NULL) { break; }
+
+        init_chunk_entry(transfer, chunk, index, 0);
+        chunk->entry.force = true;
+        chunk->entry.synchronization = synchronization;
+
+        status = start_chunk(transfer, chunk, KineticBuilder_BuildDelete);
+        if (status != KINETIC_STATUS_SUCCESS) { break; }
+    }
+
+    KineticStatus drained = drain_chunks(transfer);
+    if (status == KINETIC_STATUS_SUCCESS) { status = drained; }
+    free_transfer(transfer);
+    return status;
+}
+
+KineticStatus KineticObject_Put(KineticSession * const session, ByteArray const key,
+                                KineticObjectIO const * const io,
+                                KineticObjectConfig const * const config)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(io);
+    KINETIC_ASSERT(io->read);
+
+    KineticStatus status = check_key(key);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    size_t chunkSize = KINETIC_OBJ_SIZE;
+    KineticSynchronization synchronization = 0;
+    if (config != NULL) {
+        if (config->chunkSize > KINETIC_OBJ_SIZE) { return KINETIC_STATUS_INVALID_REQUEST; }
+        if (config->chunkSize > 0) { chunkSize = config->chunkSize; }
+        synchronization = config->synchronization;
+    }
+
+    ObjectTransfer * transfer = new_transfer(session, key, chunkSize, max_in_flight(config));
+    if (transfer == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    transfer->writing = true;
+    uint64_t const generation = new_generation();
+    set_generation(transfer, generation);
+
+    // Chunks are read in order but may complete in any order, so any free
+    // buffer takes the next one. They are keyed by generation, so the
+    // object being replaced stays whole until the new manifest is stored.
+    uint64_t length = 0;
+    uint64_t started = 0;
+    for (uint64_t index = 0;; index++) {
+        ObjectChunk * chunk = next_free_chunk(transfer, &status);
+        if (chunk == NULL) { break; }
+
+        ssize_t bytesRead = read_chunk(io, chunk->value, chunkSize);
+        if (bytesRead < 0) {
+            LOG1("Failed reading object data");
+            status = KINETIC_STATUS_INVALID_FILE;
+            break;
+        }
+        if (bytesRead == 0) { break; }
+        length += (uint64_t)bytesRead;
+
+        init_chunk_entry(transfer, chunk, index, chunkSize);
+        chunk->entry.value.bytesUsed = (size_t)bytesRead;
+        chunk->entry.newVersion = ByteBuffer_Create(transfer->generation,
+            sizeof(transfer->generation), sizeof(transfer->generation));
+        chunk->entry.force = true;
+        chunk->entry.synchronization = synchronization;
+
+        started = index + 1;
+        status = start_chunk(transfer, chunk, KineticBuilder_BuildPut);
+        if (status != KINETIC_STATUS_SUCCESS || (size_t)bytesRead < chunkSize) { break; }
+    }
+
+    KineticStatus drained = drain_chunks(transfer);
+    if (status == KINETIC_STATUS_SUCCESS) { status = drained; }
+    free_transfer(transfer);
+
+    // Note where the object being replaced, if any, is stored
+    KineticObjectManifest old = {.length = 0};
+    uint64_t oldCount = 0;
+    if (status == KINETIC_STATUS_SUCCESS) {
+        status = read_manifest(session, key, &old);
+        if (status == KINETIC_STATUS_SUCCESS) {
+            oldCount = KineticObject_ChunkCount(&old);
+        } else if (status == KINETIC_STATUS_NOT_FOUND || status == KINETIC_STATUS_DATA_ERROR) {
+            status = KINETIC_STATUS_SUCCESS;
+        }
+    }
+
+    // The manifest goes last, so it only ever describes stored data
+    KineticObjectManifest manifest = {
+        .length = length,
+        .chunkSize = (uint32_t)chunkSize,
+        .generation = generation,
+    };
+    bool const committing = (status == KINETIC_STATUS_SUCCESS);
+    if (committing) {
+        uint8_t manifestData[KINETIC_OBJECT_MANIFEST_LEN];
+        KineticObject_EncodeManifest(&manifest, manifestData);
+        ByteBuffer manifestBuffer = ByteBuffer_Create(manifestData,
+            sizeof(manifestData), sizeof(manifestData));
+        status = execute_manifest(session, key, &manifestBuffer,
+            synchronization, KineticBuilder_BuildPut);
+    }
+
+    // Once the manifest is stored, the replaced generation is no longer
+    // referenced; if it was never sent, this one is not. A manifest PUT
+    // that failed may still have been stored, so then both are kept.
+    // Failing to remove a generation is only logged.
+    uint64_t staleGeneration = generation;
+    uint64_t staleCount = 0;
+    if (status == KINETIC_STATUS_SUCCESS) {
+        staleGeneration = old.generation;
+        staleCount = (old.generation != generation) ? oldCount : 0;
+    } else if (!committing) {
+        staleCount = started;
+    }
+    if (staleCount > 0) {
+        KineticStatus deleted = delete_chunks(session, key, staleGeneration, 0, staleCount,
+            synchronization, config);
+        if (deleted != KINETIC_STATUS_SUCCESS) {
+            LOGF1("Failed deleting %llu stale object chunks w/status: %s",
+                (unsigned long long)staleCount, Kinetic_GetStatusDescription(deleted));
+        }
+    }
+
+    LOGF2("Object PUT of %llu bytes finished w/status: %s",
+        (unsigned long long)length, Kinetic_GetStatusDescription(status));
+    return status;
+}
+
+KineticStatus KineticObject_Get(KineticSession * const session, ByteArray const key,
+                                KineticObjectIO const * const io,
+                                KineticObjectConfig const * const config)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(io);
+    KINETIC_ASSERT(io->write);
+
+    KineticStatus status = check_key(key);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    KineticObjectManifest manifest;
+    status = read_manifest(session, key, &manifest);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+    uint64_t const count = KineticObject_ChunkCount(&manifest);
+
+    size_t buffers = max_in_flight(config);
+    if (count < buffers) { buffers = (count > 0) ? (size_t)count : 1; }
+    ObjectTransfer * transfer = new_transfer(session, key, manifest.chunkSize, buffers);
+    if (transfer == NULL) { return KINETIC_STATUS_MEMORY_ERROR; }
+    set_generation(transfer, manifest.generation);
+
+    // Chunk I lives in buffer I % bufferCount until it has been written
+    // out, so responses arriving out of order wait there for their turn
+    uint64_t issued = 0;
+    uint64_t delivered = 0;
+    while (delivered < count && status == KINETIC_STATUS_SUCCESS) {
+        while (issued < count && issued < delivered + transfer->bufferCount) {
+            ObjectChunk * chunk = &transfer->chunks[issued % transfer->bufferCount];
+            size_t len = (issued + 1 < count) ? manifest.chunkSize
+                : (size_t)(manifest.length - (count - 1) * manifest.chunkSize);
+            init_chunk_entry(transfer, chunk, issued, len);
+            status = start_chunk(transfer, chunk, KineticBuilder_BuildGet);
+            if (status != KINETIC_STATUS_SUCCESS) { break; }
+            issued++;
+        }
+        if (status != KINETIC_STATUS_SUCCESS) { break; }
+
+        ObjectChunk * chunk = &transfer->chunks[delivered % transfer->bufferCount];
+        pthread_mutex_lock(&transfer->mutex);
+        while (!chunk->done) {
+            pthread_cond_wait(&transfer->chunkDone, &transfer->mutex);
+        }
+        chunk->busy = false;
+        status = chunk->status;
+        pthread_mutex_unlock(&transfer->mutex);
+
+        // The generation's chunks are deleted once the object is
+        // overwritten, so a missing chunk may just mean that happened
+        // mid-read; a chunk of another generation should not be there
+        if (status == KINETIC_STATUS_NOT_FOUND) { status = KINETIC_STATUS_DATA_ERROR; }
+        if (status == KINETIC_STATUS_SUCCESS &&
+            (chunk->entry.dbVersion.bytesUsed != sizeof(transfer->generation) ||
+             memcmp(chunk->version, transfer->generation, sizeof(transfer->generation)) != 0 ||
+             chunk->entry.value.bytesUsed != chunk->entry.value.array.len)) {
+            status = KINETIC_STATUS_DATA_ERROR;
+        }
+        if (status == KINETIC_STATUS_SUCCESS &&
+            !io->write(io->context, chunk->value, chunk->entry.value.bytesUsed)) {
+            LOG1("Failed writing object data");
+            status = KINETIC_STATUS_INVALID_FILE;
+        }
+        delivered++;
+    }
+
+    (void)drain_chunks(transfer);
+    free_transfer(transfer);
+
+    LOGF2("Object GET of %llu bytes finished w/status: %s",
+        (unsigned long long)manifest.length, Kinetic_GetStatusDescription(status));
+    return status;
+}
+
+KineticStatus KineticObject_Delete(KineticSession * const session, ByteArray const key,
+                                   KineticObjectConfig const * const config)
+{
+    KINETIC_ASSERT(session);
+
+    KineticStatus status = check_key(key);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+
+    KineticSynchronization synchronization = (config != NULL) ? config->synchronization : 0;
+
+    KineticObjectManifest manifest;
+    status = read_manifest(session, key, &manifest);
+    if (status != KINETIC_STATUS_SUCCESS) { return status; }
+    uint64_t const count = KineticObject_ChunkCount(&manifest);
+
+    // The manifest goes first, so GET never finds an object missing chunks
+    ByteBuffer none = BYTE_BUFFER_NONE;
+    status = execute_manifest(session, key, &none, synchronization, KineticBuilder_BuildDelete);
+    if (status == KINETIC_STATUS_SUCCESS) {
+        status = delete_chunks(session, key, manifest.generation, 0, count,
+            synchronization, config);
+    }
+
+    LOGF2("Object DELETE of %llu chunks finished w/status: %s",
+        (unsigned long long)count, Kinetic_GetStatusDescription(status));
+    return status;
+}
+
+static ssize_t file_read(void * context, void * buf, size_t len)
+{
+    int fd = *(int *)context;
+    ssize_t n;
+    do {
+        n = read(fd, buf, len);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+static bool file_write(void * context, void const * buf, size_t len)
+{
+    int fd = *(int *)context;
+    uint8_t const * data = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) { continue; }
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+KineticObjectIO KineticObject_FileIO(int * const fd)
+{
+    KINETIC_ASSERT(fd);
+    return (KineticObjectIO) {
+        .read = file_read,
+        .write = file_write,
+        .context = fd,
+    };
+}
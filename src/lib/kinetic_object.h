@@ -0,0 +1,82 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_OBJECT_H
+#define _KINETIC_OBJECT_H
+
+#include "kinetic_types_internal.h"
+
+/* Large objects, streamed in chunks of at most KINETIC_OBJ_SIZE bytes.
+ * An object stored under KEY is laid out as:
+ *   KEY                                 - the manifest, written last on PUT
+ *   KEY 0x00 <gen, BE64> <index, BE64>  - chunk INDEX of generation GEN
+ * so the chunks sort immediately after the manifest. Every chunk and the
+ * manifest carry a CRC32 tag, which GET verifies. Each PUT picks a new
+ * generation and writes its chunks beside the previous generation's, then
+ * stores the manifest naming it, and only then deletes the previous
+ * generation. The generation is also stored as the version of every
+ * chunk. */
+
+#define KINETIC_OBJECT_MANIFEST_LEN (32)
+#define KINETIC_OBJECT_CHUNK_KEY_SUFFIX_LEN (1 + 2 * sizeof(uint64_t))
+
+typedef struct {
+    uint64_t length;     // Total bytes in the object
+    uint32_t chunkSize;  // Bytes in every chunk but the last
+    uint64_t generation; // Version every chunk was stored with
+} KineticObjectManifest;
+
+/* Serialize MANIFEST into BUF. */
+void KineticObject_EncodeManifest(KineticObjectManifest const * const manifest,
+                                  uint8_t buf[KINETIC_OBJECT_MANIFEST_LEN]);
+
+/* Parse a stored manifest. Returns KINETIC_STATUS_DATA_ERROR if DATA is
+ * not a manifest this version can read. */
+KineticStatus KineticObject_DecodeManifest(ByteArray const data,
+                                           KineticObjectManifest * const manifest);
+
+/* Number of chunks the object described by MANIFEST is stored in. */
+uint64_t KineticObject_ChunkCount(KineticObjectManifest const * const manifest);
+
+/* Store everything IO's reader returns under KEY, keeping up to
+ * CONFIG->maxInFlight chunk PUTs outstanding. The chunks of an object
+ * previously stored under KEY are deleted once the new manifest is
+ * stored. CONFIG may be NULL. */
+KineticStatus KineticObject_Put(KineticSession * const session, ByteArray const key,
+                                KineticObjectIO const * const io,
+                                KineticObjectConfig const * const config);
+
+/* Retrieve the object stored under KEY, handing its data to IO's writer
+ * in order, keeping up to CONFIG->maxInFlight chunk GETs outstanding.
+ * CONFIG may be NULL. */
+KineticStatus KineticObject_Get(KineticSession * const session, ByteArray const key,
+                                KineticObjectIO const * const io,
+                                KineticObjectConfig const * const config);
+
+/* Delete the object stored under KEY: its manifest, then its chunks,
+ * keeping up to CONFIG->maxInFlight chunk DELETEs outstanding. CONFIG may
+ * be NULL. */
+KineticStatus KineticObject_Delete(KineticSession * const session, ByteArray const key,
+                                   KineticObjectConfig const * const config);
+
+/* An IO that reads from or writes to the file descriptor *FD. */
+KineticObjectIO KineticObject_FileIO(int * const fd);
+
+#endif // _KINETIC_OBJECT_H
@@ -27,10 +27,12 @@
 #include "kinetic_allocator.h"
 #include "kinetic_logger.h"
 #include "kinetic_request.h"
+#include "kinetic_completion_queue.h"
 
 #include <stdlib.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <time.h>
 #include <stdio.h>
 
 #include "kinetic_acl.h"
@@ -50,20 +52,8 @@ void KineticOperation_ValidateOperation(KineticOperation* op)
     KINETIC_ASSERT(op->request->command->header->has_sequence);
 }
 
-static KineticStatus send_request_in_lock(KineticOperation* const op);
-
-KineticStatus KineticOperation_SendRequest(KineticOperation* const op)
-{
-    KineticSession *session = op->session;
-    KineticOperation_ValidateOperation(op);
-    
-    if (!KineticRequest_LockSend(session)) {
-        return KINETIC_STATUS_CONNECTION_ERROR;
-    }
-    KineticStatus status = send_request_in_lock(op);
-    KineticRequest_UnlockSend(session);
-    return status;
-}
+static KineticStatus pack_request(KineticOperation* const op, uint8_t **msg, size_t *msgSize);
+static KineticStatus send_request_in_turn(KineticOperation* const op, uint8_t *msg, size_t msgSize);
 
 static void log_request_seq_id(int fd, int64_t seq_id, KineticMessageType mt)
 {
@@ -86,45 +76,191 @@ static void log_request_seq_id(int fd, int64_t seq_id, KineticMessageType mt)
 }
 
 /* Send request.
- * Note: This whole function operates with op->session->sendMutex locked. */
-static KineticStatus send_request_in_lock(KineticOperation* const op)
+ * The sequence ID is reserved atomically, and the request is packed and
+ * signed on the calling thread without holding any lock, so concurrent
+ * callers on one session pack in parallel. Only the hand-off to the bus
+ * is serialized, in sequence ID order, so the device still sees
+ * sequence IDs in increasing order. */
+KineticStatus KineticOperation_SendRequest(KineticOperation* const op)
 {
-    LOGF3("\nSending PDU via fd=%d", op->session->socket);
+    KineticOperation_ValidateOperation(op);
+    KineticSession *session = op->session;
     KineticRequest* request = op->request;
 
-    int64_t seq_id = KineticSession_GetNextSequenceCount(op->session);
+    /* Take a count before reserving a sequence ID. Otherwise a caller
+     * holding a later ID could take the last count while we wait, then
+     * block on our turn forever. */
+    KineticCountingSemaphore * const sem = session->outstandingOperations;
+    KineticCountingSemaphore_Take(sem);  // limit total concurrent requests
+
+    int64_t seq_id = KineticSession_GetNextSequenceCount(session);
     KINETIC_ASSERT(request->message.header.sequence == KINETIC_SEQUENCE_NOT_YET_BOUND);
     request->message.header.sequence = seq_id;
 
+    #ifndef TEST
+    uint8_t * msg = NULL;
+    size_t msgSize = 0;
+    #endif
+    KineticStatus status = pack_request(op, &msg, &msgSize);
+
+    /* Every reserved sequence ID takes its turn, even if packing failed,
+     * so that later requests are not held up behind it. */
+    if (!KineticRequest_LockSend(session, seq_id)) {
+        KineticRequest_SkipSend(session, seq_id);
+        if (msg != NULL) { free(msg); }
+        KineticCountingSemaphore_Give(sem);
+        return KINETIC_STATUS_CONNECTION_ERROR;
+    }
+    if (status == KINETIC_STATUS_SUCCESS) {
+        status = send_request_in_turn(op, msg, msgSize);
+    }
+    KineticRequest_UnlockSend(session, seq_id);
+
+    if (status != KINETIC_STATUS_SUCCESS) {
+        KineticCountingSemaphore_Give(sem);
+    }
+    if (msg != NULL) { free(msg); }
+    return status;
+}
+
+/* Send a run of requests, taking each run's counts, sequence IDs and turn
+ * at the send lock together rather than once per request. A run is as
+ * many requests (up to KINETIC_OPERATION_MAX_BATCH) as there are counts
+ * free once at least one is; like SendRequest, a caller never waits for
+ * counts while holding others, or for its turn before taking its counts. */
+static void send_run(KineticOperation* const ops[], KineticStatus statuses[], size_t count);
+
+void KineticOperation_SendRequests(KineticOperation* const ops[],
+                                   KineticStatus statuses[], size_t count)
+{
+    KINETIC_ASSERT(ops != NULL);
+    KINETIC_ASSERT(statuses != NULL);
+
+    size_t sent = 0;
+    while (sent < count) {
+        size_t wanted = count - sent;
+        if (wanted > KINETIC_OPERATION_MAX_BATCH) { wanted = KINETIC_OPERATION_MAX_BATCH; }
+        KineticCountingSemaphore * const sem = ops[sent]->session->outstandingOperations;
+        size_t n = KineticCountingSemaphore_TakeUpTo(sem, (uint32_t)wanted);
+        send_run(&ops[sent], &statuses[sent], n);
+        sent += n;
+    }
+}
+
+/* Pack and sign a run of requests, signing them all together, and pack
+ * each full PDU into a new buffer. Runs without the send lock held. */
+static void pack_requests(KineticOperation* const ops[], KineticStatus statuses[],
+                          uint8_t *msgs[], size_t msgSizes[], size_t count)
+{
+    KineticSession *session = ops[0]->session;
+    KineticRequest *toSign[KINETIC_OPERATION_MAX_BATCH];
+    uint8_t *commandData[KINETIC_OPERATION_MAX_BATCH];
+    size_t signCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        commandData[i] = NULL;
+        if (KineticRequest_PackCommand(ops[i]->request) == KINETIC_REQUEST_PACK_FAILURE) {
+            statuses[i] = KINETIC_STATUS_MEMORY_ERROR;
+            continue;
+        }
+        commandData[i] = ops[i]->request->message.message.commandbytes.data;
+        statuses[i] = KINETIC_STATUS_SUCCESS;
+        toSign[signCount++] = ops[i]->request;
+    }
+
+    KineticStatus status = KINETIC_STATUS_SUCCESS;
+    if (signCount > 0) {
+        status = KineticRequest_PopulateAuthenticationBatch(&session->config, toSign, signCount);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (statuses[i] == KINETIC_STATUS_SUCCESS) {
+            statuses[i] = (status == KINETIC_STATUS_SUCCESS)
+                ? KineticRequest_PackMessage(ops[i], &msgs[i], &msgSizes[i])
+                : status;
+        }
+        if (commandData[i]) { free(commandData[i]); }
+    }
+}
+
+static void send_run(KineticOperation* const ops[], KineticStatus statuses[], size_t count)
+{
+    KineticSession *session = ops[0]->session;
+    int64_t first_seq_id = KineticSession_GetNextSequenceCounts(session, count);
+    for (size_t i = 0; i < count; i++) {
+        KineticOperation_ValidateOperation(ops[i]);
+        KINETIC_ASSERT(ops[i]->session == session);
+        KINETIC_ASSERT(ops[i]->pin == NULL);
+        KINETIC_ASSERT(ops[i]->request->message.header.sequence == KINETIC_SEQUENCE_NOT_YET_BOUND);
+        ops[i]->request->message.header.sequence = first_seq_id + (int64_t)i;
+    }
+
+    uint8_t *msgs[KINETIC_OPERATION_MAX_BATCH] = {NULL};
+    size_t msgSizes[KINETIC_OPERATION_MAX_BATCH] = {0};
+    pack_requests(ops, statuses, msgs, msgSizes, count);
+
+    /* The whole run goes out in the first sequence ID's turn. Its turns
+     * are passed on even if none of it could be packed or sent, so later
+     * requests are not held up behind it. */
+    if (KineticRequest_LockSend(session, first_seq_id)) {
+        for (size_t i = 0; i < count; i++) {
+            if (statuses[i] == KINETIC_STATUS_SUCCESS) {
+                statuses[i] = send_request_in_turn(ops[i], msgs[i], msgSizes[i]);
+            }
+        }
+        KineticRequest_UnlockSendRun(session, first_seq_id, count);
+    }
+    else {
+        KineticRequest_SkipSendRun(session, first_seq_id, count);
+        for (size_t i = 0; i < count; i++) {
+            statuses[i] = KINETIC_STATUS_CONNECTION_ERROR;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (statuses[i] != KINETIC_STATUS_SUCCESS) {
+            KineticCountingSemaphore_Give(session->outstandingOperations);
+        }
+        if (msgs[i] != NULL) { free(msgs[i]); }
+    }
+}
+
+/* Pack the command, sign it, and pack the full PDU into a new buffer.
+ * Runs without the session send lock held. */
+static KineticStatus pack_request(KineticOperation* const op, uint8_t **msg, size_t *msgSize)
+{
+    KineticRequest* request = op->request;
+    KineticSession *session = op->session;
+
     size_t expectedLen = KineticRequest_PackCommand(request);
     if (expectedLen == KINETIC_REQUEST_PACK_FAILURE) {
         return KINETIC_STATUS_MEMORY_ERROR;
     }
     uint8_t * commandData = request->message.message.commandbytes.data;
 
-    log_request_seq_id(op->session->socket, seq_id, request->message.header.messagetype);
-
-    KineticSession *session = op->session;
     KineticStatus status = KineticRequest_PopulateAuthentication(&session->config,
         op->request, op->pin);
-    if (status != KINETIC_STATUS_SUCCESS) {
-        if (commandData) { free(commandData); }
-        return status;        
-    }
-
-    #ifndef TEST
-    uint8_t * msg = NULL;
-    size_t msgSize = 0;
-    #endif
-    status = KineticRequest_PackMessage(op, &msg, &msgSize);
-    if (status != KINETIC_STATUS_SUCCESS) {
-        if (commandData) { free(commandData); }
-        return status;
+    if (status == KINETIC_STATUS_SUCCESS) {
+        status = KineticRequest_PackMessage(op, msg, msgSize);
     }
 
     if (commandData) { free(commandData); }
-    KineticCountingSemaphore * const sem = op->session->outstandingOperations;
-    KineticCountingSemaphore_Take(sem);  // limit total concurrent requests
+    return status;
+}
+
+/* Hand the packed request to the bus.
+ * Note: This operates with op->session->sendMutex locked, on this
+ * request's turn. */
+static KineticStatus send_request_in_turn(KineticOperation* const op, uint8_t *msg, size_t msgSize)
+{
+    KineticRequest* request = op->request;
+    int64_t seq_id = request->message.header.sequence;
+    LOGF3("\nSending PDU via fd=%d", op->session->socket);
+    log_request_seq_id(op->session->socket, seq_id, request->message.header.messagetype);
+
+    if (op->session->window != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &op->sendTime);
+    }
 
     if (!KineticRequest_SendRequest(op, msg, msgSize)) {
         LOGF0("Failed queuing request %p for transmit on fd=%d w/seq=%lld",
@@ -133,14 +269,9 @@ static KineticStatus send_request_in_lock(KineticOperation* const op)
          * rejected outright, so the usual asynchronous, callback-based
          * error handling for errors during the request or response will
          * not be used. */
-        KineticCountingSemaphore_Give(sem);
-        status = KINETIC_STATUS_REQUEST_REJECTED;
-    } else {
-        status = KINETIC_STATUS_SUCCESS;
+        return KINETIC_STATUS_REQUEST_REJECTED;
     }
-
-    if (msg != NULL) { free(msg); }
-    return status;
+    return KINETIC_STATUS_SUCCESS;
 }
 
 KineticStatus KineticOperation_GetStatus(const KineticOperation* const op)
@@ -152,6 +283,24 @@ KineticStatus KineticOperation_GetStatus(const KineticOperation* const op)
     return status;
 }
 
+static void update_window(KineticOperation* op, KineticStatus status)
+{
+    KineticSession * const session = op->session;
+    struct timespec now;
+    int64_t latencyUsec = 0;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0 && op->sendTime.tv_sec != 0) {
+        latencyUsec = (int64_t)(now.tv_sec - op->sendTime.tv_sec) * 1000000 +
+            (now.tv_nsec - op->sendTime.tv_nsec) / 1000;
+    }
+
+    /* Timeouts are treated like DEVICE_BUSY: either way the device is
+     * not keeping up with the current window. */
+    bool busy = (status == KINETIC_STATUS_DEVICE_BUSY ||
+                 status == KINETIC_STATUS_OPERATION_TIMEDOUT);
+    uint32_t limit = KineticWindow_Update(session->window, latencyUsec, busy);
+    KineticCountingSemaphore_SetLimit(session->outstandingOperations, limit);
+}
+
 void KineticOperation_Complete(KineticOperation* op, KineticStatus status)
 {
     KINETIC_ASSERT(op);
@@ -160,10 +309,19 @@ void KineticOperation_Complete(KineticOperation* op, KineticStatus status)
     // ExecuteOperation should ensure a callback exists (either a user supplied one, or the a default)
     KineticCompletionData completionData = {.status = status};
 
+    // Resize the adaptive window before giving back the count, so a shrink
+    // takes effect before anyone blocked on the old limit is woken
+    if (op->session->window != NULL) {
+        update_window(op, status);
+    }
+
     // Release this request so that others can be unblocked if at max (request PDUs throttled)
     KineticCountingSemaphore_Give(op->session->outstandingOperations);
 
-    if(op->closure.callback != NULL) {
+    if (op->closure.queue != NULL) {
+        KineticCompletionQueue_Push(op->closure.queue, op->closure.clientData, status);
+    }
+    else if(op->closure.callback != NULL) {
         op->closure.callback(&completionData, op->closure.clientData);
     }
 
@@ -25,6 +25,16 @@
 
 void KineticOperation_ValidateOperation(KineticOperation* op);
 KineticStatus KineticOperation_SendRequest(KineticOperation* const op);
+
+/* Most requests packed, signed and handed to the bus together by
+ * KineticOperation_SendRequests. */
+#define KINETIC_OPERATION_MAX_BATCH (16)
+
+/* Send COUNT HMAC-authenticated requests on one session, in order, storing
+ * each one's send status in STATUSES. As with SendRequest, a request that
+ * failed to send will not be completed. */
+void KineticOperation_SendRequests(KineticOperation* const ops[],
+                                   KineticStatus statuses[], size_t count);
 KineticStatus KineticOperation_GetStatus(const KineticOperation* const op);
 void KineticOperation_Complete(KineticOperation* op, KineticStatus status);
 
@@ -29,3 +29,172 @@ Com__Seagate__Kinetic__Proto__Message* KineticPDU_unpack_message(ProtobufCAlloca
         size_t len, const uint8_t* data) {
     return com__seagate__kinetic__proto__message__unpack(allocator, len, data);
 }
+
+/* Field numbers and wire types used by KineticPDU_unpack_summary, from
+ * kinetic.proto. */
+enum {
+    MESSAGE_AUTH_TYPE = 4,
+    MESSAGE_COMMAND_BYTES = 7,
+    COMMAND_HEADER = 1,
+    COMMAND_STATUS = 3,
+    HEADER_CONNECTION_ID = 3,
+    HEADER_ACK_SEQUENCE = 6,
+    STATUS_CODE = 1,
+};
+
+enum {
+    WIRETYPE_VARINT = 0,
+    WIRETYPE_64BIT = 1,
+    WIRETYPE_LENGTH_PREFIXED = 2,
+    WIRETYPE_32BIT = 5,
+};
+
+typedef struct {
+    const uint8_t* data;
+    const uint8_t* end;
+} wire_reader;
+
+typedef struct {
+    uint32_t number;
+    int wireType;
+    uint64_t varint;            // for WIRETYPE_VARINT
+    wire_reader nested;         // for WIRETYPE_LENGTH_PREFIXED
+} wire_field;
+
+static bool read_varint(wire_reader* r, uint64_t* out)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64 && r->data < r->end; shift += 7) {
+        uint8_t b = *r->data++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Read the next field, skipping its payload unless it is a varint or
+ * length-prefixed. Returns false at the end of input or on bad input;
+ * *ok tells the two apart. */
+static bool next_field(wire_reader* r, wire_field* f, bool* ok)
+{
+    *ok = true;
+    if (r->data == r->end) { return false; }
+    *ok = false;
+
+    uint64_t key;
+    if (!read_varint(r, &key) || (key >> 3) == 0 || (key >> 3) > UINT32_MAX) { return false; }
+    f->number = (uint32_t)(key >> 3);
+    f->wireType = (int)(key & 0x07);
+
+    uint64_t len;
+    switch (f->wireType) {
+    case WIRETYPE_VARINT:
+        if (!read_varint(r, &f->varint)) { return false; }
+        break;
+    case WIRETYPE_64BIT:
+    case WIRETYPE_32BIT:
+        len = (f->wireType == WIRETYPE_64BIT) ? 8 : 4;
+        if ((uint64_t)(r->end - r->data) < len) { return false; }
+        r->data += len;
+        break;
+    case WIRETYPE_LENGTH_PREFIXED:
+        if (!read_varint(r, &len) || (uint64_t)(r->end - r->data) < len) { return false; }
+        f->nested = (wire_reader){.data = r->data, .end = r->data + len};
+        r->data += len;
+        break;
+    default:
+        return false;   // groups are not used by kinetic.proto
+    }
+    *ok = true;
+    return true;
+}
+
+/* A known field with an unexpected wire type fails the full unpack too. */
+#define EXPECT_WIRETYPE(F, T) if ((F).wireType != (T)) { return false; }
+
+static bool unpack_header_summary(wire_reader r, KineticResponseSummary* summary)
+{
+    wire_field f;
+    bool ok;
+    while (next_field(&r, &f, &ok)) {
+        if (f.number == HEADER_ACK_SEQUENCE) {
+            EXPECT_WIRETYPE(f, WIRETYPE_VARINT);
+            summary->ackSequence = (int64_t)f.varint;
+        } else if (f.number == HEADER_CONNECTION_ID) {
+            EXPECT_WIRETYPE(f, WIRETYPE_VARINT);
+            summary->connectionID = (int64_t)f.varint;
+        }
+    }
+    return ok;
+}
+
+static bool unpack_status_summary(wire_reader r, KineticResponseSummary* summary)
+{
+    wire_field f;
+    bool ok;
+    while (next_field(&r, &f, &ok)) {
+        if (f.number == STATUS_CODE) {
+            EXPECT_WIRETYPE(f, WIRETYPE_VARINT);
+            summary->hasStatusCode = true;
+            summary->statusCode = (Com__Seagate__Kinetic__Proto__Command__Status__StatusCode)(int32_t)f.varint;
+        }
+    }
+    return ok;
+}
+
+static bool unpack_command_summary(wire_reader r, KineticResponseSummary* summary)
+{
+    wire_field f;
+    bool ok;
+    while (next_field(&r, &f, &ok)) {
+        // Repeated occurrences of a message field are merged, so each
+        // one is scanned in turn and later scalars win.
+        if (f.number == COMMAND_HEADER) {
+            EXPECT_WIRETYPE(f, WIRETYPE_LENGTH_PREFIXED);
+            summary->hasHeader = true;
+            if (!unpack_header_summary(f.nested, summary)) { return false; }
+        } else if (f.number == COMMAND_STATUS) {
+            EXPECT_WIRETYPE(f, WIRETYPE_LENGTH_PREFIXED);
+            if (!unpack_status_summary(f.nested, summary)) { return false; }
+        }
+    }
+    return ok;
+}
+
+static bool unpack_message_summary(wire_reader r, KineticResponseSummary* summary)
+{
+    wire_reader command = {.data = NULL, .end = NULL};
+    wire_field f;
+    bool ok;
+    while (next_field(&r, &f, &ok)) {
+        if (f.number == MESSAGE_AUTH_TYPE) {
+            EXPECT_WIRETYPE(f, WIRETYPE_VARINT);
+            summary->hasAuthType = true;
+            summary->authType = (Com__Seagate__Kinetic__Proto__Message__AuthType)(int32_t)f.varint;
+        } else if (f.number == MESSAGE_COMMAND_BYTES) {
+            EXPECT_WIRETYPE(f, WIRETYPE_LENGTH_PREFIXED);
+            command = f.nested;     // last one wins, as for any bytes field
+        }
+    }
+    if (!ok) { return false; }
+
+    // Empty command bytes are not unpacked, so there is no header
+    if (command.data == command.end) { return true; }
+    return unpack_command_summary(command, summary);
+}
+
+bool KineticPDU_unpack_summary(size_t len, const uint8_t* data,
+    KineticResponseSummary* summary)
+{
+    *summary = (KineticResponseSummary){.hasAuthType = false};
+    if (len == 0) { return true; }
+    wire_reader r = {.data = data, .end = data + len};
+    if (!unpack_message_summary(r, summary)) {
+        *summary = (KineticResponseSummary){.hasAuthType = false};
+        return false;
+    }
+    return true;
+}
@@ -22,6 +22,7 @@
 #define KINETIC_PDU_UNPACK_H
 
 #include "kinetic.pb-c.h"
+#include "kinetic_types_internal.h"
 
 /* This wrapper only exists for mocking purposes. */
 Com__Seagate__Kinetic__Proto__Command *KineticPDU_unpack_command(ProtobufCAllocator* allocator,
@@ -30,4 +31,10 @@ Com__Seagate__Kinetic__Proto__Command *KineticPDU_unpack_command(ProtobufCAlloca
 Com__Seagate__Kinetic__Proto__Message* KineticPDU_unpack_message(ProtobufCAllocator* allocator,
     size_t len, const uint8_t* data);
 
+/* Read the fields needed to route a response (auth type, ack sequence,
+ * connection ID, status code) straight from the packed message, without
+ * unpacking it. Returns false if the bytes can't be parsed. */
+bool KineticPDU_unpack_summary(size_t len, const uint8_t* data,
+    KineticResponseSummary* summary);
+
 #endif
@@ -25,6 +25,7 @@
 #include "kinetic_auth.h"
 #include "kinetic_nbo.h"
 #include "kinetic_controller.h"
+#include "kinetic_encoder.h"
 #include "byte_array.h"
 #include "bus.h"
 
@@ -35,7 +36,10 @@ uint8_t *msg = NULL;
 
 size_t KineticRequest_PackCommand(KineticRequest* request)
 {
-    size_t expectedLen = com__seagate__kinetic__proto__command__get_packed_size(&request->message.command);
+    Com__Seagate__Kinetic__Proto__Command* command = &request->message.command;
+    bool direct = KineticEncoder_CanPackCommand(command);
+    size_t expectedLen = direct ? KineticEncoder_CommandSize(command, request->encoderTemplate)
+        : com__seagate__kinetic__proto__command__get_packed_size(command);
     #ifndef TEST
     uint8_t *cmdBuf = (uint8_t*)malloc(expectedLen);
     #endif
@@ -46,8 +50,8 @@ size_t KineticRequest_PackCommand(KineticRequest* request)
     }
     request->message.message.commandbytes.data = cmdBuf;
 
-    size_t packedLen = com__seagate__kinetic__proto__command__pack(
-        &request->message.command, cmdBuf);
+    size_t packedLen = direct ? KineticEncoder_PackCommand(command, request->encoderTemplate, cmdBuf)
+        : com__seagate__kinetic__proto__command__pack(command, cmdBuf);
     KINETIC_ASSERT(packedLen == expectedLen);
     request->message.message.commandbytes.len = packedLen;
     request->message.message.has_commandbytes = true;
@@ -69,14 +73,23 @@ KineticStatus KineticRequest_PopulateAuthentication(KineticSessionConfig *config
     }
 }
 
+KineticStatus KineticRequest_PopulateAuthenticationBatch(KineticSessionConfig *config,
+    KineticRequest * const requests[], size_t count)
+{
+    return KineticAuth_PopulateHmacBatch(config, requests, count);
+}
+
 KineticStatus KineticRequest_PackMessage(KineticOperation *operation,
     uint8_t **out_msg, size_t *msgSize)
 {
     // Configure PDU header
     Com__Seagate__Kinetic__Proto__Message* proto = &operation->request->message.message;
+    KineticEncoderTemplate const * tmpl = operation->request->encoderTemplate;
+    bool direct = KineticEncoder_CanPackMessage(proto);
     KineticPDUHeader header = {
         .versionPrefix = 'F',
-        .protobufLength = com__seagate__kinetic__proto__message__get_packed_size(proto)
+        .protobufLength = direct ? KineticEncoder_MessageSize(proto, tmpl)
+            : com__seagate__kinetic__proto__message__get_packed_size(proto)
     };
     header.valueLength = operation->value.len;
     uint32_t nboProtoLength = KineticNBO_FromHostU32(header.protobufLength);
@@ -100,7 +113,8 @@ KineticStatus KineticRequest_PackMessage(KineticOperation *operation,
     offset += sizeof(nboProtoLength);
     memcpy(&msg[offset], &nboValueLength, sizeof(nboValueLength));
     offset += sizeof(nboValueLength);
-    size_t len = com__seagate__kinetic__proto__message__pack(&request->message.message, &msg[offset]);
+    size_t len = direct ? KineticEncoder_PackMessage(proto, tmpl, &msg[offset])
+        : com__seagate__kinetic__proto__message__pack(proto, &msg[offset]);
     KINETIC_ASSERT(len == header.protobufLength);
     offset += header.protobufLength;
 
@@ -143,18 +157,54 @@ bool KineticRequest_SendRequest(KineticOperation *operation,
         .cb       = KineticController_HandleResult,
         .udata    = operation,
         .timeout_sec = operation->timeoutSeconds,
+        .inline_cb = operation->completeInline,
     };
     return Bus_SendRequest(operation->session->messageBus, &bus_msg);
 }
 
-bool KineticRequest_LockSend(KineticSession* session)
+bool KineticRequest_LockSend(KineticSession* session, int64_t seq_id)
 {
     KINETIC_ASSERT(session);
-    return 0 == pthread_mutex_lock(&session->sendMutex);
+    if (0 != pthread_mutex_lock(&session->sendMutex)) { return false; }
+    while (session->nextSendSequence != seq_id) {
+        pthread_cond_wait(&session->sendTurn, &session->sendMutex);
+    }
+    return true;
 }
 
-bool KineticRequest_UnlockSend(KineticSession* session)
+bool KineticRequest_UnlockSend(KineticSession* session, int64_t seq_id)
+{
+    return KineticRequest_UnlockSendRun(session, seq_id, 1);
+}
+
+bool KineticRequest_UnlockSendRun(KineticSession* session, int64_t first_seq_id, size_t count)
 {
     KINETIC_ASSERT(session);
+    KINETIC_ASSERT(count > 0);
+    KINETIC_ASSERT(session->nextSendSequence == first_seq_id);
+    session->nextSendSequence = first_seq_id + (int64_t)count;
+    pthread_cond_broadcast(&session->sendTurn);
     return 0 == pthread_mutex_unlock(&session->sendMutex);
 }
+
+void KineticRequest_SkipSend(KineticSession* session, int64_t seq_id)
+{
+    KineticRequest_SkipSendRun(session, seq_id, 1);
+}
+
+void KineticRequest_SkipSendRun(KineticSession* session, int64_t first_seq_id, size_t count)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(count > 0);
+
+    if (0 != pthread_mutex_lock(&session->sendMutex)) {
+        LOGF0("Failed to pass on send turns from sequence ID %lld", (long long)first_seq_id);
+        return;
+    }
+    while (session->nextSendSequence != first_seq_id) {
+        pthread_cond_wait(&session->sendTurn, &session->sendMutex);
+    }
+    session->nextSendSequence = first_seq_id + (int64_t)count;
+    pthread_cond_broadcast(&session->sendTurn);
+    pthread_mutex_unlock(&session->sendMutex);
+}
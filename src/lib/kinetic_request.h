@@ -35,6 +35,10 @@ size_t KineticRequest_PackCommand(KineticRequest* request);
 KineticStatus KineticRequest_PopulateAuthentication(KineticSessionConfig *config,
     KineticRequest *request, ByteArray *pin);
 
+/* Populate HMAC authentication for COUNT requests, signing them together. */
+KineticStatus KineticRequest_PopulateAuthenticationBatch(KineticSessionConfig *config,
+    KineticRequest * const requests[], size_t count);
+
 /* Pack the header, command, and value (if any), allocating a buffer and
  * returning the buffer and its size in *msg and *msgSize.
  * Returns KINETIC_STATUS_SUCCESS on success, or KINETIC_STATUS_MEMORY_ERROR
@@ -49,7 +53,25 @@ KineticStatus KineticRequest_PackMessage(KineticOperation *operation,
 bool KineticRequest_SendRequest(KineticOperation *operation,
     uint8_t *msg, size_t msgSize);
 
-bool KineticRequest_LockSend(KineticSession* session);
-bool KineticRequest_UnlockSend(KineticSession* session);
+/* Lock the session for sending, waiting until every request with an
+ * earlier sequence ID has had its turn. */
+bool KineticRequest_LockSend(KineticSession* session, int64_t seq_id);
+
+/* End SEQ_ID's turn and unlock, letting the next sequence ID send. */
+bool KineticRequest_UnlockSend(KineticSession* session, int64_t seq_id);
+
+/* End the turns of COUNT consecutive sequence IDs from FIRST_SEQ_ID, all
+ * sent under one KineticRequest_LockSend(FIRST_SEQ_ID), and unlock. */
+bool KineticRequest_UnlockSendRun(KineticSession* session, int64_t first_seq_id, size_t count);
+
+/* Give up SEQ_ID's turn when the send lock could not be taken: try the
+ * lock again, wait for the turn, and pass it on without sending, so that
+ * later sequence IDs are not held up behind a request that will never be
+ * sent. */
+void KineticRequest_SkipSend(KineticSession* session, int64_t seq_id);
+
+/* As KineticRequest_SkipSend, for the COUNT turns of a run from
+ * FIRST_SEQ_ID. */
+void KineticRequest_SkipSendRun(KineticSession* session, int64_t first_seq_id, size_t count);
 
 #endif
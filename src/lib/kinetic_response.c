@@ -29,6 +29,7 @@
 #include "kinetic_allocator.h"
 #include "kinetic_controller.h"
 #include "kinetic_pdu_unpack.h"
+#include "kinetic_arena.h"
 
 #include <time.h>
 
@@ -44,17 +45,53 @@ uint32_t KineticResponse_GetValueLength(KineticResponse * response)
     return response->header.valueLength;
 }
 
+/* Unpack the message and the command inside it into one arena, so they
+ * are freed together. If no arena can be had, unpack with the default
+ * allocator. The hint covers the command bytes being copied once per
+ * unpack, plus the structs. Responses built without packed bytes are
+ * taken as already unpacked. */
+static void unpack_on_demand(KineticResponse * response)
+{
+    if (response->unpacked || response->protoBytes == NULL) { return; }
+    response->unpacked = true;
+
+    size_t len = response->header.protobufLength;
+    response->arena = KineticArena_Take(2 * len + 1024);
+    ProtobufCAllocator * allocator = KineticArena_Allocator(response->arena);
+
+    response->proto = KineticPDU_unpack_message(allocator, len, response->protoBytes);
+    if (response->proto != NULL &&
+        response->proto->has_commandbytes &&
+        response->proto->commandbytes.data != NULL &&
+        response->proto->commandbytes.len > 0)
+    {
+        response->command = KineticPDU_unpack_command(allocator,
+            response->proto->commandbytes.len, response->proto->commandbytes.data);
+    }
+}
+
+Com__Seagate__Kinetic__Proto__Message* KineticResponse_GetMessage(KineticResponse * response)
+{
+    KINETIC_ASSERT(response);
+    unpack_on_demand(response);
+    return response->proto;
+}
+
+Com__Seagate__Kinetic__Proto__Command* KineticResponse_GetCommand(KineticResponse * response)
+{
+    KINETIC_ASSERT(response);
+    unpack_on_demand(response);
+    return response->command;
+}
+
 KineticStatus KineticResponse_GetStatus(KineticResponse * response)
 {
     KineticStatus status = KINETIC_STATUS_INVALID;
 
-    if (response != NULL &&
-        response->command != NULL &&
-        response->command->status != NULL &&
-        response->command->status->has_code != false)
+    if (response != NULL && response->summary.hasStatusCode)
     {
         status = KineticProtoStatusCode_to_KineticStatus(
-            response->command->status->code);
+            response->summary.statusCode);
     }
 
     return status;
@@ -64,13 +101,11 @@ int64_t KineticResponse_GetConnectionID(KineticResponse * response)
 {
     int64_t id = 0;
     KINETIC_ASSERT(response);
-    KINETIC_ASSERT(response->proto);
-    if (response->proto->authtype == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS &&
-        response->command != NULL &&
-        response->command->header != NULL &&
-        response->command->header->has_connectionid)
+    if (response->summary.hasAuthType &&
+        response->summary.authType == COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS &&
+        response->summary.hasHeader)
     {
-        id = response->command->header->connectionid;
+        id = response->summary.connectionID;
     }
     return id;
 }
@@ -80,7 +115,7 @@ Com__Seagate__Kinetic__Proto__Command__KeyValue* KineticResponse_GetKeyValue(Kin
     Com__Seagate__Kinetic__Proto__Command__KeyValue* keyValue = NULL;
 
     if (response != NULL &&
-        response->command != NULL &&
+        KineticResponse_GetCommand(response) != NULL &&
         response->command->body != NULL)
     {
         keyValue = response->command->body->keyvalue;
@@ -92,8 +127,7 @@ Com__Seagate__Kinetic__Proto__Command__Range* KineticResponse_GetKeyRange(Kineti
 {
     Com__Seagate__Kinetic__Proto__Command__Range* range = NULL;
     if (response != NULL &&
-        response->proto != NULL &&
-        response->command != NULL &&
+        KineticResponse_GetCommand(response) != NULL &&
         response->command->body != NULL)
     {
         range = response->command->body->range;
@@ -25,6 +25,12 @@
 
 uint32_t KineticResponse_GetProtobufLength(KineticResponse * response);
 uint32_t KineticResponse_GetValueLength(KineticResponse * response);
+
+/* The message and command are unpacked on first use; routing and status
+ * only need the summary read when the response arrived. */
+Com__Seagate__Kinetic__Proto__Message* KineticResponse_GetMessage(KineticResponse * response);
+Com__Seagate__Kinetic__Proto__Command* KineticResponse_GetCommand(KineticResponse * response);
+
 KineticStatus KineticResponse_GetStatus(KineticResponse * response);
 int64_t KineticResponse_GetConnectionID(KineticResponse * response);
 Com__Seagate__Kinetic__Proto__Command__KeyValue* KineticResponse_GetKeyValue(KineticResponse * response);
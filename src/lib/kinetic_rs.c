@@ -0,0 +1,374 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_rs.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KINETIC_RS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/* Regions are coded a block at a time, so that each block of the sources
+ * stays in L1 cache while every output row is computed from it. */
+#define RS_BLOCK (4 * 1024)
+
+/* Products of a coefficient with each low nibble, then each high nibble */
+typedef uint8_t MulTable[32];
+
+typedef void (*MulRegionFn)(MulTable const table, uint8_t const * src,
+                            uint8_t * dst, size_t len, bool accumulate);
+
+struct _KineticRS {
+    size_t k;
+    size_t m;
+    uint8_t * parity;       // M x K Cauchy matrix, row-major
+    MulTable * tables;      // For each parity coefficient
+};
+
+static struct {
+    pthread_once_t once;
+    uint8_t exp[512];
+    uint8_t log[256];
+    bool ssse3;
+    bool avx2;
+    MulRegionFn mulRegion;
+} Gf = {.once = PTHREAD_ONCE_INIT};
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0) { return 0; }
+    return Gf.exp[Gf.log[a] + Gf.log[b]];
+}
+
+static uint8_t gf_inv(uint8_t a)
+{
+    KINETIC_ASSERT(a != 0);
+    return Gf.exp[255 - Gf.log[a]];
+}
+
+static void init_table(MulTable table, uint8_t coefficient)
+{
+    for (int x = 0; x < 16; x++) {
+        table[x] = gf_mul(coefficient, (uint8_t)x);
+        table[16 + x] = gf_mul(coefficient, (uint8_t)(x << 4));
+    }
+}
+
+static void mul_region_scalar(MulTable const table, uint8_t const * src,
+                              uint8_t * dst, size_t len, bool accumulate)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t product = table[src[i] & 0x0F] ^ table[16 + (src[i] >> 4)];
+        dst[i] = accumulate ? (dst[i] ^ product) : product;
+    }
+}
+
+#ifdef KINETIC_RS_X86
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+SSSE3_TARGET
+static void mul_region_ssse3(MulTable const table, uint8_t const * src,
+                             uint8_t * dst, size_t len, bool accumulate)
+{
+    __m128i const lo = _mm_loadu_si128((__m128i const *)&table[0]);
+    __m128i const hi = _mm_loadu_si128((__m128i const *)&table[16]);
+    __m128i const mask = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i const x = _mm_loadu_si128((__m128i const *)&src[i]);
+        __m128i product = _mm_xor_si128(
+            _mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+            _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        if (accumulate) {
+            product = _mm_xor_si128(product, _mm_loadu_si128((__m128i const *)&dst[i]));
+        }
+        _mm_storeu_si128((__m128i *)&dst[i], product);
+    }
+    mul_region_scalar(table, &src[i], &dst[i], len - i, accumulate);
+}
+
+AVX2_TARGET
+static void mul_region_avx2(MulTable const table, uint8_t const * src,
+                            uint8_t * dst, size_t len, bool accumulate)
+{
+    // VPSHUFB looks up within each 128-bit lane, so both get the tables
+    __m256i const lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)&table[0]));
+    __m256i const hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *)&table[16]));
+    __m256i const mask = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i const x = _mm256_loadu_si256((__m256i const *)&src[i]);
+        __m256i product = _mm256_xor_si256(
+            _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+            _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        if (accumulate) {
+            product = _mm256_xor_si256(product, _mm256_loadu_si256((__m256i const *)&dst[i]));
+        }
+        _mm256_storeu_si256((__m256i *)&dst[i], product);
+    }
+    mul_region_scalar(table, &src[i], &dst[i], len - i, accumulate);
+}
+
+#endif
+
+static MulRegionFn mul_region_for(KineticRSImpl impl)
+{
+    switch (impl) {
+#ifdef KINETIC_RS_X86
+    case KINETIC_RS_AVX2: return Gf.avx2 ? mul_region_avx2 : NULL;
+    case KINETIC_RS_SSSE3: return Gf.ssse3 ? mul_region_ssse3 : NULL;
+#endif
+    case KINETIC_RS_SCALAR: return mul_region_scalar;
+    default: return NULL;
+    }
+}
+
+static KineticRSImpl best_impl(void)
+{
+    if (Gf.avx2) { return KINETIC_RS_AVX2; }
+    if (Gf.ssse3) { return KINETIC_RS_SSSE3; }
+    return KINETIC_RS_SCALAR;
+}
+
+static void init_gf(void)
+{
+    unsigned x = 1;
+    for (int i = 0; i < 255; i++) {
+        Gf.exp[i] = (uint8_t)x;
+        Gf.log[x] = (uint8_t)i;
+        x <<= 1;
+        if (x & 0x100) { x ^= 0x11D; }
+    }
+    for (int i = 255; i < 512; i++) {
+        Gf.exp[i] = Gf.exp[i - 255];
+    }
+
+#ifdef KINETIC_RS_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        Gf.ssse3 = (ecx & bit_SSSE3) != 0;
+
+        // AVX2 also needs the OS to save the YMM registers
+        bool ymm = false;
+        if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+            uint32_t xcr0, xcr0High;
+            __asm__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+            (void)xcr0High;
+            ymm = (xcr0 & 0x6) == 0x6;
+        }
+        if (__get_cpuid_max(0, NULL) >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            Gf.avx2 = ymm && (ebx & bit_AVX2) != 0;
+        }
+    }
+#endif
+    Gf.mulRegion = mul_region_for(best_impl());
+    LOGF2("Reed-Solomon: ssse3=%d, avx2=%d", Gf.ssse3, Gf.avx2);
+}
+
+KineticRSImpl KineticRS_BestImpl(void)
+{
+    pthread_once(&Gf.once, init_gf);
+    return best_impl();
+}
+
+bool KineticRS_SetImpl(KineticRSImpl impl)
+{
+    pthread_once(&Gf.once, init_gf);
+    MulRegionFn mulRegion = mul_region_for(impl);
+    if (mulRegion == NULL) { return false; }
+    Gf.mulRegion = mulRegion;
+    return true;
+}
+
+KineticRS * KineticRS_Create(size_t dataFragments, size_t parityFragments)
+{
+    if (dataFragments == 0 || parityFragments == 0 ||
+        dataFragments + parityFragments > KINETIC_RS_MAX_FRAGMENTS) {
+        return NULL;
+    }
+    pthread_once(&Gf.once, init_gf);
+
+    size_t const k = dataFragments;
+    size_t const m = parityFragments;
+    KineticRS * rs = calloc(1, sizeof(*rs));
+    if (rs == NULL) { return NULL; }
+    rs->k = k;
+    rs->m = m;
+    rs->parity = malloc(m * k);
+    rs->tables = malloc(m * k * sizeof(rs->tables[0]));
+    if (rs->parity == NULL || rs->tables == NULL) {
+        KineticRS_Destroy(rs);
+        return NULL;
+    }
+
+    // 1 / (x_i + y_j), with distinct x_i = K + i and y_j = j
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < k; j++) {
+            uint8_t coefficient = gf_inv((uint8_t)((k + i) ^ j));
+            rs->parity[i * k + j] = coefficient;
+            init_table(rs->tables[i * k + j], coefficient);
+        }
+    }
+    return rs;
+}
+
+void KineticRS_Destroy(KineticRS * rs)
+{
+    if (rs == NULL) { return; }
+    free(rs->tables);
+    free(rs->parity);
+    free(rs);
+}
+
+/* OUT[r] = sum over j of TABLES[r * COUNT + j] * IN[j], for each of ROWS
+ * outputs, a block at a time. */
+static void mul_matrix(MulTable const * tables, size_t rows, size_t count,
+                       uint8_t const * const in[], uint8_t * const out[], size_t len)
+{
+    MulRegionFn const mulRegion = Gf.mulRegion;
+    for (size_t offset = 0; offset < len; offset += RS_BLOCK) {
+        size_t n = (len - offset < RS_BLOCK) ? len - offset : RS_BLOCK;
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t j = 0; j < count; j++) {
+                mulRegion(tables[r * count + j], &in[j][offset], &out[r][offset], n, j > 0);
+            }
+        }
+    }
+}
+
+void KineticRS_Encode(KineticRS const * const rs,
+                      uint8_t const * const data[],
+                      uint8_t * const parity[],
+                      size_t len)
+{
+    KINETIC_ASSERT(rs != NULL);
+    mul_matrix((MulTable const *)rs->tables, rs->m, rs->k, data, parity, len);
+}
+
+/* Invert the N x N matrix A into INV by Gauss-Jordan elimination,
+ * destroying A. The generator's square submatrices are all invertible. */
+static void invert(uint8_t * a, uint8_t * inv, size_t n)
+{
+    memset(inv, 0, n * n);
+    for (size_t i = 0; i < n; i++) { inv[i * n + i] = 1; }
+
+    for (size_t col = 0; col < n; col++) {
+        size_t pivot = col;
+        while (pivot < n && a[pivot * n + col] == 0) { pivot++; }
+        KINETIC_ASSERT(pivot < n);
+        if (pivot != col) {
+            for (size_t j = 0; j < n; j++) {
+                uint8_t t = a[col * n + j];
+                a[col * n + j] = a[pivot * n + j];
+                a[pivot * n + j] = t;
+                t = inv[col * n + j];
+                inv[col * n + j] = inv[pivot * n + j];
+                inv[pivot * n + j] = t;
+            }
+        }
+
+        uint8_t scale = gf_inv(a[col * n + col]);
+        for (size_t j = 0; j < n; j++) {
+            a[col * n + j] = gf_mul(a[col * n + j], scale);
+            inv[col * n + j] = gf_mul(inv[col * n + j], scale);
+        }
+
+        for (size_t row = 0; row < n; row++) {
+            uint8_t factor = a[row * n + col];
+            if (row == col || factor == 0) { continue; }
+            for (size_t j = 0; j < n; j++) {
+                a[row * n + j] ^= gf_mul(factor, a[col * n + j]);
+                inv[row * n + j] ^= gf_mul(factor, inv[col * n + j]);
+            }
+        }
+    }
+}
+
+bool KineticRS_Reconstruct(KineticRS const * const rs,
+                           uint8_t * const fragments[],
+                           bool const present[],
+                           size_t len)
+{
+    KINETIC_ASSERT(rs != NULL);
+    size_t const k = rs->k;
+
+    // Use the first K fragments present, which favours the data fragments
+    size_t sources[KINETIC_RS_MAX_FRAGMENTS];
+    size_t sourceCount = 0;
+    size_t missing[KINETIC_RS_MAX_FRAGMENTS];
+    size_t missingCount = 0;
+    for (size_t i = 0; i < k + rs->m && sourceCount < k; i++) {
+        if (present[i]) { sources[sourceCount++] = i; }
+    }
+    if (sourceCount < k) { return false; }
+    for (size_t j = 0; j < k; j++) {
+        if (!present[j]) { missing[missingCount++] = j; }
+    }
+    if (missingCount == 0) { return true; }
+
+    uint8_t * a = malloc(2 * k * k);
+    MulTable * tables = malloc(missingCount * k * sizeof(tables[0]));
+    if (a == NULL || tables == NULL) {
+        free(a);
+        free(tables);
+        return false;
+    }
+    uint8_t * inv = &a[k * k];
+
+    // Rows of the generator for the sources: identity rows for data,
+    // Cauchy rows for parity
+    for (size_t r = 0; r < k; r++) {
+        size_t source = sources[r];
+        if (source < k) {
+            memset(&a[r * k], 0, k);
+            a[r * k + source] = 1;
+        } else {
+            memcpy(&a[r * k], &rs->parity[(source - k) * k], k);
+        }
+    }
+    invert(a, inv, k);
+
+    uint8_t const * in[KINETIC_RS_MAX_FRAGMENTS];
+    uint8_t * out[KINETIC_RS_MAX_FRAGMENTS];
+    for (size_t r = 0; r < k; r++) {
+        in[r] = fragments[sources[r]];
+    }
+    for (size_t i = 0; i < missingCount; i++) {
+        out[i] = fragments[missing[i]];
+        for (size_t r = 0; r < k; r++) {
+            init_table(tables[i * k + r], inv[missing[i] * k + r]);
+        }
+    }
+    mul_matrix((MulTable const *)tables, missingCount, k, in, out, len);
+
+    free(tables);
+    free(a);
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_RS_H
+#define _KINETIC_RS_H
+
+#include "kinetic_types_internal.h"
+
+/* Reed-Solomon erasure code over GF(2^8) (polynomial 0x11D). K data
+ * fragments are extended with M parity fragments, and any K of the K+M
+ * fragments recover the data. The code is systematic: parity rows are a
+ * Cauchy matrix, so every K x K submatrix of the generator is invertible.
+ * Multiplying a region by a constant looks each nibble up in a 16-entry
+ * table, 32 bytes at a time with AVX2 or 16 with SSSE3 (PSHUFB), chosen
+ * once via CPUID, and a byte at a time otherwise. */
+
+#define KINETIC_RS_MAX_FRAGMENTS (255)
+
+typedef enum {
+    KINETIC_RS_SCALAR,
+    KINETIC_RS_SSSE3,
+    KINETIC_RS_AVX2,
+} KineticRSImpl;
+
+typedef struct _KineticRS KineticRS;
+
+/* Create a code for DATAFRAGMENTS + PARITYFRAGMENTS fragments. Returns
+ * NULL if either is zero, their sum exceeds KINETIC_RS_MAX_FRAGMENTS, or
+ * allocation fails. */
+KineticRS * KineticRS_Create(size_t dataFragments, size_t parityFragments);
+void KineticRS_Destroy(KineticRS * rs);
+
+/* Compute the parity fragments of LEN bytes each from the data fragments. */
+void KineticRS_Encode(KineticRS const * const rs,
+                      uint8_t const * const data[],
+                      uint8_t * const parity[],
+                      size_t len);
+
+/* Rebuild the data fragments missing from FRAGMENTS (data first, then
+ * parity, LEN bytes each) from the first K for which PRESENT is set.
+ * Missing parity fragments are left alone. Returns false, changing
+ * nothing, if fewer than K fragments are present. */
+bool KineticRS_Reconstruct(KineticRS const * const rs,
+                           uint8_t * const fragments[],
+                           bool const present[],
+                           size_t len);
+
+/* The fastest implementation this CPU supports. */
+KineticRSImpl KineticRS_BestImpl(void);
+
+/* Use IMPL for all codes from now on, for benchmarks and tests. Returns
+ * false, changing nothing, if the CPU does not support it. */
+bool KineticRS_SetImpl(KineticRSImpl impl);
+
+#endif // _KINETIC_RS_H
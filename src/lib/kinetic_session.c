@@ -27,6 +27,11 @@
 #include "kinetic_controller.h"
 #include "kinetic_allocator.h"
 #include "kinetic_resourcewaiter.h"
+#include "kinetic_encoder.h"
+#include "kinetic_hmac.h"
+#include "kinetic_signingqueue.h"
+#include "kinetic_hmac_mb.h"
+#include "kinetic_cache.h"
 #include "kinetic_logger.h"
 #include <stdlib.h>
 #include <string.h>
@@ -49,16 +54,117 @@ KineticStatus KineticSession_Create(KineticSession * const session, KineticClien
     session->connected = false;
     session->socket = KINETIC_SOCKET_INVALID;
     
-    // initialize session send mutex
+    // initialize session send mutex, and the turn order for sequence IDs
     if (pthread_mutex_init(&session->sendMutex, NULL) != 0) {
         LOG0("Failed initializing session send mutex!");
         return KINETIC_STATUS_MEMORY_ERROR;
     }
+    if (pthread_cond_init(&session->sendTurn, NULL) != 0) {
+        LOG0("Failed initializing session send condition!");
+        pthread_mutex_destroy(&session->sendMutex);
+        return KINETIC_STATUS_MEMORY_ERROR;
+    }
+    session->nextSendSequence = session->sequence;
+
+    uint32_t queueDepth = session->config.queueDepth;
+    if (queueDepth == 0) {
+        queueDepth = KINETIC_DEFAULT_QUEUE_DEPTH;
+    } else if (queueDepth > KINETIC_MAX_QUEUE_DEPTH) {
+        LOGF1("Queue depth %u capped at %u", queueDepth, KINETIC_MAX_QUEUE_DEPTH);
+        queueDepth = KINETIC_MAX_QUEUE_DEPTH;
+    }
+    session->config.queueDepth = queueDepth;
 
-    session->outstandingOperations =
-        KineticCountingSemaphore_Create(KINETIC_MAX_OUTSTANDING_OPERATIONS_PER_SESSION);
+    session->outstandingOperations = KineticCountingSemaphore_Create(queueDepth);
     if (session->outstandingOperations == NULL) {
         LOG0("Failed creating session counting semaphore!");
+        pthread_cond_destroy(&session->sendTurn);
+        pthread_mutex_destroy(&session->sendMutex);
+        return KINETIC_STATUS_MEMORY_ERROR;
+    }
+
+    session->window = NULL;
+    if (session->config.adaptiveQueueDepth) {
+        // Start no deeper than the fixed default, and let the window grow from there
+        uint32_t initial = queueDepth < KINETIC_DEFAULT_QUEUE_DEPTH ?
+            queueDepth : KINETIC_DEFAULT_QUEUE_DEPTH;
+        session->window = KineticWindow_Create(initial, queueDepth);
+        if (session->window == NULL) {
+            LOG0("Failed creating session adaptive window!");
+            KineticCountingSemaphore_Destroy(session->outstandingOperations);
+            session->outstandingOperations = NULL;
+            pthread_cond_destroy(&session->sendTurn);
+        pthread_mutex_destroy(&session->sendMutex);
+        return KINETIC_STATUS_MEMORY_ERROR;
+        }
+        KineticCountingSemaphore_SetLimit(session->outstandingOperations, initial);
+    }
+
+    // The key is fixed for the life of the session, so pad and hash it once.
+    // Concurrent senders only sign together when multi-buffer hashing pays
+    // off; otherwise each signs its own request on its own thread.
+    session->hmacKey.ready = false;
+    session->signingQueue = NULL;
+    bool hasHmacKey = session->config.hmacKey.data != NULL && session->config.hmacKey.len > 0;
+    if (hasHmacKey) {
+        KineticHMAC_InitKey(&session->hmacKey, session->config.hmacKey);
+    }
+    if (hasHmacKey && KineticHMACMB_Lanes() > 1) {
+        session->signingQueue = KineticSigningQueue_Create(&session->hmacKey);
+        if (session->signingQueue == NULL) {
+            LOG0("Failed creating session signing queue!");
+            if (session->window != NULL) {
+                KineticWindow_Destroy(session->window);
+                session->window = NULL;
+            }
+            KineticCountingSemaphore_Destroy(session->outstandingOperations);
+            session->outstandingOperations = NULL;
+            pthread_cond_destroy(&session->sendTurn);
+        pthread_mutex_destroy(&session->sendMutex);
+        return KINETIC_STATUS_MEMORY_ERROR;
+        }
+    }
+
+    session->readCache = NULL;
+    if (session->config.readCacheBytes > 0) {
+        session->readCache = KineticCache_Create(session->config.readCacheBytes,
+            session->config.readCacheTtlMillis);
+        if (session->readCache == NULL) {
+            LOG0("Failed creating session read cache!");
+            if (session->signingQueue != NULL) {
+                KineticSigningQueue_Destroy(session->signingQueue);
+                session->signingQueue = NULL;
+            }
+            if (session->window != NULL) {
+                KineticWindow_Destroy(session->window);
+                session->window = NULL;
+            }
+            KineticCountingSemaphore_Destroy(session->outstandingOperations);
+            session->outstandingOperations = NULL;
+            pthread_cond_destroy(&session->sendTurn);
+        pthread_mutex_destroy(&session->sendMutex);
+        return KINETIC_STATUS_MEMORY_ERROR;
+        }
+    }
+
+    if (!KineticAllocator_NewOperationPool(session, queueDepth)) {
+        LOG0("Failed creating session operation pool!");
+        if (session->readCache != NULL) {
+            KineticCache_Destroy(session->readCache);
+            session->readCache = NULL;
+        }
+        if (session->signingQueue != NULL) {
+            KineticSigningQueue_Destroy(session->signingQueue);
+            session->signingQueue = NULL;
+        }
+        if (session->window != NULL) {
+            KineticWindow_Destroy(session->window);
+            session->window = NULL;
+        }
+        KineticCountingSemaphore_Destroy(session->outstandingOperations);
+        session->outstandingOperations = NULL;
+        pthread_cond_destroy(&session->sendTurn);
+        pthread_mutex_destroy(&session->sendMutex);
         return KINETIC_STATUS_MEMORY_ERROR;
     }
 
@@ -71,6 +177,16 @@ KineticStatus KineticSession_Destroy(KineticSession * const session)
         return KINETIC_STATUS_SESSION_EMPTY;
     }
     KineticCountingSemaphore_Destroy(session->outstandingOperations);
+    if (session->window != NULL) {
+        KineticWindow_Destroy(session->window);
+    }
+    if (session->signingQueue != NULL) {
+        KineticSigningQueue_Destroy(session->signingQueue);
+    }
+    if (session->readCache != NULL) {
+        KineticCache_Destroy(session->readCache);
+    }
+    KineticAllocator_FreeOperationPool(session);
     KineticAllocator_FreeSession(session);
 
     return KINETIC_STATUS_SUCCESS;
@@ -89,10 +205,10 @@ KineticStatus KineticSession_Connect(KineticSession * const session)
     if (session->socket == KINETIC_SOCKET_DESCRIPTOR_INVALID) {
         LOG0("Session connection failed!");
         session->socket = KINETIC_SOCKET_DESCRIPTOR_INVALID;
-        session->connected = false;
+        __atomic_store_n(&session->connected, false, __ATOMIC_RELEASE);
         return KINETIC_STATUS_CONNECTION_ERROR;
     }
-    session->connected = true;
+    __atomic_store_n(&session->connected, true, __ATOMIC_RELEASE);
 
     bus_socket_t socket_type = session->config.useSsl ? BUS_SOCKET_SSL : BUS_SOCKET_PLAIN;
     session->si = calloc(1, sizeof(socket_info) + 2 * PDU_PROTO_MAX_LEN);
@@ -124,7 +240,7 @@ connection_error_cleanup:
         KineticSocket_Close(session->socket);
         session->socket = KINETIC_SOCKET_DESCRIPTOR_INVALID;
     }
-    session->connected = false;
+    __atomic_store_n(&session->connected, false, __ATOMIC_RELEASE);
     return KINETIC_STATUS_CONNECTION_ERROR;
 }
 
@@ -143,8 +259,9 @@ KineticStatus KineticSession_Disconnect(KineticSession * const session)
     free(session->si);
     session->si = NULL;
     session->socket = KINETIC_SOCKET_INVALID;
-    session->connected = false;
+    __atomic_store_n(&session->connected, false, __ATOMIC_RELEASE);
     pthread_mutex_destroy(&session->sendMutex);
+    pthread_cond_destroy(&session->sendTurn);
 
     return KINETIC_STATUS_SUCCESS;
 }
@@ -154,16 +271,17 @@ KineticStatus KineticSession_GetTerminationStatus(KineticSession const * const s
     if (session == NULL) {
         return KINETIC_STATUS_SESSION_INVALID;
     }
-    return session->terminationStatus;
+    return __atomic_load_n(&session->terminationStatus, __ATOMIC_ACQUIRE);
 }
 
 void KineticSession_SetTerminationStatus(KineticSession * const session, KineticStatus status)
 {
     KINETIC_ASSERT(session);
-    session->terminationStatus = status;
+    __atomic_store_n(&session->terminationStatus, status, __ATOMIC_RELEASE);
 }
 
 #define ATOMIC_FETCH_AND_INCREMENT(P) __sync_fetch_and_add(P, 1)
+#define ATOMIC_FETCH_AND_ADD(P, N) __sync_fetch_and_add(P, N)
 
 int64_t KineticSession_GetNextSequenceCount(KineticSession * const session)
 {
@@ -172,6 +290,15 @@ int64_t KineticSession_GetNextSequenceCount(KineticSession * const session)
     return seq_cnt;
 }
 
+/* Reserve COUNT consecutive sequence counts, returning the first. */
+int64_t KineticSession_GetNextSequenceCounts(KineticSession * const session, size_t count)
+{
+    KINETIC_ASSERT(session);
+    KINETIC_ASSERT(count > 0);
+    int64_t seq_cnt = ATOMIC_FETCH_AND_ADD(&session->sequence, (int64_t)count);
+    return seq_cnt;
+}
+
 int64_t KineticSession_GetClusterVersion(KineticSession const * const session)
 {
     KINETIC_ASSERT(session);
@@ -194,4 +321,13 @@ void KineticSession_SetConnectionID(KineticSession * const session, int64_t id)
 {
     KINETIC_ASSERT(session);
     session->connectionID = id;
+
+    /* Requests are only built once the connection is ready, which is
+     * signaled after this, so the template is never written while it
+     * may be read. If the ID changes later, requests stop matching the
+     * template and are encoded field by field. */
+    if (!session->requestTemplate.ready) {
+        KineticEncoder_InitTemplate(&session->requestTemplate,
+            session->config.clusterVersion, id, session->config.identity);
+    }
 }
@@ -0,0 +1,120 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_signingqueue.h"
+#include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Lives on the waiting sender's stack until it is marked signed. */
+typedef struct _KineticSigningEntry {
+    KineticHMAC * hmac;
+    Com__Seagate__Kinetic__Proto__Message * msg;
+    bool signedMsg;
+    struct _KineticSigningEntry * next;
+} KineticSigningEntry;
+
+struct _KineticSigningQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t signedCond;
+    bool signing;
+    KineticSigningEntry * pending;
+    KineticHMACKey const * hmacKey;
+};
+
+KineticSigningQueue * KineticSigningQueue_Create(KineticHMACKey const * const hmacKey)
+{
+    KINETIC_ASSERT(hmacKey != NULL);
+    KineticSigningQueue * queue = calloc(1, sizeof(KineticSigningQueue));
+    if (queue == NULL) { return NULL; }
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->signedCond, NULL);
+    queue->hmacKey = hmacKey;
+    return queue;
+}
+
+static void sign_entries(KineticSigningQueue * const queue, KineticSigningEntry * entry)
+{
+    KineticHMAC * hmacs[KINETIC_HMAC_MB_MAX_LANES];
+    Com__Seagate__Kinetic__Proto__Message * msgs[KINETIC_HMAC_MB_MAX_LANES];
+
+    while (entry != NULL) {
+        size_t count = 0;
+        for (; entry != NULL && count < KINETIC_HMAC_MB_MAX_LANES; entry = entry->next) {
+            hmacs[count] = entry->hmac;
+            msgs[count] = entry->msg;
+            count++;
+        }
+        KineticHMAC_PopulateBatch(hmacs, msgs, count, queue->hmacKey);
+    }
+}
+
+void KineticSigningQueue_Sign(KineticSigningQueue * const queue,
+                              KineticHMAC * const hmac,
+                              Com__Seagate__Kinetic__Proto__Message * const msg)
+{
+    KINETIC_ASSERT(queue != NULL);
+    KINETIC_ASSERT(hmac != NULL);
+    KINETIC_ASSERT(msg != NULL);
+
+    KineticSigningEntry self = {
+        .hmac = hmac,
+        .msg = msg,
+    };
+
+    pthread_mutex_lock(&queue->mutex);
+    self.next = queue->pending;
+    queue->pending = &self;
+
+    while (!self.signedMsg) {
+        if (queue->signing) {
+            pthread_cond_wait(&queue->signedCond, &queue->mutex);
+            continue;
+        }
+
+        // Sign everything queued so far, including our own request,
+        // without holding the lock so others can queue meanwhile
+        KineticSigningEntry * batch = queue->pending;
+        queue->pending = NULL;
+        queue->signing = true;
+        pthread_mutex_unlock(&queue->mutex);
+
+        sign_entries(queue, batch);
+
+        pthread_mutex_lock(&queue->mutex);
+        for (; batch != NULL; batch = batch->next) {
+            batch->signedMsg = true;
+        }
+        queue->signing = false;
+        pthread_cond_broadcast(&queue->signedCond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void KineticSigningQueue_Destroy(KineticSigningQueue * const queue)
+{
+    KINETIC_ASSERT(queue != NULL);
+    KINETIC_ASSERT(queue->pending == NULL);
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->signedCond);
+    free(queue);
+}
@@ -0,0 +1,42 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_SIGNINGQUEUE_H
+#define _KINETIC_SIGNINGQUEUE_H
+
+#include "kinetic_types_internal.h"
+
+/* Requests from concurrent senders on a session, waiting to be HMAC
+ * signed. Whichever sender finds no signing in progress takes every
+ * request queued so far and signs them together (see
+ * KineticHMAC_PopulateBatch), while the others wait for theirs. A lone
+ * sender just signs its own request. */
+
+KineticSigningQueue * KineticSigningQueue_Create(KineticHMACKey const * const hmacKey);
+
+/* Sign MSG into HMAC, possibly along with other queued requests, and
+ * return once it has been signed. */
+void KineticSigningQueue_Sign(KineticSigningQueue * const queue,
+                              KineticHMAC * const hmac,
+                              Com__Seagate__Kinetic__Proto__Message * const msg);
+
+void KineticSigningQueue_Destroy(KineticSigningQueue * const queue);
+
+#endif // _KINETIC_SIGNINGQUEUE_H
@@ -0,0 +1,379 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_tag.h"
+#include "kinetic_logger.h"
+#include "byte_array.h"
+#include <string.h>
+#include <pthread.h>
+#include <openssl/sha.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KINETIC_TAG_X86 1
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+/* Values are copied and hashed a block at a time, so that each block is
+ * hashed while it is still in L1 cache from the copy. */
+#define TAG_COPY_BLOCK (8 * 1024)
+
+/* A reflected CRC with all-ones initial value and final XOR. */
+typedef struct {
+    unsigned width;           // in bits
+    uint64_t poly;            // generator, MSB-first, without the x^width term
+    uint64_t table[8][256];   // slicing-by-8 tables, reflected
+    uint64_t fold4[2];        // multipliers folding a chunk 64 bytes ahead
+    uint64_t fold1[2];        // multipliers folding a chunk 16 bytes ahead
+} Crc;
+
+static Crc Crc32 = {.width = 32, .poly = 0x04C11DB7};
+static Crc Crc64 = {.width = 64, .poly = 0x42F0E1EBA9EA3693ull};
+
+static struct {
+    pthread_once_t once;
+    bool pclmul;
+} Cpu = {.once = PTHREAD_ONCE_INIT};
+
+typedef struct {
+    KineticAlgorithm algorithm;
+    union {
+        SHA_CTX sha1;
+        SHA256_CTX sha2;
+        uint64_t crc;
+    } state;
+} TagContext;
+
+static uint64_t crc_mask(Crc const * const c)
+{
+    return (c->width == 64) ? ~0ull : ((1ull << c->width) - 1);
+}
+
+/* x^n mod P, bit-reversed into a 64-bit multiplier for carry-less
+ * multiplies in the reflected domain (x^m lands in bit 63 - m). */
+static uint64_t fold_multiplier(Crc const * const c, unsigned n)
+{
+    uint64_t const top = 1ull << (c->width - 1);
+    uint64_t r = 1;
+    for (unsigned i = 0; i < n; i++) {
+        bool carry = (r & top) != 0;
+        r = (r << 1) & crc_mask(c);
+        if (carry) { r ^= c->poly; }
+    }
+
+    uint64_t k = 0;
+    for (unsigned m = 0; m < c->width; m++) {
+        if ((r >> m) & 1) { k |= 1ull << (63 - m); }
+    }
+    return k;
+}
+
+static void init_crc(Crc * const c)
+{
+    uint64_t reflected = 0;
+    for (unsigned m = 0; m < c->width; m++) {
+        if ((c->poly >> m) & 1) { reflected |= 1ull << (c->width - 1 - m); }
+    }
+
+    for (unsigned b = 0; b < 256; b++) {
+        uint64_t crc = b;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ reflected : (crc >> 1);
+        }
+        c->table[0][b] = crc;
+    }
+    for (unsigned b = 0; b < 256; b++) {
+        for (int k = 1; k < 8; k++) {
+            uint64_t prev = c->table[k - 1][b];
+            c->table[k][b] = (prev >> 8) ^ c->table[0][prev & 0xff];
+        }
+    }
+
+    /* A 16-byte chunk A, followed D bits later by the rest of the data,
+     * contributes A * x^D. Its low and high 64-bit halves are multiplied
+     * by x^(D+63) and x^(D-1), which leaves a 128-bit remainder standing
+     * in for A that is equivalent modulo P. */
+    c->fold4[0] = fold_multiplier(c, 512 + 63);
+    c->fold4[1] = fold_multiplier(c, 512 - 1);
+    c->fold1[0] = fold_multiplier(c, 128 + 63);
+    c->fold1[1] = fold_multiplier(c, 128 - 1);
+}
+
+static void init_tag(void)
+{
+    init_crc(&Crc32);
+    init_crc(&Crc64);
+#ifdef KINETIC_TAG_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        Cpu.pclmul = (ecx & bit_PCLMUL) != 0 && (edx & bit_SSE2) != 0;
+    }
+#endif
+    LOGF2("Entry tags: pclmul=%d", Cpu.pclmul);
+}
+
+static uint64_t crc_table(Crc const * const c, uint64_t crc,
+                          uint8_t const * data, size_t len)
+{
+    uint64_t const (* const t)[256] = c->table;
+    while (len >= 8) {
+        crc ^= (uint64_t)data[0] | ((uint64_t)data[1] << 8) |
+               ((uint64_t)data[2] << 16) | ((uint64_t)data[3] << 24) |
+               ((uint64_t)data[4] << 32) | ((uint64_t)data[5] << 40) |
+               ((uint64_t)data[6] << 48) | ((uint64_t)data[7] << 56);
+        crc = t[7][crc & 0xff] ^ t[6][(crc >> 8) & 0xff] ^
+              t[5][(crc >> 16) & 0xff] ^ t[4][(crc >> 24) & 0xff] ^
+              t[3][(crc >> 32) & 0xff] ^ t[2][(crc >> 40) & 0xff] ^
+              t[1][(crc >> 48) & 0xff] ^ t[0][crc >> 56];
+        data += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef KINETIC_TAG_X86
+
+#define TAG_TARGET __attribute__((target("sse2,pclmul")))
+
+TAG_TARGET
+static __m128i fold(__m128i const chunk, __m128i const multipliers)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(chunk, multipliers, 0x00),
+                         _mm_clmulepi64_si128(chunk, multipliers, 0x11));
+}
+
+TAG_TARGET
+static __m128i load(uint8_t const * const src, uint8_t * const dst, size_t offset)
+{
+    __m128i const chunk = _mm_loadu_si128((__m128i const *)&src[offset]);
+    if (dst != NULL) {
+        _mm_storeu_si128((__m128i *)&dst[offset], chunk);
+    }
+    return chunk;
+}
+
+/* CRC of LEN bytes (at least 64, and a multiple of 16) of SRC, copying
+ * them to DST as they are loaded, if DST is not NULL. Four chunks are
+ * folded in parallel, then into one, and the last 16-byte remainder is
+ * reduced with the tables. */
+TAG_TARGET
+static uint64_t crc_pclmul(Crc const * const c, uint64_t crc,
+                           uint8_t const * const src, uint8_t * const dst, size_t len)
+{
+    __m128i const fold4 = _mm_set_epi64x((long long)c->fold4[1], (long long)c->fold4[0]);
+    __m128i const fold1 = _mm_set_epi64x((long long)c->fold1[1], (long long)c->fold1[0]);
+
+    __m128i x0 = load(src, dst, 0);
+    __m128i x1 = load(src, dst, 16);
+    __m128i x2 = load(src, dst, 32);
+    __m128i x3 = load(src, dst, 48);
+    x0 = _mm_xor_si128(x0, _mm_set_epi64x(0, (long long)crc));
+
+    size_t offset = 64;
+    for (; offset + 64 <= len; offset += 64) {
+        x0 = _mm_xor_si128(fold(x0, fold4), load(src, dst, offset));
+        x1 = _mm_xor_si128(fold(x1, fold4), load(src, dst, offset + 16));
+        x2 = _mm_xor_si128(fold(x2, fold4), load(src, dst, offset + 32));
+        x3 = _mm_xor_si128(fold(x3, fold4), load(src, dst, offset + 48));
+    }
+
+    x0 = _mm_xor_si128(fold(x0, fold1), x1);
+    x0 = _mm_xor_si128(fold(x0, fold1), x2);
+    x0 = _mm_xor_si128(fold(x0, fold1), x3);
+    for (; offset + 16 <= len; offset += 16) {
+        x0 = _mm_xor_si128(fold(x0, fold1), load(src, dst, offset));
+    }
+
+    uint8_t remainder[16];
+    _mm_storeu_si128((__m128i *)remainder, x0);
+    return crc_table(c, 0, remainder, sizeof(remainder));
+}
+
+#endif
+
+/* Continue CRC over LEN bytes of SRC, copying them to DST if it is not
+ * NULL. Copying is fused into the folding loop when it is used. */
+static uint64_t crc_update(Crc const * const c, uint64_t crc,
+                           uint8_t const * src, uint8_t * dst, size_t len)
+{
+#ifdef KINETIC_TAG_X86
+    if (Cpu.pclmul && len >= 64) {
+        size_t bulk = len & ~(size_t)15;
+        crc = crc_pclmul(c, crc, src, dst, bulk);
+        src += bulk;
+        if (dst != NULL) { dst += bulk; }
+        len -= bulk;
+    }
+#endif
+    while (len > 0) {
+        size_t n = (len < TAG_COPY_BLOCK) ? len : TAG_COPY_BLOCK;
+        if (dst != NULL) {
+            memcpy(dst, src, n);
+            dst += n;
+        }
+        crc = crc_table(c, crc, src, n);
+        src += n;
+        len -= n;
+    }
+    return crc;
+}
+
+static Crc const * crc_for(KineticAlgorithm algorithm)
+{
+    switch (algorithm) {
+    case KINETIC_ALGORITHM_CRC32: return &Crc32;
+    case KINETIC_ALGORITHM_CRC64: return &Crc64;
+    default: return NULL;
+    }
+}
+
+static bool tag_init(TagContext * const ctx, KineticAlgorithm algorithm)
+{
+    pthread_once(&Cpu.once, init_tag);
+    ctx->algorithm = algorithm;
+    switch (algorithm) {
+    case KINETIC_ALGORITHM_SHA1:
+        SHA1_Init(&ctx->state.sha1);
+        return true;
+    case KINETIC_ALGORITHM_SHA2:
+        SHA256_Init(&ctx->state.sha2);
+        return true;
+    case KINETIC_ALGORITHM_CRC32:
+    case KINETIC_ALGORITHM_CRC64:
+        ctx->state.crc = crc_mask(crc_for(algorithm));
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Hash LEN bytes of SRC, first copying them to DST if it is not NULL. */
+static void tag_update(TagContext * const ctx,
+                       uint8_t const * src, uint8_t * dst, size_t len)
+{
+    Crc const * const c = crc_for(ctx->algorithm);
+    if (c != NULL) {
+        ctx->state.crc = crc_update(c, ctx->state.crc, src, dst, len);
+        return;
+    }
+
+    while (len > 0) {
+        size_t n = len;
+        uint8_t const * data = src;
+        if (dst != NULL) {
+            if (n > TAG_COPY_BLOCK) { n = TAG_COPY_BLOCK; }
+            memcpy(dst, src, n);
+            data = dst;
+            dst += n;
+        }
+        if (ctx->algorithm == KINETIC_ALGORITHM_SHA1) {
+            SHA1_Update(&ctx->state.sha1, data, n);
+        } else {
+            SHA256_Update(&ctx->state.sha2, data, n);
+        }
+        src += n;
+        len -= n;
+    }
+}
+
+static size_t tag_final(TagContext * const ctx, uint8_t digest[KINETIC_TAG_MAX_LEN])
+{
+    size_t const len = KineticTag_Length(ctx->algorithm);
+    Crc const * const c = crc_for(ctx->algorithm);
+    if (c != NULL) {
+        uint64_t crc = ctx->state.crc ^ crc_mask(c);
+        for (size_t i = 0; i < len; i++) {
+            digest[i] = (uint8_t)(crc >> (8 * (len - 1 - i)));
+        }
+    } else if (ctx->algorithm == KINETIC_ALGORITHM_SHA1) {
+        SHA1_Final(digest, &ctx->state.sha1);
+    } else {
+        SHA256_Final(digest, &ctx->state.sha2);
+    }
+    return len;
+}
+
+size_t KineticTag_Length(KineticAlgorithm algorithm)
+{
+    switch (algorithm) {
+    case KINETIC_ALGORITHM_SHA1: return SHA_DIGEST_LENGTH;
+    case KINETIC_ALGORITHM_SHA2: return SHA256_DIGEST_LENGTH;
+    case KINETIC_ALGORITHM_CRC32: return sizeof(uint32_t);
+    case KINETIC_ALGORITHM_CRC64: return sizeof(uint64_t);
+    default: return 0;
+    }
+}
+
+KineticStatus KineticTag_Compute(KineticAlgorithm algorithm,
+                                 ByteArray const value,
+                                 ByteBuffer * const tag)
+{
+    KINETIC_ASSERT(tag != NULL);
+    TagContext ctx;
+    if (!tag_init(&ctx, algorithm)) {
+        LOGF1("Cannot compute tag, unsupported algorithm: %d", algorithm);
+        return KINETIC_STATUS_INVALID_REQUEST;
+    }
+    size_t const len = KineticTag_Length(algorithm);
+    if (tag->array.data == NULL || tag->array.len < len) {
+        LOGF1("Tag buffer too small: %zu, need %zu", tag->array.len, len);
+        return KINETIC_STATUS_BUFFER_OVERRUN;
+    }
+
+    uint8_t digest[KINETIC_TAG_MAX_LEN];
+    tag_update(&ctx, value.data, NULL, value.len);
+    tag_final(&ctx, digest);
+    ByteBuffer_Reset(tag);
+    ByteBuffer_Append(tag, digest, len);
+    return KINETIC_STATUS_SUCCESS;
+}
+
+KineticStatus KineticTag_AppendAndVerify(KineticAlgorithm algorithm,
+                                         ByteBuffer * const dest,
+                                         ByteArray const value,
+                                         ByteArray const tag)
+{
+    KINETIC_ASSERT(dest != NULL);
+    KINETIC_ASSERT(dest->array.data != NULL);
+    TagContext ctx;
+    if (!tag_init(&ctx, algorithm)) {
+        LOGF1("Cannot verify tag, unsupported algorithm: %d", algorithm);
+        return KINETIC_STATUS_INVALID_REQUEST;
+    }
+    if (dest->bytesUsed + value.len > dest->array.len) {
+        return KINETIC_STATUS_BUFFER_OVERRUN;
+    }
+
+    uint8_t digest[KINETIC_TAG_MAX_LEN];
+    tag_update(&ctx, value.data, &dest->array.data[dest->bytesUsed], value.len);
+    dest->bytesUsed += value.len;
+    size_t const len = tag_final(&ctx, digest);
+    if (tag.len != len || memcmp(tag.data, digest, len) != 0) {
+        LOG1("Value does not match its tag");
+        return KINETIC_STATUS_DATA_ERROR;
+    }
+    return KINETIC_STATUS_SUCCESS;
+}
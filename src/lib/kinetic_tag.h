@@ -0,0 +1,59 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_TAG_H
+#define _KINETIC_TAG_H
+
+#include "kinetic_types_internal.h"
+
+/* Integrity tags for entry values (see KineticEntry.computeTag), per the
+ * entry's algorithm:
+ *   SHA1, SHA2  - SHA-1 and SHA-256 digests, via OpenSSL (which uses the
+ *                 SHA instructions where the CPU has them)
+ *   CRC32       - the IEEE/Ethernet CRC-32, big-endian in 4 bytes
+ *   CRC64       - CRC-64/XZ (ECMA-182 polynomial, reflected), big-endian
+ *                 in 8 bytes
+ * The CRCs fold 16 bytes at a time with carry-less multiplies when the
+ * CPU has PCLMULQDQ, and fall back to slicing-by-8 tables otherwise.
+ * SHA3 is not supported. */
+
+#define KINETIC_TAG_MAX_LEN (32)
+
+/* Length of the tag for ALGORITHM, or 0 if it is not supported. */
+size_t KineticTag_Length(KineticAlgorithm algorithm);
+
+/* Replace the contents of TAG with the tag of VALUE.
+ * Returns KINETIC_STATUS_INVALID_REQUEST if the algorithm is not
+ * supported, or KINETIC_STATUS_BUFFER_OVERRUN if the tag does not fit. */
+KineticStatus KineticTag_Compute(KineticAlgorithm algorithm,
+                                 ByteArray const value,
+                                 ByteBuffer * const tag);
+
+/* Append VALUE to DEST and check it against TAG in the same pass, so the
+ * value is hashed while it is still in cache from the copy.
+ * Returns KINETIC_STATUS_BUFFER_OVERRUN (appending nothing) if VALUE does
+ * not fit, KINETIC_STATUS_INVALID_REQUEST if the algorithm is not
+ * supported, or KINETIC_STATUS_DATA_ERROR if the tag does not match. */
+KineticStatus KineticTag_AppendAndVerify(KineticAlgorithm algorithm,
+                                         ByteBuffer * const dest,
+                                         ByteArray const value,
+                                         ByteArray const tag);
+
+#endif // _KINETIC_TAG_H
@@ -427,13 +427,62 @@ static void KineticMessage_HeaderInit(Com__Seagate__Kinetic__Proto__Command__Hea
     };
 }
 
+static void KineticRequest_BindSession(KineticRequest* request, KineticSession const * const session)
+{
+    KineticMessage_HeaderInit(&(request->message.header), session);
+    request->command = &request->message.command;
+    request->command->header = &request->message.header;
+    request->pinAuth = false;
+    request->encoderTemplate = session->requestTemplate.ready ? &session->requestTemplate : NULL;
+    request->hmacKey = session->hmacKey.ready ? &session->hmacKey : NULL;
+    request->signingQueue = session->signingQueue;
+}
+
 void KineticRequest_Init(KineticRequest* request, KineticSession const * const session)
 {
     KINETIC_ASSERT(request != NULL);
     KINETIC_ASSERT(session != NULL);
     memset(request, 0, sizeof(KineticRequest));
     KineticMessage_Init(&(request->message));
-    KineticMessage_HeaderInit(&(request->message.header), session);
-    request->command = &request->message.command;
-    request->command->header = &request->message.header;
+    KineticRequest_BindSession(request, session);
+}
+
+void KineticRequest_Reset(KineticRequest* request, KineticSession const * const session)
+{
+    KINETIC_ASSERT(request != NULL);
+    KINETIC_ASSERT(session != NULL);
+    KineticMessage * const message = &request->message;
+
+    // Only the sub-messages the last command linked in can have been set
+    Com__Seagate__Kinetic__Proto__Command__Body const * const body = message->command.body;
+    if (body != NULL) {
+        if (body->keyvalue != NULL) {
+            com__seagate__kinetic__proto__command__key_value__init(&message->keyValue);
+        }
+        if (body->range != NULL) {
+            com__seagate__kinetic__proto__command__range__init(&message->keyRange);
+        }
+        if (body->setup != NULL) {
+            com__seagate__kinetic__proto__command__setup__init(&message->setup);
+        }
+        if (body->getlog != NULL) {
+            com__seagate__kinetic__proto__command__get_log__init(&message->getLog);
+            com__seagate__kinetic__proto__command__get_log__device__init(&message->getLogDevice);
+        }
+        if (body->security != NULL) {
+            com__seagate__kinetic__proto__command__security__init(&message->security);
+        }
+        if (body->pinop != NULL) {
+            com__seagate__kinetic__proto__command__pin_operation__init(&message->pinOp);
+        }
+        com__seagate__kinetic__proto__command__body__init(&message->body);
+    }
+    if (message->command.status != NULL) {
+        com__seagate__kinetic__proto__command__status__init(&message->status);
+    }
+    com__seagate__kinetic__proto__message__init(&message->message);
+    com__seagate__kinetic__proto__message__hmacauth__init(&message->hmacAuth);
+    com__seagate__kinetic__proto__message__pinauth__init(&message->pinAuth);
+    com__seagate__kinetic__proto__command__init(&message->command);
+    KineticRequest_BindSession(request, session);
 }
@@ -24,6 +24,9 @@
 #include "kinetic_types.h"
 #include "kinetic.pb-c.h"
 #include "kinetic_countingsemaphore.h"
+#include "kinetic_window.h"
+#include "kinetic_arena.h"
+#include "kinetic_encoder.h"
 #include "kinetic_resourcewaiter_types.h"
 #include "kinetic_resourcewaiter.h"
 #include "kinetic_acl.h"
@@ -33,7 +36,6 @@
 #include <time.h>
 #include <pthread.h>
 
-#define KINETIC_MAX_OUTSTANDING_OPERATIONS_PER_SESSION (10)
 #define KINETIC_SOCKET_DESCRIPTOR_INVALID (-1)
 #define KINETIC_CONNECTION_TIMEOUT_SECS (30) /* Java simulator may take longer than 10 seconds to respond */
 #define KINETIC_OPERATION_TIMEOUT_SECS (20)
@@ -88,6 +90,28 @@ typedef struct {
     uint8_t buf[];
 } socket_info;
 
+typedef struct _KineticOperationSlot KineticOperationSlot;
+
+// Preallocated operation/request pairs, reset and reused instead of
+// being allocated and freed for every operation
+typedef struct {
+    pthread_mutex_t mutex;
+    KineticOperationSlot * slots;
+    size_t count;
+    KineticOperationSlot * freeList;
+} KineticOperationPool;
+
+// HMAC-SHA1 state after absorbing the padded session key, so that
+// signing a request only hashes the message (see KineticHMAC_InitKey)
+typedef struct _KineticHMACKey {
+    bool ready;
+    SHA_CTX inner;      ///< after (key ^ ipad)
+    SHA_CTX outer;      ///< after (key ^ opad)
+} KineticHMACKey;
+
+typedef struct _KineticSigningQueue KineticSigningQueue;
+typedef struct _KineticCache KineticCache;
+
 /**
  * @brief An instance of a session with a Kinetic device.
  */
@@ -100,9 +124,20 @@ struct _KineticSession {
     int64_t         sequence;                           ///< increments for each request in a session
     struct bus *    messageBus;                         ///< pointer to message bus instance
     socket_info *   si;                                 ///< pointer to socket information
-    pthread_mutex_t sendMutex;                          ///< mutex for locking around seq count acquisision, PDU packing, and transfer to threadpool
+    pthread_mutex_t sendMutex;                          ///< mutex for locking around transfer of packed PDUs to the bus
+    pthread_cond_t  sendTurn;                           ///< signaled when nextSendSequence advances
+    int64_t         nextSendSequence;                   ///< sequence ID whose turn it is to be transferred to the bus
     KineticResourceWaiter connectionReady;              ///< connection ready status (set to true once connectionID recieved)
     KineticCountingSemaphore * outstandingOperations;   ///< counting semaphore to only allows the configured number of outstanding operation at a given time
+    KineticWindow * window;                             ///< adaptive limit on outstanding operations (NULL unless config.adaptiveQueueDepth)
+    KineticOperationPool operationPool;                 ///< reusable operations, sized to the queue depth
+    KineticEncoderTemplate requestTemplate;             ///< pre-encoded header/auth fields (ready once connectionID is received)
+    KineticHMACKey  hmacKey;                            ///< precomputed HMAC state for config.hmacKey
+    KineticSigningQueue * signingQueue;                 ///< signs concurrent requests together (NULL until hmacKey is ready)
+    KineticCache *  readCache;                          ///< GET results cache (NULL unless config.readCacheBytes)
+    KineticSession ** lanes;                            ///< extra connections for large transfers, each a session of its own (see config.connections)
+    size_t          laneCount;                          ///< number of extra connections
+    uint32_t        nextLane;                           ///< round robin position over lanes
     uint16_t timeoutSeconds;                            ///< Default response timeout
 };
 
@@ -159,13 +194,33 @@ struct _KineticRequest {
     KineticMessage message;
     Com__Seagate__Kinetic__Proto__Command* command;
     bool pinAuth;
+    KineticEncoderTemplate const * encoderTemplate;    ///< session's, if any
+    KineticHMACKey const * hmacKey;                     ///< session's, if any
+    KineticSigningQueue * signingQueue;                 ///< session's, if any
 };
 
+// Fields needed to route and complete a response, read straight from
+// the wire without unpacking the message or command
+typedef struct _KineticResponseSummary
+{
+    bool hasAuthType;
+    Com__Seagate__Kinetic__Proto__Message__AuthType authType;
+    bool hasHeader;
+    int64_t ackSequence;
+    int64_t connectionID;
+    bool hasStatusCode;
+    Com__Seagate__Kinetic__Proto__Command__Status__StatusCode statusCode;
+} KineticResponseSummary;
+
 typedef struct _KineticResponse
 {
     KineticPDUHeader header;
+    KineticResponseSummary summary;
+    uint8_t* protoBytes;    ///< packed message, kept for unpacking on demand
+    bool unpacked;
     Com__Seagate__Kinetic__Proto__Message* proto;
     Com__Seagate__Kinetic__Proto__Command* command;
+    KineticArena* arena;    ///< backs proto and command, if not NULL
     uint8_t value[];
 } KineticResponse;
 
@@ -177,6 +232,7 @@ typedef KineticStatus (*KineticOperationCallback)(KineticOperation* const operat
 // Kinetic Operation
 struct _KineticOperation {
     KineticSession* session;
+    KineticOperationPool* pool;
     KineticRequest* request;
     KineticResponse* response;
     uint16_t timeoutSeconds;
@@ -184,11 +240,22 @@ struct _KineticOperation {
     ByteArray* pin;
     KineticEntry* entry;
     ByteBufferArray* buffers;
+    KineticKeyCallback keyCallback;
+    void* keyClientData;
     KineticLogInfo** deviceInfo;
     KineticP2P_Operation* p2pOp;
     KineticOperationCallback opCallback;
     KineticCompletionClosure closure;
+    bool completeInline;    // Complete on the bus listener thread (blocking callers only)
     ByteArray value;
+    struct timespec sendTime;
+};
+
+// Pooled operation, with its request (see KineticOperationPool)
+struct _KineticOperationSlot {
+    KineticOperation operation;
+    KineticRequest request;
+    KineticOperationSlot * next;
 };
 
 
@@ -225,4 +292,8 @@ KineticMessageType Com__Seagate__Kinetic__Proto__Command__MessageType_to_Kinetic
 void KineticMessage_Init(KineticMessage* const message);
 void KineticRequest_Init(KineticRequest* reqeust, KineticSession const * const session);
 
+// Re-initialize a request previously set up by KineticRequest_Init for a
+// new operation, resetting only the parts of the message it used
+void KineticRequest_Reset(KineticRequest* request, KineticSession const * const session);
+
 #endif // _KINETIC_TYPES_INTERNAL_H
@@ -0,0 +1,149 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include "kinetic_window.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Latency counts as congested once the smoothed value is this many
+ * times the baseline, and at least KINETIC_WINDOW_LATENCY_SLACK_USEC
+ * above it (so microsecond-scale jitter on a fast link is ignored). */
+#define KINETIC_WINDOW_LATENCY_FACTOR (2)
+#define KINETIC_WINDOW_LATENCY_SLACK_USEC (500)
+
+/* Weight of each new sample in the smoothed latency, as 1/2^N. */
+#define KINETIC_WINDOW_EWMA_SHIFT (3)
+
+/* The baseline is the lowest latency over the last one to two periods
+ * of this many round trips (a window's worth of completions each), so
+ * it follows the device when its uncongested latency rises for good. */
+#define KINETIC_WINDOW_BASELINE_ROUNDS (16)
+
+struct _KineticWindow {
+    pthread_mutex_t mutex;
+    double size;
+    uint32_t max;
+    int64_t smoothedUsec;
+    uint32_t sinceDecrease;
+
+    int64_t prevMinUsec;        // Lowest latency in the last full period
+    int64_t curMinUsec;         // Lowest latency in this period so far
+    uint32_t roundCompletions;
+    uint32_t rounds;
+};
+
+/* Fold a latency sample into the baseline, and return the baseline. */
+static int64_t update_baseline(KineticWindow * const window, int64_t latencyUsec)
+{
+    if (latencyUsec > 0 &&
+        (window->curMinUsec == 0 || latencyUsec < window->curMinUsec)) {
+        window->curMinUsec = latencyUsec;
+    }
+
+    int64_t baseline = window->curMinUsec;
+    if (baseline == 0 ||
+        (window->prevMinUsec > 0 && window->prevMinUsec < baseline)) {
+        baseline = window->prevMinUsec;
+    }
+
+    if (++window->roundCompletions >= (uint32_t)window->size) {
+        window->roundCompletions = 0;
+        if (++window->rounds >= KINETIC_WINDOW_BASELINE_ROUNDS) {
+            window->rounds = 0;
+            window->prevMinUsec = window->curMinUsec;
+            window->curMinUsec = 0;
+        }
+    }
+    return baseline;
+}
+
+KineticWindow * KineticWindow_Create(uint32_t initial, uint32_t max)
+{
+    KineticWindow * window = calloc(1, sizeof(KineticWindow));
+    if (window == NULL) { return NULL; }
+    if (max < 1) { max = 1; }
+    if (initial < 1) { initial = 1; }
+    if (initial > max) { initial = max; }
+    pthread_mutex_init(&window->mutex, NULL);
+    window->size = initial;
+    window->max = max;
+    return window;
+}
+
+uint32_t KineticWindow_Update(KineticWindow * const window,
+    int64_t latencyUsec, bool busy)
+{
+    KINETIC_ASSERT(window != NULL);
+    pthread_mutex_lock(&window->mutex);
+
+    if (latencyUsec > 0) {
+        if (window->smoothedUsec == 0) {
+            window->smoothedUsec = latencyUsec;
+        } else {
+            window->smoothedUsec +=
+                (latencyUsec - window->smoothedUsec) >> KINETIC_WINDOW_EWMA_SHIFT;
+        }
+    }
+
+    int64_t baseline = update_baseline(window, latencyUsec);
+    bool congested = busy || (baseline > 0 &&
+        window->smoothedUsec > baseline * KINETIC_WINDOW_LATENCY_FACTOR &&
+        window->smoothedUsec - baseline > KINETIC_WINDOW_LATENCY_SLACK_USEC);
+
+    double before = window->size;
+    window->sinceDecrease++;
+    if (congested) {
+        if (window->sinceDecrease >= (uint32_t)window->size) {
+            window->size /= 2;
+            if (window->size < 1) { window->size = 1; }
+            window->sinceDecrease = 0;
+        }
+    } else {
+        window->size += 1.0 / window->size;
+        if (window->size > window->max) { window->size = window->max; }
+    }
+
+    uint32_t size = (uint32_t)window->size;
+    int64_t smoothed = window->smoothedUsec;
+    pthread_mutex_unlock(&window->mutex);
+
+    if (size != (uint32_t)before) {
+        LOGF2("Adaptive queue depth: %u => %u (latency=%lld usec, baseline=%lld usec%s)",
+            (uint32_t)before, size, (long long)smoothed, (long long)baseline,
+            busy ? ", device busy" : "");
+    }
+    return size;
+}
+
+uint32_t KineticWindow_Size(KineticWindow * const window)
+{
+    KINETIC_ASSERT(window != NULL);
+    pthread_mutex_lock(&window->mutex);
+    uint32_t size = (uint32_t)window->size;
+    pthread_mutex_unlock(&window->mutex);
+    return size;
+}
+
+void KineticWindow_Destroy(KineticWindow * const window)
+{
+    KINETIC_ASSERT(window != NULL);
+    pthread_mutex_destroy(&window->mutex);
+    free(window);
+}
@@ -0,0 +1,50 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#ifndef _KINETIC_WINDOW_H
+#define _KINETIC_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Adaptive queue depth for a session, sized by additive-increase /
+ * multiplicative-decrease (AIMD) on completion latency.
+ *
+ * The lowest recent latency is taken as the uncongested baseline. It is
+ * re-based every few dozen round trips, so a lasting rise in the device's
+ * latency stops counting as congestion. While the smoothed latency stays
+ * near it, every completion grows the window by 1/window, i.e. by about
+ * one operation per round trip. When the
+ * smoothed latency climbs well past the baseline, or the device reports
+ * it is busy, the window is halved, at most once per window's worth of
+ * completions so that one burst of slow responses only counts once. */
+typedef struct _KineticWindow KineticWindow;
+
+KineticWindow * KineticWindow_Create(uint32_t initial, uint32_t max);
+
+/* Record a completed operation, and return the new window size (between
+ * 1 and max). BUSY should be set if the device asked us to back off. */
+uint32_t KineticWindow_Update(KineticWindow * const window,
+    int64_t latencyUsec, bool busy);
+
+uint32_t KineticWindow_Size(KineticWindow * const window);
+void KineticWindow_Destroy(KineticWindow * const window);
+
+#endif // _KINETIC_WINDOW_H
@@ -34,9 +34,12 @@ static size_t fibs(size_t arg) {
 }
 
 static void dump_stats(const char *prefix, struct threadpool_info *stats) {
-    printf("%s(at %d, dt %d, bl %zd)\n",
+    printf("%s(at %d, dt %d, bl %zd, peak %d, spawned %zd, reaped %zd, "
+        "grow bl/lat %zd/%zd, avg %zd usec)\n",
         prefix, stats->active_threads, stats->dormant_threads,
-        stats->backlog_size);
+        stats->backlog_size, stats->peak_threads, stats->spawned_threads,
+        stats->reaped_threads, stats->backlog_grows, stats->latency_grows,
+        stats->avg_task_usec);
 }
 
 #define ATOMIC_BOOL_COMPARE_AND_SWAP(PTR, OLD, NEW)     \
@@ -72,18 +75,113 @@ static void inf_loop_cb(void *env) {
     }
 }
 
+static size_t running_count = 0;
+
+static void rendezvous_cb(void *udata) {
+    size_t expected = *(size_t *)udata;
+    __sync_fetch_and_add(&running_count, 1);
+    /* Hold this thread until every other task is running concurrently. */
+    for (int i = 0; i < 500 && running_count < expected; i++) {
+        (void)poll(NULL, 0, 10);
+    }
+}
+
+/* Every spawned thread must actually be running tasks, not just have
+ * its slot marked as started. */
+static void check_spawned_threads_run(uint8_t sz2, uint16_t max_threads) {
+    struct threadpool_config cfg = {
+        .task_ringbuf_size2 = sz2,
+        .min_threads = max_threads,
+        .max_threads = max_threads,
+        .idle_timeout = 1000,
+    };
+    struct threadpool *t = Threadpool_Init(&cfg);
+    assert(t);
+
+    size_t expected = max_threads;
+    struct threadpool_task task = {
+        .task = rendezvous_cb, .udata = &expected,
+    };
+    for (size_t i = 0; i < expected; i++) {
+        size_t counterpressure = 0;
+        while (!Threadpool_Schedule(t, &task, &counterpressure)) {
+            usleep(10 * 1000);
+        }
+    }
+
+    for (int i = 0; i < 500 && running_count < expected; i++) {
+        (void)poll(NULL, 0, 10);
+    }
+    assert(running_count == expected);
+
+    struct threadpool_info stats;
+    Threadpool_Stats(t, &stats);
+    dump_stats("spawned...", &stats);
+    assert(stats.spawned_threads == expected);
+
+    while (!Threadpool_Shutdown(t, false)) {
+        (void)poll(NULL, 0, 10);
+    }
+    Threadpool_Free(t);
+}
+
+static void sleep_cb(void *udata) {
+    (void)udata;
+    (void)poll(NULL, 0, 5);
+}
+
+/* Killing every thread must only cancel threads that are running, while
+ * other slots are unused, reaped, or having their idle thread retire. */
+static void check_kill_all_with_idle_slots(uint8_t sz2, uint16_t max_threads) {
+    struct threadpool_config cfg = {
+        .task_ringbuf_size2 = sz2,
+        .min_threads = 1,
+        .max_threads = max_threads,
+        .idle_timeout = 10,
+    };
+    struct threadpool *t = Threadpool_Init(&cfg);
+    assert(t);
+
+    struct threadpool_task task = { .task = sleep_cb, };
+    for (size_t i = 0; i < 4 * max_threads; i++) {
+        size_t counterpressure = 0;
+        while (!Threadpool_Schedule(t, &task, &counterpressure)) {
+            usleep(10 * 1000);
+        }
+    }
+    /* Shut down while idle threads above min_threads are being reaped. */
+    (void)poll(NULL, 0, 60);
+
+    while (!Threadpool_Shutdown(t, true)) {
+        (void)poll(NULL, 0, 10);
+    }
+
+    struct threadpool_info stats;
+    Threadpool_Stats(t, &stats);
+    dump_stats("killed...", &stats);
+    assert(stats.active_threads == 0);
+    assert(stats.dormant_threads == 0);
+    Threadpool_Free(t);
+}
+
 int main(int argc, char **argv) {
     uint8_t sz2 = 8;
-    uint8_t max_threads = 8;
+    uint16_t max_threads = 8;
+    const size_t idle_timeout = 200;
 
     char *sz2_env = getenv("SZ2");
     char *max_threads_env = getenv("MAX_THREADS");
     if (sz2_env) { sz2 = atoi(sz2_env); }
     if (max_threads_env) { max_threads = atoi(max_threads_env); }
 
+    check_spawned_threads_run(sz2, max_threads);
+    check_kill_all_with_idle_slots(sz2, max_threads);
+
     struct threadpool_config cfg = {
         .task_ringbuf_size2 = sz2,
+        .min_threads = 1,
         .max_threads = max_threads,
+        .idle_timeout = idle_timeout,
     };
     struct threadpool *t = Threadpool_Init(&cfg);
     assert(t);
@@ -119,6 +217,32 @@ int main(int argc, char **argv) {
         sleep(1);
     }
 
+    /* Schedule a batch, reserved and committed in one step. */
+    struct threadpool_task batch[40];
+    for (int i = 0; i < 40; i++) { batch[i] = task; }
+    size_t batched = 0;
+    while (batched < 40) {
+        size_t counterpressure = 0;
+        batched += Threadpool_ScheduleBatch(t, &batch[batched],
+            40 - batched, &counterpressure);
+        if (batched < 40) { usleep(10 * 1000 * counterpressure); }
+    }
+    printf("scheduled batch of 40...\n");
+
+    while (task_count < 5 * 40) {
+        sleep(1);
+    }
+
+    /* Once idle, threads beyond min_threads should be reaped. */
+    do {
+        (void)poll(NULL, 0, 5 * idle_timeout);
+        Threadpool_Stats(t, &stats);
+    } while (stats.active_threads > 0);
+    Threadpool_Stats(t, &stats);
+    dump_stats("idle...", &stats);
+    assert(stats.active_threads + stats.dormant_threads == cfg.min_threads);
+    assert(stats.reaped_threads == stats.spawned_threads - cfg.min_threads);
+
     task.task = inf_loop_cb;
     size_t counterpressure = 0;
     while (!Threadpool_Schedule(t, &task, &counterpressure)) {
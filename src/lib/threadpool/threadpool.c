@@ -17,6 +17,10 @@
 * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 *
 */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L     /* for clock_gettime */
+#endif
+
 #include <stdio.h>
 #include <pthread.h>
 #include <unistd.h>
@@ -25,6 +29,9 @@
 #include <err.h>
 #include <poll.h>
 #include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <time.h>
 
 #include "threadpool_internals.h"
 
@@ -33,12 +40,25 @@
 #define INFINITE_DELAY -1 /* poll will only return upon an event */
 #define DEFAULT_TASK_RINGBUF_SIZE2 8
 #define DEFAULT_MAX_THREADS 8
+#define DEFAULT_IDLE_TIMEOUT 1000 /* msec */
+#define DEFAULT_SLOW_TASK_USEC 1000
+
+/* Weight of the newest sample in the callback latency moving average,
+ * as a right shift: 3 => 1/8. */
+#define LATENCY_EWMA_SHIFT 3
 
-static void notify_new_task(struct threadpool *t);
+static void notify_new_tasks(struct threadpool *t, size_t count);
 static bool notify_shutdown(struct threadpool *t);
+static bool claim_live_thread(struct thread_info *ti);
+static bool grow(struct threadpool *t);
 static bool spawn(struct threadpool *t);
+static struct thread_info *claim_slot(struct threadpool *t);
+static bool retire_idle_thread(struct threadpool *t, struct thread_info *ti);
+static void observe_task_latency(struct threadpool *t,
+    struct timespec *start, struct timespec *done);
 static void *thread_task(void *thread_info);
 static void commit_current_task(struct threadpool *t, struct marked_task *task, size_t wh);
+static void advance_commit_head(struct threadpool *t);
 static void release_current_task(struct threadpool *t, struct marked_task *task, size_t rh);
 
 static void set_defaults(struct threadpool_config *cfg) {
@@ -47,6 +67,8 @@ static void set_defaults(struct threadpool_config *cfg) {
     }
     
     if (cfg->max_threads == 0) { cfg->max_threads = DEFAULT_MAX_THREADS; }
+    if (cfg->idle_timeout == 0) { cfg->idle_timeout = DEFAULT_IDLE_TIMEOUT; }
+    if (cfg->slow_task_usec == 0) { cfg->slow_task_usec = DEFAULT_SLOW_TASK_USEC; }
 }
 
 struct threadpool *Threadpool_Init(struct threadpool_config *cfg) {
@@ -56,6 +78,7 @@ struct threadpool *Threadpool_Init(struct threadpool_config *cfg) {
         return NULL;
     }
     if (cfg->max_threads < 1) { return NULL; }
+    if (cfg->min_threads > cfg->max_threads) { return NULL; }
 
     struct threadpool *t = NULL;
     struct marked_task *tasks = NULL;
@@ -75,6 +98,10 @@ struct threadpool *Threadpool_Init(struct threadpool_config *cfg) {
 
     memset(t, 0, sizeof(*t));
     memset(threads, 0, threads_sz);
+    for (size_t i = 0; i < cfg->max_threads; i++) {
+        threads[i].parent_fd = -1;
+        threads[i].child_fd = -1;
+    }
 
     /* Note: tasks is memset to a non-0 value so that the first slot,
      * tasks[0].mark, will not match its ID and leave it in a
@@ -86,7 +113,11 @@ struct threadpool *Threadpool_Init(struct threadpool_config *cfg) {
     t->task_ringbuf_size = 1 << cfg->task_ringbuf_size2;
     t->task_ringbuf_size2 = cfg->task_ringbuf_size2;
     t->task_ringbuf_mask = t->task_ringbuf_size - 1;
+    t->min_threads = cfg->min_threads;
     t->max_threads = cfg->max_threads;
+    t->idle_timeout = (cfg->idle_timeout < MIN_DELAY ? MIN_DELAY
+        : cfg->idle_timeout > INT_MAX ? INT_MAX : (int)cfg->idle_timeout);
+    t->slow_task_usec = cfg->slow_task_usec;
     return t;
 
 cleanup:
@@ -125,19 +156,75 @@ bool Threadpool_Schedule(struct threadpool *t, struct threadpool_task *task,
             tbuf->udata = task->udata;
 
             commit_current_task(t, tbuf, wh);
-            notify_new_task(t);
+            notify_new_tasks(t, 1);
             if (pushback) { *pushback = wh - rh; }
             return true;
         }
     }
 }
 
+size_t Threadpool_ScheduleBatch(struct threadpool *t,
+        struct threadpool_task *tasks, size_t count, size_t *pushback) {
+    if (t == NULL || tasks == NULL) { return 0; }
+
+    /* New tasks must not be scheduled after the threadpool starts
+     * shutting down. */
+    if (t->shutting_down) { return 0; }
+
+    /* Only schedule up to the first invalid task. */
+    for (size_t i = 0; i < count; i++) {
+        if (tasks[i].task == NULL) {
+            count = i;
+            break;
+        }
+    }
+    if (count == 0) { return 0; }
+
+    size_t queue_size = t->task_ringbuf_size - 1;
+    size_t mask = queue_size;
+
+    for (;;) {
+        size_t wh = t->task_reserve_head;
+        size_t rh = t->task_release_head;
+
+        if (wh - rh >= queue_size - 1) {
+            if (pushback) { *pushback = wh - rh; }
+            return 0;           /* full, cannot schedule */
+        }
+
+        size_t available = queue_size - 1 - (wh - rh);
+        size_t n = (count < available ? count : available);
+
+        if (ATOMIC_BOOL_COMPARE_AND_SWAP(&t->task_reserve_head, wh, wh + n)) {
+            assert(t->task_reserve_head - t->task_release_head < queue_size);
+            for (size_t i = 0; i < n; i++) {
+                struct marked_task *tbuf = &t->tasks[(wh + i) & mask];
+                tbuf->task = tasks[i].task;
+                tbuf->cleanup = tasks[i].cleanup;
+                tbuf->udata = tasks[i].udata;
+                tbuf->mark = wh + i;
+            }
+
+            advance_commit_head(t);
+            notify_new_tasks(t, n);
+            if (pushback) { *pushback = wh - rh; }
+            return n;
+        }
+    }
+}
+
 static void commit_current_task(struct threadpool *t, struct marked_task *task, size_t wh) {
-    size_t mask = t->task_ringbuf_mask;
     task->mark = wh;
+    advance_commit_head(t);
+}
+
+/* Advance task_commit_head past every consecutive task whose mark shows
+ * it has been fully written. */
+static void advance_commit_head(struct threadpool *t) {
+    size_t mask = t->task_ringbuf_mask;
     for (;;) {
         size_t ch = t->task_commit_head;
-        task = &t->tasks[ch & mask];
+        struct marked_task *task = &t->tasks[ch & mask];
         if (ch != task->mark) { break; }
         assert(ch < t->task_reserve_head);
         if (ATOMIC_BOOL_COMPARE_AND_SWAP(&t->task_commit_head, ch, ch + 1)) {
@@ -148,15 +235,26 @@ static void commit_current_task(struct threadpool *t, struct marked_task *task,
 
 void Threadpool_Stats(struct threadpool *t, struct threadpool_info *info) {
     if (info) {
-        uint8_t at = 0;
-        for (int i = 0; i < t->live_threads; i++) {
+        uint16_t at = 0;
+        uint16_t dt = 0;
+        for (size_t i = 0; i < t->used_slots; i++) {
             struct thread_info *ti = &t->threads[i];
-            if (ti->status == STATUS_AWAKE) { at++; }
+            if (ti->status == STATUS_AWAKE) {
+                at++;
+            } else if (ti->status == STATUS_ASLEEP || ti->status == STATUS_RETIRING) {
+                dt++;
+            }
         }
         info->active_threads = at;
-
-        info->dormant_threads = t->live_threads - at;
+        info->dormant_threads = dt;
         info->backlog_size = t->task_commit_head - t->task_request_head;
+
+        info->peak_threads = t->peak_threads;
+        info->spawned_threads = t->spawned_threads;
+        info->reaped_threads = t->reaped_threads;
+        info->backlog_grows = t->backlog_grows;
+        info->latency_grows = t->latency_grows;
+        info->avg_task_usec = t->avg_task_usec;
     }
 }
 
@@ -165,10 +263,9 @@ bool Threadpool_Shutdown(struct threadpool *t, bool kill_all) {
     size_t mask = t->task_ringbuf_mask;
 
     if (kill_all) {
-        for (int i = 0; i < t->live_threads; i++) {
+        for (size_t i = 0; i < t->used_slots; i++) {
             struct thread_info *ti = &t->threads[i];
-            if (ti->status < STATUS_SHUTDOWN) {
-                ti->status = STATUS_SHUTDOWN;
+            if (claim_live_thread(ti)) {
                 int pcres = pthread_cancel(ti->t);
                 if (pcres != 0) {
                     /* If this fails, tolerate the failure that the
@@ -205,14 +302,17 @@ void Threadpool_Free(struct threadpool *t) {
     free(t);
 }
 
-static void notify_new_task(struct threadpool *t) {
-    for (int i = 0; i < t->live_threads; i++) {
+/* Wake up to COUNT sleeping threads for newly committed tasks, each at
+ * most once, then consider growing the pool for any remaining tasks. */
+static void notify_new_tasks(struct threadpool *t, size_t count) {
+    size_t woken = 0;
+    for (size_t i = 0; i < t->used_slots && woken < count; i++) {
         struct thread_info *ti = &t->threads[i];
         if (ti->status == STATUS_ASLEEP) {
             ssize_t res = write(ti->parent_fd,
                 NOTIFY_MSG, NOTIFY_MSG_LEN);
             if (NOTIFY_MSG_LEN == res) {
-                return;
+                woken++;
             } else if (res == -1) {
                 err(1, "write");
             } else {
@@ -221,72 +321,240 @@ static void notify_new_task(struct threadpool *t) {
         }
     }
 
-    if (t->live_threads < t->max_threads) { /* spawn */
-        if (spawn(t)) {
-            SPIN_ADJ(t->live_threads, 1);
-        }
+    for (; woken < count; woken++) {
+        if (!grow(t)) { break; }
+    }
+}
+
+/* No thread is asleep, so decide whether the backlog justifies starting
+ * another one. Threads are always added while below min_threads or while
+ * the backlog outnumbers the live threads; otherwise, only when callbacks
+ * are slow enough that the busy threads won't get to it soon. */
+static bool grow(struct threadpool *t) {
+    size_t live = t->live_threads;
+    if (live >= t->max_threads) {
+        return false;   /* all awake & busy, just keep out of the way & let them work */
+    }
+
+    size_t backlog = t->task_commit_head - t->task_request_head;
+    size_t *reason = NULL;
+    if (live < t->min_threads || backlog >= live) {
+        reason = &t->backlog_grows;
+    } else if (t->avg_task_usec >= t->slow_task_usec) {
+        reason = &t->latency_grows;
     } else {
-        /* all awake & busy, just keep out of the way & let them work */
+        return false;   /* fast callbacks, the backlog will drain shortly */
+    }
+
+    if (spawn(t)) {
+        SPIN_ADJ(*reason, 1);
+        return true;
+    }
+    return false;
+}
+
+/* Mark TI's thread STATUS_SHUTDOWN, if it is running. Returns false for
+ * slots with no thread to cancel: never spawned, still being spawned,
+ * reaped, or already shut down. A retiring thread is waited out, since
+ * it may be about to exit. */
+static bool claim_live_thread(struct thread_info *ti) {
+    for (;;) {
+        thread_status_t status = ti->status;
+        if (status == STATUS_AWAKE || status == STATUS_ASLEEP) {
+            if (ATOMIC_BOOL_COMPARE_AND_SWAP(&ti->status, status, STATUS_SHUTDOWN)) {
+                return true;
+            }
+        } else if (status == STATUS_RETIRING) {
+            sched_yield();
+        } else {
+            return false;
+        }
     }
 }
 
 static bool notify_shutdown(struct threadpool *t) {
-    int done = 0;
-    
-    for (int i = 0; i < t->live_threads; i++) {
+    size_t done = 0;
+
+    for (size_t i = 0; i < t->used_slots; i++) {
         struct thread_info *ti = &t->threads[i];
-        if (ti->status == STATUS_JOINED) {
+        thread_status_t status = ti->status;
+        if (status == STATUS_JOINED || status == STATUS_NONE) {
             done++;
-        } else if (ti->status == STATUS_SHUTDOWN) {
+        } else if (status == STATUS_SHUTDOWN || status == STATUS_REAPED) {
             void *v = NULL;
             int joinres = pthread_join(ti->t, &v);
             if (0 == joinres) {
+                if (status == STATUS_REAPED) {
+                    /* Reaped threads leave their pipe open for reuse. */
+                    close(ti->child_fd);
+                    ti->child_fd = -1;
+                    if (ti->parent_fd != -1) {
+                        close(ti->parent_fd);
+                        ti->parent_fd = -1;
+                    }
+                }
                 ti->status = STATUS_JOINED;
                 done++;
             } else {
                 fprintf(stderr, "pthread_join: %d\n", joinres);
                 assert(joinres == ESRCH);
             }
-        } else {
+        } else if (status == STATUS_SPAWNING) {
+            /* still starting up, check again next time */
+        } else if (ti->parent_fd != -1) {
             close(ti->parent_fd);
+            ti->parent_fd = -1;
         }
     }
-    
-    return (done == t->live_threads);
+
+    return (done == t->used_slots);
 }
 
 static bool spawn(struct threadpool *t) {
-    int id = t->live_threads;
-    if (id >= t->max_threads) { return false; }
-    struct thread_info *ti = &t->threads[id];
+    /* Reserve a place in live_threads first, so concurrent spawns
+     * cannot exceed max_threads. */
+    for (;;) {
+        size_t live = t->live_threads;
+        if (live >= t->max_threads) { return false; }
+        if (ATOMIC_BOOL_COMPARE_AND_SWAP(&t->live_threads, live, live + 1)) {
+            break;
+        }
+    }
 
-    struct thread_context *tc = malloc(sizeof(*tc));
-    if (tc == NULL) { return false; }
+    struct thread_info *ti = claim_slot(t);
+    if (ti == NULL) { goto fail; }
 
-    int pipe_fds[2];
-    if (0 != pipe(pipe_fds)) {
-        printf("pipe(2) failure\n");
-        free(tc);
-        return false;
+    struct thread_context *tc = malloc(sizeof(*tc));
+    if (tc == NULL) { goto fail; }
+
+    if (ti->child_fd == -1) {
+        int pipe_fds[2];
+        if (0 != pipe(pipe_fds)) {
+            printf("pipe(2) failure\n");
+            free(tc);
+            goto fail;
+        }
+        ti->child_fd = pipe_fds[0];
+        ti->parent_fd = pipe_fds[1];
     }
 
-    ti->child_fd = pipe_fds[0];
-    ti->parent_fd = pipe_fds[1];
-
     *tc = (struct thread_context){ .t = t, .ti = ti };
 
+    /* Mark the slot awake before the thread can run, since thread_task
+     * exits as soon as it sees a status at or past STATUS_SHUTDOWN. */
+    ti->status = STATUS_AWAKE;
     int res = pthread_create(&ti->t, NULL, thread_task, tc);
     if (res == 0) {
-        ti->status = STATUS_AWAKE;
+        SPIN_ADJ(t->spawned_threads, 1);
+        for (;;) {
+            size_t peak = t->peak_threads;
+            size_t live = t->live_threads;
+            if (live <= peak) { break; }
+            if (ATOMIC_BOOL_COMPARE_AND_SWAP(&t->peak_threads, peak, live)) {
+                break;
+            }
+        }
         return true;
     } else if (res == EAGAIN) {
-        close(pipe_fds[0]);
-        close(pipe_fds[1]);
         free(tc);
-        return false;
+        goto fail;
     } else {
         assert(false);
-    }                    
+    }
+
+fail:
+    if (ti) {
+        if (ti->child_fd != -1) {
+            close(ti->child_fd);
+            close(ti->parent_fd);
+            ti->child_fd = -1;
+            ti->parent_fd = -1;
+        }
+        ti->status = STATUS_NONE;
+    }
+    SPIN_ADJ(t->live_threads, -1);
+    return false;
+}
+
+/* Claim a thread slot that was never used or whose idle thread has been
+ * reaped, marking it STATUS_SPAWNING. A reaped slot's previous thread is
+ * joined, and its pipe is kept for the new thread. */
+static struct thread_info *claim_slot(struct threadpool *t) {
+    for (;;) {
+        bool retiring = false;
+        for (size_t i = 0; i < t->max_threads; i++) {
+            struct thread_info *ti = &t->threads[i];
+            thread_status_t status = ti->status;
+            if (status == STATUS_RETIRING) {
+                retiring = true;
+            } else if (status == STATUS_REAPED) {
+                if (ATOMIC_BOOL_COMPARE_AND_SWAP(&ti->status, STATUS_REAPED, STATUS_SPAWNING)) {
+                    void *v = NULL;
+                    (void)pthread_join(ti->t, &v);
+                    return ti;
+                }
+            } else if (status == STATUS_NONE) {
+                if (ATOMIC_BOOL_COMPARE_AND_SWAP(&ti->status, STATUS_NONE, STATUS_SPAWNING)) {
+                    for (;;) {
+                        size_t used = t->used_slots;
+                        if (used > i) { break; }
+                        if (ATOMIC_BOOL_COMPARE_AND_SWAP(&t->used_slots, used, i + 1)) {
+                            break;
+                        }
+                    }
+                    return ti;
+                }
+            }
+        }
+
+        /* A retiring thread is about to either free its slot or stay. */
+        if (!retiring) { return NULL; }
+        sched_yield();
+    }
+}
+
+/* Called by an idle thread when its poll times out. Returns true if the
+ * thread has been retired, in which case it must exit without touching
+ * TI again, because the slot may already belong to a new thread. */
+static bool retire_idle_thread(struct threadpool *t, struct thread_info *ti) {
+    if (t->shutting_down || t->live_threads <= t->min_threads) { return false; }
+    if (!ATOMIC_BOOL_COMPARE_AND_SWAP(&ti->status, STATUS_ASLEEP, STATUS_RETIRING)) {
+        return false;
+    }
+
+    /* notify_new_task skips RETIRING threads, so after this point new
+     * tasks will either be seen below or will grow the pool. */
+    for (;;) {
+        size_t live = t->live_threads;
+        if (live <= t->min_threads) {
+            ti->status = STATUS_ASLEEP;
+            return false;
+        }
+        if (ATOMIC_BOOL_COMPARE_AND_SWAP(&t->live_threads, live, live - 1)) {
+            break;
+        }
+    }
+
+    if (t->task_request_head != t->task_commit_head) {
+        SPIN_ADJ(t->live_threads, 1);
+        ti->status = STATUS_AWAKE;
+        return false;
+    }
+
+    SPIN_ADJ(t->reaped_threads, 1);
+    ti->status = STATUS_REAPED;
+    return true;
+}
+
+static void observe_task_latency(struct threadpool *t,
+        struct timespec *start, struct timespec *done) {
+    size_t usec = (done->tv_sec - start->tv_sec) * 1000000L
+        + (done->tv_nsec - start->tv_nsec) / 1000L;
+
+    /* The moving average is advisory, so a racing update is harmless. */
+    size_t avg = t->avg_task_usec;
+    t->avg_task_usec = avg - (avg >> LATENCY_EWMA_SHIFT)
+        + (usec >> LATENCY_EWMA_SHIFT);
 }
 
 static void *thread_task(void *arg) {
@@ -300,18 +568,24 @@ static void *thread_task(void *arg) {
 
     while (ti->status < STATUS_SHUTDOWN) {
         if (t->task_request_head == t->task_commit_head) {
-            if (ti->status == STATUS_AWAKE) {
-                ti->status = STATUS_ASLEEP;
-            }
-            int res = poll(pfd, 1, -1);
-            if (res == 1) {
+            /* Status changes race Threadpool_Shutdown, so only make
+             * them if it has not claimed the slot. */
+            (void)ATOMIC_BOOL_COMPARE_AND_SWAP(&ti->status, STATUS_AWAKE, STATUS_ASLEEP);
+            int res = poll(pfd, 1, t->idle_timeout);
+            if (res == 0) {
+                if (retire_idle_thread(t, ti)) {
+                    free(tc);
+                    return NULL;
+                }
+                continue;
+            } else if (res == 1) {
                 if (pfd[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
                     /* TODO: HUP should be distinct from ERR -- hup is
                      * intentional shutdown, ERR probably isn't. */
                     ti->status = STATUS_SHUTDOWN;
                     break;
                 } else if (pfd[0].revents & POLLIN) {
-                    if (ti->status == STATUS_ASLEEP) { ti->status = STATUS_AWAKE; }
+                    (void)ATOMIC_BOOL_COMPARE_AND_SWAP(&ti->status, STATUS_ASLEEP, STATUS_AWAKE);
                     //SPIN_ADJ(t->active_threads, 1);
                     ssize_t rres = read(ti->child_fd, read_buf, sizeof(read_buf));
                     if (rres < 0) {
@@ -339,7 +613,13 @@ static void *thread_task(void *arg) {
 
                 release_current_task(t, ptask, rh);
                 ptask = NULL;
+
+                struct timespec start;
+                struct timespec done;
+                clock_gettime(CLOCK_MONOTONIC, &start);
                 task.task(task.udata);
+                clock_gettime(CLOCK_MONOTONIC, &done);
+                observe_task_latency(t, &start, &done);
                 break;
             }
         }
@@ -34,7 +34,12 @@ struct threadpool;
 struct threadpool_config {
     uint8_t task_ringbuf_size2; //> log2(size) of task ring buffer
     size_t max_delay;           //> max delay, in msec. 0 => default
-    uint8_t max_threads;        //> max threads to alloc on demand
+    uint16_t min_threads;       //> threads kept alive even when idle
+    uint16_t max_threads;       //> max threads to alloc on demand
+    size_t idle_timeout;        //> msec before an idle thread above
+                                //  min_threads is reaped. 0 => default
+    size_t slow_task_usec;      //> callbacks averaging longer than this
+                                //  grow the pool eagerly. 0 => default
 };
 
 /** Callback for a task, with an arbitrary user-supplied pointer. */
@@ -53,9 +58,17 @@ struct threadpool_task {
 
 /** Statistics about the current state of the threadpool. */
 struct threadpool_info {
-    uint8_t active_threads;
-    uint8_t dormant_threads;
+    uint16_t active_threads;
+    uint16_t dormant_threads;
     size_t backlog_size;
+
+    /* Sizing decisions, counted since Threadpool_Init. */
+    uint16_t peak_threads;      //> most threads live at once
+    size_t spawned_threads;     //> threads started
+    size_t reaped_threads;      //> idle threads retired
+    size_t backlog_grows;       //> spawns due to backlog outpacing threads
+    size_t latency_grows;       //> spawns due to slow callbacks
+    size_t avg_task_usec;       //> moving average of callback latency
 };
 
 /** Initialize a threadpool, according to a config. Returns NULL on error. */
@@ -72,6 +85,19 @@ struct threadpool *Threadpool_Init(struct threadpool_config *cfg);
 bool Threadpool_Schedule(struct threadpool *t, struct threadpool_task *task,
     size_t *pushback);
 
+/** Schedule up to COUNT tasks in the threadpool at once. Space for all
+ * of them is reserved in a single atomic step, they are committed
+ * together, and each idle worker is woken at most once, so this is
+ * cheaper than calling Threadpool_Schedule in a loop.
+ *
+ * Returns how many tasks were registered. If the backlog is too full for
+ * all of them, only a prefix of TASKS is scheduled, and the caller keeps
+ * ownership of the rest. *pushback is set as in Threadpool_Schedule.
+ *
+ * TASKS are copied into the threadpool by value. */
+size_t Threadpool_ScheduleBatch(struct threadpool *t,
+    struct threadpool_task *tasks, size_t count, size_t *pushback);
+
 /** If TI is non-NULL, fill out some statistics about the operating state
  * of the thread pool. */
 void Threadpool_Stats(struct threadpool *t, struct threadpool_info *ti);
@@ -28,8 +28,11 @@ typedef enum {
     STATUS_NONE,                //> undefined status
     STATUS_ASLEEP,              //> thread is poll-sleeping to reduce CPU
     STATUS_AWAKE,               //> thread is active
+    STATUS_RETIRING,            //> idle thread is checking whether to exit
     STATUS_SHUTDOWN,            //> thread has been notified about shutdown
     STATUS_JOINED,              //> thread has been pthread_join'd
+    STATUS_REAPED,              //> thread exited while idle, slot reusable
+    STATUS_SPAWNING,            //> slot claimed by a thread being started
 } thread_status_t;
 
 /** Info retained by a thread while working. */
@@ -79,9 +82,21 @@ struct threadpool {
     uint8_t task_ringbuf_size2; //> log2 of size of ring buffer
 
     bool shutting_down;         //> shutdown has been called
-    uint8_t live_threads;       //> currently live threads
-    uint8_t max_threads;        //> max number of threads to start
+    size_t live_threads;        //> currently live threads
+    size_t used_slots;          //> high-water mark of slots in threads[]
+    uint16_t min_threads;       //> threads exempt from idle reaping
+    uint16_t max_threads;       //> max number of threads to start
+    int idle_timeout;           //> msec before reaping an idle thread
+    size_t slow_task_usec;      //> latency that triggers eager growth
     struct thread_info *threads;
+
+    /* Sizing statistics, see struct threadpool_info. */
+    size_t peak_threads;
+    size_t spawned_threads;
+    size_t reaped_threads;
+    size_t backlog_grows;
+    size_t latency_grows;
+    size_t avg_task_usec;
 };
 
 /* Do an atomic compare-and-swap, changing *PTR from OLD to NEW. Returns
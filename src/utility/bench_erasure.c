@@ -0,0 +1,187 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <err.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "kinetic_rs.h"
+
+/* Microbenchmark for the Reed-Solomon codec behind KineticErasure_*. For
+ * each value size, encodes K data fragments into M parity fragments, and
+ * decodes with the first M data fragments lost (the most work a GET can
+ * need), with each implementation the CPU supports. Prints one JSON
+ * object per run with value bytes coded per second of CPU time, i.e. per
+ * core. */
+
+typedef enum {
+    CODE_ENCODE,
+    CODE_DECODE,
+} code_mode;
+
+static const char *mode_names[] = {
+    "rs_encode",
+    "rs_decode",
+};
+
+static const char *impl_names[] = {
+    "scalar",
+    "ssse3",
+    "avx2",
+};
+
+#define DEFAULT_OP_COUNT 1000
+#define DEFAULT_DATA_FRAGMENTS 8
+#define DEFAULT_PARITY_FRAGMENTS 4
+#define MAX_VALUE_SIZE (64 * 1024 * 1024)
+
+static const size_t default_sizes[] = {4096, 65536, 1024 * 1024};
+
+static const char *executable_name;
+
+typedef struct {
+    size_t op_count;
+    size_t value_size;      ///< 0 runs all of default_sizes
+    size_t k;
+    size_t m;
+} bench_state;
+
+static int64_t cpu_usec(void) {
+    struct rusage ru;
+    if (0 != getrusage(RUSAGE_SELF, &ru)) { err(1, "getrusage"); }
+    return 1000000L * (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)
+      + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "Usage: %s [-n OPS] [-p VALUE_SIZE] [-k DATA_FRAGMENTS] [-m PARITY_FRAGMENTS]\n"
+        "    Without -p, runs value sizes of 4 KB to 1 MB.\n"
+        , executable_name);
+    exit(1);
+}
+
+static void parse_args(int argc, char **argv, bench_state *s) {
+    int a = 0;
+
+    s->op_count = DEFAULT_OP_COUNT;
+    s->k = DEFAULT_DATA_FRAGMENTS;
+    s->m = DEFAULT_PARITY_FRAGMENTS;
+
+    while ((a = getopt(argc, argv, "n:p:k:m:")) != -1) {
+        switch (a) {
+        case 'n':               /* coded values per run */
+            s->op_count = strtoul(optarg, NULL, 10);
+            break;
+        case 'p':               /* value size */
+            s->value_size = strtoul(optarg, NULL, 10);
+            break;
+        case 'k':               /* data fragments */
+            s->k = strtoul(optarg, NULL, 10);
+            break;
+        case 'm':               /* parity fragments */
+            s->m = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "illegal option: -- %c\n", a);
+            usage();
+        }
+    }
+
+    if (s->op_count == 0) { usage(); }
+    if (s->value_size > MAX_VALUE_SIZE) { usage(); }
+    if (s->k == 0 || s->m == 0 || s->k + s->m > KINETIC_RS_MAX_FRAGMENTS) { usage(); }
+    // Decoding loses M data fragments
+    if (s->m > s->k) { usage(); }
+}
+
+static double run(bench_state *s, size_t value_size, code_mode mode, KineticRSImpl impl) {
+    size_t const k = s->k;
+    size_t const m = s->m;
+    size_t const fragment_size = (value_size + k - 1) / k;
+    uint8_t *fragments = malloc((k + m) * fragment_size + 1);
+    KineticRS *rs = KineticRS_Create(k, m);
+    if (fragments == NULL || rs == NULL) { err(1, "malloc"); }
+    for (size_t i = 0; i < (k + m) * fragment_size; i++) { fragments[i] = (uint8_t)i; }
+
+    uint8_t const *data[KINETIC_RS_MAX_FRAGMENTS];
+    uint8_t *all[KINETIC_RS_MAX_FRAGMENTS];
+    bool present[KINETIC_RS_MAX_FRAGMENTS];
+    for (size_t i = 0; i < k + m; i++) {
+        all[i] = &fragments[i * fragment_size];
+        data[i] = all[i];
+        present[i] = (i >= m);
+    }
+    KineticRS_Encode(rs, data, &all[k], fragment_size);
+
+    int64_t start_cpu = cpu_usec();
+    for (size_t i = 0; i < s->op_count; i++) {
+        switch (mode) {
+        case CODE_ENCODE:
+            KineticRS_Encode(rs, data, &all[k], fragment_size);
+            break;
+        case CODE_DECODE:
+            if (!KineticRS_Reconstruct(rs, all, present, fragment_size)) {
+                errx(1, "reconstruct failed");
+            }
+            break;
+        }
+    }
+    int64_t cpu = cpu_usec() - start_cpu;
+    if (cpu <= 0) { cpu = 1; }
+    KineticRS_Destroy(rs);
+    free(fragments);
+
+    double bytes_per_sec = (double)s->op_count * value_size / (cpu / 1000000.0);
+    printf("{\"scenario\":\"%s\",\"impl\":\"%s\",\"value_bytes\":%zd,"
+        "\"data_fragments\":%zd,\"parity_fragments\":%zd,\"ops\":%zd,"
+        "\"cpu_sec\":%.3f,\"mb_per_sec_per_core\":%.1f}\n",
+        mode_names[mode], impl_names[impl], value_size, k, m,
+        s->op_count, cpu / 1000000.0, bytes_per_sec / (1024 * 1024));
+    fflush(stdout);
+    return bytes_per_sec;
+}
+
+int main(int argc, char **argv) {
+    bench_state state;
+    memset(&state, 0, sizeof(state));
+    executable_name = argv[0];
+    parse_args(argc, argv, &state);
+
+    KineticRSImpl best = KineticRS_BestImpl();
+    size_t size_count = state.value_size ? 1 : NUM_ELEMENTS(default_sizes);
+    for (size_t i = 0; i < size_count; i++) {
+        size_t size = state.value_size ? state.value_size : default_sizes[i];
+        for (code_mode mode = CODE_ENCODE; mode <= CODE_DECODE; mode++) {
+            double rates[NUM_ELEMENTS(impl_names)] = {0};
+            for (KineticRSImpl impl = KINETIC_RS_SCALAR; impl <= best; impl++) {
+                if (!KineticRS_SetImpl(impl)) { continue; }
+                rates[impl] = run(&state, size, mode, impl);
+            }
+            fprintf(stderr, "%zd byte values: %s %.2fx per core with %s\n",
+                size, mode_names[mode], rates[best] / rates[KINETIC_RS_SCALAR],
+                impl_names[best]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <err.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
+
+/* Microbenchmark for request signing. For each command size, signs the
+ * same message repeatedly: the way requests used to be signed (setting
+ * the key up for every request), with the session's precomputed key
+ * state, and KINETIC_HMAC_MB_MAX_LANES at a time in SIMD lanes. Prints
+ * one JSON object per run with signed ops per second of CPU time, i.e.
+ * per core. */
+
+typedef enum {
+    SIGN_PER_REQUEST,
+    SIGN_PRECOMPUTED,
+    SIGN_MULTI_BUFFER,
+} sign_mode;
+
+static const char *mode_names[] = {
+    "hmac_per_request",
+    "hmac_precomputed",
+    "hmac_multi_buffer",
+};
+
+#define DEFAULT_OP_COUNT 1000000
+#define DEFAULT_KEY "asdfasdf"
+#define MAX_COMMAND_SIZE (1024 * 1024)
+
+static const size_t default_sizes[] = {16, 64, 128, 256, 1024};
+
+static const char *executable_name;
+
+typedef struct {
+    size_t op_count;
+    size_t command_size;    ///< 0 runs all of default_sizes
+    const char *key;
+} bench_state;
+
+static int64_t cpu_usec(void) {
+    struct rusage ru;
+    if (0 != getrusage(RUSAGE_SELF, &ru)) { err(1, "getrusage"); }
+    return 1000000L * (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)
+      + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "Usage: %s [-n OPS] [-p COMMAND_SIZE] [-k KEY]\n"
+        "    Without -p, runs command sizes of 16 to 1024 bytes.\n"
+        , executable_name);
+    exit(1);
+}
+
+static void parse_args(int argc, char **argv, bench_state *s) {
+    int a = 0;
+
+    s->op_count = DEFAULT_OP_COUNT;
+    s->key = DEFAULT_KEY;
+
+    while ((a = getopt(argc, argv, "n:p:k:")) != -1) {
+        switch (a) {
+        case 'n':               /* signed ops per run */
+            s->op_count = strtoul(optarg, NULL, 10);
+            break;
+        case 'p':               /* command size */
+            s->command_size = strtoul(optarg, NULL, 10);
+            break;
+        case 'k':               /* HMAC key */
+            s->key = optarg;
+            break;
+        default:
+            fprintf(stderr, "illegal option: -- %c\n", a);
+            usage();
+        }
+    }
+
+    if (s->op_count == 0) { usage(); }
+    // Multi-buffer runs sign a full set of lanes at a time
+    s->op_count += (KINETIC_HMAC_MB_MAX_LANES - s->op_count % KINETIC_HMAC_MB_MAX_LANES)
+        % KINETIC_HMAC_MB_MAX_LANES;
+    if (s->command_size > MAX_COMMAND_SIZE) { usage(); }
+    if (strlen(s->key) == 0) { usage(); }
+}
+
+static double run(bench_state *s, size_t command_size, sign_mode mode) {
+    uint8_t *command = malloc(command_size);
+    if (command == NULL) { err(1, "malloc"); }
+    for (size_t i = 0; i < command_size; i++) { command[i] = (uint8_t)i; }
+
+    ByteArray key = ByteArray_CreateWithCString(s->key);
+    KineticHMACKey hmacKey;
+    KineticHMAC_InitKey(&hmacKey, key);
+
+    uint8_t hmacData[KINETIC_HMAC_MAX_LEN];
+    Com__Seagate__Kinetic__Proto__Message__HMACauth hmacAuth =
+        COM__SEAGATE__KINETIC__PROTO__MESSAGE__HMACAUTH__INIT;
+    hmacAuth.hmac = (ProtobufCBinaryData) {.data = hmacData, .len = sizeof(hmacData)};
+    Com__Seagate__Kinetic__Proto__Message msg = COM__SEAGATE__KINETIC__PROTO__MESSAGE__INIT;
+    msg.hmacauth = &hmacAuth;
+    msg.has_commandbytes = true;
+    msg.commandbytes = (ProtobufCBinaryData) {.data = command, .len = command_size};
+
+    ByteArray commands[KINETIC_HMAC_MB_MAX_LANES];
+    uint8_t digests[KINETIC_HMAC_MB_MAX_LANES][KINETIC_HMAC_SHA1_LEN];
+    for (size_t i = 0; i < KINETIC_HMAC_MB_MAX_LANES; i++) {
+        commands[i] = ByteArray_Create(command, command_size);
+    }
+
+    KineticHMAC hmac;
+    int64_t start_cpu = cpu_usec();
+    for (size_t i = 0; i < s->op_count; i++) {
+        command[0] = (uint8_t)i;
+        switch (mode) {
+        case SIGN_PER_REQUEST:
+            KineticHMAC_Populate(&hmac, &msg, key);
+            break;
+        case SIGN_PRECOMPUTED:
+            KineticHMAC_PopulateWithKey(&hmac, &msg, &hmacKey);
+            break;
+        case SIGN_MULTI_BUFFER:
+            KineticHMACMB_Compute(&hmacKey, commands, digests, KINETIC_HMAC_MB_MAX_LANES);
+            i += KINETIC_HMAC_MB_MAX_LANES - 1;
+            break;
+        }
+    }
+    int64_t cpu = cpu_usec() - start_cpu;
+    if (cpu <= 0) { cpu = 1; }
+    free(command);
+
+    double ops_per_sec = s->op_count / (cpu / 1000000.0);
+    printf("{\"scenario\":\"%s\",\"command_bytes\":%zd,\"key_bytes\":%zd,"
+        "\"lanes\":%zd,\"ops\":%zd,\"cpu_sec\":%.3f,\"ops_per_sec_per_core\":%.1f,"
+        "\"cpu_nsec_per_op\":%.1f}\n",
+        mode_names[mode], command_size, key.len, KineticHMACMB_Lanes(),
+        s->op_count, cpu / 1000000.0, ops_per_sec,
+        (cpu * 1000.0) / s->op_count);
+    fflush(stdout);
+    return ops_per_sec;
+}
+
+int main(int argc, char **argv) {
+    bench_state state;
+    memset(&state, 0, sizeof(state));
+    executable_name = argv[0];
+    parse_args(argc, argv, &state);
+
+    size_t size_count = state.command_size ? 1 : NUM_ELEMENTS(default_sizes);
+    for (size_t i = 0; i < size_count; i++) {
+        size_t size = state.command_size ? state.command_size : default_sizes[i];
+        double before = run(&state, size, SIGN_PER_REQUEST);
+        double after = run(&state, size, SIGN_PRECOMPUTED);
+        double batched = run(&state, size, SIGN_MULTI_BUFFER);
+        fprintf(stderr, "%zd byte commands: %.2fx ops/sec per core precomputed, "
+            "%.2fx multi-buffer\n", size, after / before, batched / before);
+    }
+    return 0;
+}
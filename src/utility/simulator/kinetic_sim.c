@@ -0,0 +1,773 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_sim.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_hmac.h"
+#include "kinetic_nbo.h"
+#include "kinetic_logger.h"
+#include "kinetic_pdu_unpack.h"
+#include "kinetic.pb-c.h"
+#include "socket99.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define SIM_DEFAULT_HOST "127.0.0.1"
+#define SIM_DEFAULT_IDENTITY (1)
+#define SIM_DEFAULT_HMAC_KEY "asdfasdf"
+#define SIM_POLL_TIMEOUT_MSEC (100)
+#define SIM_MAX_KEY_RANGE_COUNT (1000)
+
+typedef Com__Seagate__Kinetic__Proto__Command__Status__StatusCode SimStatusCode;
+typedef Com__Seagate__Kinetic__Proto__Command__MessageType SimMessageType;
+
+/* A packed response PDU, waiting for its delay to expire and then for
+ * the socket to take it. */
+typedef struct _SimResponse {
+    struct _SimResponse *next;
+    int64_t due_usec;
+    size_t size;
+    size_t written;
+    uint8_t buf[];
+} SimResponse;
+
+/* One client connection. The receive side uses the same header/body
+ * framing as the client's sink_cb in kinetic_bus.c. */
+typedef struct {
+    int fd;
+    int64_t connectionID;
+    enum socket_state state;
+    KineticPDUHeader header;
+    size_t accumulated;
+    uint8_t *buf;
+    SimResponse *head;
+    SimResponse *tail;
+} SimConnection;
+
+typedef struct {
+    KineticSim *sim;
+    int port;
+    int listen_fd;
+    pthread_t thread;
+    bool thread_started;
+    SimConnection **conns;
+    size_t conn_count;
+    size_t conn_capacity;
+    struct pollfd *fds;
+} SimPort;
+
+struct _KineticSim {
+    KineticSimConfig config;
+    ByteArray hmacKey;
+    KineticSimStore *store;
+    volatile bool running;
+    int64_t next_connection_id;
+    SimPort *ports;
+};
+
+static int64_t now_usec(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) { return 0; }
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*******************************************************************************
+ * Response packing
+*******************************************************************************/
+
+/* Pack COMMAND into a PDU, authenticated with the simulator's HMAC key
+ * (or as an unsolicited status), and queue it on CONN. */
+static bool queue_response(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command *command,
+    const uint8_t *value, size_t valueLen, bool unsolicited)
+{
+    size_t cmdLen = com__seagate__kinetic__proto__command__get_packed_size(command);
+    uint8_t *cmdBuf = malloc(cmdLen > 0 ? cmdLen : 1);
+    if (cmdBuf == NULL) { return false; }
+    com__seagate__kinetic__proto__command__pack(command, cmdBuf);
+
+    uint8_t hmacData[KINETIC_HMAC_MAX_LEN];
+    Com__Seagate__Kinetic__Proto__Message__HMACauth hmacAuth = COM__SEAGATE__KINETIC__PROTO__MESSAGE__HMACAUTH__INIT;
+    Com__Seagate__Kinetic__Proto__Message msg = COM__SEAGATE__KINETIC__PROTO__MESSAGE__INIT;
+    msg.has_commandbytes = true;
+    msg.commandbytes.data = cmdBuf;
+    msg.commandbytes.len = cmdLen;
+    msg.has_authtype = true;
+
+    if (unsolicited) {
+        msg.authtype = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS;
+    } else {
+        msg.authtype = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH;
+        hmacAuth.has_identity = true;
+        hmacAuth.identity = sim->config.identity;
+        hmacAuth.hmac.data = hmacData;
+        msg.hmacauth = &hmacAuth;
+        KineticHMAC hmac;
+        KineticHMAC_Populate(&hmac, &msg, sim->hmacKey);
+    }
+
+    uint32_t protoLen = com__seagate__kinetic__proto__message__get_packed_size(&msg);
+    size_t size = PDU_HEADER_LEN + protoLen + valueLen;
+    SimResponse *res = malloc(sizeof(*res) + size);
+    if (res == NULL) {
+        free(cmdBuf);
+        return false;
+    }
+
+    uint32_t nboProtoLen = KineticNBO_FromHostU32(protoLen);
+    uint32_t nboValueLen = KineticNBO_FromHostU32((uint32_t)valueLen);
+    size_t offset = 0;
+    res->buf[offset++] = 'F';
+    memcpy(&res->buf[offset], &nboProtoLen, sizeof(nboProtoLen));
+    offset += sizeof(nboProtoLen);
+    memcpy(&res->buf[offset], &nboValueLen, sizeof(nboValueLen));
+    offset += sizeof(nboValueLen);
+    offset += com__seagate__kinetic__proto__message__pack(&msg, &res->buf[offset]);
+    if (valueLen > 0) {
+        memcpy(&res->buf[offset], value, valueLen);
+        offset += valueLen;
+    }
+    KINETIC_ASSERT(offset == size);
+    free(cmdBuf);
+
+    res->next = NULL;
+    res->size = size;
+    res->written = 0;
+    res->due_usec = (sim->config.responseDelayUsec > 0 && !unsolicited)
+        ? now_usec() + sim->config.responseDelayUsec : 0;
+
+    if (conn->tail == NULL) {
+        conn->head = res;
+    } else {
+        conn->tail->next = res;
+    }
+    conn->tail = res;
+    return true;
+}
+
+static bool queue_status(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command__Header *reqHeader,
+    SimStatusCode code, const char *statusMessage)
+{
+    Com__Seagate__Kinetic__Proto__Command__Header header = COM__SEAGATE__KINETIC__PROTO__COMMAND__HEADER__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Status status = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__INIT;
+    Com__Seagate__Kinetic__Proto__Command command = COM__SEAGATE__KINETIC__PROTO__COMMAND__INIT;
+
+    header.has_connectionid = true;
+    header.connectionid = conn->connectionID;
+    header.has_acksequence = true;
+    header.acksequence = reqHeader->sequence;
+    if (reqHeader->has_messagetype) {
+        header.has_messagetype = true;
+        header.messagetype = (SimMessageType)(reqHeader->messagetype - 1);
+    }
+    status.has_code = true;
+    status.code = code;
+    status.statusmessage = (char *)statusMessage;
+    command.header = &header;
+    command.status = &status;
+
+    return queue_response(sim, conn, &command, NULL, 0, false);
+}
+
+/*******************************************************************************
+ * Request handlers
+*******************************************************************************/
+
+static SimStatusCode store_status(KineticSimStoreStatus status)
+{
+    switch (status) {
+    case KINETIC_SIM_STORE_SUCCESS:
+        return COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS;
+    case KINETIC_SIM_STORE_NOT_FOUND:
+        return COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__NOT_FOUND;
+    case KINETIC_SIM_STORE_VERSION_MISMATCH:
+        return COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__VERSION_MISMATCH;
+    case KINETIC_SIM_STORE_MEMORY_ERROR:
+    default:
+        return COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__INTERNAL_ERROR;
+    }
+}
+
+static bool handle_put(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command *request, const uint8_t *value, size_t valueLen)
+{
+    Com__Seagate__Kinetic__Proto__Command__KeyValue *kv = request->body ? request->body->keyvalue : NULL;
+    if (kv == NULL || !kv->has_key) {
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__INVALID_REQUEST, "PUT requires a key");
+    }
+
+    KineticSimEntry *entry = KineticSimStore_NewEntry(
+        kv->key.data, kv->key.len,
+        kv->has_newversion ? kv->newversion.data : NULL, kv->has_newversion ? kv->newversion.len : 0,
+        kv->has_tag ? kv->tag.data : NULL, kv->has_tag ? kv->tag.len : 0,
+        kv->has_algorithm, kv->algorithm,
+        value, valueLen);
+    KineticSimStoreStatus status = KINETIC_SIM_STORE_MEMORY_ERROR;
+    if (entry != NULL) {
+        status = KineticSimStore_Put(sim->store, entry,
+            kv->has_dbversion ? kv->dbversion.data : NULL, kv->has_dbversion ? kv->dbversion.len : 0,
+            kv->has_force && kv->force);
+    }
+    return queue_status(sim, conn, request->header, store_status(status), NULL);
+}
+
+static bool handle_delete(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command *request)
+{
+    Com__Seagate__Kinetic__Proto__Command__KeyValue *kv = request->body ? request->body->keyvalue : NULL;
+    if (kv == NULL || !kv->has_key) {
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__INVALID_REQUEST, "DELETE requires a key");
+    }
+
+    KineticSimStoreStatus status = KineticSimStore_Delete(sim->store, kv->key.data, kv->key.len,
+        kv->has_dbversion ? kv->dbversion.data : NULL, kv->has_dbversion ? kv->dbversion.len : 0,
+        kv->has_force && kv->force);
+    return queue_status(sim, conn, request->header, store_status(status), NULL);
+}
+
+/* GET, GETNEXT, and GETPREVIOUS all answer with one entry's metadata and
+ * (unless metadataOnly is set) its value. */
+static bool handle_get(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command *request, SimMessageType type)
+{
+    Com__Seagate__Kinetic__Proto__Command__KeyValue *kv = request->body ? request->body->keyvalue : NULL;
+    if (kv == NULL || !kv->has_key) {
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__INVALID_REQUEST, "GET requires a key");
+    }
+
+    KineticSimEntry *entry = NULL;
+    switch (type) {
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETNEXT:
+        entry = KineticSimStore_GetNext(sim->store, kv->key.data, kv->key.len);
+        break;
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETPREVIOUS:
+        entry = KineticSimStore_GetPrevious(sim->store, kv->key.data, kv->key.len);
+        break;
+    default:
+        entry = KineticSimStore_Get(sim->store, kv->key.data, kv->key.len);
+        break;
+    }
+
+    if (entry == NULL) {
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__NOT_FOUND, NULL);
+    }
+
+    Com__Seagate__Kinetic__Proto__Command__Header header = COM__SEAGATE__KINETIC__PROTO__COMMAND__HEADER__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Status status = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__INIT;
+    Com__Seagate__Kinetic__Proto__Command__KeyValue respKV = COM__SEAGATE__KINETIC__PROTO__COMMAND__KEY_VALUE__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Body body = COM__SEAGATE__KINETIC__PROTO__COMMAND__BODY__INIT;
+    Com__Seagate__Kinetic__Proto__Command command = COM__SEAGATE__KINETIC__PROTO__COMMAND__INIT;
+
+    header.has_connectionid = true;
+    header.connectionid = conn->connectionID;
+    header.has_acksequence = true;
+    header.acksequence = request->header->sequence;
+    header.has_messagetype = true;
+    header.messagetype = (SimMessageType)(type - 1);
+    status.has_code = true;
+    status.code = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS;
+
+    respKV.has_key = true;
+    respKV.key = (ProtobufCBinaryData){.data = entry->key, .len = entry->keyLen};
+    respKV.has_dbversion = true;
+    respKV.dbversion = (ProtobufCBinaryData){.data = entry->version, .len = entry->versionLen};
+    respKV.has_tag = true;
+    respKV.tag = (ProtobufCBinaryData){.data = entry->tag, .len = entry->tagLen};
+    if (entry->hasAlgorithm) {
+        respKV.has_algorithm = true;
+        respKV.algorithm = (Com__Seagate__Kinetic__Proto__Command__Algorithm)entry->algorithm;
+    }
+
+    body.keyvalue = &respKV;
+    command.header = &header;
+    command.body = &body;
+    command.status = &status;
+
+    bool metadataOnly = kv->has_metadataonly && kv->metadataonly;
+    bool res = queue_response(sim, conn, &command,
+        entry->value, metadataOnly ? 0 : entry->valueLen, false);
+    KineticSimStore_Release(entry);
+    return res;
+}
+
+static bool handle_get_key_range(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command *request)
+{
+    Com__Seagate__Kinetic__Proto__Command__Range *range = request->body ? request->body->range : NULL;
+    if (range == NULL) {
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__INVALID_REQUEST, "GETKEYRANGE requires a range");
+    }
+
+    size_t maxReturned = SIM_MAX_KEY_RANGE_COUNT;
+    if (range->has_maxreturned && range->maxreturned >= 0 &&
+        (size_t)range->maxreturned < maxReturned) {
+        maxReturned = range->maxreturned;
+    }
+
+    KineticSimEntry *entries[SIM_MAX_KEY_RANGE_COUNT];
+    ProtobufCBinaryData keys[SIM_MAX_KEY_RANGE_COUNT];
+    size_t count = KineticSimStore_GetKeyRange(sim->store,
+        range->has_startkey ? range->startkey.data : NULL,
+        range->has_startkey ? range->startkey.len : 0,
+        range->has_startkeyinclusive && range->startkeyinclusive,
+        range->has_endkey ? range->endkey.data : NULL,
+        range->has_endkey ? range->endkey.len : 0,
+        range->has_endkeyinclusive && range->endkeyinclusive,
+        range->has_reverse && range->reverse,
+        maxReturned, entries);
+    for (size_t i = 0; i < count; i++) {
+        keys[i] = (ProtobufCBinaryData){.data = entries[i]->key, .len = entries[i]->keyLen};
+    }
+
+    Com__Seagate__Kinetic__Proto__Command__Header header = COM__SEAGATE__KINETIC__PROTO__COMMAND__HEADER__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Status status = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Range respRange = COM__SEAGATE__KINETIC__PROTO__COMMAND__RANGE__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Body body = COM__SEAGATE__KINETIC__PROTO__COMMAND__BODY__INIT;
+    Com__Seagate__Kinetic__Proto__Command command = COM__SEAGATE__KINETIC__PROTO__COMMAND__INIT;
+
+    header.has_connectionid = true;
+    header.connectionid = conn->connectionID;
+    header.has_acksequence = true;
+    header.acksequence = request->header->sequence;
+    header.has_messagetype = true;
+    header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETKEYRANGE_RESPONSE;
+    status.has_code = true;
+    status.code = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS;
+    respRange.n_keys = count;
+    respRange.keys = keys;
+    body.range = &respRange;
+    command.header = &header;
+    command.body = &body;
+    command.status = &status;
+
+    bool res = queue_response(sim, conn, &command, NULL, 0, false);
+    for (size_t i = 0; i < count; i++) {
+        KineticSimStore_Release(entries[i]);
+    }
+    return res;
+}
+
+static bool handle_command(KineticSim *sim, SimConnection *conn,
+    Com__Seagate__Kinetic__Proto__Command *request, const uint8_t *value, size_t valueLen)
+{
+    if (request->header->has_clusterversion &&
+        request->header->clusterversion != sim->config.clusterVersion) {
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__VERSION_FAILURE,
+            "CLUSTER_VERSION_FAILURE");
+    }
+
+    SimMessageType type = request->header->messagetype;
+    switch (type) {
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT:
+        return handle_put(sim, conn, request, value, valueLen);
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__DELETE:
+        return handle_delete(sim, conn, request);
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETNEXT:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETPREVIOUS:
+        return handle_get(sim, conn, request, type);
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETKEYRANGE:
+        return handle_get_key_range(sim, conn, request);
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__FLUSHALLDATA:
+    case COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__NOOP:
+        /* Everything is already as durable as it will ever be. */
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS, NULL);
+    default:
+        return queue_status(sim, conn, request->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__INVALID_REQUEST,
+            "message type not supported by simulator");
+    }
+}
+
+/* Authenticate and dispatch one complete PDU. Returns false if the
+ * connection should be dropped. */
+static bool handle_pdu(KineticSim *sim, SimConnection *conn)
+{
+    bool res = false;
+    const uint8_t *value = &conn->buf[conn->header.protobufLength];
+    Com__Seagate__Kinetic__Proto__Command *command = NULL;
+    Com__Seagate__Kinetic__Proto__Message *msg = KineticPDU_unpack_message(NULL,
+        conn->header.protobufLength, conn->buf);
+    if (msg == NULL || !msg->has_commandbytes) {
+        LOG0("[SIM] failed to unpack message");
+        goto cleanup;
+    }
+
+    command = KineticPDU_unpack_command(NULL, msg->commandbytes.len, msg->commandbytes.data);
+    if (command == NULL || command->header == NULL) {
+        LOG0("[SIM] failed to unpack command");
+        goto cleanup;
+    }
+
+    if (msg->hmacauth == NULL || !msg->hmacauth->has_identity ||
+        msg->hmacauth->identity != sim->config.identity ||
+        !KineticHMAC_Validate(msg, sim->hmacKey)) {
+        LOGF1("[SIM] HMAC failure on connection %lld", (long long)conn->connectionID);
+        res = queue_status(sim, conn, command->header,
+            COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__HMAC_FAILURE, NULL);
+        goto cleanup;
+    }
+
+    res = handle_command(sim, conn, command, value, conn->header.valueLength);
+
+cleanup:
+    if (command != NULL) { com__seagate__kinetic__proto__command__free_unpacked(command, NULL); }
+    if (msg != NULL) { com__seagate__kinetic__proto__message__free_unpacked(msg, NULL); }
+    return res;
+}
+
+/*******************************************************************************
+ * Connection I/O
+*******************************************************************************/
+
+static bool unpack_header(SimConnection *conn)
+{
+    KineticPDUHeader const * const buf_header = (KineticPDUHeader const *)conn->buf;
+    uint32_t protobufLength = KineticNBO_ToHostU32(buf_header->protobufLength);
+    uint32_t valueLength = KineticNBO_ToHostU32(buf_header->valueLength);
+
+    if (buf_header->versionPrefix != 'F' ||
+        protobufLength > PDU_PROTO_MAX_LEN ||
+        valueLength > KINETIC_OBJ_SIZE) {
+        return false;
+    }
+    conn->header = (KineticPDUHeader){
+        .versionPrefix = buf_header->versionPrefix,
+        .protobufLength = protobufLength,
+        .valueLength = valueLength,
+    };
+    return true;
+}
+
+/* Read as much as is available, handling each PDU as it completes.
+ * Returns false if the connection should be dropped. */
+static bool read_connection(KineticSim *sim, SimConnection *conn)
+{
+    for (;;) {
+        size_t want = (conn->state == STATE_AWAITING_BODY)
+            ? conn->header.protobufLength + conn->header.valueLength
+            : PDU_HEADER_LEN;
+        if (conn->accumulated == want) {
+            if (conn->state == STATE_AWAITING_BODY) {
+                if (!handle_pdu(sim, conn)) { return false; }
+                conn->state = STATE_AWAITING_HEADER;
+            } else if (unpack_header(conn)) {
+                conn->state = STATE_AWAITING_BODY;
+            } else {
+                LOG0("[SIM] invalid PDU header");
+                return false;
+            }
+            conn->accumulated = 0;
+            continue;
+        }
+
+        ssize_t rd = read(conn->fd, &conn->buf[conn->accumulated], want - conn->accumulated);
+        if (rd > 0) {
+            conn->accumulated += rd;
+        } else if (rd == 0) {
+            return false;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            errno = 0;
+            return true;
+        } else {
+            return false;
+        }
+    }
+}
+
+/* Write out any responses that are due. Returns false if the connection
+ * should be dropped. */
+static bool write_connection(SimConnection *conn, int64_t now)
+{
+    while (conn->head != NULL && conn->head->due_usec <= now) {
+        SimResponse *res = conn->head;
+        ssize_t wr = write(conn->fd, &res->buf[res->written], res->size - res->written);
+        if (wr < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                errno = 0;
+                return true;
+            }
+            return false;
+        }
+        res->written += wr;
+        if (res->written < res->size) { return true; }
+        conn->head = res->next;
+        if (conn->head == NULL) { conn->tail = NULL; }
+        free(res);
+    }
+    return true;
+}
+
+static void free_connection(SimConnection *conn)
+{
+    close(conn->fd);
+    while (conn->head != NULL) {
+        SimResponse *next = conn->head->next;
+        free(conn->head);
+        conn->head = next;
+    }
+    free(conn->buf);
+    free(conn);
+}
+
+static void accept_connection(KineticSim *sim, SimPort *port)
+{
+    int fd = accept(port->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        errno = 0;
+        return;
+    }
+
+    int flag = 1;
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1 ||
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) != 0) {
+        close(fd);
+        return;
+    }
+
+    if (port->conn_count == port->conn_capacity) {
+        size_t capacity = port->conn_capacity ? 2 * port->conn_capacity : 16;
+        SimConnection **conns = realloc(port->conns, capacity * sizeof(*conns));
+        struct pollfd *fds = realloc(port->fds, (capacity + 1) * sizeof(*fds));
+        if (conns != NULL) { port->conns = conns; }
+        if (fds != NULL) { port->fds = fds; }
+        if (conns == NULL || fds == NULL) {
+            close(fd);
+            return;
+        }
+        port->conn_capacity = capacity;
+    }
+
+    SimConnection *conn = calloc(1, sizeof(*conn));
+    uint8_t *buf = malloc(PDU_PROTO_MAX_LEN + KINETIC_OBJ_SIZE);
+    if (conn == NULL || buf == NULL) {
+        free(conn);
+        free(buf);
+        close(fd);
+        return;
+    }
+    conn->fd = fd;
+    conn->buf = buf;
+    conn->state = STATE_AWAITING_HEADER;
+    conn->connectionID = __sync_fetch_and_add(&sim->next_connection_id, 1);
+
+    /* Clients block on connect until they get a connection ID. */
+    Com__Seagate__Kinetic__Proto__Command__Header header = COM__SEAGATE__KINETIC__PROTO__COMMAND__HEADER__INIT;
+    Com__Seagate__Kinetic__Proto__Command__Status status = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__INIT;
+    Com__Seagate__Kinetic__Proto__Command command = COM__SEAGATE__KINETIC__PROTO__COMMAND__INIT;
+    header.has_connectionid = true;
+    header.connectionid = conn->connectionID;
+    header.has_clusterversion = true;
+    header.clusterversion = sim->config.clusterVersion;
+    status.has_code = true;
+    status.code = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS;
+    command.header = &header;
+    command.status = &status;
+    if (!queue_response(sim, conn, &command, NULL, 0, true)) {
+        free_connection(conn);
+        return;
+    }
+
+    LOGF2("[SIM] port %d: accepted connection %lld", port->port, (long long)conn->connectionID);
+    port->conns[port->conn_count++] = conn;
+}
+
+static void *port_thread(void *arg)
+{
+    SimPort *port = arg;
+    KineticSim *sim = port->sim;
+
+    while (sim->running) {
+        int64_t now = now_usec();
+        int timeout = SIM_POLL_TIMEOUT_MSEC;
+
+        port->fds[0].fd = port->listen_fd;
+        port->fds[0].events = POLLIN;
+        port->fds[0].revents = 0;
+        for (size_t i = 0; i < port->conn_count; i++) {
+            SimConnection *conn = port->conns[i];
+            struct pollfd *pfd = &port->fds[i + 1];
+            pfd->fd = conn->fd;
+            pfd->events = POLLIN;
+            pfd->revents = 0;
+            if (conn->head != NULL) {
+                if (conn->head->due_usec <= now) {
+                    pfd->events |= POLLOUT;
+                } else {
+                    int wait = (int)((conn->head->due_usec - now + 999) / 1000);
+                    if (wait < timeout) { timeout = wait; }
+                }
+            }
+        }
+
+        int res = poll(port->fds, port->conn_count + 1, timeout);
+        if (res < 0) {
+            if (errno == EINTR) {
+                errno = 0;
+                continue;
+            }
+            LOGF0("[SIM] port %d: poll failed, errno %d", port->port, errno);
+            break;
+        }
+
+        now = now_usec();
+        for (size_t i = 0; i < port->conn_count; i++) {
+            SimConnection *conn = port->conns[i];
+            short revents = port->fds[i + 1].revents;
+            bool ok = true;
+            if (revents & (POLLERR | POLLNVAL)) {
+                ok = false;
+            } else if (revents & (POLLIN | POLLHUP)) {
+                ok = read_connection(sim, conn);
+            }
+            if (ok) { ok = write_connection(conn, now); }
+
+            if (!ok) {
+                LOGF2("[SIM] port %d: closing connection %lld", port->port, (long long)conn->connectionID);
+                free_connection(conn);
+                port->conns[i] = port->conns[port->conn_count - 1];
+                port->fds[i + 1] = port->fds[port->conn_count];
+                port->conn_count--;
+                i--;
+            }
+        }
+
+        if (port->fds[0].revents & POLLIN) {
+            accept_connection(sim, port);
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Public API
+*******************************************************************************/
+
+KineticSim* KineticSim_Start(const KineticSimConfig* const config)
+{
+    KINETIC_ASSERT(config != NULL);
+    KineticSim *sim = calloc(1, sizeof(*sim));
+    if (sim == NULL) { return NULL; }
+
+    sim->config = *config;
+    if (sim->config.host == NULL) { sim->config.host = SIM_DEFAULT_HOST; }
+    if (sim->config.port == 0) { sim->config.port = KINETIC_PORT; }
+    if (sim->config.portCount <= 0) { sim->config.portCount = 1; }
+    if (sim->config.identity == 0) { sim->config.identity = SIM_DEFAULT_IDENTITY; }
+    if (sim->config.hmacKey == NULL) { sim->config.hmacKey = SIM_DEFAULT_HMAC_KEY; }
+    sim->hmacKey = (ByteArray){
+        .data = (uint8_t *)sim->config.hmacKey,
+        .len = strlen(sim->config.hmacKey),
+    };
+    sim->next_connection_id = (int64_t)time(NULL);
+    sim->running = true;
+
+    sim->store = KineticSimStore_Create();
+    sim->ports = calloc(sim->config.portCount, sizeof(*sim->ports));
+    if (sim->store == NULL || sim->ports == NULL) { goto cleanup; }
+
+    for (int i = 0; i < sim->config.portCount; i++) {
+        SimPort *port = &sim->ports[i];
+        port->sim = sim;
+        port->port = sim->config.port + i;
+        port->listen_fd = -1;
+        port->fds = calloc(1, sizeof(*port->fds));
+        if (port->fds == NULL) { goto cleanup; }
+
+        socket99_config scfg = {
+            .host = (char *)sim->config.host,
+            .port = port->port,
+            .server = true,
+            .nonblocking = true,
+        };
+        socket99_result res;
+        if (!socket99_open(&scfg, &res)) {
+            char buf[256];
+            socket99_snprintf(buf, sizeof(buf), &res);
+            LOGF0("[SIM] failed to open port %d: %s", port->port, buf);
+            goto cleanup;
+        }
+        port->listen_fd = res.fd;
+    }
+
+    for (int i = 0; i < sim->config.portCount; i++) {
+        SimPort *port = &sim->ports[i];
+        if (pthread_create(&port->thread, NULL, port_thread, port) != 0) { goto cleanup; }
+        port->thread_started = true;
+    }
+
+    LOGF1("[SIM] serving ports %d-%d, response delay %u usec", sim->config.port,
+        sim->config.port + sim->config.portCount - 1, sim->config.responseDelayUsec);
+    return sim;
+
+cleanup:
+    KineticSim_Stop(sim);
+    return NULL;
+}
+
+KineticSimStore* KineticSim_GetStore(KineticSim* const sim)
+{
+    KINETIC_ASSERT(sim != NULL);
+    return sim->store;
+}
+
+void KineticSim_Stop(KineticSim* const sim)
+{
+    if (sim == NULL) { return; }
+    sim->running = false;
+
+    if (sim->ports != NULL) {
+        for (int i = 0; i < sim->config.portCount; i++) {
+            SimPort *port = &sim->ports[i];
+            if (port->thread_started) { pthread_join(port->thread, NULL); }
+            for (size_t c = 0; c < port->conn_count; c++) {
+                free_connection(port->conns[c]);
+            }
+            if (port->listen_fd >= 0) { close(port->listen_fd); }
+            free(port->conns);
+            free(port->fds);
+        }
+        free(sim->ports);
+    }
+
+    KineticSimStore_Free(sim->store);
+    free(sim);
+}
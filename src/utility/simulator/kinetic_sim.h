@@ -0,0 +1,65 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#ifndef _KINETIC_SIM_H
+#define _KINETIC_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "kinetic_sim_store.h"
+
+/**
+ * @brief Native, in-process Kinetic device simulator.
+ *
+ * Serves the Kinetic wire protocol from an in-memory ordered store so client
+ * throughput and latency can be measured without the Java simulator.
+ * Supports PUT, GET, DELETE, GETNEXT, GETPREVIOUS, GETKEYRANGE, FLUSHALLDATA
+ * and NOOP, authenticated with HMAC-SHA1. Other message types are answered
+ * with INVALID_REQUEST.
+ */
+typedef struct _KineticSim KineticSim;
+
+typedef struct _KineticSimConfig {
+    const char* host;           ///< Address to listen on (default "127.0.0.1")
+    int         port;           ///< First port to listen on (default KINETIC_PORT)
+    int         portCount;      ///< Number of consecutive ports, each served by its own thread (default 1)
+    int64_t     identity;       ///< HMAC identity accepted (default 1)
+    const char* hmacKey;        ///< HMAC key for the identity (default "asdfasdf")
+    int64_t     clusterVersion; ///< Cluster version requests must carry (default 0)
+    uint32_t    responseDelayUsec; ///< Delay added before each response is sent
+} KineticSimConfig;
+
+/**
+ * @brief Opens the configured ports and starts serving them from background threads.
+ *
+ * @return  The running simulator, or NULL if a port could not be opened.
+ */
+KineticSim* KineticSim_Start(const KineticSimConfig* const config);
+
+/**
+ * @brief Returns the simulator's store, e.g. to preload data before a benchmark.
+ */
+KineticSimStore* KineticSim_GetStore(KineticSim* const sim);
+
+/**
+ * @brief Stops serving, closes all connections, and frees the simulator and its store.
+ */
+void KineticSim_Stop(KineticSim* const sim);
+
+#endif // _KINETIC_SIM_H
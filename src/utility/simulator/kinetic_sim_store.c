@@ -0,0 +1,344 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_sim_store.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* The store is a skip list under a single mutex. Entries are immutable
+ * and reference counted, so the lock is only held while walking the
+ * list, never while values are copied out to a socket. */
+
+#define MAX_LEVEL 16
+
+typedef struct _KineticSimNode {
+    KineticSimEntry *entry;
+    struct _KineticSimNode *next[];
+} KineticSimNode;
+
+struct _KineticSimStore {
+    pthread_mutex_t mutex;
+    KineticSimNode *head;
+    int level;
+    size_t count;
+    uint32_t rng;
+};
+
+static int compare_keys(const uint8_t *a, size_t aLen, const uint8_t *b, size_t bLen)
+{
+    size_t len = (aLen < bLen) ? aLen : bLen;
+    int res = (len > 0) ? memcmp(a, b, len) : 0;
+    if (res != 0) { return res; }
+    return (aLen > bLen) - (aLen < bLen);
+}
+
+static int compare_node(const KineticSimNode *node, const uint8_t *key, size_t keyLen)
+{
+    return compare_keys(node->entry->key, node->entry->keyLen, key, keyLen);
+}
+
+static bool versions_match(const KineticSimEntry *entry, const uint8_t *version, size_t versionLen)
+{
+    size_t stored = (entry != NULL) ? entry->versionLen : 0;
+    if (stored != versionLen) { return false; }
+    return (versionLen == 0) || (memcmp(entry->version, version, versionLen) == 0);
+}
+
+static KineticSimNode *new_node(KineticSimEntry *entry, int level)
+{
+    KineticSimNode *node = calloc(1, sizeof(*node) + level * sizeof(node->next[0]));
+    if (node != NULL) { node->entry = entry; }
+    return node;
+}
+
+static int random_level(KineticSimStore *store)
+{
+    int level = 1;
+    while (level < MAX_LEVEL) {
+        /* xorshift32; each level is 1/4 as likely as the one below it */
+        store->rng ^= store->rng << 13;
+        store->rng ^= store->rng >> 17;
+        store->rng ^= store->rng << 5;
+        if ((store->rng & 3) != 0) { break; }
+        level++;
+    }
+    return level;
+}
+
+static KineticSimEntry *take_ref(KineticSimEntry *entry)
+{
+    __sync_fetch_and_add(&entry->refs, 1);
+    return entry;
+}
+
+/* Find the last node at each level whose key is less than KEY (or less
+ * than or equal to KEY, if OR_EQUAL is set), and return the one at the
+ * bottom level. UPDATE, if non-NULL, receives the node for every level. */
+static KineticSimNode *find_predecessor(KineticSimStore *store,
+    const uint8_t *key, size_t keyLen, bool orEqual, KineticSimNode **update)
+{
+    KineticSimNode *x = store->head;
+    for (int i = MAX_LEVEL - 1; i >= 0; i--) {
+        if (i < store->level) {
+            while (x->next[i] != NULL) {
+                int cmp = compare_node(x->next[i], key, keyLen);
+                if (cmp < 0 || (orEqual && cmp == 0)) {
+                    x = x->next[i];
+                } else {
+                    break;
+                }
+            }
+        }
+        if (update != NULL) { update[i] = x; }
+    }
+    return x;
+}
+
+KineticSimStore * KineticSimStore_Create(void)
+{
+    KineticSimStore *store = calloc(1, sizeof(*store));
+    if (store == NULL) { return NULL; }
+    store->head = new_node(NULL, MAX_LEVEL);
+    if (store->head == NULL) {
+        free(store);
+        return NULL;
+    }
+    if (pthread_mutex_init(&store->mutex, NULL) != 0) {
+        free(store->head);
+        free(store);
+        return NULL;
+    }
+    store->level = 1;
+    store->rng = 0x2545F491;
+    return store;
+}
+
+void KineticSimStore_Free(KineticSimStore * const store)
+{
+    if (store == NULL) { return; }
+    KineticSimNode *node = store->head->next[0];
+    while (node != NULL) {
+        KineticSimNode *next = node->next[0];
+        KineticSimStore_Release(node->entry);
+        free(node);
+        node = next;
+    }
+    free(store->head);
+    pthread_mutex_destroy(&store->mutex);
+    free(store);
+}
+
+size_t KineticSimStore_Count(KineticSimStore * const store)
+{
+    pthread_mutex_lock(&store->mutex);
+    size_t count = store->count;
+    pthread_mutex_unlock(&store->mutex);
+    return count;
+}
+
+KineticSimEntry * KineticSimStore_NewEntry(
+    const uint8_t *key, size_t keyLen,
+    const uint8_t *version, size_t versionLen,
+    const uint8_t *tag, size_t tagLen,
+    bool hasAlgorithm, int32_t algorithm,
+    const uint8_t *value, size_t valueLen)
+{
+    KineticSimEntry *entry = malloc(sizeof(*entry) + keyLen + versionLen + tagLen + valueLen);
+    if (entry == NULL) { return NULL; }
+
+    uint8_t *p = entry->data;
+    entry->refs = 1;
+    entry->key = p;
+    entry->keyLen = keyLen;
+    if (keyLen > 0) { memcpy(p, key, keyLen); }
+    p += keyLen;
+    entry->version = p;
+    entry->versionLen = versionLen;
+    if (versionLen > 0) { memcpy(p, version, versionLen); }
+    p += versionLen;
+    entry->tag = p;
+    entry->tagLen = tagLen;
+    if (tagLen > 0) { memcpy(p, tag, tagLen); }
+    p += tagLen;
+    entry->hasAlgorithm = hasAlgorithm;
+    entry->algorithm = algorithm;
+    entry->value = p;
+    entry->valueLen = valueLen;
+    if (valueLen > 0) { memcpy(p, value, valueLen); }
+    return entry;
+}
+
+void KineticSimStore_Release(KineticSimEntry * const entry)
+{
+    if (entry != NULL && __sync_sub_and_fetch(&entry->refs, 1) == 0) {
+        free(entry);
+    }
+}
+
+KineticSimEntry * KineticSimStore_Get(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen)
+{
+    KineticSimEntry *res = NULL;
+    pthread_mutex_lock(&store->mutex);
+    KineticSimNode *node = find_predecessor(store, key, keyLen, false, NULL)->next[0];
+    if (node != NULL && compare_node(node, key, keyLen) == 0) {
+        res = take_ref(node->entry);
+    }
+    pthread_mutex_unlock(&store->mutex);
+    return res;
+}
+
+KineticSimEntry * KineticSimStore_GetNext(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen)
+{
+    KineticSimEntry *res = NULL;
+    pthread_mutex_lock(&store->mutex);
+    KineticSimNode *node = find_predecessor(store, key, keyLen, true, NULL)->next[0];
+    if (node != NULL) { res = take_ref(node->entry); }
+    pthread_mutex_unlock(&store->mutex);
+    return res;
+}
+
+KineticSimEntry * KineticSimStore_GetPrevious(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen)
+{
+    KineticSimEntry *res = NULL;
+    pthread_mutex_lock(&store->mutex);
+    KineticSimNode *node = find_predecessor(store, key, keyLen, false, NULL);
+    if (node != store->head) { res = take_ref(node->entry); }
+    pthread_mutex_unlock(&store->mutex);
+    return res;
+}
+
+KineticSimStoreStatus KineticSimStore_Put(KineticSimStore * const store,
+    KineticSimEntry * const entry,
+    const uint8_t *dbVersion, size_t dbVersionLen, bool force)
+{
+    KineticSimNode *update[MAX_LEVEL];
+    KineticSimStoreStatus status = KINETIC_SIM_STORE_SUCCESS;
+
+    pthread_mutex_lock(&store->mutex);
+    KineticSimNode *node = find_predecessor(store, entry->key, entry->keyLen, false, update)->next[0];
+    if (node != NULL && compare_node(node, entry->key, entry->keyLen) != 0) {
+        node = NULL;
+    }
+
+    if (!force && !versions_match(node ? node->entry : NULL, dbVersion, dbVersionLen)) {
+        status = KINETIC_SIM_STORE_VERSION_MISMATCH;
+    } else if (node != NULL) {
+        KineticSimEntry *old = node->entry;
+        node->entry = entry;
+        KineticSimStore_Release(old);
+    } else {
+        int level = random_level(store);
+        node = new_node(entry, level);
+        if (node == NULL) {
+            status = KINETIC_SIM_STORE_MEMORY_ERROR;
+        } else {
+            if (level > store->level) { store->level = level; }
+            for (int i = 0; i < level; i++) {
+                node->next[i] = update[i]->next[i];
+                update[i]->next[i] = node;
+            }
+            store->count++;
+        }
+    }
+    pthread_mutex_unlock(&store->mutex);
+
+    if (status != KINETIC_SIM_STORE_SUCCESS) {
+        KineticSimStore_Release(entry);
+    }
+    return status;
+}
+
+KineticSimStoreStatus KineticSimStore_Delete(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen,
+    const uint8_t *dbVersion, size_t dbVersionLen, bool force)
+{
+    KineticSimNode *update[MAX_LEVEL];
+    KineticSimStoreStatus status = KINETIC_SIM_STORE_SUCCESS;
+
+    pthread_mutex_lock(&store->mutex);
+    KineticSimNode *node = find_predecessor(store, key, keyLen, false, update)->next[0];
+    if (node == NULL || compare_node(node, key, keyLen) != 0) {
+        status = KINETIC_SIM_STORE_NOT_FOUND;
+    } else if (!force && !versions_match(node->entry, dbVersion, dbVersionLen)) {
+        status = KINETIC_SIM_STORE_VERSION_MISMATCH;
+    } else {
+        for (int i = 0; i < store->level; i++) {
+            if (update[i]->next[i] != node) { break; }
+            update[i]->next[i] = node->next[i];
+        }
+        while (store->level > 1 && store->head->next[store->level - 1] == NULL) {
+            store->level--;
+        }
+        store->count--;
+    }
+    pthread_mutex_unlock(&store->mutex);
+
+    if (status == KINETIC_SIM_STORE_SUCCESS) {
+        KineticSimStore_Release(node->entry);
+        free(node);
+    }
+    return status;
+}
+
+size_t KineticSimStore_GetKeyRange(KineticSimStore * const store,
+    const uint8_t *start, size_t startLen, bool startInclusive,
+    const uint8_t *end, size_t endLen, bool endInclusive,
+    bool reverse, size_t maxReturned, KineticSimEntry **out)
+{
+    size_t count = 0;
+    pthread_mutex_lock(&store->mutex);
+
+    if (!reverse) {
+        KineticSimNode *node = find_predecessor(store, start, startLen, !startInclusive, NULL)->next[0];
+        while (node != NULL && count < maxReturned) {
+            if (end != NULL) {
+                int cmp = compare_node(node, end, endLen);
+                if (cmp > 0 || (cmp == 0 && !endInclusive)) { break; }
+            }
+            out[count++] = take_ref(node->entry);
+            node = node->next[0];
+        }
+    } else {
+        /* Walk down from the end of the range, one predecessor search
+         * per key. maxReturned is small, so this stays cheap. */
+        KineticSimNode *node = NULL;
+        if (end != NULL) {
+            node = find_predecessor(store, end, endLen, endInclusive, NULL);
+        } else {
+            node = store->head;
+            for (int i = store->level - 1; i >= 0; i--) {
+                while (node->next[i] != NULL) { node = node->next[i]; }
+            }
+        }
+        while (node != store->head && count < maxReturned) {
+            int cmp = compare_node(node, start, startLen);
+            if (cmp < 0 || (cmp == 0 && !startInclusive)) { break; }
+            out[count++] = take_ref(node->entry);
+            node = find_predecessor(store, node->entry->key, node->entry->keyLen, false, NULL);
+        }
+    }
+
+    pthread_mutex_unlock(&store->mutex);
+    return count;
+}
@@ -0,0 +1,96 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#ifndef _KINETIC_SIM_STORE_H
+#define _KINETIC_SIM_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Ordered in-memory key/value store backing the native simulator.
+ * Keys are ordered bytewise (memcmp), with a shorter key ordering
+ * before any longer key it is a prefix of. */
+typedef struct _KineticSimStore KineticSimStore;
+
+/* An immutable, reference counted entry. Lookups return a reference
+ * which must be handed back with KineticSimStore_Release. */
+typedef struct _KineticSimEntry {
+    size_t refs;
+    uint8_t *key;
+    size_t keyLen;
+    uint8_t *version;
+    size_t versionLen;
+    uint8_t *tag;
+    size_t tagLen;
+    bool hasAlgorithm;
+    int32_t algorithm;
+    uint8_t *value;
+    size_t valueLen;
+    uint8_t data[];
+} KineticSimEntry;
+
+typedef enum {
+    KINETIC_SIM_STORE_SUCCESS = 0,
+    KINETIC_SIM_STORE_NOT_FOUND,
+    KINETIC_SIM_STORE_VERSION_MISMATCH,
+    KINETIC_SIM_STORE_MEMORY_ERROR,
+} KineticSimStoreStatus;
+
+KineticSimStore * KineticSimStore_Create(void);
+void KineticSimStore_Free(KineticSimStore * const store);
+size_t KineticSimStore_Count(KineticSimStore * const store);
+
+/* Allocate a new entry holding copies of the given fields, with one reference. */
+KineticSimEntry * KineticSimStore_NewEntry(
+    const uint8_t *key, size_t keyLen,
+    const uint8_t *version, size_t versionLen,
+    const uint8_t *tag, size_t tagLen,
+    bool hasAlgorithm, int32_t algorithm,
+    const uint8_t *value, size_t valueLen);
+void KineticSimStore_Release(KineticSimEntry * const entry);
+
+/* Lookups. Each returns a new reference, or NULL if there is no match. */
+KineticSimEntry * KineticSimStore_Get(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen);
+KineticSimEntry * KineticSimStore_GetNext(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen);
+KineticSimEntry * KineticSimStore_GetPrevious(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen);
+
+/* Store ENTRY, taking over the caller's reference. Unless FORCE is set,
+ * DB_VERSION must match the stored version (empty for a new key). */
+KineticSimStoreStatus KineticSimStore_Put(KineticSimStore * const store,
+    KineticSimEntry * const entry,
+    const uint8_t *dbVersion, size_t dbVersionLen, bool force);
+
+/* Remove KEY. Unless FORCE is set, DB_VERSION must match. */
+KineticSimStoreStatus KineticSimStore_Delete(KineticSimStore * const store,
+    const uint8_t *key, size_t keyLen,
+    const uint8_t *dbVersion, size_t dbVersionLen, bool force);
+
+/* Collect up to MAX_RETURNED entries between START and END into OUT (in
+ * descending order if REVERSE), returning how many were collected. A
+ * NULL END leaves the range open-ended. The entries are new references. */
+size_t KineticSimStore_GetKeyRange(KineticSimStore * const store,
+    const uint8_t *start, size_t startLen, bool startInclusive,
+    const uint8_t *end, size_t endLen, bool endInclusive,
+    bool reverse, size_t maxReturned, KineticSimEntry **out);
+
+#endif // _KINETIC_SIM_STORE_H
@@ -0,0 +1,130 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_sim.h"
+#include "kinetic_logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_signal(int sig)
+{
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+        "Usage: %s [--port PORT] [--ports COUNT] [--host HOST] [--delay USEC]\n"
+        "       [--identity ID] [--hmackey KEY] [--clusterversion VERSION] [--loglevel LEVEL]\n"
+        "\n"
+        "  Serves an in-memory Kinetic device on COUNT consecutive ports\n"
+        "  starting at PORT, delaying each response by USEC microseconds.\n",
+        name);
+}
+
+int main(int argc, char** argv)
+{
+    KineticSimConfig config = {
+        .host = NULL,
+        .port = KINETIC_PORT,
+        .portCount = 1,
+    };
+    int logLevel = 0;
+
+    struct option long_options[] = {
+        {"help",            no_argument,       0, '?'},
+        {"host",            required_argument, 0, 'H'},
+        {"port",            required_argument, 0, 'p'},
+        {"ports",           required_argument, 0, 'n'},
+        {"delay",           required_argument, 0, 'd'},
+        {"identity",        required_argument, 0, 'i'},
+        {"hmackey",         required_argument, 0, 'k'},
+        {"clusterversion",  required_argument, 0, 'c'},
+        {"loglevel",        required_argument, 0, 'l'},
+        {0,                 0,                 0, 0},
+    };
+
+    extern char *optarg;
+    int option, optionIndex = 0;
+    while ((option = getopt_long(argc, argv, "?H:p:n:d:i:k:c:l:", long_options, &optionIndex)) != -1) {
+        switch (option) {
+        case 'H':
+            config.host = optarg;
+            break;
+        case 'p':
+            config.port = atoi(optarg);
+            break;
+        case 'n':
+            config.portCount = atoi(optarg);
+            break;
+        case 'd':
+            config.responseDelayUsec = strtoul(optarg, NULL, 10);
+            break;
+        case 'i':
+            config.identity = strtoll(optarg, NULL, 10);
+            break;
+        case 'k':
+            config.hmacKey = optarg;
+            break;
+        case 'c':
+            config.clusterVersion = strtoll(optarg, NULL, 10);
+            break;
+        case 'l':
+            logLevel = atoi(optarg);
+            break;
+        case '?':
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    KineticLogger_Init("stdout", logLevel);
+
+    struct sigaction sa;
+    sa.sa_handler = handle_signal;
+    sa.sa_flags = 0;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    KineticSim *sim = KineticSim_Start(&config);
+    if (sim == NULL) {
+        fprintf(stderr, "Failed to start simulator on port %d\n", config.port);
+        KineticLogger_Close();
+        return 1;
+    }
+
+    while (!stop_requested) {
+        pause();
+    }
+
+    KineticSim_Stop(sim);
+    KineticLogger_Close();
+    return 0;
+}
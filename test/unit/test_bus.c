@@ -706,6 +706,7 @@ void test_Bus_Free_should_call_shutdown_if_not_shut_down(void)
 
     Listener_Free_Expect(b->listeners[0]);
     Listener_Free_Expect(b->listeners[1]);
+    Threadpool_Stats_Ignore();
     Threadpool_Shutdown_ExpectAndReturn(b->threadpool, false, true);
     Threadpool_Free_Expect(b->threadpool);
 
@@ -740,6 +741,7 @@ void test_Bus_Free_should_free_bus(void)
 
     Listener_Free_Expect(b->listeners[0]);
     Listener_Free_Expect(b->listeners[1]);
+    Threadpool_Stats_Ignore();
     Threadpool_Shutdown_ExpectAndReturn(b->threadpool, false, true);
     Threadpool_Free_Expect(b->threadpool);
 
@@ -747,3 +749,74 @@ void test_Bus_Free_should_free_bus(void)
     BusSSL_CtxFree_Expect(b);
     Bus_Free(b);
 }
+
+static int inline_calls;
+
+static void inline_cb(bus_msg_result_t *res, void *udata) {
+    (void)res;
+    (void)udata;
+    inline_calls++;
+}
+
+static boxed_msg *new_delivery_box(bool inline_cb_flag) {
+    boxed_msg *box = calloc(1, sizeof(*box));
+    TEST_ASSERT(box);
+    box->result.status = BUS_SEND_SUCCESS;
+    box->cb = inline_cb;
+    box->inline_cb = inline_cb_flag;
+    return box;
+}
+
+void test_Bus_ProcessBoxedMessage_should_call_inline_callbacks_directly(void)
+{
+    struct bus b = {
+        .log_level = 0,
+    };
+    size_t backpressure = 0;
+    inline_calls = 0;
+
+    TEST_ASSERT_TRUE(Bus_ProcessBoxedMessage(&b, new_delivery_box(true), &backpressure));
+    TEST_ASSERT_EQUAL(1, inline_calls);
+}
+
+void test_Bus_ProcessBoxedMessages_should_call_inline_callbacks_in_order_with_scheduled_ones(void)
+{
+    struct bus b = {
+        .log_level = 0,
+    };
+    size_t backpressure = 0;
+    boxed_msg *boxes[] = {
+        new_delivery_box(false),
+        new_delivery_box(true),
+        new_delivery_box(false),
+    };
+    inline_calls = 0;
+
+    Threadpool_ScheduleBatch_IgnoreAndReturn(1);
+    TEST_ASSERT_EQUAL(3, Bus_ProcessBoxedMessages(&b, boxes, 3, &backpressure));
+    TEST_ASSERT_EQUAL(1, inline_calls);
+
+    /* Boxes handed to the (mock) thread pool are not freed by it. */
+    free(boxes[0]);
+    free(boxes[2]);
+}
+
+void test_Bus_ProcessBoxedMessages_should_not_call_inline_callbacks_after_a_message_not_scheduled(void)
+{
+    struct bus b = {
+        .log_level = 0,
+    };
+    size_t backpressure = 0;
+    boxed_msg *boxes[] = {
+        new_delivery_box(false),
+        new_delivery_box(true),
+    };
+    inline_calls = 0;
+
+    Threadpool_ScheduleBatch_IgnoreAndReturn(0);
+    TEST_ASSERT_EQUAL(0, Bus_ProcessBoxedMessages(&b, boxes, 2, &backpressure));
+    TEST_ASSERT_EQUAL(0, inline_calls);
+
+    free(boxes[0]);
+    free(boxes[1]);
+}
@@ -78,6 +78,7 @@ void setUp(void) {
         rx_info_t *info = &l->rx_info[i];
         info->state = RIS_INACTIVE;
     }
+    Box.fd = 1;
     Box.out_seq_id = 12345;
 
     box = &Box;
@@ -162,6 +163,43 @@ void test_ListenerIO_AttemptRecv_should_handle_hangups(void) {
     TEST_ASSERT_EQUAL(RX_ERROR_POLLHUP, info2->u.hold.error);
 }
 
+void test_ListenerIO_AttemptRecv_should_not_fail_responses_already_queued_for_delivery(void) {
+    Box.fd = 5;
+
+    rx_info_t *info1 = &l->rx_info[1];
+    info1->state = RIS_EXPECT;
+    info1->u.expect.box = box;
+    info1->u.expect.error = RX_ERROR_READY_FOR_DELIVERY;
+
+    boxed_msg pending_box = {
+        .fd = 5,
+        .out_seq_id = 12346,
+    };
+    rx_info_t *info2 = &l->rx_info[2];
+    info2->state = RIS_EXPECT;
+    info2->u.expect.box = &pending_box;
+    info2->u.expect.error = RX_ERROR_NONE;
+
+    l->fds[0 + INCOMING_MSG_PIPE].fd = 5;
+    l->fds[0 + INCOMING_MSG_PIPE].events = POLLIN;
+    l->fds[0 + INCOMING_MSG_PIPE].revents = POLLHUP;  // hangup
+
+    connection_info ci0 = {
+        .fd = 5,
+    };
+    l->fd_info[0] = &ci0;
+
+    l->tracked_fds = 1;
+    l->inactive_fds = 0;
+    l->rx_info_max_used = 2;
+
+    ListenerIO_AttemptRecv(l, 1);
+
+    /* The received response is still delivered; the pending one fails. */
+    TEST_ASSERT_EQUAL(RX_ERROR_READY_FOR_DELIVERY, info1->u.expect.error);
+    TEST_ASSERT_EQUAL(RX_ERROR_POLLHUP, info2->u.expect.error);
+}
+
 void test_ListenerIO_AttemptRecv_should_handle_socket_errors(void) {
     rx_info_t *info1 = &l->rx_info[1];
     info1->state = RIS_HOLD;
@@ -290,7 +328,7 @@ void test_ListenerIO_AttemptRecv_should_handle_successful_socket_read_and_unpack
         .state = RIS_EXPECT,
     };
     ListenerHelper_FindInfoBySequenceID_ExpectAndReturn(l, ci.fd, 12345, &unpack_res_info);
-    ListenerTask_AttemptDelivery_Expect(l, &unpack_res_info);
+    ListenerTask_QueueDelivery_Expect(l, &unpack_res_info);
     
     ListenerIO_AttemptRecv(l, 1);
 
@@ -372,7 +410,7 @@ void test_ListenerIO_AttemptRecv_should_handle_successful_socket_read_and_unpack
         .state = RIS_EXPECT,
     };
     ListenerHelper_FindInfoBySequenceID_ExpectAndReturn(l, ci.fd, 12345, &unpack_res_info);
-    ListenerTask_AttemptDelivery_Expect(l, &unpack_res_info);
+    ListenerTask_QueueDelivery_Expect(l, &unpack_res_info);
     
     ListenerIO_AttemptRecv(l, 1);
 
@@ -418,7 +456,7 @@ void test_ListenerIO_AttemptRecv_should_handle_successful_socket_read_and_unpack
         .state = RIS_EXPECT,
     };
     ListenerHelper_FindInfoBySequenceID_ExpectAndReturn(l, ci.fd, 12345, &unpack_res_info);
-    ListenerTask_AttemptDelivery_Expect(l, &unpack_res_info);
+    ListenerTask_QueueDelivery_Expect(l, &unpack_res_info);
     
     ListenerIO_AttemptRecv(l, 1);
 
@@ -498,7 +536,7 @@ void test_ListenerIO_AttemptRecv_should_handle_successful_socket_read_and_unpack
         .state = RIS_EXPECT,
     };
     ListenerHelper_FindInfoBySequenceID_ExpectAndReturn(l, ci.fd, 12345, &unpack_res_info);
-    ListenerTask_AttemptDelivery_Expect(l, &unpack_res_info);
+    ListenerTask_QueueDelivery_Expect(l, &unpack_res_info);
     
     ListenerIO_AttemptRecv(l, 1);
 
@@ -544,7 +582,7 @@ void test_ListenerIO_AttemptRecv_should_handle_successful_socket_read_and_unpack
         .state = RIS_EXPECT,
     };
     ListenerHelper_FindInfoBySequenceID_ExpectAndReturn(l, ci.fd, 12345, &unpack_res_info);
-    ListenerTask_AttemptDelivery_Expect(l, &unpack_res_info);
+    ListenerTask_QueueDelivery_Expect(l, &unpack_res_info);
     
     ListenerIO_AttemptRecv(l, 1);
 
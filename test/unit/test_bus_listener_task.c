@@ -321,6 +321,57 @@ void test_ListenerTask_MainLoop_should_check_commands(void) {
     ListenerTask_MainLoop((void *)l);
 }
 
+void test_ListenerTask_MainLoop_should_deliver_queued_messages_as_a_batch(void) {
+    l->is_idle = true;
+    poll_res = 1;
+    l->rx_info_max_used = 2;
+
+    boxed_msg box2 = {
+        .fd = 1,
+        .out_seq_id = 12346,
+        .timeout_sec = 11,
+    };
+    rx_info_t *info0 = &l->rx_info[0];
+    rx_info_t *info1 = &l->rx_info[1];
+    box->result.status = BUS_SEND_REQUEST_COMPLETE;
+    box2.result.status = BUS_SEND_REQUEST_COMPLETE;
+    info0->state = RIS_EXPECT;
+    info0->u.expect.box = box;
+    info0->u.expect.error = RX_ERROR_READY_FOR_DELIVERY;
+    info0->u.expect.has_result = true;
+    info0->u.expect.result.ok = true;
+    info0->u.expect.result.u.success.seq_id = 12345;
+    info1->state = RIS_EXPECT;
+    info1->u.expect.box = &box2;
+    info1->u.expect.error = RX_ERROR_READY_FOR_DELIVERY;
+    info1->u.expect.has_result = true;
+    info1->u.expect.result.ok = true;
+    info1->u.expect.result.u.success.seq_id = 12346;
+
+    ListenerTask_QueueDelivery(l, info0);
+    ListenerTask_QueueDelivery(l, info1);
+    TEST_ASSERT_EQUAL(2, l->delivery_batch_count);
+
+    // threadpool only has room for the first
+    boxed_msg *expected_boxes[] = {box, &box2};
+    now.tv_sec = -1;   // skip tick_handler
+    Util_Timestamp_ExpectAndReturn(&now, true, true);
+    syscall_poll_ExpectAndReturn(l->fds, l->tracked_fds + INCOMING_MSG_PIPE,
+        -1, poll_res);
+    ListenerCmd_CheckIncomingMessages_Expect(l, &poll_res);
+    ListenerIO_AttemptRecv_Expect(l, poll_res);
+    Bus_ProcessBoxedMessages_ExpectAndReturn(l->bus, expected_boxes, 2, &backpressure, 1);
+
+    ListenerTask_MainLoop((void *)l);
+    TEST_ASSERT_EQUAL(0, l->delivery_batch_count);
+    TEST_ASSERT_EQUAL(RIS_INACTIVE, info0->state);
+    TEST_ASSERT_EQUAL(BUS_SEND_SUCCESS, box->result.status);
+    TEST_ASSERT_EQUAL(12345, box->result.u.response.seq_id);
+    TEST_ASSERT_EQUAL(RIS_EXPECT, info1->state);
+    TEST_ASSERT_EQUAL(&box2, info1->u.expect.box);
+    TEST_ASSERT_EQUAL(RX_ERROR_READY_FOR_DELIVERY, info1->u.expect.error);
+}
+
 void test_ListenerTask_ReleaseMsg_should_repool_listener_messages(void)
 {
     listener_msg *msg = &l->msgs[1];
@@ -183,3 +183,13 @@ void test_Send_DoBlockingSend_should_return_true_and_status_set_by_callee_if_wri
     TEST_ASSERT_TRUE(Send_DoBlockingSend(b, box));
     TEST_ASSERT_EQUAL(BUS_SEND_RX_TIMEOUT, box->result.status);
 }
+
+void test_Send_HandleFailure_should_not_call_back_inline_on_the_sending_thread(void) {
+    box->inline_cb = true;
+    expect_handle_failure();
+
+    Send_HandleFailure(b, box, BUS_SEND_TX_FAILURE);
+
+    TEST_ASSERT_FALSE(box->inline_cb);
+    TEST_ASSERT_EQUAL(BUS_SEND_TX_FAILURE, box->result.status);
+}
@@ -26,6 +26,9 @@
 #include "kinetic_device_info.h"
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_controller.h"
+#include "mock_kinetic_object.h"
+#include "mock_kinetic_cache.h"
+#include "mock_kinetic_completion_queue.h"
 #include "mock_kinetic_builder.h"
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_bus.h"
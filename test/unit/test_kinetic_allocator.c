@@ -29,6 +29,7 @@
 #include "byte_array.h"
 #include "mock_protobuf-c.h"
 #include "mock_kinetic_memory.h"
+#include "mock_kinetic_arena.h"
 #include <stdlib.h>
 #include <pthread.h>
 
@@ -98,11 +99,20 @@ void test_KineticAllocator_FreeSession_should_destroy_waiter_and_free_session(vo
 
 void test_KineticAllocator_NewKineticResponse_should_return_null_if_calloc_return_null(void)
 {
-    KineticCalloc_ExpectAndReturn(1, sizeof(KineticResponse) + 1234, NULL);
-    KineticResponse * response = KineticAllocator_NewKineticResponse(1234);
+    KineticCalloc_ExpectAndReturn(1, sizeof(KineticResponse) + 1234 + 56, NULL);
+    KineticResponse * response = KineticAllocator_NewKineticResponse(56, 1234);
     TEST_ASSERT_NULL(response);
 }
 
+void test_KineticAllocator_NewKineticResponse_should_keep_the_protobuf_after_the_value(void)
+{
+    uint8_t buf[sizeof(KineticResponse) + 1234 + 56];
+    KineticCalloc_ExpectAndReturn(1, sizeof(KineticResponse) + 1234 + 56, buf);
+    KineticResponse * response = KineticAllocator_NewKineticResponse(56, 1234);
+    TEST_ASSERT_EQUAL_PTR(buf, response);
+    TEST_ASSERT_EQUAL_PTR(&response->value[1234], response->protoBytes);
+}
+
 void test_KineticAllocator_FreeKineticResponse_should_free_the_command_if_its_not_null(void)
 {
     Com__Seagate__Kinetic__Proto__Command command;
@@ -144,6 +154,23 @@ void test_KineticAllocator_FreeKineticResponse_should_free_the_proto_and_command
     KineticAllocator_FreeKineticResponse(&rsp);
 }
 
+void test_KineticAllocator_FreeKineticResponse_should_release_the_arena_instead_of_freeing_each_message(void)
+{
+    Com__Seagate__Kinetic__Proto__Message proto;
+    Com__Seagate__Kinetic__Proto__Command command;
+    KineticArena * arena = (KineticArena *)0x1234;
+
+    KineticResponse rsp = {
+        .proto = &proto,
+        .command = &command,
+        .arena = arena,
+    };
+    KineticArena_Release_Expect(arena);
+    KineticFree_Expect(&rsp);
+
+    KineticAllocator_FreeKineticResponse(&rsp);
+}
+
 void test_KineticAllocator_NewOperation_should_return_null_if_calloc_returns_null_for_operation(void)
 {
     KineticCalloc_ExpectAndReturn(1, sizeof(KineticOperation), NULL);
@@ -211,6 +238,58 @@ void test_KineticAllocator_FreeOperation_should_free_response_if_its_not_null(vo
     KineticAllocator_FreeOperation(&op);
 }
 
+void test_KineticAllocator_NewOperationPool_should_return_false_if_calloc_returns_null(void)
+{
+    KineticCalloc_ExpectAndReturn(4, sizeof(KineticOperationSlot), NULL);
+    TEST_ASSERT_FALSE(KineticAllocator_NewOperationPool(&Session, 4));
+    TEST_ASSERT_NULL(Session.operationPool.slots);
+}
+
+void test_KineticAllocator_NewOperation_should_reuse_pooled_operations_before_allocating(void)
+{
+    Session.timeoutSeconds = 17;
+    KineticOperationSlot slots[2];
+    KineticCalloc_ExpectAndReturn(2, sizeof(KineticOperationSlot), slots);
+    // Pooled requests are fully initialized once, up front...
+    KineticRequest_Init_Expect(&slots[0].request, &Session);
+    KineticRequest_Init_Expect(&slots[1].request, &Session);
+    TEST_ASSERT_TRUE(KineticAllocator_NewOperationPool(&Session, 2));
+
+    // ...and only reset when reused
+    KineticRequest_Reset_Expect(&slots[0].request, &Session);
+    KineticRequest_Reset_Expect(&slots[1].request, &Session);
+    KineticOperation * first = KineticAllocator_NewOperation(&Session);
+    KineticOperation * second = KineticAllocator_NewOperation(&Session);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_TRUE(first != second);
+    TEST_ASSERT_EQUAL_PTR(&Session, first->session);
+    TEST_ASSERT_NOT_NULL(first->request);
+    TEST_ASSERT_EQUAL(17, first->timeoutSeconds);
+
+    // Pool exhausted, so the next one comes from the heap
+    KineticOperation heapOp;
+    KineticRequest heapRequest;
+    KineticCalloc_ExpectAndReturn(1, sizeof(KineticOperation), &heapOp);
+    KineticCalloc_ExpectAndReturn(1, sizeof(KineticRequest), &heapRequest);
+    KineticRequest_Init_Expect(&heapRequest, &Session);
+    TEST_ASSERT_EQUAL_PTR(&heapOp, KineticAllocator_NewOperation(&Session));
+
+    // Returning a pooled operation makes it available again, without freeing
+    KineticAllocator_FreeOperation(first);
+    KineticRequest_Reset_Expect(first->request, &Session);
+    TEST_ASSERT_EQUAL_PTR(first, KineticAllocator_NewOperation(&Session));
+
+    // Heap operations are still freed
+    KineticFree_Expect(&heapRequest);
+    KineticFree_Expect(&heapOp);
+    KineticAllocator_FreeOperation(&heapOp);
+
+    KineticFree_Expect(slots);
+    KineticAllocator_FreeOperationPool(&Session);
+    TEST_ASSERT_NULL(Session.operationPool.slots);
+}
+
 void test_KineticAllocator_FreeP2PProtobuf_should_free_protobuf_message_P2P_operation_tree(void)
 {
     TEST_IGNORE_MESSAGE("TODO: Need to test P2P protobuf free");
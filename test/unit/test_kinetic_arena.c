@@ -0,0 +1,92 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_arena.h"
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_logger.h"
+#include "protobuf-c/protobuf-c.h"
+#include <stdint.h>
+#include <string.h>
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_KineticArena_Allocator_should_be_NULL_for_NULL_arena(void)
+{
+    TEST_ASSERT_NULL(KineticArena_Allocator(NULL));
+    KineticArena_Release(NULL);
+}
+
+void test_KineticArena_should_hand_out_aligned_non_overlapping_allocations(void)
+{
+    KineticArena * arena = KineticArena_Take(64);
+    TEST_ASSERT_NOT_NULL(arena);
+    ProtobufCAllocator * allocator = KineticArena_Allocator(arena);
+    TEST_ASSERT_NOT_NULL(allocator);
+
+    uint8_t * a = allocator->alloc(allocator->allocator_data, 3);
+    uint8_t * b = allocator->alloc(allocator->allocator_data, 8);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)a % sizeof(void *));
+    TEST_ASSERT_EQUAL(0, (uintptr_t)b % sizeof(int64_t));
+    TEST_ASSERT_TRUE(b >= a + 3);
+
+    memset(a, 0xaa, 3);
+    memset(b, 0xbb, 8);
+    allocator->free(allocator->allocator_data, a);
+    TEST_ASSERT_EQUAL_HEX8(0xaa, a[2]);
+
+    KineticArena_Release(arena);
+}
+
+void test_KineticArena_should_grow_past_its_first_block(void)
+{
+    KineticArena * arena = KineticArena_Take(0);
+    ProtobufCAllocator * allocator = KineticArena_Allocator(arena);
+
+    // Far more than one block's worth, in pieces and in one large chunk
+    for (int i = 0; i < 1000; i++) {
+        uint8_t * p = allocator->alloc(allocator->allocator_data, 100);
+        TEST_ASSERT_NOT_NULL(p);
+        memset(p, i, 100);
+    }
+    uint8_t * big = allocator->alloc(allocator->allocator_data, 1024 * 1024);
+    TEST_ASSERT_NOT_NULL(big);
+    memset(big, 0, 1024 * 1024);
+
+    KineticArena_Release(arena);
+}
+
+void test_KineticArena_Release_should_return_arena_to_pool_for_reuse(void)
+{
+    KineticArena * arena = KineticArena_Take(128);
+    KineticArena_Release(arena);
+
+    KineticArena * again = KineticArena_Take(128);
+    TEST_ASSERT_EQUAL_PTR(arena, again);
+    KineticArena_Release(again);
+}
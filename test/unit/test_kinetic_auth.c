@@ -22,6 +22,8 @@
 #include "unity_helper.h"
 #include "kinetic_auth.h"
 #include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
+#include "kinetic_signingqueue.h"
 #include "kinetic_nbo.h"
 #include "kinetic.pb-c.h"
 #include "kinetic_logger.h"
@@ -123,6 +125,160 @@ void test_KineticAuth_PopulateHmac_should_add_and_populate_HMAC_authentication(v
 }
 
 
+void test_KineticAuth_PopulateHmac_should_sign_with_the_sessions_precomputed_key_if_available(void)
+{
+    uint8_t dummyMessageBytes[16];
+    memset(dummyMessageBytes, 0xA5, sizeof(dummyMessageBytes));
+    const char* hmacKey = "asdfasdf";
+    KineticSession session = {
+        .config = (KineticSessionConfig) {
+            .port = 1234,
+            .hmacKey = ByteArray_Create(session.config.keyData, strlen(hmacKey)),
+            .identity = 1,
+        }
+    };
+    strcpy((char*)session.config.keyData, hmacKey);
+
+    // Sign once the old way, with the raw key
+    KineticRequest_Init(&Request, &session);
+    TEST_ASSERT_NULL(Request.hmacKey);
+    Request.message.message.has_commandbytes = true;
+    Request.message.message.commandbytes = (ProtobufCBinaryData) {
+        .data = dummyMessageBytes,
+        .len = sizeof(dummyMessageBytes),
+    };
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticAuth_PopulateHmac(&session.config, &Request));
+    uint8_t expected[KINETIC_HMAC_SHA1_LEN];
+    memcpy(expected, Request.message.hmacData, sizeof(expected));
+
+    // ...and again with the session's precomputed key state
+    KineticHMAC_InitKey(&session.hmacKey, session.config.hmacKey);
+    KineticRequest_Init(&Request, &session);
+    TEST_ASSERT_EQUAL_PTR(&session.hmacKey, Request.hmacKey);
+    Request.message.message.has_commandbytes = true;
+    Request.message.message.commandbytes = (ProtobufCBinaryData) {
+        .data = dummyMessageBytes,
+        .len = sizeof(dummyMessageBytes),
+    };
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticAuth_PopulateHmac(&session.config, &Request));
+
+    TEST_ASSERT_TRUE(Request.message.hmacAuth.has_hmac);
+    TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, Request.message.hmacAuth.hmac.len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, Request.message.hmacData, KINETIC_HMAC_SHA1_LEN);
+}
+
+void test_KineticAuth_PopulateHmac_should_sign_through_the_sessions_signing_queue_if_available(void)
+{
+    uint8_t dummyMessageBytes[16];
+    memset(dummyMessageBytes, 0x5A, sizeof(dummyMessageBytes));
+    const char* hmacKey = "asdfasdf";
+    KineticSession session = {
+        .config = (KineticSessionConfig) {
+            .port = 1234,
+            .hmacKey = ByteArray_Create(session.config.keyData, strlen(hmacKey)),
+            .identity = 1,
+        }
+    };
+    strcpy((char*)session.config.keyData, hmacKey);
+    KineticHMAC_InitKey(&session.hmacKey, session.config.hmacKey);
+
+    // Sign once with the key state alone
+    KineticRequest_Init(&Request, &session);
+    TEST_ASSERT_NULL(Request.signingQueue);
+    Request.message.message.has_commandbytes = true;
+    Request.message.message.commandbytes = (ProtobufCBinaryData) {
+        .data = dummyMessageBytes,
+        .len = sizeof(dummyMessageBytes),
+    };
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticAuth_PopulateHmac(&session.config, &Request));
+    uint8_t expected[KINETIC_HMAC_SHA1_LEN];
+    memcpy(expected, Request.message.hmacData, sizeof(expected));
+
+    // ...and again through the signing queue
+    session.signingQueue = KineticSigningQueue_Create(&session.hmacKey);
+    TEST_ASSERT_NOT_NULL(session.signingQueue);
+    KineticRequest_Init(&Request, &session);
+    TEST_ASSERT_EQUAL_PTR(session.signingQueue, Request.signingQueue);
+    Request.message.message.has_commandbytes = true;
+    Request.message.message.commandbytes = (ProtobufCBinaryData) {
+        .data = dummyMessageBytes,
+        .len = sizeof(dummyMessageBytes),
+    };
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticAuth_PopulateHmac(&session.config, &Request));
+    KineticSigningQueue_Destroy(session.signingQueue);
+
+    TEST_ASSERT_TRUE(Request.message.hmacAuth.has_hmac);
+    TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, Request.message.hmacAuth.hmac.len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, Request.message.hmacData, KINETIC_HMAC_SHA1_LEN);
+}
+
+void test_KineticAuth_PopulateHmacBatch_should_return_HMAC_REQUIRED_if_HMAC_not_specified_in_the_session_config(void)
+{
+    KineticSession session = {
+        .config = (KineticSessionConfig) {
+            .port = 1234,
+        }
+    };
+    KineticRequest* pdus[] = {&Request};
+
+    KineticStatus status = KineticAuth_PopulateHmacBatch(&session.config, pdus, 1);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_HMAC_REQUIRED, status);
+}
+
+void test_KineticAuth_PopulateHmacBatch_should_sign_each_request_as_PopulateHmac_would(void)
+{
+    enum { COUNT = KINETIC_HMAC_MB_MAX_LANES + 3 };
+    uint8_t dummyMessageBytes[COUNT][16];
+    const char* hmacKey = "asdfasdf";
+    KineticSession session = {
+        .config = (KineticSessionConfig) {
+            .port = 1234,
+            .hmacKey = ByteArray_Create(session.config.keyData, strlen(hmacKey)),
+            .identity = 1,
+        }
+    };
+    strcpy((char*)session.config.keyData, hmacKey);
+    KineticHMAC_InitKey(&session.hmacKey, session.config.hmacKey);
+
+    static KineticRequest requests[COUNT];
+    KineticRequest* pdus[COUNT];
+    uint8_t expected[COUNT][KINETIC_HMAC_SHA1_LEN];
+    for (int i = 0; i < COUNT; i++) {
+        memset(dummyMessageBytes[i], i, sizeof(dummyMessageBytes[i]));
+        KineticRequest_Init(&Request, &session);
+        Request.message.message.has_commandbytes = true;
+        Request.message.message.commandbytes = (ProtobufCBinaryData) {
+            .data = dummyMessageBytes[i],
+            .len = sizeof(dummyMessageBytes[i]),
+        };
+        TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+            KineticAuth_PopulateHmac(&session.config, &Request));
+        memcpy(expected[i], Request.message.hmacData, sizeof(expected[i]));
+
+        KineticRequest_Init(&requests[i], &session);
+        requests[i].message.message.has_commandbytes = true;
+        requests[i].message.message.commandbytes = Request.message.message.commandbytes;
+        pdus[i] = &requests[i];
+    }
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticAuth_PopulateHmacBatch(&session.config, pdus, COUNT));
+
+    for (int i = 0; i < COUNT; i++) {
+        TEST_ASSERT_TRUE(requests[i].message.message.has_authtype);
+        TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH,
+            requests[i].message.message.authtype);
+        TEST_ASSERT_TRUE(requests[i].message.hmacAuth.has_hmac);
+        TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, requests[i].message.hmacAuth.hmac.len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected[i], requests[i].message.hmacData, KINETIC_HMAC_SHA1_LEN);
+    }
+}
+
 void test_KineticAuth_Populate_should_add_and_populate_PIN_authentication(void)
 {
     char testPin[] = "192736aHUx@*G!Q";
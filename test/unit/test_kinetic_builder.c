@@ -27,10 +27,13 @@
 #include "kinetic_builder.h"
 #include "kinetic_memory.h"
 #include "kinetic_allocator.h"
+#include "kinetic_arena.h"
+#include "kinetic_tag.h"
 #include "mock_kinetic_resourcewaiter.h"
 #include "mock_kinetic_callbacks.h"
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_message.h"
+#include <openssl/sha.h>
 
 static KineticSession Session;
 static KineticRequest Request;
@@ -129,16 +132,19 @@ void test_KineticBuilder_BuildPut_should_build_and_execute_a_PUT_operation_to_cr
     ByteArray value = ByteArray_CreateWithCString("Luke, I am your father");
     ByteArray key = ByteArray_CreateWithCString("foobar");
     ByteArray newVersion = ByteArray_CreateWithCString("v1.0");
-    ByteArray tag = ByteArray_CreateWithCString("some_tag");
+    uint8_t tagData[SHA_DIGEST_LENGTH];
+    uint8_t expectedTag[SHA_DIGEST_LENGTH];
 
     KineticEntry entry = {
         .key = ByteBuffer_CreateWithArray(key),
         .newVersion = ByteBuffer_CreateWithArray(newVersion),
-        .tag = ByteBuffer_CreateWithArray(tag),
+        .tag = ByteBuffer_Create(tagData, sizeof(tagData), 0),
         .algorithm = KINETIC_ALGORITHM_SHA1,
         .value = ByteBuffer_CreateWithArray(value),
         .computeTag = true,
     };
+    entry.value.bytesUsed = value.len;
+    SHA1(value.data, value.len, expectedTag);
 
     KineticOperation_ValidateOperation_Expect(&Operation);
     KineticMessage_ConfigureKeyValue_Expect(&Operation.request->message, &entry);
@@ -153,12 +159,60 @@ void test_KineticBuilder_BuildPut_should_build_and_execute_a_PUT_operation_to_cr
     TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT,
         Request.message.command.header->messagetype);
     TEST_ASSERT_EQUAL_ByteArray(value, Operation.entry->value.array);
-    TEST_ASSERT_EQUAL(0, Operation.entry->value.bytesUsed);
+    TEST_ASSERT_EQUAL(sizeof(expectedTag), entry.tag.bytesUsed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expectedTag, tagData, sizeof(expectedTag));
     TEST_ASSERT_FALSE(Request.pinAuth);
     TEST_ASSERT_EQUAL(0, Operation.timeoutSeconds);
     TEST_ASSERT_NULL(Operation.response);
 }
 
+void test_KineticBuilder_BuildPut_should_return_BUFFER_OVERRUN_if_calculated_tag_does_not_fit(void)
+{
+    ByteArray value = ByteArray_CreateWithCString("Luke, I am your father");
+    ByteArray key = ByteArray_CreateWithCString("foobar");
+    ByteArray tag = ByteArray_CreateWithCString("some_tag");
+
+    KineticEntry entry = {
+        .key = ByteBuffer_CreateWithArray(key),
+        .tag = ByteBuffer_CreateWithArray(tag),
+        .algorithm = KINETIC_ALGORITHM_SHA2,
+        .value = ByteBuffer_CreateWithArray(value),
+        .computeTag = true,
+    };
+
+    KineticOperation_ValidateOperation_Expect(&Operation);
+
+    KineticStatus status = KineticBuilder_BuildPut(&Operation, &entry);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN, status);
+}
+
+void test_KineticBuilder_BuildPut_should_skip_the_tag_if_tag_algorithm_is_not_supported(void)
+{
+    ByteArray value = ByteArray_CreateWithCString("Luke, I am your father");
+    ByteArray key = ByteArray_CreateWithCString("foobar");
+    ByteArray tag = ByteArray_CreateWithCString("some_tag");
+
+    KineticEntry entry = {
+        .key = ByteBuffer_CreateWithArray(key),
+        .tag = ByteBuffer_CreateWithArray(tag),
+        .algorithm = KINETIC_ALGORITHM_SHA3,
+        .value = ByteBuffer_CreateWithArray(value),
+        .computeTag = true,
+    };
+    entry.value.bytesUsed = value.len;
+    entry.tag.bytesUsed = tag.len;
+
+    KineticOperation_ValidateOperation_Expect(&Operation);
+    KineticMessage_ConfigureKeyValue_Expect(&Operation.request->message, &entry);
+
+    KineticStatus status = KineticBuilder_BuildPut(&Operation, &entry);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT,
+        Request.message.command.header->messagetype);
+    TEST_ASSERT_EQUAL(tag.len, entry.tag.bytesUsed);
+    TEST_ASSERT_EQUAL_STRING_LEN("some_tag", entry.tag.array.data, tag.len);
+}
+
 uint8_t ValueData[KINETIC_OBJ_SIZE];
 
 void test_KineticBuilder_BuildGet_should_build_a_GET_operation(void)
@@ -418,6 +472,37 @@ void test_KineticBuilder_BuildGetKeyRange_should_build_a_GetKeyRange_request(voi
     TEST_ASSERT_EQUAL_PTR(&Request.message.command, Request.command);
 }
 
+static bool count_key(ByteArray const key, void* client_data)
+{
+    (void)key;
+    (*(int*)client_data)++;
+    return true;
+}
+
+void test_KineticBuilder_BuildGetKeyRangeStream_should_build_a_GetKeyRange_request_without_key_buffers(void)
+{
+    uint8_t startKeyData[] = "key_range_00_00";
+    uint8_t endKeyData[] = "key_range_00_03";
+    KineticKeyRange range = {
+        .startKey = ByteBuffer_Create(startKeyData, sizeof(startKeyData), sizeof(startKeyData)),
+        .endKey = ByteBuffer_Create(endKeyData, sizeof(endKeyData), sizeof(endKeyData)),
+        .maxReturned = 4,
+    };
+    int count = 0;
+
+    KineticOperation_ValidateOperation_Expect(&Operation);
+    KineticMessage_ConfigureKeyRange_Expect(&Request.message, &range);
+
+    KineticBuilder_BuildGetKeyRangeStream(&Operation, &range, count_key, &count);
+
+    TEST_ASSERT_TRUE(Request.command->header->has_messagetype);
+    TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETKEYRANGE,
+        Request.command->header->messagetype);
+    TEST_ASSERT_EQUAL_PTR(KineticCallbacks_GetKeyRangeStream, Operation.opCallback);
+    TEST_ASSERT_EQUAL_PTR(count_key, Operation.keyCallback);
+    TEST_ASSERT_EQUAL_PTR(&count, Operation.keyClientData);
+    TEST_ASSERT_NULL(Operation.buffers);
+}
 
 void test_KineticBuilder_BuildP2POperation_should_build_a_P2POperation_request(void)
 {
@@ -283,7 +283,7 @@ void test_unpack_cb_should_expose_alloc_failure(void)
         },
     };
     
-    KineticAllocator_NewKineticResponse_ExpectAndReturn(8, NULL);
+    KineticAllocator_NewKineticResponse_ExpectAndReturn(0, 8, NULL);
     bus_unpack_cb_res_t res = unpack_cb((void*)&si, &Session);
     TEST_ASSERT_FALSE(res.ok);
     TEST_ASSERT_EQUAL(UNPACK_ERROR_PAYLOAD_MALLOC_FAIL, res.u.error.opaque_error_id);
@@ -296,7 +296,6 @@ void test_unpack_cb_should_skip_empty_commands(void)
     socket_info *si = (socket_info *)si_buf;
     si->state = STATE_AWAITING_HEADER;
     si->unpack_status = UNPACK_ERROR_SUCCESS,
-    si->header.protobufLength = 0x01;
     si->header.valueLength = 0x01;
     si->header.protobufLength = 0x01;
     si->buf[0] = 0x00;
@@ -305,32 +304,36 @@ void test_unpack_cb_should_skip_empty_commands(void)
     uint8_t response_buf[sizeof(KineticResponse) + 128];
     memset(response_buf, 0, sizeof(response_buf));
     KineticResponse *response = (KineticResponse *)response_buf;
+    uint8_t protoBytes[1];
+    response->protoBytes = protoBytes;
 
-    KineticAllocator_NewKineticResponse_ExpectAndReturn(1, response);
-
-    Com__Seagate__Kinetic__Proto__Message Proto;
-    memset(&Proto, 0, sizeof(Proto));
-    Proto.has_commandbytes = false;
+    KineticAllocator_NewKineticResponse_ExpectAndReturn(1, 1, response);
 
-    KineticPDU_unpack_message_ExpectAndReturn(NULL, si->header.protobufLength,
-        si->buf, &Proto);
+    KineticResponseSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    KineticPDU_unpack_summary_ExpectAndReturn(si->header.protobufLength,
+        protoBytes, &response->summary, true);
+    KineticPDU_unpack_summary_ReturnThruPtr_summary(&summary);
 
     bus_unpack_cb_res_t res = unpack_cb(si, &Session);
 
+    TEST_ASSERT_EQUAL(0x00, protoBytes[0]);
     TEST_ASSERT_EQUAL(0xee, response->value[0]);
+    TEST_ASSERT_NULL(response->proto);
+    TEST_ASSERT_NULL(response->command);
 
     TEST_ASSERT(res.ok);
     TEST_ASSERT_EQUAL(response, res.u.success.msg);
+    TEST_ASSERT_EQUAL(BUS_NO_SEQ_ID, res.u.success.seq_id);
 }
 
-void test_unpack_cb_should_unpack_command_bytes(void)
+void test_unpack_cb_should_route_by_the_ack_sequence_without_unpacking(void)
 {
     Session.socket = 123;
     socket_info *si = (socket_info *)si_buf;
     si->state = STATE_AWAITING_HEADER;
     si->unpack_status = UNPACK_ERROR_SUCCESS,
-    si->header.protobufLength = 0x01;
-    si->header.valueLength = 0x08;
+    si->header.valueLength = 0x01;
     si->header.protobufLength = 0x02;
     si->buf[0] = 0x00;
     si->buf[1] = 0x01;
@@ -339,34 +342,63 @@ void test_unpack_cb_should_unpack_command_bytes(void)
     uint8_t response_buf[sizeof(KineticResponse) + 1];
     memset(response_buf, 0, sizeof(response_buf));
     KineticResponse *response = (KineticResponse *)response_buf;
+    uint8_t protoBytes[2];
+    response->protoBytes = protoBytes;
 
-    KineticAllocator_NewKineticResponse_ExpectAndReturn(8, response);
-
-    Com__Seagate__Kinetic__Proto__Message Proto;
-    memset(&Proto, 0, sizeof(Proto));
-    Proto.has_commandbytes = true;
-    Proto.commandbytes.data = (uint8_t *)"data";
-    Proto.commandbytes.len = 4;
-
-    KineticPDU_unpack_message_ExpectAndReturn(NULL, si->header.protobufLength,
-        si->buf, &Proto);
-
-    Com__Seagate__Kinetic__Proto__Command Command;
-    memset(&Command, 0, sizeof(Command));
-    Com__Seagate__Kinetic__Proto__Command__Header Header;
-    memset(&Header, 0, sizeof(Header));
-    Command.header = &Header;
-    response->header.valueLength = 1;
-    Header.acksequence = 0x12345678;
+    KineticAllocator_NewKineticResponse_ExpectAndReturn(2, 1, response);
 
-    KineticPDU_unpack_command_ExpectAndReturn(NULL, Proto.commandbytes.len,
-        Proto.commandbytes.data, &Command);
+    KineticResponseSummary summary = {
+        .hasAuthType = true,
+        .authType = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH,
+        .hasHeader = true,
+        .ackSequence = 0x12345678,
+    };
+    KineticPDU_unpack_summary_ExpectAndReturn(si->header.protobufLength,
+        protoBytes, &response->summary, true);
+    KineticPDU_unpack_summary_ReturnThruPtr_summary(&summary);
 
     bus_unpack_cb_res_t res = unpack_cb(si, &Session);
 
+    TEST_ASSERT_EQUAL_MEMORY(si->buf, protoBytes, sizeof(protoBytes));
     TEST_ASSERT_EQUAL(0xee, response->value[0]);
+    TEST_ASSERT_NULL(response->proto);
+    TEST_ASSERT_NULL(response->command);
 
     TEST_ASSERT(res.ok);
     TEST_ASSERT_EQUAL(response, res.u.success.msg);
     TEST_ASSERT_EQUAL(0x12345678, res.u.success.seq_id);
 }
+
+void test_unpack_cb_should_ignore_the_unsolicited_status_on_connect(void)
+{
+    Session.socket = 123;
+    socket_info *si = (socket_info *)si_buf;
+    si->state = STATE_AWAITING_HEADER;
+    si->unpack_status = UNPACK_ERROR_SUCCESS,
+    si->header.valueLength = 0;
+    si->header.protobufLength = 0x01;
+
+    uint8_t response_buf[sizeof(KineticResponse)];
+    memset(response_buf, 0, sizeof(response_buf));
+    KineticResponse *response = (KineticResponse *)response_buf;
+    uint8_t protoBytes[1];
+    response->protoBytes = protoBytes;
+
+    KineticAllocator_NewKineticResponse_ExpectAndReturn(1, 0, response);
+
+    KineticResponseSummary summary = {
+        .hasAuthType = true,
+        .authType = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS,
+        .hasHeader = true,
+        .connectionID = 999,
+    };
+    KineticPDU_unpack_summary_ExpectAndReturn(si->header.protobufLength,
+        protoBytes, &response->summary, true);
+    KineticPDU_unpack_summary_ReturnThruPtr_summary(&summary);
+    KineticSession_GetConnectionID_ExpectAndReturn(&Session, 0);
+
+    bus_unpack_cb_res_t res = unpack_cb(si, &Session);
+
+    TEST_ASSERT(res.ok);
+    TEST_ASSERT_EQUAL(BUS_NO_SEQ_ID, res.u.success.seq_id);
+}
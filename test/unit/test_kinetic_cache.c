@@ -0,0 +1,218 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_cache.h"
+#include "byte_array.h"
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_logger.h"
+#include <stdio.h>
+#include <string.h>
+
+static KineticCache * Cache;
+static uint8_t KeyData[32];
+static uint8_t ValueData[256];
+static uint8_t VersionData[16];
+static uint8_t TagData[32];
+
+void setUp(void)
+{
+    Cache = NULL;
+}
+
+void tearDown(void)
+{
+    if (Cache != NULL) { KineticCache_Destroy(Cache); }
+}
+
+/* An entry as a GET of KEY would have left it, holding VALUE at VERSION. */
+static KineticEntry read_entry(const char * key, const char * value, const char * version)
+{
+    size_t keyLen = strlen(key);
+    memcpy(KeyData, key, keyLen);
+    KineticEntry entry = {
+        .key = ByteBuffer_Create(KeyData, sizeof(KeyData), keyLen),
+        .value = ByteBuffer_Create(ValueData, sizeof(ValueData), 0),
+        .dbVersion = ByteBuffer_Create(VersionData, sizeof(VersionData), 0),
+        .tag = ByteBuffer_Create(TagData, sizeof(TagData), 0),
+        .algorithm = KINETIC_ALGORITHM_SHA1,
+    };
+    ByteBuffer_Append(&entry.value, value, strlen(value));
+    ByteBuffer_Append(&entry.dbVersion, version, strlen(version));
+    ByteBuffer_Append(&entry.tag, "tag", 3);
+    return entry;
+}
+
+/* An entry ready for a GET of KEY. */
+static KineticEntry get_entry(const char * key)
+{
+    KineticEntry entry = read_entry(key, "", "");
+    ByteBuffer_Reset(&entry.tag);
+    entry.algorithm = KINETIC_ALGORITHM_INVALID;
+    return entry;
+}
+
+static ByteArray array_of(const char * s)
+{
+    return (ByteArray) {.data = (uint8_t *)s, .len = strlen(s)};
+}
+
+void test_KineticCache_Lookup_should_serve_an_inserted_entry_as_a_GET_would(void)
+{
+    Cache = KineticCache_Create(64 * 1024, 60000);
+    uint64_t generation;
+    KineticEntry entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+
+    entry = read_entry("key", "value", "v1");
+    KineticCache_Insert(Cache, &entry, generation);
+
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_HIT, KineticCache_Lookup(Cache, &entry, &generation));
+    TEST_ASSERT_EQUAL(5, entry.value.bytesUsed);
+    TEST_ASSERT_EQUAL_MEMORY("value", entry.value.array.data, 5);
+    TEST_ASSERT_EQUAL(2, entry.dbVersion.bytesUsed);
+    TEST_ASSERT_EQUAL_MEMORY("v1", entry.dbVersion.array.data, 2);
+    TEST_ASSERT_EQUAL(3, entry.tag.bytesUsed);
+    TEST_ASSERT_EQUAL(KINETIC_ALGORITHM_SHA1, entry.algorithm);
+
+    KineticCacheStats stats;
+    KineticCache_GetStats(Cache, &stats);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+    TEST_ASSERT_EQUAL(1, stats.entries);
+}
+
+void test_KineticCache_Lookup_should_miss_if_the_value_buffer_is_too_small(void)
+{
+    Cache = KineticCache_Create(64 * 1024, 60000);
+    uint64_t generation;
+    KineticEntry entry = read_entry("key", "value", "v1");
+    KineticCache_Insert(Cache, &entry, 0);
+
+    entry = get_entry("key");
+    entry.value.array.len = 4;
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+    TEST_ASSERT_EQUAL(0, entry.value.bytesUsed);
+}
+
+void test_KineticCache_Lookup_should_ask_for_revalidation_once_the_TTL_has_passed(void)
+{
+    Cache = KineticCache_Create(64 * 1024, 0);
+    uint64_t generation;
+    KineticEntry entry = read_entry("key", "value", "v1");
+    KineticCache_Insert(Cache, &entry, 0);
+
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_STALE, KineticCache_Lookup(Cache, &entry, &generation));
+    TEST_ASSERT_EQUAL(0, entry.value.bytesUsed);
+    TEST_ASSERT_EQUAL_MEMORY("v1", entry.dbVersion.array.data, 2);
+
+    TEST_ASSERT_TRUE(KineticCache_Revalidate(Cache, &entry, array_of("v1")));
+    TEST_ASSERT_EQUAL_MEMORY("value", entry.value.array.data, 5);
+
+    KineticCacheStats stats;
+    KineticCache_GetStats(Cache, &stats);
+    TEST_ASSERT_EQUAL(1, stats.revalidatedHits);
+    TEST_ASSERT_EQUAL(0, stats.hits);
+}
+
+void test_KineticCache_Revalidate_should_drop_an_entry_whose_version_changed(void)
+{
+    Cache = KineticCache_Create(64 * 1024, 0);
+    uint64_t generation;
+    KineticEntry entry = read_entry("key", "value", "v1");
+    KineticCache_Insert(Cache, &entry, 0);
+
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_STALE, KineticCache_Lookup(Cache, &entry, &generation));
+    TEST_ASSERT_FALSE(KineticCache_Revalidate(Cache, &entry, array_of("v2")));
+    TEST_ASSERT_EQUAL(0, entry.value.bytesUsed);
+
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+}
+
+void test_KineticCache_Invalidate_should_drop_the_key_and_reject_reads_that_raced_it(void)
+{
+    Cache = KineticCache_Create(64 * 1024, 60000);
+    uint64_t generation;
+    KineticEntry entry = read_entry("key", "value", "v1");
+    KineticCache_Insert(Cache, &entry, 0);
+
+    KineticCache_Invalidate(Cache, array_of("key"));
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+
+    // A GET that started before a write must not cache what it read
+    KineticCache_Invalidate(Cache, array_of("key"));
+    entry = read_entry("key", "old", "v1");
+    KineticCache_Insert(Cache, &entry, generation);
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+
+    KineticCacheStats stats;
+    KineticCache_GetStats(Cache, &stats);
+    TEST_ASSERT_EQUAL(1, stats.invalidations);
+    TEST_ASSERT_EQUAL(0, stats.entries);
+}
+
+void test_KineticCache_Insert_should_skip_entries_without_a_version_or_too_large(void)
+{
+    Cache = KineticCache_Create(KINETIC_CACHE_SHARDS * 128, 60000);
+    uint64_t generation;
+    KineticEntry entry = read_entry("key", "value", "");
+    KineticCache_Insert(Cache, &entry, 0);
+
+    char big[200];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    entry = read_entry("big", big, "v1");
+    KineticCache_Insert(Cache, &entry, 0);
+
+    entry = get_entry("key");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+    entry = get_entry("big");
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_MISS, KineticCache_Lookup(Cache, &entry, &generation));
+}
+
+void test_KineticCache_Insert_should_evict_to_stay_within_capacity(void)
+{
+    size_t const capacity = KINETIC_CACHE_SHARDS * 512;
+    Cache = KineticCache_Create(capacity, 60000);
+    uint64_t generation;
+    char key[16];
+    KineticEntry entry;
+
+    for (int i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        entry = read_entry(key, "a value of some length", "v1");
+        KineticCache_Insert(Cache, &entry, 0);
+    }
+
+    KineticCacheStats stats;
+    KineticCache_GetStats(Cache, &stats);
+    TEST_ASSERT_TRUE(stats.evictions > 0);
+    TEST_ASSERT_EQUAL(200, stats.entries + stats.evictions);
+    TEST_ASSERT_TRUE(stats.bytes <= capacity);
+
+    entry = get_entry(key);
+    TEST_ASSERT_EQUAL(KINETIC_CACHE_HIT, KineticCache_Lookup(Cache, &entry, &generation));
+}
@@ -34,13 +34,142 @@
 #include "mock_kinetic_allocator.h"
 #include "mock_kinetic_request.h"
 #include "mock_kinetic_acl.h"
+#include "mock_kinetic_tag.h"
 #include "kinetic_callbacks.h"
+#include <stdlib.h>
+#include <string.h>
 
 void test_kinetic_callbacks_needs_testing(void)
 {
     TEST_IGNORE_MESSAGE("TODO: Test operation callbacks.");
 }
 
+static KineticStatus get_with_tag(KineticEntry* entry, ByteArray value, KineticStatus verifyStatus)
+{
+    KineticSession session;
+    KineticResponse* response = calloc(1, sizeof(KineticResponse) + value.len);
+    TEST_ASSERT_NOT_NULL(response);
+    response->header.valueLength = value.len;
+    memcpy(response->value, value.data, value.len);
+    KineticOperation op = {.session = &session, .entry = entry, .response = response};
+
+    uint8_t tagData[] = {0xCB, 0xF4, 0x39, 0x26};
+    Com__Seagate__Kinetic__Proto__Command__KeyValue keyValue = {
+        .has_tag = true,
+        .tag = {.data = tagData, .len = sizeof(tagData)},
+        .has_algorithm = true,
+        .algorithm = COM__SEAGATE__KINETIC__PROTO__COMMAND__ALGORITHM__CRC32,
+    };
+
+    KineticResponse_GetKeyValue_ExpectAndReturn(response, &keyValue);
+    if (entry->computeTag) {
+        KineticTag_Length_ExpectAndReturn(KINETIC_ALGORITHM_CRC32, sizeof(tagData));
+        KineticTag_AppendAndVerify_ExpectAndReturn(KINETIC_ALGORITHM_CRC32, &entry->value,
+            (ByteArray){.data = response->value, .len = value.len},
+            (ByteArray){.data = tagData, .len = sizeof(tagData)}, verifyStatus);
+    }
+
+    KineticStatus status = KineticCallbacks_Get(&op, KINETIC_STATUS_SUCCESS);
+    free(response);
+    return status;
+}
+
+void test_KineticCallbacks_Get_should_verify_the_value_against_the_returned_tag_if_computeTag_is_set(void)
+{
+    uint8_t tag[4];
+    uint8_t value[16];
+    KineticEntry entry = {
+        .tag = ByteBuffer_Create(tag, sizeof(tag), 0),
+        .value = ByteBuffer_Create(value, sizeof(value), 0),
+        .computeTag = true,
+    };
+
+    KineticStatus status = get_with_tag(&entry, ByteArray_CreateWithCString("123456789"),
+        KINETIC_STATUS_DATA_ERROR);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR, status);
+    TEST_ASSERT_EQUAL(KINETIC_ALGORITHM_CRC32, entry.algorithm);
+}
+
+void test_KineticCallbacks_Get_should_copy_the_value_without_verifying_if_computeTag_is_not_set(void)
+{
+    uint8_t tag[4];
+    uint8_t value[16];
+    KineticEntry entry = {
+        .tag = ByteBuffer_Create(tag, sizeof(tag), 0),
+        .value = ByteBuffer_Create(value, sizeof(value), 0),
+    };
+    ByteArray expected = ByteArray_CreateWithCString("123456789");
+
+    KineticStatus status = get_with_tag(&entry, expected, KINETIC_STATUS_SUCCESS);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL(expected.len, entry.value.bytesUsed);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data, value, expected.len);
+}
+
+typedef struct {
+    size_t count;
+    size_t stopAfter;
+    ByteArray last;
+} KeysSeen;
+
+static bool see_key(ByteArray const key, void* client_data)
+{
+    KeysSeen * seen = client_data;
+    seen->count++;
+    seen->last = key;
+    return seen->count < seen->stopAfter;
+}
+
+static KineticStatus get_key_range_stream(KeysSeen * seen)
+{
+    KineticSession session;
+    KineticResponse response;
+    ProtobufCBinaryData keys[] = {
+        {.len = 3, .data = (uint8_t*)"one"},
+        {.len = 3, .data = (uint8_t*)"two"},
+        {.len = 5, .data = (uint8_t*)"three"},
+    };
+    Com__Seagate__Kinetic__Proto__Command__Range range = {
+        .n_keys = sizeof(keys) / sizeof(keys[0]),
+        .keys = keys,
+    };
+    KineticOperation op = {
+        .session = &session,
+        .response = &response,
+        .keyCallback = see_key,
+        .keyClientData = seen,
+    };
+
+    KineticResponse_GetKeyRange_ExpectAndReturn(&response, &range);
+
+    return KineticCallbacks_GetKeyRangeStream(&op, KINETIC_STATUS_SUCCESS);
+}
+
+void test_KineticCallbacks_GetKeyRangeStream_should_hand_each_key_to_the_callback(void)
+{
+    KeysSeen seen = {.stopAfter = 10};
+
+    KineticStatus status = get_key_range_stream(&seen);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL(3, seen.count);
+    TEST_ASSERT_EQUAL(5, seen.last.len);
+    TEST_ASSERT_EQUAL_MEMORY("three", seen.last.data, 5);
+}
+
+void test_KineticCallbacks_GetKeyRangeStream_should_stop_once_the_callback_returns_false(void)
+{
+    KeysSeen seen = {.stopAfter = 2};
+
+    KineticStatus status = get_key_range_stream(&seen);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL(2, seen.count);
+    TEST_ASSERT_EQUAL_MEMORY("two", seen.last.data, 3);
+}
+
 // void test_KineticBuilder_GetLogCallback_should_copy_returned_device_info_into_dynamically_allocated_info_structure(void)
 // {
 //     // KineticRequest response;
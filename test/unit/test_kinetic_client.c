@@ -32,6 +32,9 @@
 #include "mock_kinetic_allocator.h"
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_controller.h"
+#include "mock_kinetic_object.h"
+#include "mock_kinetic_cache.h"
+#include "mock_kinetic_completion_queue.h"
 #include "mock_kinetic_message.h"
 #include "mock_kinetic_bus.h"
 #include "protobuf-c/protobuf-c.h"
@@ -25,6 +25,9 @@
 #include "mock_kinetic_allocator.h"
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_controller.h"
+#include "mock_kinetic_object.h"
+#include "mock_kinetic_cache.h"
+#include "mock_kinetic_completion_queue.h"
 #include "mock_kinetic_builder.h"
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_bus.h"
@@ -63,3 +66,19 @@ void test_KineticClient_Delete_should_execute_DELETE_operation(void)
 
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
 }
+
+void test_KineticClient_DeleteBatch_should_execute_a_batch_of_DELETE_operations(void)
+{
+    uint8_t key[] = "some_key";
+    KineticEntry entries[] = {
+        {.key = ByteBuffer_Create(key, sizeof(key), sizeof(key))},
+    };
+    KineticStatus statuses[1];
+
+    KineticController_ExecuteBatch_ExpectAndReturn(&Session, entries, 1,
+        KineticBuilder_BuildDelete, statuses, NULL, KINETIC_STATUS_NOT_FOUND);
+
+    KineticStatus status = KineticClient_DeleteBatch(&Session, entries, 1, statuses, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, status);
+}
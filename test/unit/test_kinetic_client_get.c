@@ -26,6 +26,9 @@
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_controller.h"
+#include "mock_kinetic_object.h"
+#include "mock_kinetic_cache.h"
+#include "mock_kinetic_completion_queue.h"
 #include "mock_kinetic_bus.h"
 #include "mock_kinetic_memory.h"
 #include "mock_kinetic_allocator.h"
@@ -126,3 +129,82 @@ void test_KineticClient_Get_should_execute_GET_operation_and_retrieve_only_metad
 
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
 }
+
+void test_KineticClient_Get_should_serve_a_cache_hit_without_a_request(void)
+{
+    uint8_t key[] = "some_key";
+    uint8_t value[64];
+    KineticEntry entry = {
+        .key = ByteBuffer_Create(key, sizeof(key), sizeof(key)),
+        .value = ByteBuffer_Create(value, sizeof(value), 0),
+    };
+    Session.readCache = (KineticCache *)0x1234;
+
+    KineticCache_Lookup_IgnoreAndReturn(KINETIC_CACHE_HIT);
+
+    KineticStatus status = KineticClient_Get(&Session, &entry, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    Session.readCache = NULL;
+}
+
+void test_KineticClient_Get_should_cache_what_it_read_on_a_miss(void)
+{
+    uint8_t key[] = "some_key";
+    uint8_t value[64];
+    KineticEntry entry = {
+        .key = ByteBuffer_Create(key, sizeof(key), sizeof(key)),
+        .value = ByteBuffer_Create(value, sizeof(value), 0),
+    };
+    KineticOperation operation;
+    Session.readCache = (KineticCache *)0x1234;
+
+    KineticCache_Lookup_IgnoreAndReturn(KINETIC_CACHE_MISS);
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &operation);
+    KineticBuilder_BuildGet_ExpectAndReturn(&operation, &entry, KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&operation, NULL, KINETIC_STATUS_SUCCESS);
+    KineticCache_Insert_Ignore();
+
+    KineticStatus status = KineticClient_Get(&Session, &entry, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    Session.readCache = NULL;
+}
+
+void test_KineticClient_GetBatch_should_check_every_entry_before_sending_any(void)
+{
+    uint8_t key[] = "some_key";
+    uint8_t value[64];
+    KineticEntry entries[] = {
+        {.key = ByteBuffer_Create(key, sizeof(key), sizeof(key)),
+         .value = ByteBuffer_Create(value, sizeof(value), 0)},
+        {.key = ByteBuffer_Create(key, sizeof(key), sizeof(key))},
+    };
+
+    KineticStatus status = KineticClient_GetBatch(&Session, entries, 2, NULL, NULL);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_MISSING_VALUE_BUFFER, status);
+
+    entries[1] = (KineticEntry) {.value = ByteBuffer_Create(value, sizeof(value), 0)};
+    status = KineticClient_GetBatch(&Session, entries, 2, NULL, NULL);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_MISSING_KEY, status);
+}
+
+void test_KineticClient_GetBatch_should_execute_a_batch_of_GET_operations(void)
+{
+    uint8_t key[] = "some_key";
+    uint8_t value[64];
+    KineticEntry entries[] = {
+        {.key = ByteBuffer_Create(key, sizeof(key), sizeof(key)),
+         .value = ByteBuffer_Create(value, sizeof(value), 0)},
+        {.key = ByteBuffer_Create(key, sizeof(key), sizeof(key)),
+         .metadataOnly = true},
+    };
+    KineticCompletionClosure closure = {.callback = NULL};
+
+    KineticController_ExecuteBatch_ExpectAndReturn(&Session, entries, 2,
+        KineticBuilder_BuildGet, NULL, &closure, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticClient_GetBatch(&Session, entries, 2, NULL, &closure);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+}
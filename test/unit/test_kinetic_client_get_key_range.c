@@ -25,6 +25,9 @@
 #include "kinetic_device_info.h"
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_controller.h"
+#include "mock_kinetic_object.h"
+#include "mock_kinetic_cache.h"
+#include "mock_kinetic_completion_queue.h"
 #include "mock_kinetic_builder.h"
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_bus.h"
@@ -96,3 +99,34 @@ void test_KineticClient_GetKeyRange_should_return_a_list_of_keys_within_the_spec
 
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN, status);
 }
+
+static bool ignore_key(ByteArray const key, void* client_data)
+{
+    (void)key;
+    (void)client_data;
+    return true;
+}
+
+void test_KineticClient_GetKeyRangeStream_should_hand_keys_to_the_callback_instead_of_buffers(void)
+{
+    ByteBuffer_AppendCString(&StartKey, "key_range_00_00");
+    ByteBuffer_AppendCString(&EndKey, "key_range_00_03");
+
+    KineticKeyRange keyRange = {
+        .startKey = StartKey,
+        .endKey = EndKey,
+        .maxReturned = MAX_KEYS_RETRIEVED,
+    };
+    int clientData;
+    KineticOperation operation;
+
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &operation);
+    KineticBuilder_BuildGetKeyRangeStream_ExpectAndReturn(&operation, &keyRange,
+        ignore_key, &clientData, KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&operation, NULL, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticClient_GetKeyRangeStream(&Session, &keyRange,
+        ignore_key, &clientData, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+}
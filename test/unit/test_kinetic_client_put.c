@@ -23,6 +23,9 @@
 #include "kinetic_types_internal.h"
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_controller.h"
+#include "mock_kinetic_object.h"
+#include "mock_kinetic_cache.h"
+#include "mock_kinetic_completion_queue.h"
 #include "mock_kinetic_builder.h"
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_bus.h"
@@ -96,3 +99,20 @@ void test_KineticClient_Put_should_return_BUFFER_OVERRUN_if_object_value_too_lon
 
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN, status);
 }
+
+void test_KineticClient_PutBatch_should_execute_a_batch_of_PUT_operations(void)
+{
+    uint8_t value[] = "Four score, and seven years ago";
+    KineticEntry entries[] = {
+        {.value = ByteBuffer_Create(value, sizeof(value), sizeof(value))},
+        {.value = ByteBuffer_Create(value, sizeof(value), sizeof(value))},
+    };
+    KineticStatus statuses[2];
+
+    KineticController_ExecuteBatch_ExpectAndReturn(&Session, entries, 2,
+        KineticBuilder_BuildPut, statuses, NULL, KINETIC_STATUS_VERSION_MISMATCH);
+
+    KineticStatus status = KineticClient_PutBatch(&Session, entries, 2, statuses, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_VERSION_MISMATCH, status);
+}
@@ -0,0 +1,247 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_cluster.h"
+#include "kinetic_types.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_logger.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include "byte_array.h"
+#include "mock_kinetic_client.h"
+#include "mock_kinetic_completion_queue.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_KEYS (10000)
+#define NUM_DRIVES (4)
+
+static KineticCluster * Cluster;
+static KineticSession Sessions[NUM_DRIVES + 1];
+static uint8_t KeyData[NUM_KEYS][16];
+static ByteArray Keys[NUM_KEYS];
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 1);
+    memset(Sessions, 0, sizeof(Sessions));
+    for (int i = 0; i <= NUM_DRIVES; i++) {
+        snprintf(Sessions[i].config.host, sizeof(Sessions[i].config.host), "10.0.0.%d", i + 1);
+        Sessions[i].config.port = KINETIC_PORT;
+    }
+    for (int i = 0; i < NUM_KEYS; i++) {
+        int len = snprintf((char *)KeyData[i], sizeof(KeyData[i]), "key-%d", i);
+        Keys[i] = ByteArray_Create(KeyData[i], (size_t)len);
+    }
+    Cluster = KineticCluster_Create(0);
+    TEST_ASSERT_NOT_NULL(Cluster);
+}
+
+void tearDown(void)
+{
+    KineticCluster_Destroy(Cluster);
+    KineticLogger_Close();
+}
+
+static void count_keys(size_t counts[NUM_DRIVES + 1])
+{
+    memset(counts, 0, (NUM_DRIVES + 1) * sizeof(counts[0]));
+    for (int i = 0; i < NUM_KEYS; i++) {
+        KineticSession * session = KineticCluster_Locate(Cluster, Keys[i]);
+        TEST_ASSERT_NOT_NULL(session);
+        counts[session - Sessions]++;
+    }
+}
+
+void test_KineticCluster_Locate_should_return_NULL_for_an_empty_cluster(void)
+{
+    TEST_ASSERT_NULL(KineticCluster_Locate(Cluster, Keys[0]));
+}
+
+void test_KineticCluster_Put_should_report_an_invalid_session_for_an_empty_cluster(void)
+{
+    KineticEntry entry = {.key = ByteBuffer_Create(Keys[0].data, Keys[0].len, Keys[0].len)};
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_INVALID,
+        KineticCluster_Put(Cluster, &entry, NULL));
+}
+
+void test_KineticCluster_AddSession_should_reject_a_zero_weight_or_a_duplicate_drive(void)
+{
+    KineticSession duplicate = Sessions[0];
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticCluster_AddSession(Cluster, &Sessions[0], 0));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticCluster_AddSession(Cluster, &Sessions[0], 1));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticCluster_AddSession(Cluster, &duplicate, 1));
+}
+
+void test_KineticCluster_RemoveSession_should_reject_an_unknown_session(void)
+{
+    KineticCluster_AddSession(Cluster, &Sessions[0], 1);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticCluster_RemoveSession(Cluster, &Sessions[1]));
+}
+
+void test_KineticCluster_Locate_should_not_depend_on_the_order_drives_were_added(void)
+{
+    KineticCluster * reversed = KineticCluster_Create(0);
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        KineticCluster_AddSession(Cluster, &Sessions[i], 1);
+        KineticCluster_AddSession(reversed, &Sessions[NUM_DRIVES - 1 - i], 1);
+    }
+
+    for (int i = 0; i < NUM_KEYS; i++) {
+        TEST_ASSERT_EQUAL_PTR(KineticCluster_Locate(Cluster, Keys[i]),
+            KineticCluster_Locate(reversed, Keys[i]));
+    }
+    KineticCluster_Destroy(reversed);
+}
+
+void test_KineticCluster_Locate_should_spread_keys_evenly_across_equal_drives(void)
+{
+    size_t counts[NUM_DRIVES + 1];
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        KineticCluster_AddSession(Cluster, &Sessions[i], 1);
+    }
+
+    count_keys(counts);
+
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        TEST_ASSERT_INT_WITHIN(NUM_KEYS / NUM_DRIVES / 4, NUM_KEYS / NUM_DRIVES, counts[i]);
+    }
+}
+
+void test_KineticCluster_Locate_should_spread_keys_in_proportion_to_weight(void)
+{
+    size_t counts[NUM_DRIVES + 1];
+    KineticCluster_AddSession(Cluster, &Sessions[0], 3);
+    KineticCluster_AddSession(Cluster, &Sessions[1], 1);
+
+    count_keys(counts);
+
+    TEST_ASSERT_INT_WITHIN(NUM_KEYS / 20, NUM_KEYS * 3 / 4, counts[0]);
+    TEST_ASSERT_EQUAL(NUM_KEYS, counts[0] + counts[1]);
+}
+
+void test_KineticCluster_AddSession_should_only_move_keys_to_the_new_drive(void)
+{
+    static KineticSession * before[NUM_KEYS];
+    size_t counts[NUM_DRIVES + 1];
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        KineticCluster_AddSession(Cluster, &Sessions[i], 1);
+    }
+    for (int i = 0; i < NUM_KEYS; i++) {
+        before[i] = KineticCluster_Locate(Cluster, Keys[i]);
+    }
+
+    KineticCluster_AddSession(Cluster, &Sessions[NUM_DRIVES], 1);
+
+    for (int i = 0; i < NUM_KEYS; i++) {
+        KineticSession * after = KineticCluster_Locate(Cluster, Keys[i]);
+        if (after != before[i]) {
+            TEST_ASSERT_EQUAL_PTR(&Sessions[NUM_DRIVES], after);
+        }
+    }
+    count_keys(counts);
+    TEST_ASSERT_INT_WITHIN(NUM_KEYS / (NUM_DRIVES + 1) / 4,
+        NUM_KEYS / (NUM_DRIVES + 1), counts[NUM_DRIVES]);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticCluster_RemoveSession(Cluster, &Sessions[NUM_DRIVES]));
+
+    for (int i = 0; i < NUM_KEYS; i++) {
+        TEST_ASSERT_EQUAL_PTR(before[i], KineticCluster_Locate(Cluster, Keys[i]));
+    }
+}
+
+void test_KineticCluster_Put_should_execute_on_the_drive_owning_the_key(void)
+{
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        KineticCluster_AddSession(Cluster, &Sessions[i], 1);
+    }
+    KineticEntry entry = {.key = ByteBuffer_Create(Keys[7].data, Keys[7].len, Keys[7].len)};
+    KineticSession * owner = KineticCluster_Locate(Cluster, Keys[7]);
+
+    KineticClient_Put_ExpectAndReturn(owner, &entry, NULL, KINETIC_STATUS_SUCCESS);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticCluster_Put(Cluster, &entry, NULL));
+}
+
+void test_KineticCluster_PutBatch_should_report_each_entry_when_its_drive_rejects_it(void)
+{
+    KineticEntry entries[8];
+    KineticStatus statuses[8];
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        KineticCluster_AddSession(Cluster, &Sessions[i], 1);
+    }
+    for (int i = 0; i < 8; i++) {
+        entries[i] = (KineticEntry) {.key = ByteBuffer_Create(Keys[i].data, Keys[i].len, Keys[i].len)};
+        statuses[i] = KINETIC_STATUS_INVALID;
+    }
+
+    KineticClient_PutBatch_IgnoreAndReturn(KINETIC_STATUS_SESSION_TERMINATED);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED,
+        KineticCluster_PutBatch(Cluster, entries, 8, statuses, NULL));
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED, statuses[i]);
+        TEST_ASSERT_EQUAL_PTR(KeyData[i], entries[i].key.array.data);
+    }
+}
+
+static int BatchCallbacks;
+
+static void CountBatchCallback(KineticCompletionData* kinetic_data, void* client_data)
+{
+    (void)kinetic_data;
+    (void)client_data;
+    BatchCallbacks++;
+}
+
+void test_KineticCluster_PutBatch_should_return_the_failure_without_calling_back_if_no_drive_was_sent_its_share(void)
+{
+    KineticEntry entries[8];
+    KineticStatus statuses[8];
+    KineticCompletionClosure closure = {.callback = CountBatchCallback};
+    BatchCallbacks = 0;
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        KineticCluster_AddSession(Cluster, &Sessions[i], 1);
+    }
+    for (int i = 0; i < 8; i++) {
+        entries[i] = (KineticEntry) {.key = ByteBuffer_Create(Keys[i].data, Keys[i].len, Keys[i].len)};
+        statuses[i] = KINETIC_STATUS_INVALID;
+    }
+
+    KineticClient_PutBatch_IgnoreAndReturn(KINETIC_STATUS_SESSION_TERMINATED);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED,
+        KineticCluster_PutBatch(Cluster, entries, 8, statuses, &closure));
+    TEST_ASSERT_EQUAL(0, BatchCallbacks);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED, statuses[i]);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_completion_queue.h"
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_logger.h"
+#include <pthread.h>
+#include <stdint.h>
+
+static KineticCompletionQueue * Queue;
+static int Tags[16];
+
+void setUp(void)
+{
+    Queue = NULL;
+}
+
+void tearDown(void)
+{
+    KineticCompletionQueue_Destroy(Queue);
+}
+
+void test_KineticCompletionQueue_Poll_should_return_nothing_at_once_if_empty_and_no_timeout(void)
+{
+    KineticCompletionEvent events[4];
+    Queue = KineticCompletionQueue_Create(4);
+    TEST_ASSERT_NOT_NULL(Queue);
+
+    TEST_ASSERT_EQUAL(0, KineticCompletionQueue_Poll(Queue, events, 4, 0));
+}
+
+void test_KineticCompletionQueue_Poll_should_give_up_after_the_timeout(void)
+{
+    KineticCompletionEvent events[4];
+    Queue = KineticCompletionQueue_Create(4);
+
+    TEST_ASSERT_EQUAL(0, KineticCompletionQueue_Poll(Queue, events, 4, 10));
+}
+
+void test_KineticCompletionQueue_should_return_events_oldest_first_up_to_max(void)
+{
+    KineticCompletionEvent events[4];
+    Queue = KineticCompletionQueue_Create(4);
+
+    KineticCompletionQueue_Push(Queue, &Tags[0], KINETIC_STATUS_SUCCESS);
+    KineticCompletionQueue_Push(Queue, &Tags[1], KINETIC_STATUS_NOT_FOUND);
+    KineticCompletionQueue_Push(Queue, &Tags[2], KINETIC_STATUS_SUCCESS);
+
+    TEST_ASSERT_EQUAL(2, KineticCompletionQueue_Poll(Queue, events, 2, 0));
+    TEST_ASSERT_EQUAL_PTR(&Tags[0], events[0].tag);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, events[0].status);
+    TEST_ASSERT_EQUAL_PTR(&Tags[1], events[1].tag);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, events[1].status);
+
+    TEST_ASSERT_EQUAL(1, KineticCompletionQueue_Poll(Queue, events, 4, -1));
+    TEST_ASSERT_EQUAL_PTR(&Tags[2], events[0].tag);
+}
+
+void test_KineticCompletionQueue_should_reuse_its_cells_as_they_are_polled(void)
+{
+    KineticCompletionEvent events[4];
+    Queue = KineticCompletionQueue_Create(3);
+
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 4; i++) {
+            KineticCompletionQueue_Push(Queue, &Tags[i], KINETIC_STATUS_SUCCESS);
+        }
+        TEST_ASSERT_EQUAL(4, KineticCompletionQueue_Poll(Queue, events, 4, 0));
+        for (int i = 0; i < 4; i++) {
+            TEST_ASSERT_EQUAL_PTR(&Tags[i], events[i].tag);
+        }
+    }
+}
+
+#define PUSHES_PER_THREAD (10000)
+
+static void * push_all(void * arg)
+{
+    for (intptr_t i = 0; i < PUSHES_PER_THREAD; i++) {
+        KineticCompletionQueue_Push(Queue, (void *)((intptr_t)arg + i), KINETIC_STATUS_SUCCESS);
+    }
+    return NULL;
+}
+
+void test_KineticCompletionQueue_should_deliver_every_event_pushed_by_concurrent_threads_to_a_waiting_poller(void)
+{
+    enum { THREADS = 4 };
+    pthread_t threads[THREADS];
+    intptr_t next[THREADS] = {0};
+    KineticCompletionEvent events[16];
+
+    // Smaller than the events in flight, so pushers also wait for room
+    Queue = KineticCompletionQueue_Create(8);
+    for (intptr_t t = 0; t < THREADS; t++) {
+        pthread_create(&threads[t], NULL, push_all, (void *)(t * PUSHES_PER_THREAD));
+    }
+
+    size_t received = 0;
+    while (received < THREADS * PUSHES_PER_THREAD) {
+        size_t count = KineticCompletionQueue_Poll(Queue, events, 16, 5000);
+        TEST_ASSERT_TRUE(count > 0);
+        for (size_t i = 0; i < count; i++) {
+            // Each thread's events arrive in the order it pushed them
+            intptr_t tag = (intptr_t)events[i].tag;
+            intptr_t t = tag / PUSHES_PER_THREAD;
+            TEST_ASSERT_EQUAL(next[t], tag % PUSHES_PER_THREAD);
+            next[t]++;
+        }
+        received += count;
+    }
+
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    TEST_ASSERT_EQUAL(0, KineticCompletionQueue_Poll(Queue, events, 16, 0));
+}
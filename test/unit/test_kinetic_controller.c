@@ -31,6 +31,8 @@
 #include "mock_kinetic_operation.h"
 #include "mock_kinetic_allocator.h"
 #include "mock_kinetic_resourcewaiter.h"
+#include "mock_kinetic_completion_queue.h"
+#include "kinetic_futex.h"
 #include <pthread.h>
 
 void setUp(void)
@@ -117,3 +119,315 @@ void test_KineticController_ExecuteOperation_should_carry_out_an_operation_with_
 
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_OPERATION_INVALID, status);
 }
+
+void test_KineticController_ExecuteOperation_should_complete_blocking_operations_inline_and_report_failure_to_send(void)
+{
+    KineticSession session = {.connected = true};
+    KineticRequest request = {.message.header = {
+        .messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT}};
+    KineticOperation operation = {
+        .session = &session,
+        .request = &request,
+    };
+
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+    KineticOperation_SendRequest_ExpectAndReturn(&operation, KINETIC_STATUS_OPERATION_INVALID);
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticController_ExecuteOperation(&operation, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_OPERATION_INVALID, status);
+    TEST_ASSERT_TRUE(operation.completeInline);
+    TEST_ASSERT_NOT_NULL(operation.closure.callback);
+}
+
+/* Execute OPERATION as a blocking call, failing to send it, and report
+ * whether it was set to complete inline. */
+static bool BlockingCompletesInline(KineticOperation * const operation)
+{
+    KineticSession_GetTerminationStatus_ExpectAndReturn(operation->session, KINETIC_STATUS_SUCCESS);
+    KineticOperation_SendRequest_ExpectAndReturn(operation, KINETIC_STATUS_OPERATION_INVALID);
+    KineticSession_GetTerminationStatus_ExpectAndReturn(operation->session, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticController_ExecuteOperation(operation, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_OPERATION_INVALID, status);
+    return operation->completeInline;
+}
+
+static bool KeyCallback(ByteArray const key, void * clientData)
+{
+    (void)key;
+    (void)clientData;
+    return true;
+}
+
+void test_KineticController_ExecuteOperation_should_not_complete_blocking_operations_inline_that_run_caller_code(void)
+{
+    KineticSession session = {.connected = true};
+    KineticRequest request = {.message.header = {
+        .messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GETKEYRANGE}};
+    KineticOperation operation = {
+        .session = &session,
+        .request = &request,
+        .keyCallback = KeyCallback,
+    };
+
+    TEST_ASSERT_FALSE(BlockingCompletesInline(&operation));
+}
+
+void test_KineticController_ExecuteOperation_should_not_complete_large_or_tag_checked_GETs_inline(void)
+{
+    KineticSession session = {.connected = true};
+    KineticRequest request = {.message.header = {
+        .messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET}};
+    static uint8_t value[64 * 1024];
+    KineticEntry entry = {.value = ByteBuffer_Create(value, 1024, 0)};
+    KineticOperation operation = {
+        .session = &session,
+        .request = &request,
+        .entry = &entry,
+    };
+
+    TEST_ASSERT_TRUE(BlockingCompletesInline(&operation));
+
+    entry.computeTag = true;
+    TEST_ASSERT_FALSE(BlockingCompletesInline(&operation));
+
+    entry = (KineticEntry) {.value = ByteBuffer_Create(value, sizeof(value), 0)};
+    TEST_ASSERT_FALSE(BlockingCompletesInline(&operation));
+}
+
+void test_KineticController_ExecuteOperation_should_send_large_transfers_round_robin_on_extra_connections(void)
+{
+    KineticSession lane1 = {.connected = true, .connectionID = 11,
+        .terminationStatus = KINETIC_STATUS_SUCCESS};
+    KineticSession lane2 = {.connected = true, .connectionID = 12,
+        .terminationStatus = KINETIC_STATUS_SUCCESS};
+    KineticSession * lanes[] = {&lane1, &lane2};
+    KineticSession session = {.connected = true, .connectionID = 10,
+        .config = {.stripeThreshold = 1000}, .lanes = lanes, .laneCount = 2};
+    uint8_t value[1000];
+    KineticEntry entry = {.value = ByteBuffer_Create(value, sizeof(value), sizeof(value))};
+    KineticCompletionClosure closure;
+
+    for (int i = 0; i < 2; i++) {
+        KineticRequest request = {.message.header = {
+            .messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT,
+            .connectionid = 10}};
+        KineticOperation operation = {
+            .session = &session,
+            .request = &request,
+            .entry = &entry,
+        };
+
+        KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+        KineticOperation_SendRequest_ExpectAndReturn(&operation, KINETIC_STATUS_SUCCESS);
+
+        KineticStatus status = KineticController_ExecuteOperation(&operation, &closure);
+
+        TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+        TEST_ASSERT_EQUAL_PTR(lanes[i], operation.session);
+        TEST_ASSERT_EQUAL_INT64(lanes[i]->connectionID, request.message.header.connectionid);
+    }
+}
+
+void test_KineticController_ExecuteOperation_should_keep_small_requests_and_lost_connections_on_the_session(void)
+{
+    KineticSession lane = {.connected = false, .connectionID = 11,
+        .terminationStatus = KINETIC_STATUS_SUCCESS};
+    KineticSession * lanes[] = {&lane};
+    KineticSession session = {.connected = true, .connectionID = 10,
+        .config = {.stripeThreshold = 1000}, .lanes = lanes, .laneCount = 1};
+    uint8_t value[1000];
+    KineticEntry small = {.value = ByteBuffer_Create(value, sizeof(value), sizeof(value) - 1)};
+    KineticEntry large = {.value = ByteBuffer_Create(value, sizeof(value), sizeof(value))};
+    KineticEntry * entries[] = {&small, &large};
+    KineticCompletionClosure closure;
+
+    for (int i = 0; i < 2; i++) {
+        KineticRequest request = {.message.header = {
+            .messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT,
+            .connectionid = 10}};
+        KineticOperation operation = {
+            .session = &session,
+            .request = &request,
+            .entry = entries[i],
+        };
+
+        KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+        KineticOperation_SendRequest_ExpectAndReturn(&operation, KINETIC_STATUS_SUCCESS);
+
+        KineticStatus status = KineticController_ExecuteOperation(&operation, &closure);
+
+        TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+        TEST_ASSERT_EQUAL_PTR(&session, operation.session);
+        TEST_ASSERT_EQUAL_INT64(10, request.message.header.connectionid);
+    }
+}
+
+void test_KineticController_ExecuteOperation_should_leave_a_failed_extra_connection_to_its_session(void)
+{
+    KineticSession lane = {.connected = true, .connectionID = 11,
+        .terminationStatus = KINETIC_STATUS_SUCCESS};
+    KineticSession * lanes[] = {&lane};
+    KineticSession session = {.connected = true, .connectionID = 10,
+        .config = {.stripeThreshold = 1000}, .lanes = lanes, .laneCount = 1};
+    uint8_t value[1000];
+    KineticEntry entry = {.value = ByteBuffer_Create(value, sizeof(value), sizeof(value))};
+    KineticRequest request = {.message.header = {
+        .messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT,
+        .connectionid = 10}};
+    KineticOperation operation = {
+        .session = &session,
+        .request = &request,
+        .entry = &entry,
+    };
+
+    // The lane is still listed in the session, so it must not be disconnected
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+    KineticOperation_SendRequest_ExpectAndReturn(&operation, KINETIC_STATUS_SOCKET_ERROR);
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticController_ExecuteOperation(&operation, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SOCKET_ERROR, status);
+    TEST_ASSERT_EQUAL_PTR(&lane, operation.session);
+}
+
+static KineticStatus BuildStatuses[2];
+static KineticEntry* BuiltEntries[2];
+static size_t BuildCount;
+
+static KineticStatus FakeBuild(KineticOperation* const op, KineticEntry* const entry)
+{
+    (void)op;
+    BuiltEntries[BuildCount] = entry;
+    return BuildStatuses[BuildCount++];
+}
+
+typedef struct {
+    int calls;
+    KineticStatus status;
+} BatchClosureData;
+
+static void BatchClosureCallback(KineticCompletionData* kinetic_data, void* client_data)
+{
+    BatchClosureData * data = client_data;
+    data->calls++;
+    data->status = kinetic_data->status;
+}
+
+void test_KineticController_ExecuteBatch_should_report_session_terminated_if_detected(void)
+{
+    KineticSession session = {.connected = true};
+    KineticEntry entries[2];
+
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_HMAC_FAILURE);
+    KineticStatus status = KineticController_ExecuteBatch(&session, entries, 2,
+        FakeBuild, NULL, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED, status);
+}
+
+void test_KineticController_ExecuteBatch_should_send_every_entry_and_complete_once_when_all_have_completed(void)
+{
+    KineticSession session = {.connected = true};
+    KineticEntry entries[2];
+    KineticOperation op0 = {.session = &session}, op1 = {.session = &session};
+    KineticOperation* sent[] = {&op0, &op1};
+    KineticStatus unsent[] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+    KineticStatus sendStatuses[] = {KINETIC_STATUS_SUCCESS, KINETIC_STATUS_SUCCESS};
+    KineticStatus statuses[2] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+    BatchClosureData data = {.calls = 0};
+    KineticCompletionClosure closure = {.callback = BatchClosureCallback, .clientData = &data};
+    BuildStatuses[0] = BuildStatuses[1] = KINETIC_STATUS_SUCCESS;
+    BuildCount = 0;
+
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+    KineticAllocator_NewOperation_ExpectAndReturn(&session, &op0);
+    KineticAllocator_NewOperation_ExpectAndReturn(&session, &op1);
+    KineticOperation_SendRequests_Expect(sent, unsent, 2);
+    KineticOperation_SendRequests_ReturnArrayThruPtr_statuses(sendStatuses, 2);
+
+    KineticStatus status = KineticController_ExecuteBatch(&session, entries, 2,
+        FakeBuild, statuses, &closure);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_PTR(&entries[0], BuiltEntries[0]);
+    TEST_ASSERT_EQUAL_PTR(&entries[1], BuiltEntries[1]);
+
+    // Responses may arrive in any order; only the last completes the batch
+    KineticCompletionData completion = {.status = KINETIC_STATUS_NOT_FOUND};
+    op1.closure.callback(&completion, op1.closure.clientData);
+    TEST_ASSERT_EQUAL(0, data.calls);
+
+    completion.status = KINETIC_STATUS_SUCCESS;
+    op0.closure.callback(&completion, op0.closure.clientData);
+    TEST_ASSERT_EQUAL(1, data.calls);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, data.status);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, statuses[0]);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, statuses[1]);
+}
+
+void test_KineticController_ExecuteBatch_should_complete_entries_that_fail_to_build_or_send_and_report_the_first_failure(void)
+{
+    KineticSession session = {.connected = true};
+    KineticEntry entries[2];
+    KineticOperation op0 = {.session = &session}, op1 = {.session = &session};
+    KineticOperation* sent[] = {&op0};
+    KineticStatus unsent[] = {KINETIC_STATUS_INVALID};
+    KineticStatus sendStatuses[] = {KINETIC_STATUS_CONNECTION_ERROR};
+    KineticStatus statuses[2] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+    BuildStatuses[0] = KINETIC_STATUS_SUCCESS;
+    BuildStatuses[1] = KINETIC_STATUS_BUFFER_OVERRUN;
+    BuildCount = 0;
+
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+    KineticAllocator_NewOperation_ExpectAndReturn(&session, &op0);
+    KineticAllocator_NewOperation_ExpectAndReturn(&session, &op1);
+    KineticAllocator_FreeOperation_Expect(&op1);
+    KineticOperation_SendRequests_Expect(sent, unsent, 1);
+    KineticOperation_SendRequests_ReturnArrayThruPtr_statuses(sendStatuses, 1);
+    KineticAllocator_FreeOperation_Expect(&op0);
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticController_ExecuteBatch(&session, entries, 2,
+        FakeBuild, statuses, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_CONNECTION_ERROR, status);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_CONNECTION_ERROR, statuses[0]);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN, statuses[1]);
+}
+
+void test_KineticController_ExecuteBatch_should_return_the_first_failure_without_calling_back_if_nothing_was_sent(void)
+{
+    KineticSession session = {.connected = true};
+    KineticEntry entries[2];
+    KineticOperation op0 = {.session = &session}, op1 = {.session = &session};
+    KineticOperation* sent[] = {&op0};
+    KineticStatus unsent[] = {KINETIC_STATUS_INVALID};
+    KineticStatus sendStatuses[] = {KINETIC_STATUS_CONNECTION_ERROR};
+    KineticStatus statuses[2] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+    BatchClosureData data = {.calls = 0};
+    KineticCompletionClosure closure = {.callback = BatchClosureCallback, .clientData = &data};
+    BuildStatuses[0] = KINETIC_STATUS_SUCCESS;
+    BuildStatuses[1] = KINETIC_STATUS_BUFFER_OVERRUN;
+    BuildCount = 0;
+
+    KineticSession_GetTerminationStatus_ExpectAndReturn(&session, KINETIC_STATUS_SUCCESS);
+    KineticAllocator_NewOperation_ExpectAndReturn(&session, &op0);
+    KineticAllocator_NewOperation_ExpectAndReturn(&session, &op1);
+    KineticAllocator_FreeOperation_Expect(&op1);
+    KineticOperation_SendRequests_Expect(sent, unsent, 1);
+    KineticOperation_SendRequests_ReturnArrayThruPtr_statuses(sendStatuses, 1);
+    KineticAllocator_FreeOperation_Expect(&op0);
+
+    KineticStatus status = KineticController_ExecuteBatch(&session, entries, 2,
+        FakeBuild, statuses, &closure);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_CONNECTION_ERROR, status);
+    TEST_ASSERT_EQUAL(0, data.calls);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_CONNECTION_ERROR, statuses[0]);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN, statuses[1]);
+}
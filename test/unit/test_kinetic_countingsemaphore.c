@@ -58,3 +58,44 @@ void test_kinetic_countingsemaphore_should_be_thread_safe(void)
 
     KineticCountingSemaphore_Destroy(sem);
 }
+
+void test_kinetic_countingsemaphore_should_honor_limit_below_max(void)
+{
+    KineticCountingSemaphore* sem = KineticCountingSemaphore_Create(4);
+
+    KineticCountingSemaphore_Take(sem);
+    KineticCountingSemaphore_Take(sem);
+    KineticCountingSemaphore_SetLimit(sem, 1);
+    TEST_ASSERT_EQUAL(1, sem->limit);
+
+    // Taken counts are not revoked, just returned
+    KineticCountingSemaphore_Give(sem);
+    KineticCountingSemaphore_Give(sem);
+    TEST_ASSERT_EQUAL(4, sem->count);
+
+    KineticCountingSemaphore_SetLimit(sem, 0);
+    TEST_ASSERT_EQUAL(1, sem->limit);
+    KineticCountingSemaphore_SetLimit(sem, 10);
+    TEST_ASSERT_EQUAL(4, sem->limit);
+
+    KineticCountingSemaphore_Destroy(sem);
+}
+
+void test_kinetic_countingsemaphore_TakeUpTo_should_take_only_the_free_counts_under_the_limit(void)
+{
+    KineticCountingSemaphore* sem = KineticCountingSemaphore_Create(8);
+
+    TEST_ASSERT_EQUAL(3, KineticCountingSemaphore_TakeUpTo(sem, 3));
+    TEST_ASSERT_EQUAL(5, sem->count);
+
+    KineticCountingSemaphore_SetLimit(sem, 6);
+    TEST_ASSERT_EQUAL(3, KineticCountingSemaphore_TakeUpTo(sem, 10));
+    TEST_ASSERT_EQUAL(2, sem->count);
+
+    for (int i = 0; i < 6; i++) {
+        KineticCountingSemaphore_Give(sem);
+    }
+    TEST_ASSERT_EQUAL(8, sem->count);
+
+    KineticCountingSemaphore_Destroy(sem);
+}
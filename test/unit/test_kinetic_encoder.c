@@ -0,0 +1,300 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity_helper.h"
+#include "kinetic_encoder.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include <string.h>
+
+static Com__Seagate__Kinetic__Proto__Command Command;
+static Com__Seagate__Kinetic__Proto__Command__Header Header;
+static Com__Seagate__Kinetic__Proto__Command__Body Body;
+static Com__Seagate__Kinetic__Proto__Command__KeyValue KeyValue;
+static Com__Seagate__Kinetic__Proto__Message Message;
+static Com__Seagate__Kinetic__Proto__Message__HMACauth HmacAuth;
+static Com__Seagate__Kinetic__Proto__Message__PINauth PinAuth;
+
+static uint8_t Key[] = "my_key_3.1415927";
+static uint8_t NewVersion[] = "v2.0";
+static uint8_t DbVersion[] = "v1.0";
+static uint8_t Tag[] = "SomeTagValue";
+static uint8_t Hmac[20] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+
+void setUp(void)
+{
+    com__seagate__kinetic__proto__command__init(&Command);
+    com__seagate__kinetic__proto__command__header__init(&Header);
+    com__seagate__kinetic__proto__command__body__init(&Body);
+    com__seagate__kinetic__proto__command__key_value__init(&KeyValue);
+    com__seagate__kinetic__proto__message__init(&Message);
+    com__seagate__kinetic__proto__message__hmacauth__init(&HmacAuth);
+    com__seagate__kinetic__proto__message__pinauth__init(&PinAuth);
+
+    Header.has_clusterversion = true;
+    Header.clusterversion = 1122334455667788;
+    Header.has_connectionid = true;
+    Header.connectionid = 1234;
+    Header.has_sequence = true;
+    Header.sequence = 300;
+    Command.header = &Header;
+}
+
+void tearDown(void) {}
+
+static void assert_packs_command(const KineticEncoderTemplate* tmpl,
+    const uint8_t* expected, size_t expectedLen)
+{
+    uint8_t actual[1024];
+    memset(actual, 0xa5, sizeof(actual));
+    TEST_ASSERT_EQUAL(expectedLen, KineticEncoder_CommandSize(&Command, tmpl));
+    TEST_ASSERT_EQUAL(expectedLen, KineticEncoder_PackCommand(&Command, tmpl, actual));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, actual, expectedLen);
+    TEST_ASSERT_EQUAL_HEX8(0xa5, actual[expectedLen]);
+}
+
+/* Check the encoder with no template, with a template that matches the
+ * header, and with one that doesn't. */
+static void assert_command_matches_protobuf_c(void)
+{
+    TEST_ASSERT_TRUE(KineticEncoder_CanPackCommand(&Command));
+
+    size_t expectedLen = com__seagate__kinetic__proto__command__get_packed_size(&Command);
+    uint8_t expected[1024];
+    TEST_ASSERT_TRUE(expectedLen <= sizeof(expected));
+    TEST_ASSERT_EQUAL(expectedLen, com__seagate__kinetic__proto__command__pack(&Command, expected));
+
+    assert_packs_command(NULL, expected, expectedLen);
+
+    KineticEncoderTemplate tmpl;
+    KineticEncoder_InitTemplate(&tmpl, Header.clusterversion, Header.connectionid, 1);
+    assert_packs_command(&tmpl, expected, expectedLen);
+    KineticEncoder_InitTemplate(&tmpl, Header.clusterversion + 1, Header.connectionid, 1);
+    assert_packs_command(&tmpl, expected, expectedLen);
+}
+
+static void assert_packs_message(const KineticEncoderTemplate* tmpl,
+    const uint8_t* expected, size_t expectedLen)
+{
+    uint8_t actual[1024];
+    memset(actual, 0xa5, sizeof(actual));
+    TEST_ASSERT_EQUAL(expectedLen, KineticEncoder_MessageSize(&Message, tmpl));
+    TEST_ASSERT_EQUAL(expectedLen, KineticEncoder_PackMessage(&Message, tmpl, actual));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, actual, expectedLen);
+    TEST_ASSERT_EQUAL_HEX8(0xa5, actual[expectedLen]);
+}
+
+static void assert_message_matches_protobuf_c(void)
+{
+    TEST_ASSERT_TRUE(KineticEncoder_CanPackMessage(&Message));
+
+    size_t expectedLen = com__seagate__kinetic__proto__message__get_packed_size(&Message);
+    uint8_t expected[1024];
+    TEST_ASSERT_TRUE(expectedLen <= sizeof(expected));
+    TEST_ASSERT_EQUAL(expectedLen, com__seagate__kinetic__proto__message__pack(&Message, expected));
+
+    assert_packs_message(NULL, expected, expectedLen);
+
+    KineticEncoderTemplate tmpl;
+    KineticEncoder_InitTemplate(&tmpl, 0, 0, HmacAuth.identity);
+    assert_packs_message(&tmpl, expected, expectedLen);
+    KineticEncoder_InitTemplate(&tmpl, 0, 0, HmacAuth.identity + 1);
+    assert_packs_message(&tmpl, expected, expectedLen);
+}
+
+static void set_key_value(void)
+{
+    Body.keyvalue = &KeyValue;
+    Command.body = &Body;
+    KeyValue.has_key = true;
+    KeyValue.key = (ProtobufCBinaryData){.data = Key, .len = sizeof(Key) - 1};
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_a_header_only_command(void)
+{
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__NOOP;
+
+    assert_command_matches_protobuf_c();
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_a_PUT(void)
+{
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT;
+    set_key_value();
+    KeyValue.has_newversion = true;
+    KeyValue.newversion = (ProtobufCBinaryData){.data = NewVersion, .len = sizeof(NewVersion) - 1};
+    KeyValue.has_dbversion = true;
+    KeyValue.dbversion = (ProtobufCBinaryData){.data = DbVersion, .len = sizeof(DbVersion) - 1};
+    KeyValue.has_tag = true;
+    KeyValue.tag = (ProtobufCBinaryData){.data = Tag, .len = sizeof(Tag) - 1};
+    KeyValue.has_algorithm = true;
+    KeyValue.algorithm = COM__SEAGATE__KINETIC__PROTO__COMMAND__ALGORITHM__SHA1;
+    KeyValue.has_force = true;
+    KeyValue.force = true;
+    KeyValue.has_synchronization = true;
+    KeyValue.synchronization = COM__SEAGATE__KINETIC__PROTO__COMMAND__SYNCHRONIZATION__WRITEBACK;
+
+    assert_command_matches_protobuf_c();
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_a_metadata_only_GET(void)
+{
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET;
+    set_key_value();
+    KeyValue.has_metadataonly = true;
+    KeyValue.metadataonly = true;
+
+    assert_command_matches_protobuf_c();
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_a_DELETE(void)
+{
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__DELETE;
+    set_key_value();
+    KeyValue.has_dbversion = true;
+    KeyValue.dbversion = (ProtobufCBinaryData){.data = DbVersion, .len = sizeof(DbVersion) - 1};
+    KeyValue.has_synchronization = true;
+    KeyValue.synchronization = COM__SEAGATE__KINETIC__PROTO__COMMAND__SYNCHRONIZATION__WRITETHROUGH;
+
+    assert_command_matches_protobuf_c();
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_negative_and_empty_fields(void)
+{
+    Header.sequence = -1;
+    Header.has_acksequence = true;
+    Header.acksequence = -1234567;
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__INVALID_MESSAGE_TYPE;
+    Header.has_timeout = true;
+    Header.timeout = 0;
+    Header.has_earlyexit = true;
+    Header.earlyexit = false;
+    Header.has_priority = true;
+    Header.priority = COM__SEAGATE__KINETIC__PROTO__COMMAND__PRIORITY__HIGHEST;
+    Header.has_timequanta = true;
+    Header.timequanta = INT64_MAX;
+    Command.body = &Body;
+    assert_command_matches_protobuf_c();
+
+    set_key_value();
+    KeyValue.key.len = 0;
+    KeyValue.has_newversion = true;
+    assert_command_matches_protobuf_c();
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_long_keys(void)
+{
+    uint8_t longKey[4000];
+    for (size_t i = 0; i < sizeof(longKey); i++) { longKey[i] = (uint8_t)i; }
+    set_key_value();
+    KeyValue.key = (ProtobufCBinaryData){.data = longKey, .len = sizeof(longKey)};
+
+    TEST_ASSERT_TRUE(KineticEncoder_CanPackCommand(&Command));
+    size_t expectedLen = com__seagate__kinetic__proto__command__get_packed_size(&Command);
+    uint8_t expected[sizeof(longKey) + 128];
+    uint8_t actual[sizeof(longKey) + 128];
+    TEST_ASSERT_EQUAL(expectedLen, com__seagate__kinetic__proto__command__pack(&Command, expected));
+    TEST_ASSERT_EQUAL(expectedLen, KineticEncoder_PackCommand(&Command, NULL, actual));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, actual, expectedLen);
+}
+
+void test_KineticEncoder_CanPackCommand_should_reject_other_bodies_and_status(void)
+{
+    Com__Seagate__Kinetic__Proto__Command__Range range;
+    com__seagate__kinetic__proto__command__range__init(&range);
+    Com__Seagate__Kinetic__Proto__Command__Status status;
+    com__seagate__kinetic__proto__command__status__init(&status);
+
+    TEST_ASSERT_FALSE(KineticEncoder_CanPackCommand(NULL));
+
+    Command.body = &Body;
+    Body.range = &range;
+    TEST_ASSERT_FALSE(KineticEncoder_CanPackCommand(&Command));
+
+    Body.range = NULL;
+    Command.status = &status;
+    TEST_ASSERT_FALSE(KineticEncoder_CanPackCommand(&Command));
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_an_HMAC_message(void)
+{
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET;
+    set_key_value();
+    uint8_t commandBytes[256];
+    size_t commandLen = KineticEncoder_PackCommand(&Command, NULL, commandBytes);
+
+    Message.has_authtype = true;
+    Message.authtype = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH;
+    Message.hmacauth = &HmacAuth;
+    HmacAuth.has_identity = true;
+    HmacAuth.identity = 1;
+    HmacAuth.has_hmac = true;
+    HmacAuth.hmac = (ProtobufCBinaryData){.data = Hmac, .len = sizeof(Hmac)};
+    Message.has_commandbytes = true;
+    Message.commandbytes = (ProtobufCBinaryData){.data = commandBytes, .len = commandLen};
+
+    assert_message_matches_protobuf_c();
+}
+
+void test_KineticEncoder_should_match_protobuf_c_for_a_PIN_message(void)
+{
+    uint8_t pin[] = "1234";
+    uint8_t commandBytes[256];
+    size_t commandLen = KineticEncoder_PackCommand(&Command, NULL, commandBytes);
+
+    Message.has_authtype = true;
+    Message.authtype = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__PINAUTH;
+    Message.pinauth = &PinAuth;
+    PinAuth.has_pin = true;
+    PinAuth.pin = (ProtobufCBinaryData){.data = pin, .len = sizeof(pin) - 1};
+    Message.has_commandbytes = true;
+    Message.commandbytes = (ProtobufCBinaryData){.data = commandBytes, .len = commandLen};
+
+    assert_message_matches_protobuf_c();
+}
+
+void test_KineticEncoder_template_should_handle_wide_and_negative_values(void)
+{
+    Header.clusterversion = -1;
+    Header.connectionid = INT64_MAX;
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__PUT;
+    set_key_value();
+    assert_command_matches_protobuf_c();
+
+    uint8_t commandBytes[256];
+    size_t commandLen = KineticEncoder_PackCommand(&Command, NULL, commandBytes);
+    Message.has_authtype = true;
+    Message.authtype = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH;
+    Message.hmacauth = &HmacAuth;
+    HmacAuth.has_identity = true;
+    HmacAuth.identity = -12345;
+    HmacAuth.has_hmac = true;
+    HmacAuth.hmac = (ProtobufCBinaryData){.data = Hmac, .len = sizeof(Hmac)};
+    Message.has_commandbytes = true;
+    Message.commandbytes = (ProtobufCBinaryData){.data = commandBytes, .len = commandLen};
+    assert_message_matches_protobuf_c();
+}
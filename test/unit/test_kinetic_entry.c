@@ -31,6 +31,8 @@
 #include "mock_kinetic_resourcewaiter.h"
 #include "mock_kinetic_response.h"
 #include "mock_kinetic_session.h"
+#include "mock_kinetic_completion_queue.h"
+#include "kinetic_futex.h"
 #include "protobuf-c.h"
 #include "kinetic_entry.h"
 #include <string.h>
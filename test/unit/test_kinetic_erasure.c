@@ -0,0 +1,101 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_erasure.h"
+#include "kinetic_rs.h"
+#include "kinetic_nbo.h"
+#include "kinetic_types.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_logger.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include "byte_array.h"
+#include "mock_kinetic_client.h"
+#include <string.h>
+
+#define K (4)
+#define M (2)
+
+static KineticSession Drives[K + M];
+static KineticSession * Sessions[K + M];
+static uint8_t KeyData[] = "erasure";
+static uint8_t ValueData[KINETIC_OBJ_SIZE + 1];
+static KineticEntry Entry;
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    for (int i = 0; i < K + M; i++) { Sessions[i] = &Drives[i]; }
+    Entry = (KineticEntry) {
+        .key = ByteBuffer_Create(KeyData, sizeof(KeyData) - 1, sizeof(KeyData) - 1),
+        .value = ByteBuffer_Create(ValueData, sizeof(ValueData), 1000),
+    };
+}
+
+void tearDown(void)
+{
+    KineticLogger_Close();
+}
+
+void test_KineticErasure_Put_should_reject_bad_fragment_counts(void)
+{
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticErasure_Put(Sessions, 0, M, &Entry));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticErasure_Put(Sessions, K, 0, &Entry));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticErasure_Put(Sessions, KINETIC_ERASURE_MAX_FRAGMENTS, 1, &Entry));
+}
+
+void test_KineticErasure_Put_should_reject_a_fragment_larger_than_an_object(void)
+{
+    Entry.value.bytesUsed = KINETIC_OBJ_SIZE + 1;
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN,
+        KineticErasure_Put(Sessions, 1, 1, &Entry));
+}
+
+void test_KineticErasure_Put_should_report_the_first_fragment_that_failed(void)
+{
+    KineticClient_Put_IgnoreAndReturn(KINETIC_STATUS_SESSION_TERMINATED);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED,
+        KineticErasure_Put(Sessions, K, M, &Entry));
+}
+
+void test_KineticErasure_Get_should_fail_if_fewer_than_K_fragments_can_be_read(void)
+{
+    Entry.value.bytesUsed = 0;
+    KineticClient_Get_IgnoreAndReturn(KINETIC_STATUS_SESSION_TERMINATED);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED,
+        KineticErasure_Get(Sessions, K, M, &Entry));
+    TEST_ASSERT_EQUAL(0, Entry.value.bytesUsed);
+}
+
+void test_KineticErasure_Delete_should_report_NOT_FOUND_if_no_fragment_was_found(void)
+{
+    KineticClient_Delete_IgnoreAndReturn(KINETIC_STATUS_NOT_FOUND);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND,
+        KineticErasure_Delete(Sessions, K, M, &Entry));
+}
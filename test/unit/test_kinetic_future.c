@@ -0,0 +1,145 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_future.h"
+#include "kinetic_futex.h"
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_logger.h"
+#include <pthread.h>
+#include <stdint.h>
+
+static KineticFuturePool * Pool;
+
+void setUp(void)
+{
+    Pool = KineticFuturePool_Create(4);
+    TEST_ASSERT_NOT_NULL(Pool);
+}
+
+void tearDown(void)
+{
+    KineticFuturePool_Destroy(Pool);
+}
+
+// As the operation given the future's closure would on completing
+static void complete(KineticFuture * future, KineticStatus status)
+{
+    KineticCompletionClosure * closure = KineticFuture_Closure(future);
+    KineticCompletionData data = {.status = status};
+    closure->callback(&data, closure->clientData);
+}
+
+void test_KineticFuture_Wait_should_return_the_status_of_a_completed_operation(void)
+{
+    KineticFuture * future = KineticFuture_Create(Pool);
+    TEST_ASSERT_NOT_NULL(future);
+    TEST_ASSERT_FALSE(KineticFuture_IsDone(future));
+
+    complete(future, KINETIC_STATUS_NOT_FOUND);
+
+    TEST_ASSERT_TRUE(KineticFuture_IsDone(future));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, KineticFuture_Wait(future));
+    KineticFuture_Release(future);
+}
+
+void test_KineticFuture_should_be_reset_when_reused_and_allocated_beyond_the_pool(void)
+{
+    KineticFuture * futures[6];
+    for (int i = 0; i < 6; i++) {
+        futures[i] = KineticFuture_Create(Pool);
+        TEST_ASSERT_NOT_NULL(futures[i]);
+        complete(futures[i], KINETIC_STATUS_SUCCESS);
+    }
+    for (int i = 0; i < 6; i++) {
+        KineticFuture_Release(futures[i]);
+    }
+
+    KineticFuture * future = KineticFuture_Create(Pool);
+    TEST_ASSERT_FALSE(KineticFuture_IsDone(future));
+    KineticFuture_Release(future);
+}
+
+void test_KineticFuture_WaitAll_should_report_the_first_failure_in_order(void)
+{
+    KineticFuture * futures[3];
+    for (int i = 0; i < 3; i++) {
+        futures[i] = KineticFuture_Create(Pool);
+    }
+    complete(futures[2], KINETIC_STATUS_VERSION_MISMATCH);
+    complete(futures[0], KINETIC_STATUS_SUCCESS);
+    complete(futures[1], KINETIC_STATUS_NOT_FOUND);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, KineticFuture_WaitAll(futures, 3));
+    for (int i = 0; i < 3; i++) {
+        KineticFuture_Release(futures[i]);
+    }
+}
+
+void test_KineticFuture_WaitAny_should_return_a_completed_future(void)
+{
+    KineticFuture * futures[3];
+    for (int i = 0; i < 3; i++) {
+        futures[i] = KineticFuture_Create(Pool);
+    }
+    complete(futures[1], KINETIC_STATUS_NOT_FOUND);
+
+    KineticStatus status = KINETIC_STATUS_INVALID;
+    TEST_ASSERT_EQUAL(1, KineticFuture_WaitAny(futures, 3, &status));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, status);
+    complete(futures[0], KINETIC_STATUS_SUCCESS);
+    complete(futures[2], KINETIC_STATUS_SUCCESS);
+    for (int i = 0; i < 3; i++) {
+        KineticFuture_Release(futures[i]);
+    }
+}
+
+#define FUTURE_COUNT (64)
+
+static KineticFuture * Futures[FUTURE_COUNT];
+
+static void * complete_all(void * arg)
+{
+    (void)arg;
+    for (int i = FUTURE_COUNT - 1; i >= 0; i--) {
+        complete(Futures[i], KINETIC_STATUS_SUCCESS);
+    }
+    return NULL;
+}
+
+void test_KineticFuture_should_wake_waiters_as_operations_complete_on_another_thread(void)
+{
+    for (int i = 0; i < FUTURE_COUNT; i++) {
+        Futures[i] = KineticFuture_Create(Pool);
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, complete_all, NULL);
+
+    size_t index = KineticFuture_WaitAny(Futures, FUTURE_COUNT, NULL);
+    TEST_ASSERT_TRUE(KineticFuture_IsDone(Futures[index]));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, KineticFuture_Wait(Futures[0]));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, KineticFuture_WaitAll(Futures, FUTURE_COUNT));
+
+    pthread_join(thread, NULL);
+    for (int i = 0; i < FUTURE_COUNT; i++) {
+        KineticFuture_Release(Futures[i]);
+    }
+}
@@ -21,6 +21,7 @@
 #include "unity_helper.h"
 #include "kinetic.pb-c.h"
 #include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
 #include "kinetic_nbo.h"
 #include "kinetic_message.h"
 #include "kinetic_logger.h"
@@ -257,3 +258,112 @@ void test_KineticHMAC_Validate_should_return_false_if_the_HMAC_presence_is_false
 
     TEST_ASSERT_FALSE(KineticHMAC_Validate(&proto, key));
 }
+
+static void assert_PopulateWithKey_matches_HMAC_SHA1(const ByteArray key, size_t commandLen)
+{
+    Com__Seagate__Kinetic__Proto__Message msg = COM__SEAGATE__KINETIC__PROTO__MESSAGE__INIT;
+    Com__Seagate__Kinetic__Proto__Message__HMACauth hmacAuth = COM__SEAGATE__KINETIC__PROTO__MESSAGE__HMACAUTH__INIT;
+    uint8_t data[KINETIC_HMAC_MAX_LEN];
+    uint8_t commandBytes[300];
+    TEST_ASSERT_TRUE(commandLen <= sizeof(commandBytes));
+    ByteArray commandArray = ByteArray_Create(commandBytes, commandLen);
+    ByteArray_FillWithDummyData(commandArray);
+    msg.commandbytes = (ProtobufCBinaryData) {.data = commandBytes, .len = commandLen};
+    msg.has_commandbytes = true;
+    hmacAuth.hmac = (ProtobufCBinaryData) {.data = data, .len = KINETIC_HMAC_MAX_LEN};
+    msg.hmacauth = &hmacAuth;
+
+    // Reference: one-shot HMAC over the length-prefixed command bytes
+    uint8_t signedBytes[sizeof(uint32_t) + sizeof(commandBytes)];
+    uint32_t lenNBO = KineticNBO_FromHostU32(commandLen);
+    memcpy(signedBytes, &lenNBO, sizeof(lenNBO));
+    memcpy(&signedBytes[sizeof(lenNBO)], commandBytes, commandLen);
+    uint8_t expected[KINETIC_HMAC_MAX_LEN];
+    unsigned int expectedLen = 0;
+    HMAC(EVP_sha1(), key.data, key.len, signedBytes, sizeof(lenNBO) + commandLen,
+        expected, &expectedLen);
+    TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, expectedLen);
+
+    KineticHMACKey hmacKey;
+    memset(&hmacKey, 0, sizeof(hmacKey));
+    KineticHMAC_InitKey(&hmacKey, key);
+    TEST_ASSERT_TRUE(hmacKey.ready);
+
+    // Signing twice must not disturb the precomputed state
+    KineticHMAC actual;
+    for (int i = 0; i < 2; i++) {
+        memset(data, 0, sizeof(data));
+        KineticHMAC_PopulateWithKey(&actual, &msg, &hmacKey);
+        TEST_ASSERT_TRUE(hmacAuth.has_hmac);
+        TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, hmacAuth.hmac.len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual.data, KINETIC_HMAC_SHA1_LEN);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data, KINETIC_HMAC_SHA1_LEN);
+    }
+    TEST_ASSERT_TRUE(KineticHMAC_Validate(&msg, key));
+}
+
+void test_KineticHMAC_PopulateWithKey_should_compute_the_same_HMAC_as_Populate(void)
+{
+    assert_PopulateWithKey_matches_HMAC_SHA1(ByteArray_CreateWithCString("asdfasdf"), 1);
+    assert_PopulateWithKey_matches_HMAC_SHA1(ByteArray_CreateWithCString("1234567890ABCDEFGHIJK"), 123);
+    assert_PopulateWithKey_matches_HMAC_SHA1(ByteArray_CreateWithCString("1234567890ABCDEFGHIJK"), 300);
+}
+
+void test_KineticHMAC_InitKey_should_handle_keys_of_one_SHA1_block_and_longer(void)
+{
+    uint8_t keyBytes[100];
+    ByteArray key = ByteArray_Create(keyBytes, sizeof(keyBytes));
+    ByteArray_FillWithDummyData(key);
+
+    key.len = SHA_CBLOCK;
+    assert_PopulateWithKey_matches_HMAC_SHA1(key, 64);
+    key.len = SHA_CBLOCK + 1;
+    assert_PopulateWithKey_matches_HMAC_SHA1(key, 64);
+    key.len = sizeof(keyBytes);
+    assert_PopulateWithKey_matches_HMAC_SHA1(key, 64);
+}
+
+void test_KineticHMAC_PopulateBatch_should_sign_each_message_as_PopulateWithKey_would(void)
+{
+    enum { COUNT = 11 };    // more than one pass of the widest lanes
+    Com__Seagate__Kinetic__Proto__Message msgs[COUNT];
+    Com__Seagate__Kinetic__Proto__Message__HMACauth hmacAuths[COUNT];
+    Com__Seagate__Kinetic__Proto__Message* msgPtrs[COUNT];
+    KineticHMAC hmacs[COUNT];
+    KineticHMAC* hmacPtrs[COUNT];
+    uint8_t data[COUNT][KINETIC_HMAC_MAX_LEN];
+    uint8_t commandBytes[COUNT][100];
+    const ByteArray key = ByteArray_CreateWithCString("1234567890ABCDEFGHIJK");
+
+    KineticHMACKey hmacKey;
+    memset(&hmacKey, 0, sizeof(hmacKey));
+    KineticHMAC_InitKey(&hmacKey, key);
+
+    for (int i = 0; i < COUNT; i++) {
+        com__seagate__kinetic__proto__message__init(&msgs[i]);
+        com__seagate__kinetic__proto__message__hmacauth__init(&hmacAuths[i]);
+        ByteArray commandArray = ByteArray_Create(commandBytes[i], 10 + i * 8);
+        ByteArray_FillWithDummyData(commandArray);
+        commandBytes[i][0] = (uint8_t)i;
+        msgs[i].commandbytes = (ProtobufCBinaryData) {.data = commandArray.data, .len = commandArray.len};
+        msgs[i].has_commandbytes = true;
+        hmacAuths[i].hmac = (ProtobufCBinaryData) {.data = data[i], .len = KINETIC_HMAC_MAX_LEN};
+        msgs[i].hmacauth = &hmacAuths[i];
+        msgPtrs[i] = &msgs[i];
+        hmacPtrs[i] = &hmacs[i];
+    }
+
+    KineticHMAC_PopulateBatch(hmacPtrs, msgPtrs, COUNT, &hmacKey);
+
+    for (int i = 0; i < COUNT; i++) {
+        KineticHMAC expected;
+        uint8_t expectedData[KINETIC_HMAC_MAX_LEN];
+        TEST_ASSERT_TRUE(hmacAuths[i].has_hmac);
+        TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, hmacAuths[i].hmac.len);
+        hmacAuths[i].hmac.data = expectedData;
+        KineticHMAC_PopulateWithKey(&expected, &msgs[i], &hmacKey);
+        TEST_ASSERT_EQUAL(expected.len, hmacs[i].len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data, hmacs[i].data, KINETIC_HMAC_SHA1_LEN);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.data, data[i], KINETIC_HMAC_SHA1_LEN);
+    }
+}
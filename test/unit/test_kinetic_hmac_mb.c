@@ -0,0 +1,124 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_hmac_mb.h"
+#include "kinetic.pb-c.h"
+#include "kinetic_hmac.h"
+#include "kinetic_nbo.h"
+#include "kinetic_logger.h"
+#include "kinetic_types_internal.h"
+#include "byte_array.h"
+#include "protobuf-c/protobuf-c.h"
+#include <string.h>
+#include <openssl/hmac.h>
+
+#define MAX_COMMAND_LEN (300)
+
+static uint8_t CommandData[KINETIC_HMAC_MB_MAX_LANES][MAX_COMMAND_LEN];
+static KineticHMACKey HmacKey;
+static ByteArray Key;
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    for (size_t lane = 0; lane < KINETIC_HMAC_MB_MAX_LANES; lane++) {
+        for (size_t i = 0; i < MAX_COMMAND_LEN; i++) {
+            CommandData[lane][i] = (uint8_t)(i * 13 + lane * 31);
+        }
+    }
+    Key = ByteArray_CreateWithCString("1234567890ABCDEFGHIJK");
+    memset(&HmacKey, 0, sizeof(HmacKey));
+    KineticHMAC_InitKey(&HmacKey, Key);
+}
+
+void tearDown(void)
+{
+    KineticLogger_Close();
+}
+
+static void expected_hmac(ByteArray const command, uint8_t digest[KINETIC_HMAC_SHA1_LEN])
+{
+    uint8_t signedBytes[sizeof(uint32_t) + MAX_COMMAND_LEN];
+    uint32_t lenNBO = KineticNBO_FromHostU32(command.len);
+    memcpy(signedBytes, &lenNBO, sizeof(lenNBO));
+    memcpy(&signedBytes[sizeof(lenNBO)], command.data, command.len);
+    unsigned int len = 0;
+    HMAC(EVP_sha1(), Key.data, Key.len, signedBytes, sizeof(lenNBO) + command.len,
+        digest, &len);
+    TEST_ASSERT_EQUAL(KINETIC_HMAC_SHA1_LEN, len);
+}
+
+static void assert_Compute_matches_HMAC_SHA1(size_t const lengths[], size_t count)
+{
+    ByteArray commands[KINETIC_HMAC_MB_MAX_LANES];
+    uint8_t digests[KINETIC_HMAC_MB_MAX_LANES][KINETIC_HMAC_SHA1_LEN];
+    memset(commands, 0, sizeof(commands));
+    for (size_t lane = 0; lane < count; lane++) {
+        commands[lane] = ByteArray_Create(CommandData[lane], lengths[lane]);
+    }
+    memset(digests, 0, sizeof(digests));
+
+    KineticHMACMB_Compute(&HmacKey, commands, digests, count);
+
+    for (size_t lane = 0; lane < count; lane++) {
+        uint8_t expected[KINETIC_HMAC_SHA1_LEN];
+        expected_hmac(commands[lane], expected);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, digests[lane], KINETIC_HMAC_SHA1_LEN);
+    }
+}
+
+void test_KineticHMACMB_Lanes_should_report_a_supported_lane_count(void)
+{
+    size_t lanes = KineticHMACMB_Lanes();
+    TEST_ASSERT_TRUE(lanes == 1 || lanes == 4 || lanes == 8);
+    TEST_ASSERT_TRUE(lanes <= KINETIC_HMAC_MB_MAX_LANES);
+    TEST_ASSERT_EQUAL(lanes, KineticHMACMB_Lanes());
+}
+
+void test_KineticHMACMB_Compute_should_match_HMAC_SHA1_for_every_batch_size(void)
+{
+    size_t lengths[KINETIC_HMAC_MB_MAX_LANES] = {17, 64, 1, 120, 55, 250, 33, 9};
+    for (size_t count = 1; count <= KINETIC_HMAC_MB_MAX_LANES; count++) {
+        assert_Compute_matches_HMAC_SHA1(lengths, count);
+    }
+}
+
+void test_KineticHMACMB_Compute_should_pad_messages_ending_near_block_boundaries(void)
+{
+    // With the 4-byte length prefix, 51 bytes is the longest command that
+    // pads into a single block, and 52 the shortest that needs two
+    for (size_t len = 40; len < 140; len++) {
+        size_t lengths[KINETIC_HMAC_MB_MAX_LANES];
+        for (size_t lane = 0; lane < KINETIC_HMAC_MB_MAX_LANES; lane++) {
+            lengths[lane] = len + lane;
+        }
+        assert_Compute_matches_HMAC_SHA1(lengths, KINETIC_HMAC_MB_MAX_LANES);
+        assert_Compute_matches_HMAC_SHA1(lengths, 4);
+    }
+}
+
+void test_KineticHMACMB_Compute_should_handle_lanes_of_very_different_lengths(void)
+{
+    size_t lengths[KINETIC_HMAC_MB_MAX_LANES] = {1, MAX_COMMAND_LEN, 2, 200, 3, 100, 4, 64};
+    assert_Compute_matches_HMAC_SHA1(lengths, KINETIC_HMAC_MB_MAX_LANES);
+    assert_Compute_matches_HMAC_SHA1(&lengths[1], 5);
+}
@@ -0,0 +1,78 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_iterator.h"
+#include "kinetic_types.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_logger.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include "byte_array.h"
+#include "mock_kinetic_client.h"
+#include <string.h>
+
+static KineticSession Session;
+static uint8_t StartKey[] = "a";
+static uint8_t EndKey[] = "z";
+static KineticKeyRange Range;
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    Range = (KineticKeyRange) {
+        .startKey = ByteBuffer_Create(StartKey, sizeof(StartKey) - 1, sizeof(StartKey) - 1),
+        .endKey = ByteBuffer_Create(EndKey, sizeof(EndKey) - 1, sizeof(EndKey) - 1),
+        .startKeyInclusive = true,
+        .endKeyInclusive = true,
+    };
+}
+
+void tearDown(void)
+{
+    KineticLogger_Close();
+}
+
+void test_KineticKeyIterator_Open_should_reject_an_oversized_key(void)
+{
+    static uint8_t longKey[KINETIC_MAX_KEY_LEN + 1];
+    Range.endKey = ByteBuffer_Create(longKey, sizeof(longKey), sizeof(longKey));
+    KineticKeyIterator * iterator = (KineticKeyIterator *)&Session;
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticKeyIterator_Open(&Session, &Range, NULL, &iterator));
+    TEST_ASSERT_NULL(iterator);
+}
+
+void test_KineticKeyIterator_Open_should_fail_if_the_first_page_cannot_be_requested(void)
+{
+    KineticKeyIterator * iterator = NULL;
+    KineticClient_GetKeyRangeStream_IgnoreAndReturn(KINETIC_STATUS_SESSION_TERMINATED);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SESSION_TERMINATED,
+        KineticKeyIterator_Open(&Session, &Range, NULL, &iterator));
+    TEST_ASSERT_NULL(iterator);
+}
+
+void test_KineticKeyIterator_Close_should_accept_NULL(void)
+{
+    KineticKeyIterator_Close(NULL);
+}
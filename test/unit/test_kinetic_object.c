@@ -0,0 +1,270 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_object.h"
+#include "kinetic_types.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_nbo.h"
+#include "kinetic_logger.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include "byte_array.h"
+#include "mock_kinetic_allocator.h"
+#include "mock_kinetic_builder.h"
+#include "mock_kinetic_controller.h"
+#include "mock_kinetic_cache.h"
+#include <string.h>
+
+static KineticSession Session;
+static KineticOperation Operation;
+static uint8_t KeyData[] = "my_object";
+static ByteArray Key = {.data = KeyData, .len = sizeof(KeyData) - 1};
+
+static ssize_t ReadResult;
+static size_t ReadCalls;
+
+static ssize_t TestRead(void* context, void* buf, size_t len)
+{
+    (void)context;
+    (void)buf;
+    (void)len;
+    ReadCalls++;
+    return ReadResult;
+}
+
+static KineticObjectIO TestIO = {.read = TestRead};
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    ReadResult = 0;
+    ReadCalls = 0;
+}
+
+void tearDown(void)
+{
+    KineticLogger_Close();
+}
+
+void test_KineticObject_EncodeManifest_should_store_fields_big_endian(void)
+{
+    KineticObjectManifest manifest = {
+        .length = 0x0102030405060708ull,
+        .chunkSize = KINETIC_OBJ_SIZE,
+        .generation = 0x1112131415161718ull,
+    };
+    uint8_t buf[KINETIC_OBJECT_MANIFEST_LEN];
+    uint8_t expected[KINETIC_OBJECT_MANIFEST_LEN] = {
+        'K', 'O', 'B', 'J',
+        0x00, 0x00, 0x00, 0x03,
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+        0x00, 0x10, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00,
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+    };
+
+    KineticObject_EncodeManifest(&manifest, buf);
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buf, sizeof(expected));
+}
+
+void test_KineticObject_DecodeManifest_should_read_back_an_encoded_manifest(void)
+{
+    KineticObjectManifest manifest = {.length = 3 * KINETIC_OBJ_SIZE + 17, .chunkSize = 4096,
+        .generation = 1444444444123456789ull};
+    KineticObjectManifest decoded = {.length = 0};
+    uint8_t buf[KINETIC_OBJECT_MANIFEST_LEN];
+    KineticObject_EncodeManifest(&manifest, buf);
+
+    KineticStatus status = KineticObject_DecodeManifest(
+        (ByteArray) {.data = buf, .len = sizeof(buf)}, &decoded);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_UINT64(manifest.length, decoded.length);
+    TEST_ASSERT_EQUAL_UINT32(manifest.chunkSize, decoded.chunkSize);
+    TEST_ASSERT_EQUAL_UINT64(manifest.generation, decoded.generation);
+}
+
+void test_KineticObject_DecodeManifest_should_reject_data_that_is_not_a_manifest(void)
+{
+    KineticObjectManifest manifest = {.length = 100, .chunkSize = 10};
+    KineticObjectManifest decoded;
+    uint8_t buf[KINETIC_OBJECT_MANIFEST_LEN];
+    ByteArray data = {.data = buf, .len = sizeof(buf)};
+
+    KineticObject_EncodeManifest(&manifest, buf);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR, KineticObject_DecodeManifest(
+        (ByteArray) {.data = buf, .len = sizeof(buf) - 1}, &decoded));
+
+    buf[0] ^= 0xFF;
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR,
+        KineticObject_DecodeManifest(data, &decoded));
+
+    KineticObject_EncodeManifest(&manifest, buf);
+    buf[7] = 1;
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR,
+        KineticObject_DecodeManifest(data, &decoded));
+
+    manifest.chunkSize = KINETIC_OBJ_SIZE + 1;
+    KineticObject_EncodeManifest(&manifest, buf);
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR,
+        KineticObject_DecodeManifest(data, &decoded));
+}
+
+void test_KineticObject_ChunkCount_should_round_up_to_whole_chunks(void)
+{
+    KineticObjectManifest manifest = {.length = 0, .chunkSize = 1000};
+    TEST_ASSERT_EQUAL_UINT64(0, KineticObject_ChunkCount(&manifest));
+    manifest.length = 1;
+    TEST_ASSERT_EQUAL_UINT64(1, KineticObject_ChunkCount(&manifest));
+    manifest.length = 3000;
+    TEST_ASSERT_EQUAL_UINT64(3, KineticObject_ChunkCount(&manifest));
+    manifest.length = 3001;
+    TEST_ASSERT_EQUAL_UINT64(4, KineticObject_ChunkCount(&manifest));
+}
+
+void test_KineticObject_Put_should_require_a_key(void)
+{
+    ByteArray key = {.data = NULL, .len = 0};
+
+    KineticStatus status = KineticObject_Put(&Session, key, &TestIO, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_MISSING_KEY, status);
+    TEST_ASSERT_EQUAL(0, ReadCalls);
+}
+
+void test_KineticObject_Put_should_reject_keys_too_long_to_name_chunks(void)
+{
+    static uint8_t keyData[KINETIC_MAX_KEY_LEN];
+    ByteArray key = {.data = keyData,
+        .len = KINETIC_MAX_KEY_LEN - KINETIC_OBJECT_CHUNK_KEY_SUFFIX_LEN + 1};
+
+    KineticStatus status = KineticObject_Put(&Session, key, &TestIO, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST, status);
+}
+
+void test_KineticObject_Put_should_reject_chunks_larger_than_the_max_object_size(void)
+{
+    KineticObjectConfig config = {.chunkSize = KINETIC_OBJ_SIZE + 1};
+
+    KineticStatus status = KineticObject_Put(&Session, Key, &TestIO, &config);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST, status);
+}
+
+void test_KineticObject_Put_should_store_only_the_manifest_for_an_empty_object(void)
+{
+    KineticObjectConfig config = {.chunkSize = 4096, .maxInFlight = 2};
+    ReadResult = 0;
+
+    // No object to replace
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildGet_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_NOT_FOUND);
+
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildPut_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_SUCCESS);
+
+    KineticStatus status = KineticObject_Put(&Session, Key, &TestIO, &config);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL(1, ReadCalls);
+}
+
+void test_KineticObject_Put_should_not_store_a_manifest_if_the_old_one_cannot_be_read(void)
+{
+    KineticObjectConfig config = {.chunkSize = 4096, .maxInFlight = 2};
+    ReadResult = 0;
+
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildGet_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_SOCKET_ERROR);
+
+    KineticStatus status = KineticObject_Put(&Session, Key, &TestIO, &config);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SOCKET_ERROR, status);
+}
+
+void test_KineticObject_Put_should_not_store_a_manifest_if_reading_fails(void)
+{
+    KineticObjectConfig config = {.chunkSize = 4096, .maxInFlight = 2};
+    ReadResult = -1;
+
+    KineticStatus status = KineticObject_Put(&Session, Key, &TestIO, &config);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_FILE, status);
+}
+
+void test_KineticObject_Get_should_report_the_status_of_a_failed_manifest_GET(void)
+{
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildGet_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_NOT_FOUND);
+
+    KineticStatus status = KineticObject_Get(&Session, Key, &TestIO, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, status);
+}
+
+void test_KineticObject_Get_should_report_DATA_ERROR_if_the_key_holds_a_plain_value(void)
+{
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildGet_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_BUFFER_OVERRUN);
+
+    KineticStatus status = KineticObject_Get(&Session, Key, &TestIO, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR, status);
+}
+
+void test_KineticObject_Delete_should_require_a_key(void)
+{
+    ByteArray key = {.data = NULL, .len = 0};
+
+    KineticStatus status = KineticObject_Delete(&Session, key, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_MISSING_KEY, status);
+}
+
+void test_KineticObject_Delete_should_delete_nothing_if_there_is_no_object(void)
+{
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildGet_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_NOT_FOUND);
+
+    KineticStatus status = KineticObject_Delete(&Session, Key, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_NOT_FOUND, status);
+}
+
+void test_KineticObject_Delete_should_not_delete_a_plain_value(void)
+{
+    KineticAllocator_NewOperation_ExpectAndReturn(&Session, &Operation);
+    KineticBuilder_BuildGet_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticController_ExecuteOperation_ExpectAndReturn(&Operation, NULL, KINETIC_STATUS_BUFFER_OVERRUN);
+
+    KineticStatus status = KineticObject_Delete(&Session, Key, NULL);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR, status);
+}
@@ -31,7 +31,9 @@
 #include "mock_kinetic_session.h"
 #include "mock_kinetic_response.h"
 #include "mock_kinetic_countingsemaphore.h"
+#include "mock_kinetic_window.h"
 #include "mock_kinetic_request.h"
+#include "mock_kinetic_completion_queue.h"
 
 static KineticSession Session;
 static KineticRequest Request;
@@ -64,20 +66,71 @@ void tearDown(void)
 
 void test_KineticOperation_SendRequest_should_error_out_on_lock_failure(void)
 {
-    KineticRequest_LockSend_ExpectAndReturn(Operation.session, false);
+    KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
+    KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
+    KineticRequest_PackCommand_ExpectAndReturn(Operation.request, 100);
+    KineticRequest_PopulateAuthentication_ExpectAndReturn(&session->config,
+        Operation.request, NULL, KINETIC_STATUS_SUCCESS);
+    KineticRequest_PackMessage_ExpectAndReturn(&Operation, &msg, &msgSize, KINETIC_STATUS_SUCCESS);
+
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, false);
+    KineticRequest_SkipSend_Expect(session, 12345);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
+
+    KineticStatus status = KineticOperation_SendRequest(&Operation);
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_CONNECTION_ERROR, status);
+}
+
+void test_KineticOperation_SendRequest_should_pass_on_its_turn_after_lock_failure_so_later_requests_send(void)
+{
+    KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
+    KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
+    KineticRequest_PackCommand_ExpectAndReturn(Operation.request, 100);
+    KineticRequest_PopulateAuthentication_ExpectAndReturn(&session->config,
+        Operation.request, NULL, KINETIC_STATUS_SUCCESS);
+    KineticRequest_PackMessage_ExpectAndReturn(&Operation, &msg, &msgSize, KINETIC_STATUS_SUCCESS);
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, false);
+    KineticRequest_SkipSend_Expect(session, 12345);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
+
     KineticStatus status = KineticOperation_SendRequest(&Operation);
     TEST_ASSERT_EQUAL(KINETIC_STATUS_CONNECTION_ERROR, status);
+
+    // The next request takes the following turn and goes out as usual
+    KineticRequest request2;
+    KineticRequest_Init(&request2, &Session);
+    KineticOperation operation2 = {.session = &Session, .request = &request2};
+
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
+    KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12346);
+    KineticRequest_PackCommand_ExpectAndReturn(&request2, 100);
+    KineticRequest_PopulateAuthentication_ExpectAndReturn(&session->config,
+        &request2, NULL, KINETIC_STATUS_SUCCESS);
+    KineticRequest_PackMessage_ExpectAndReturn(&operation2, &msg, &msgSize, KINETIC_STATUS_SUCCESS);
+    KineticRequest_LockSend_ExpectAndReturn(session, 12346, true);
+    KineticRequest_SendRequest_ExpectAndReturn(&operation2, msg, msgSize, true);
+    KineticRequest_UnlockSend_ExpectAndReturn(session, 12346, true);
+
+    status = KineticOperation_SendRequest(&operation2);
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_INT64(12346, request2.message.header.sequence);
 }
 
 
 void test_KineticOperation_SendRequest_should_return_MEMORY_ERROR_on_command_pack_failure(void)
 {
-    KineticRequest_LockSend_ExpectAndReturn(Operation.session, true);
     KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
     KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
 
     KineticRequest_PackCommand_ExpectAndReturn(Operation.request, KINETIC_REQUEST_PACK_FAILURE);
-    KineticRequest_UnlockSend_ExpectAndReturn(Operation.session, true);
+
+    // The reserved sequence ID still takes its turn, so later ones can send
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
+    KineticRequest_UnlockSend_ExpectAndReturn(session, 12345, true);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
 
     KineticStatus status = KineticOperation_SendRequest(&Operation);
     TEST_ASSERT_EQUAL(KINETIC_STATUS_MEMORY_ERROR, status);
@@ -85,14 +138,17 @@ void test_KineticOperation_SendRequest_should_return_MEMORY_ERROR_on_command_pac
 
 void test_KineticOperation_SendRequest_should_return_error_status_on_authentication_failure(void)
 {
-    KineticRequest_LockSend_ExpectAndReturn(Operation.session, true);
     KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
     KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
 
     KineticRequest_PackCommand_ExpectAndReturn(Operation.request, 100);
     KineticRequest_PopulateAuthentication_ExpectAndReturn(&session->config,
         Operation.request, NULL, KINETIC_STATUS_HMAC_REQUIRED);
-    KineticRequest_UnlockSend_ExpectAndReturn(Operation.session, true);
+
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
+    KineticRequest_UnlockSend_ExpectAndReturn(session, 12345, true);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
 
     KineticStatus status = KineticOperation_SendRequest(&Operation);
     TEST_ASSERT_EQUAL(KINETIC_STATUS_HMAC_REQUIRED, status);
@@ -100,8 +156,8 @@ void test_KineticOperation_SendRequest_should_return_error_status_on_authenticat
 
 void test_KineticOperation_SendRequest_should_return_error_status_on_PackMessage_failure(void)
 {
-    KineticRequest_LockSend_ExpectAndReturn(Operation.session, true);
     KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
     KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
 
     KineticRequest_PackCommand_ExpectAndReturn(Operation.request, 100);
@@ -110,7 +166,10 @@ void test_KineticOperation_SendRequest_should_return_error_status_on_PackMessage
 
     KineticRequest_PackMessage_ExpectAndReturn(&Operation, &msg, &msgSize,
         KINETIC_STATUS_MEMORY_ERROR);
-    KineticRequest_UnlockSend_ExpectAndReturn(Operation.session, true);
+
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
+    KineticRequest_UnlockSend_ExpectAndReturn(session, 12345, true);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
 
     KineticStatus status = KineticOperation_SendRequest(&Operation);
     TEST_ASSERT_EQUAL(KINETIC_STATUS_MEMORY_ERROR, status);
@@ -118,8 +177,8 @@ void test_KineticOperation_SendRequest_should_return_error_status_on_PackMessage
 
 void test_KineticOperation_SendRequest_should_return_REQUEST_REJECTED_if_SendRequest_fails(void)
 {
-    KineticRequest_LockSend_ExpectAndReturn(Operation.session, true);
     KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
     KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
 
     KineticRequest_PackCommand_ExpectAndReturn(Operation.request, 100);
@@ -128,11 +187,10 @@ void test_KineticOperation_SendRequest_should_return_REQUEST_REJECTED_if_SendReq
 
     KineticRequest_PackMessage_ExpectAndReturn(&Operation, &msg, &msgSize, KINETIC_STATUS_SUCCESS);
 
-    KineticCountingSemaphore_Take_Expect(Operation.session->outstandingOperations);
-
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
     KineticRequest_SendRequest_ExpectAndReturn(&Operation, msg, msgSize, false);
-    KineticCountingSemaphore_Give_Expect(Operation.session->outstandingOperations);
-    KineticRequest_UnlockSend_ExpectAndReturn(Operation.session, true);
+    KineticRequest_UnlockSend_ExpectAndReturn(session, 12345, true);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
 
     KineticStatus status = KineticOperation_SendRequest(&Operation);
     TEST_ASSERT_EQUAL(KINETIC_STATUS_REQUEST_REJECTED, status);
@@ -140,8 +198,8 @@ void test_KineticOperation_SendRequest_should_return_REQUEST_REJECTED_if_SendReq
 
 void test_KineticOperation_SendRequest_should_acquire_and_increment_sequence_count_and_send_PDU_to_bus(void)
 {
-    KineticRequest_LockSend_ExpectAndReturn(Operation.session, true);
     KineticSession *session = Operation.session;
+    KineticCountingSemaphore_Take_Expect(session->outstandingOperations);
     KineticSession_GetNextSequenceCount_ExpectAndReturn(session, 12345);
 
     KineticRequest_PackCommand_ExpectAndReturn(Operation.request, 100);
@@ -150,13 +208,127 @@ void test_KineticOperation_SendRequest_should_acquire_and_increment_sequence_cou
 
     KineticRequest_PackMessage_ExpectAndReturn(&Operation, &msg, &msgSize, KINETIC_STATUS_SUCCESS);
 
-    KineticCountingSemaphore_Take_Expect(Operation.session->outstandingOperations);
-
+    // Only the hand-off to the bus happens in the send lock
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
     KineticRequest_SendRequest_ExpectAndReturn(&Operation, msg, msgSize, true);
-    KineticRequest_UnlockSend_ExpectAndReturn(Operation.session, true);
+    KineticRequest_UnlockSend_ExpectAndReturn(session, 12345, true);
 
     KineticStatus status = KineticOperation_SendRequest(&Operation);
     TEST_ASSERT_EQUAL(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_INT64(12345, Operation.request->message.header.sequence);
 }
 
 
+
+void test_KineticOperation_SendRequests_should_send_a_run_of_requests_in_one_turn(void)
+{
+    KineticSession *session = Operation.session;
+    KineticRequest request2;
+    KineticRequest_Init(&request2, &Session);
+    KineticOperation operation2 = {.session = &Session, .request = &request2};
+    KineticOperation* ops[] = {&Operation, &operation2};
+    KineticRequest* signed_requests[] = {&Request, &request2};
+    KineticStatus statuses[2] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+
+    // Counts and sequence IDs are reserved for the whole run at once
+    KineticCountingSemaphore_TakeUpTo_ExpectAndReturn(session->outstandingOperations, 2, 2);
+    KineticSession_GetNextSequenceCounts_ExpectAndReturn(session, 2, 12345);
+
+    KineticRequest_PackCommand_ExpectAndReturn(&Request, 100);
+    KineticRequest_PackCommand_ExpectAndReturn(&request2, 100);
+    KineticRequest_PopulateAuthenticationBatch_ExpectAndReturn(&session->config,
+        signed_requests, 2, KINETIC_STATUS_SUCCESS);
+    KineticRequest_PackMessage_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
+    KineticRequest_SendRequest_ExpectAndReturn(&Operation, NULL, 0, true);
+    KineticRequest_SendRequest_ExpectAndReturn(&operation2, NULL, 0, true);
+    KineticRequest_UnlockSendRun_ExpectAndReturn(session, 12345, 2, true);
+
+    KineticOperation_SendRequests(ops, statuses, 2);
+
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_SUCCESS, statuses[0]);
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_SUCCESS, statuses[1]);
+    TEST_ASSERT_EQUAL_INT64(12345, Request.message.header.sequence);
+    TEST_ASSERT_EQUAL_INT64(12346, request2.message.header.sequence);
+}
+
+void test_KineticOperation_SendRequests_should_split_runs_on_available_counts_and_report_each_failure(void)
+{
+    KineticSession *session = Operation.session;
+    KineticRequest request2;
+    KineticRequest_Init(&request2, &Session);
+    KineticOperation operation2 = {.session = &Session, .request = &request2};
+    KineticOperation* ops[] = {&Operation, &operation2};
+    KineticStatus statuses[2] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+
+    // Only one count is free, so the first request goes out on its own
+    KineticCountingSemaphore_TakeUpTo_ExpectAndReturn(session->outstandingOperations, 2, 1);
+    KineticSession_GetNextSequenceCounts_ExpectAndReturn(session, 1, 12345);
+    KineticRequest_PackCommand_ExpectAndReturn(&Request, KINETIC_REQUEST_PACK_FAILURE);
+
+    // The failed request still takes its turn, so later ones can send
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, true);
+    KineticRequest_UnlockSendRun_ExpectAndReturn(session, 12345, 1, true);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
+
+    KineticCountingSemaphore_TakeUpTo_ExpectAndReturn(session->outstandingOperations, 1, 1);
+    KineticSession_GetNextSequenceCounts_ExpectAndReturn(session, 1, 12346);
+    KineticRequest_PackCommand_ExpectAndReturn(&request2, 100);
+    KineticRequest_PopulateAuthenticationBatch_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticRequest_PackMessage_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticRequest_LockSend_ExpectAndReturn(session, 12346, false);
+    KineticRequest_SkipSendRun_Expect(session, 12346, 1);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
+
+    KineticOperation_SendRequests(ops, statuses, 2);
+
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_MEMORY_ERROR, statuses[0]);
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_CONNECTION_ERROR, statuses[1]);
+}
+
+void test_KineticOperation_SendRequests_should_pass_on_every_turn_in_a_run_after_lock_failure(void)
+{
+    KineticSession *session = Operation.session;
+    KineticRequest request2;
+    KineticRequest_Init(&request2, &Session);
+    KineticOperation operation2 = {.session = &Session, .request = &request2};
+    KineticOperation* ops[] = {&Operation, &operation2};
+    KineticStatus statuses[2] = {KINETIC_STATUS_INVALID, KINETIC_STATUS_INVALID};
+
+    // The second request fails to pack, then the send lock fails too
+    KineticCountingSemaphore_TakeUpTo_ExpectAndReturn(session->outstandingOperations, 2, 2);
+    KineticSession_GetNextSequenceCounts_ExpectAndReturn(session, 2, 12345);
+    KineticRequest_PackCommand_ExpectAndReturn(&Request, 100);
+    KineticRequest_PackCommand_ExpectAndReturn(&request2, KINETIC_REQUEST_PACK_FAILURE);
+    KineticRequest_PopulateAuthenticationBatch_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticRequest_PackMessage_IgnoreAndReturn(KINETIC_STATUS_SUCCESS);
+    KineticRequest_LockSend_ExpectAndReturn(session, 12345, false);
+
+    // Both of the run's turns are released, so the next run can send
+    KineticRequest_SkipSendRun_Expect(session, 12345, 2);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
+    KineticCountingSemaphore_Give_Expect(session->outstandingOperations);
+
+    KineticOperation_SendRequests(ops, statuses, 2);
+
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_CONNECTION_ERROR, statuses[0]);
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_CONNECTION_ERROR, statuses[1]);
+
+    KineticRequest request3;
+    KineticRequest_Init(&request3, &Session);
+    KineticOperation operation3 = {.session = &Session, .request = &request3};
+    KineticOperation* nextOps[] = {&operation3};
+    KineticStatus nextStatuses[1] = {KINETIC_STATUS_INVALID};
+
+    KineticCountingSemaphore_TakeUpTo_ExpectAndReturn(session->outstandingOperations, 1, 1);
+    KineticSession_GetNextSequenceCounts_ExpectAndReturn(session, 1, 12347);
+    KineticRequest_PackCommand_ExpectAndReturn(&request3, 100);
+    KineticRequest_LockSend_ExpectAndReturn(session, 12347, true);
+    KineticRequest_SendRequest_ExpectAndReturn(&operation3, NULL, 0, true);
+    KineticRequest_UnlockSendRun_ExpectAndReturn(session, 12347, 1, true);
+
+    KineticOperation_SendRequests(nextOps, nextStatuses, 1);
+
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_SUCCESS, nextStatuses[0]);
+}
@@ -0,0 +1,157 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity_helper.h"
+#include "kinetic_pdu_unpack.h"
+#include "kinetic_types_internal.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include <string.h>
+
+static Com__Seagate__Kinetic__Proto__Command Command;
+static Com__Seagate__Kinetic__Proto__Command__Header Header;
+static Com__Seagate__Kinetic__Proto__Command__Status Status;
+static Com__Seagate__Kinetic__Proto__Message Message;
+static uint8_t CommandBytes[256];
+static uint8_t MessageBytes[512];
+
+void setUp(void)
+{
+    com__seagate__kinetic__proto__command__init(&Command);
+    com__seagate__kinetic__proto__command__header__init(&Header);
+    com__seagate__kinetic__proto__command__status__init(&Status);
+    com__seagate__kinetic__proto__message__init(&Message);
+}
+
+void tearDown(void) {}
+
+static size_t pack(void)
+{
+    Message.has_commandbytes = true;
+    Message.commandbytes.data = CommandBytes;
+    Message.commandbytes.len = com__seagate__kinetic__proto__command__pack(&Command, CommandBytes);
+    return com__seagate__kinetic__proto__message__pack(&Message, MessageBytes);
+}
+
+void test_KineticPDU_unpack_summary_should_read_the_routing_fields_of_a_response(void)
+{
+    Message.has_authtype = true;
+    Message.authtype = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH;
+    Command.header = &Header;
+    Header.has_acksequence = true;
+    Header.acksequence = 0x123456789a;
+    Header.has_connectionid = true;
+    Header.connectionid = 42;
+    Command.status = &Status;
+    Status.has_code = true;
+    Status.code = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__VERSION_MISMATCH;
+    size_t len = pack();
+
+    KineticResponseSummary summary;
+    TEST_ASSERT_TRUE(KineticPDU_unpack_summary(len, MessageBytes, &summary));
+    TEST_ASSERT_TRUE(summary.hasAuthType);
+    TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__HMACAUTH, summary.authType);
+    TEST_ASSERT_TRUE(summary.hasHeader);
+    TEST_ASSERT_EQUAL_INT64(0x123456789a, summary.ackSequence);
+    TEST_ASSERT_EQUAL_INT64(42, summary.connectionID);
+    TEST_ASSERT_TRUE(summary.hasStatusCode);
+    TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__VERSION_MISMATCH,
+        summary.statusCode);
+}
+
+void test_KineticPDU_unpack_summary_should_skip_fields_it_does_not_need(void)
+{
+    uint8_t hmac[20] = {0};
+    Com__Seagate__Kinetic__Proto__Message__HMACauth hmacAuth;
+    com__seagate__kinetic__proto__message__hmacauth__init(&hmacAuth);
+    hmacAuth.has_identity = true;
+    hmacAuth.identity = 1;
+    hmacAuth.has_hmac = true;
+    hmacAuth.hmac = (ProtobufCBinaryData){.data = hmac, .len = sizeof(hmac)};
+    Message.hmacauth = &hmacAuth;
+
+    uint8_t key[] = "key";
+    Com__Seagate__Kinetic__Proto__Command__Body body;
+    com__seagate__kinetic__proto__command__body__init(&body);
+    Com__Seagate__Kinetic__Proto__Command__KeyValue keyValue;
+    com__seagate__kinetic__proto__command__key_value__init(&keyValue);
+    keyValue.has_key = true;
+    keyValue.key = (ProtobufCBinaryData){.data = key, .len = sizeof(key)};
+    body.keyvalue = &keyValue;
+    Command.body = &body;
+
+    Command.header = &Header;
+    Header.has_clusterversion = true;
+    Header.clusterversion = -1;
+    Header.has_acksequence = true;
+    Header.acksequence = 7;
+    Header.has_messagetype = true;
+    Header.messagetype = COM__SEAGATE__KINETIC__PROTO__COMMAND__MESSAGE_TYPE__GET_RESPONSE;
+    Command.status = &Status;
+    Status.has_code = true;
+    Status.code = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS;
+    Status.statusmessage = "all good";
+    size_t len = pack();
+
+    KineticResponseSummary summary;
+    TEST_ASSERT_TRUE(KineticPDU_unpack_summary(len, MessageBytes, &summary));
+    TEST_ASSERT_FALSE(summary.hasAuthType);
+    TEST_ASSERT_TRUE(summary.hasHeader);
+    TEST_ASSERT_EQUAL_INT64(7, summary.ackSequence);
+    TEST_ASSERT_EQUAL_INT64(0, summary.connectionID);
+    TEST_ASSERT_TRUE(summary.hasStatusCode);
+    TEST_ASSERT_EQUAL(COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__SUCCESS,
+        summary.statusCode);
+}
+
+void test_KineticPDU_unpack_summary_should_report_no_header_for_an_empty_command(void)
+{
+    KineticResponseSummary summary;
+    TEST_ASSERT_TRUE(KineticPDU_unpack_summary(0, NULL, &summary));
+    TEST_ASSERT_FALSE(summary.hasHeader);
+
+    size_t len = pack();
+    TEST_ASSERT_TRUE(KineticPDU_unpack_summary(len, MessageBytes, &summary));
+    TEST_ASSERT_FALSE(summary.hasHeader);
+    TEST_ASSERT_FALSE(summary.hasStatusCode);
+}
+
+void test_KineticPDU_unpack_summary_should_reject_malformed_input(void)
+{
+    Command.header = &Header;
+    Header.has_acksequence = true;
+    Header.acksequence = 7;
+    size_t len = pack();
+
+    KineticResponseSummary summary;
+    TEST_ASSERT_FALSE(KineticPDU_unpack_summary(len - 1, MessageBytes, &summary));
+    TEST_ASSERT_FALSE(summary.hasHeader);
+
+    uint8_t wrongWireType[] = {0x22, 0x00};     // authType as bytes
+    TEST_ASSERT_FALSE(KineticPDU_unpack_summary(sizeof(wrongWireType), wrongWireType, &summary));
+
+    uint8_t longVarint[12];
+    memset(longVarint, 0xff, sizeof(longVarint));
+    longVarint[0] = 0x20;                       // authType
+    TEST_ASSERT_FALSE(KineticPDU_unpack_summary(sizeof(longVarint), longVarint, &summary));
+
+    uint8_t group[] = {0x23, 0x24};
+    TEST_ASSERT_FALSE(KineticPDU_unpack_summary(sizeof(group), group, &summary));
+}
@@ -24,8 +24,10 @@
 
 #include "kinetic_logger.h"
 #include "byte_array.h"
+#include <pthread.h>
 
 #include "mock_kinetic_auth.h"
+#include "mock_kinetic_encoder.h"
 #include "mock_kinetic_nbo.h"
 #include "mock_bus.h"
 #include "mock_kinetic_operation.h"
@@ -56,6 +58,7 @@ void test_KineticRequest_PackCommand_should_return_KINETIC_REQUEST_PACK_FAILURE_
     memset(&request, 0, sizeof(request));
     request.message = message;
 
+    KineticEncoder_CanPackCommand_ExpectAndReturn(&request.message.command, false);
     com__seagate__kinetic__proto__command__get_packed_size_ExpectAndReturn(&request.message.command,
         ((size_t)-1));
 
@@ -73,6 +76,7 @@ void test_KineticRequest_PackCommand_should_return_size_when_packing_command(voi
 
     uint8_t buf[12345];
     cmdBuf = buf;
+    KineticEncoder_CanPackCommand_ExpectAndReturn(&request.message.command, false);
     com__seagate__kinetic__proto__command__get_packed_size_ExpectAndReturn(&request.message.command,
         (size_t)12345);
 
@@ -84,6 +88,23 @@ void test_KineticRequest_PackCommand_should_return_size_when_packing_command(voi
     TEST_ASSERT_TRUE(request.message.message.has_commandbytes);
 }
 
+void test_KineticRequest_PackCommand_should_use_the_direct_encoder_when_it_can(void)
+{
+    KineticRequest request;
+    memset(&request, 0, sizeof(request));
+
+    uint8_t buf[100];
+    cmdBuf = buf;
+    KineticEncoder_CanPackCommand_ExpectAndReturn(&request.message.command, true);
+    KineticEncoder_CommandSize_ExpectAndReturn(&request.message.command, NULL, 100);
+    KineticEncoder_PackCommand_ExpectAndReturn(&request.message.command, NULL, cmdBuf, 100);
+    TEST_ASSERT_EQUAL(100, KineticRequest_PackCommand(&request));
+
+    TEST_ASSERT_EQUAL_PTR(buf, request.message.message.commandbytes.data);
+    TEST_ASSERT_EQUAL(100, request.message.message.commandbytes.len);
+    TEST_ASSERT_TRUE(request.message.message.has_commandbytes);
+}
+
 void test_KineticRequest_PopulateAuthentication_should_use_PIN_if_provided(void)
 {
     KineticSessionConfig config;
@@ -117,6 +138,7 @@ void test_KineticRequest_PackMessage_should_return_MEMORY_ERROR_on_alloc_fail(vo
     size_t msgSize = 0;
 
     Com__Seagate__Kinetic__Proto__Message* proto = &operation.request->message.message;
+    KineticEncoder_CanPackMessage_ExpectAndReturn(proto, false);
     com__seagate__kinetic__proto__message__get_packed_size_ExpectAndReturn(proto, 12345);
 
     KineticNBO_FromHostU32_ExpectAndReturn(12345, 0xaabbccdd);
@@ -147,6 +169,7 @@ void test_KineticRequest_PackMessage_should_return_SUCCESS_on_message_packing(vo
     size_t msgSize = 0;
 
     Com__Seagate__Kinetic__Proto__Message* proto = &operation.request->message.message;
+    KineticEncoder_CanPackMessage_ExpectAndReturn(proto, false);
     com__seagate__kinetic__proto__message__get_packed_size_ExpectAndReturn(proto, packedSize);
 
     // size of filler protobuf, mainly to get things nicely aligned w/ 9-byte header
@@ -193,3 +216,123 @@ void test_KineticRequest_PackMessage_should_return_SUCCESS_on_message_packing(vo
         TEST_ASSERT_EQUAL(valueBuf[i], out_msg[i + offset + packedSize]);
     }
 }
+
+void test_KineticRequest_PackMessage_should_use_the_direct_encoder_when_it_can(void)
+{
+    KineticRequest request;
+    memset(&request, 0, sizeof(request));
+    KineticOperation operation = {
+        .request = &request,
+        .value.len = 0,
+    };
+
+    uint8_t *out_msg = NULL;
+    size_t msgSize = 0;
+    size_t packedSize = 40;
+
+    Com__Seagate__Kinetic__Proto__Message* proto = &request.message.message;
+    KineticEncoder_CanPackMessage_ExpectAndReturn(proto, true);
+    KineticEncoder_MessageSize_ExpectAndReturn(proto, NULL, packedSize);
+    KineticNBO_FromHostU32_ExpectAndReturn(packedSize, 0x28000000);
+    KineticNBO_FromHostU32_ExpectAndReturn(0, 0);
+
+    uint8_t buf[64];
+    msg = &buf[0];  // fake malloc
+    size_t offset = sizeof(uint8_t) + 2*sizeof(uint32_t);
+    KineticEncoder_PackMessage_ExpectAndReturn(proto, NULL, &buf[offset], packedSize);
+
+    KineticStatus status = KineticRequest_PackMessage(&operation, &out_msg, &msgSize);
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_PTR(msg, out_msg);
+    TEST_ASSERT_EQUAL(offset + packedSize, msgSize);
+}
+
+void test_KineticRequest_UnlockSend_should_pass_the_turn_to_the_next_sequence_ID(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    pthread_mutex_init(&session.sendMutex, NULL);
+    pthread_cond_init(&session.sendTurn, NULL);
+    session.nextSendSequence = 7;
+
+    TEST_ASSERT_TRUE(KineticRequest_LockSend(&session, 7));
+    TEST_ASSERT_TRUE(KineticRequest_UnlockSend(&session, 7));
+    TEST_ASSERT_EQUAL_INT64(8, session.nextSendSequence);
+
+    TEST_ASSERT_TRUE(KineticRequest_LockSend(&session, 8));
+    TEST_ASSERT_TRUE(KineticRequest_UnlockSend(&session, 8));
+    TEST_ASSERT_EQUAL_INT64(9, session.nextSendSequence);
+
+    pthread_cond_destroy(&session.sendTurn);
+    pthread_mutex_destroy(&session.sendMutex);
+}
+
+void test_KineticRequest_UnlockSendRun_should_pass_the_turn_past_every_sequence_ID_in_the_run(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    pthread_mutex_init(&session.sendMutex, NULL);
+    pthread_cond_init(&session.sendTurn, NULL);
+    session.nextSendSequence = 7;
+
+    TEST_ASSERT_TRUE(KineticRequest_LockSend(&session, 7));
+    TEST_ASSERT_TRUE(KineticRequest_UnlockSendRun(&session, 7, 4));
+    TEST_ASSERT_EQUAL_INT64(11, session.nextSendSequence);
+
+    TEST_ASSERT_TRUE(KineticRequest_LockSend(&session, 11));
+    TEST_ASSERT_TRUE(KineticRequest_UnlockSend(&session, 11));
+    TEST_ASSERT_EQUAL_INT64(12, session.nextSendSequence);
+
+    pthread_cond_destroy(&session.sendTurn);
+    pthread_mutex_destroy(&session.sendMutex);
+}
+
+void test_KineticRequest_SkipSend_should_pass_the_turn_on_without_sending(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    pthread_mutex_init(&session.sendMutex, NULL);
+    pthread_cond_init(&session.sendTurn, NULL);
+    session.nextSendSequence = 7;
+
+    // Sequence ID 7 failed to take the lock, so 8 must still get its turn
+    KineticRequest_SkipSend(&session, 7);
+    TEST_ASSERT_EQUAL_INT64(8, session.nextSendSequence);
+
+    TEST_ASSERT_TRUE(KineticRequest_LockSend(&session, 8));
+    TEST_ASSERT_TRUE(KineticRequest_UnlockSend(&session, 8));
+    TEST_ASSERT_EQUAL_INT64(9, session.nextSendSequence);
+
+    KineticRequest_SkipSendRun(&session, 9, 3);
+    TEST_ASSERT_EQUAL_INT64(12, session.nextSendSequence);
+
+    pthread_cond_destroy(&session.sendTurn);
+    pthread_mutex_destroy(&session.sendMutex);
+}
+
+static void * lock_and_unlock_send_8(void * arg)
+{
+    KineticSession * session = arg;
+    if (KineticRequest_LockSend(session, 8)) {
+        KineticRequest_UnlockSend(session, 8);
+    }
+    return NULL;
+}
+
+void test_KineticRequest_SkipSend_should_wake_a_sender_waiting_for_the_next_turn(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    pthread_mutex_init(&session.sendMutex, NULL);
+    pthread_cond_init(&session.sendTurn, NULL);
+    session.nextSendSequence = 7;
+
+    pthread_t sender;
+    TEST_ASSERT_EQUAL(0, pthread_create(&sender, NULL, lock_and_unlock_send_8, &session));
+    KineticRequest_SkipSend(&session, 7);
+    TEST_ASSERT_EQUAL(0, pthread_join(sender, NULL));
+    TEST_ASSERT_EQUAL_INT64(9, session.nextSendSequence);
+
+    pthread_cond_destroy(&session.sendTurn);
+    pthread_mutex_destroy(&session.sendMutex);
+}
@@ -34,6 +34,7 @@
 #include "mock_kinetic_controller.h"
 #include "mock_kinetic_allocator.h"
 #include "mock_kinetic_pdu_unpack.h"
+#include "mock_kinetic_arena.h"
 #include "mock_bus.h"
 #include "mock_bus_inward.h"
 #include "byte_array.h"
@@ -128,3 +129,67 @@ void test_KineticResponse_GetKeyRange_should_return_the_Com__Seagate__Kinetic__P
     range = KineticResponse_GetKeyRange(&Response);
     TEST_ASSERT_EQUAL_PTR(&Range, range);
 }
+
+void test_KineticResponse_GetStatus_should_use_the_status_code_read_on_receipt(void)
+{
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_INVALID, KineticResponse_GetStatus(NULL));
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_INVALID, KineticResponse_GetStatus(&Response));
+
+    Response.summary.hasStatusCode = true;
+    Response.summary.statusCode = COM__SEAGATE__KINETIC__PROTO__COMMAND__STATUS__STATUS_CODE__NOT_FOUND;
+    TEST_ASSERT_EQUAL(KINETIC_STATUS_NOT_FOUND, KineticResponse_GetStatus(&Response));
+}
+
+void test_KineticResponse_GetConnectionID_should_only_return_the_ID_of_an_unsolicited_status(void)
+{
+    Response.summary.hasHeader = true;
+    Response.summary.connectionID = 1234;
+    TEST_ASSERT_EQUAL(0, KineticResponse_GetConnectionID(&Response));
+
+    Response.summary.hasAuthType = true;
+    Response.summary.authType = COM__SEAGATE__KINETIC__PROTO__MESSAGE__AUTH_TYPE__UNSOLICITEDSTATUS;
+    TEST_ASSERT_EQUAL(1234, KineticResponse_GetConnectionID(&Response));
+}
+
+void test_KineticResponse_GetCommand_should_unpack_the_message_and_command_once(void)
+{
+    uint8_t packed[] = {0x3a, 0x02, 0x0a, 0x00};
+    Response.header.protobufLength = sizeof(packed);
+    Response.protoBytes = packed;
+
+    Com__Seagate__Kinetic__Proto__Message Message;
+    memset(&Message, 0, sizeof(Message));
+    Message.has_commandbytes = true;
+    Message.commandbytes.data = &packed[2];
+    Message.commandbytes.len = 2;
+    Com__Seagate__Kinetic__Proto__Command Command;
+    memset(&Command, 0, sizeof(Command));
+
+    KineticArena * arena = (KineticArena *)0x1234;
+    ProtobufCAllocator allocator;
+    KineticArena_Take_ExpectAndReturn(2 * sizeof(packed) + 1024, arena);
+    KineticArena_Allocator_ExpectAndReturn(arena, &allocator);
+    KineticPDU_unpack_message_ExpectAndReturn(&allocator, sizeof(packed), packed, &Message);
+    KineticPDU_unpack_command_ExpectAndReturn(&allocator, 2, &packed[2], &Command);
+
+    TEST_ASSERT_EQUAL_PTR(&Command, KineticResponse_GetCommand(&Response));
+    TEST_ASSERT_EQUAL_PTR(arena, Response.arena);
+
+    // Already unpacked
+    TEST_ASSERT_EQUAL_PTR(&Command, KineticResponse_GetCommand(&Response));
+    TEST_ASSERT_EQUAL_PTR(&Message, KineticResponse_GetMessage(&Response));
+}
+
+void test_KineticResponse_GetCommand_should_not_retry_a_failed_unpack(void)
+{
+    uint8_t packed[] = {0xff};
+    Response.header.protobufLength = sizeof(packed);
+    Response.protoBytes = packed;
+
+    KineticArena_Take_ExpectAndReturn(2 * sizeof(packed) + 1024, NULL);
+    KineticArena_Allocator_ExpectAndReturn(NULL, NULL);
+    KineticPDU_unpack_message_ExpectAndReturn(NULL, sizeof(packed), packed, NULL);
+
+    TEST_ASSERT_NULL(KineticResponse_GetCommand(&Response));
+    TEST_ASSERT_NULL(KineticResponse_GetMessage(&Response));
+}
@@ -0,0 +1,140 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_rs.h"
+#include "kinetic_types_internal.h"
+#include "kinetic_logger.h"
+#include "kinetic.pb-c.h"
+#include "protobuf-c/protobuf-c.h"
+#include "byte_array.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define K (4)
+#define M (2)
+#define LEN (1000)  // Not a multiple of any vector width
+
+static uint8_t Fragments[K + M][LEN];
+static uint8_t Original[K + M][LEN];
+static KineticRS * Code;
+
+static void encode(void)
+{
+    uint8_t const * data[K];
+    uint8_t * parity[M];
+    for (int i = 0; i < K; i++) {
+        for (int j = 0; j < LEN; j++) { Fragments[i][j] = (uint8_t)rand(); }
+        data[i] = Fragments[i];
+    }
+    for (int i = 0; i < M; i++) { parity[i] = Fragments[K + i]; }
+    KineticRS_Encode(Code, data, parity, LEN);
+    memcpy(Original, Fragments, sizeof(Original));
+}
+
+static bool reconstruct(bool const present[])
+{
+    uint8_t * fragments[K + M];
+    for (int i = 0; i < K + M; i++) {
+        fragments[i] = Fragments[i];
+        if (!present[i]) { memset(Fragments[i], 0, LEN); }
+    }
+    return KineticRS_Reconstruct(Code, fragments, present, LEN);
+}
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    KineticRS_SetImpl(KineticRS_BestImpl());
+    Code = KineticRS_Create(K, M);
+    TEST_ASSERT_NOT_NULL(Code);
+    encode();
+}
+
+void tearDown(void)
+{
+    KineticRS_Destroy(Code);
+    KineticLogger_Close();
+}
+
+void test_KineticRS_Create_should_reject_bad_fragment_counts(void)
+{
+    TEST_ASSERT_NULL(KineticRS_Create(0, 2));
+    TEST_ASSERT_NULL(KineticRS_Create(4, 0));
+    TEST_ASSERT_NULL(KineticRS_Create(KINETIC_RS_MAX_FRAGMENTS, 1));
+}
+
+void test_KineticRS_Encode_should_mirror_a_single_data_fragment(void)
+{
+    KineticRS * mirror = KineticRS_Create(1, 1);
+    uint8_t const * data[1] = {Original[0]};
+    uint8_t parity[LEN];
+    uint8_t * parities[1] = {parity};
+
+    KineticRS_Encode(mirror, data, parities, LEN);
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(Original[0], parity, LEN);
+    KineticRS_Destroy(mirror);
+}
+
+void test_KineticRS_Reconstruct_should_recover_the_data_from_any_K_fragments(void)
+{
+    for (int a = 0; a < K + M; a++) {
+        for (int b = a + 1; b < K + M; b++) {
+            bool present[K + M];
+            for (int i = 0; i < K + M; i++) { present[i] = (i != a && i != b); }
+
+            TEST_ASSERT_TRUE(reconstruct(present));
+
+            for (int i = 0; i < K; i++) {
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(Original[i], Fragments[i], LEN);
+            }
+            memcpy(Fragments, Original, sizeof(Fragments));
+        }
+    }
+}
+
+void test_KineticRS_Reconstruct_should_fail_with_fewer_than_K_fragments(void)
+{
+    bool present[K + M] = {false, true, true, false, true, false};
+
+    TEST_ASSERT_FALSE(reconstruct(present));
+}
+
+void test_KineticRS_Encode_should_match_the_scalar_code_with_each_SIMD_implementation(void)
+{
+    KineticRSImpl impls[] = {KINETIC_RS_SSSE3, KINETIC_RS_AVX2};
+    for (size_t n = 0; n < NUM_ELEMENTS(impls); n++) {
+        if (!KineticRS_SetImpl(impls[n])) { continue; }
+
+        encode();
+
+        TEST_ASSERT_TRUE(KineticRS_SetImpl(KINETIC_RS_SCALAR));
+        uint8_t const * data[K];
+        uint8_t parity[M][LEN];
+        uint8_t * parities[M] = {parity[0], parity[1]};
+        for (int i = 0; i < K; i++) { data[i] = Original[i]; }
+        KineticRS_Encode(Code, data, parities, LEN);
+        for (int i = 0; i < M; i++) {
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(parity[i], Original[K + i], LEN);
+        }
+    }
+}
@@ -33,7 +33,13 @@
 #include "mock_kinetic_client.h"
 #include "mock_kinetic_pdu_unpack.h"
 #include "mock_kinetic_countingsemaphore.h"
+#include "mock_kinetic_window.h"
 #include "mock_kinetic_resourcewaiter.h"
+#include "mock_kinetic_encoder.h"
+#include "mock_kinetic_hmac.h"
+#include "mock_kinetic_signingqueue.h"
+#include "mock_kinetic_hmac_mb.h"
+#include "mock_kinetic_cache.h"
 
 #include "mock_bus.h"
 #include "byte_array.h"
@@ -47,6 +53,7 @@ static int OperationCompleteCallbackCount;
 static KineticStatus LastStatus;
 static struct _KineticClient Client;
 static struct bus MessageBus;
+static KineticSigningQueue * const SigningQueue = (KineticSigningQueue *)0x5150;
 
 void setUp(void)
 {
@@ -57,7 +64,8 @@ void setUp(void)
         .clusterVersion = 6,
     };
     Client.bus = &MessageBus;
-    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_MAX_OUTSTANDING_OPERATIONS_PER_SESSION, &Semaphore);
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, &Semaphore);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&Session, KINETIC_DEFAULT_QUEUE_DEPTH, true);
     
     KineticStatus status = KineticSession_Create(&Session, &Client);
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
@@ -92,7 +100,8 @@ void test_KineticSession_Create_should_allocate_and_destroy_KineticConnections(v
     KineticSession session;
     memset(&session, 0, sizeof(session));
 
-    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_MAX_OUTSTANDING_OPERATIONS_PER_SESSION, &Semaphore);
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, &Semaphore);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, KINETIC_DEFAULT_QUEUE_DEPTH, true);
 
     KineticStatus status = KineticSession_Create(&session, &Client);    
     
@@ -103,6 +112,7 @@ void test_KineticSession_Create_should_allocate_and_destroy_KineticConnections(v
     TEST_ASSERT_EQUAL_INT64(0, session.connectionID);
 
     KineticCountingSemaphore_Destroy_Expect(&Semaphore);
+    KineticAllocator_FreeOperationPool_Expect(&session);
     KineticAllocator_FreeSession_Expect(&session);
 
     status = KineticSession_Destroy(&session);
@@ -110,6 +120,151 @@ void test_KineticSession_Create_should_allocate_and_destroy_KineticConnections(v
     TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
 }
 
+void test_KineticSession_Create_should_precompute_the_HMAC_key_state(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    strcpy((char*)session.config.keyData, "asdfasdf");
+    session.config.hmacKey = ByteArray_Create(session.config.keyData, 8);
+
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, &Semaphore);
+    KineticHMAC_InitKey_Expect(&session.hmacKey, session.config.hmacKey);
+    KineticHMACMB_Lanes_ExpectAndReturn(8);
+    KineticSigningQueue_Create_ExpectAndReturn(&session.hmacKey, SigningQueue);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, KINETIC_DEFAULT_QUEUE_DEPTH, true);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_PTR(SigningQueue, session.signingQueue);
+
+    KineticCountingSemaphore_Destroy_Expect(&Semaphore);
+    KineticSigningQueue_Destroy_Expect(SigningQueue);
+    KineticAllocator_FreeOperationPool_Expect(&session);
+    KineticAllocator_FreeSession_Expect(&session);
+
+    status = KineticSession_Destroy(&session);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+}
+
+void test_KineticSession_Create_should_sign_on_each_senders_thread_without_multi_buffer_lanes(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    strcpy((char*)session.config.keyData, "asdfasdf");
+    session.config.hmacKey = ByteArray_Create(session.config.keyData, 8);
+
+    // With a single lane, a shared signing queue would only serialize senders
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, &Semaphore);
+    KineticHMAC_InitKey_Expect(&session.hmacKey, session.config.hmacKey);
+    KineticHMACMB_Lanes_ExpectAndReturn(1);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, KINETIC_DEFAULT_QUEUE_DEPTH, true);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_NULL(session.signingQueue);
+
+    KineticCountingSemaphore_Destroy_Expect(&Semaphore);
+    KineticAllocator_FreeOperationPool_Expect(&session);
+    KineticAllocator_FreeSession_Expect(&session);
+
+    status = KineticSession_Destroy(&session);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+}
+
+void test_KineticSession_Create_should_fail_if_signing_queue_cannot_be_allocated(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    strcpy((char*)session.config.keyData, "asdfasdf");
+    session.config.hmacKey = ByteArray_Create(session.config.keyData, 8);
+
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, &Semaphore);
+    KineticHMAC_InitKey_Expect(&session.hmacKey, session.config.hmacKey);
+    KineticHMACMB_Lanes_ExpectAndReturn(8);
+    KineticSigningQueue_Create_ExpectAndReturn(&session.hmacKey, NULL);
+    KineticCountingSemaphore_Destroy_Expect(&Semaphore);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_MEMORY_ERROR, status);
+}
+
+void test_KineticSession_Create_should_size_outstanding_operations_by_configured_queue_depth(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    session.config.queueDepth = 64;
+
+    KineticCountingSemaphore_Create_ExpectAndReturn(64, &Semaphore);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, 64, true);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_NULL(session.window);
+}
+
+void test_KineticSession_Create_should_cap_queue_depth(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    session.config.queueDepth = KINETIC_MAX_QUEUE_DEPTH + 1;
+
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_MAX_QUEUE_DEPTH, &Semaphore);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, KINETIC_MAX_QUEUE_DEPTH, true);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL(KINETIC_MAX_QUEUE_DEPTH, session.config.queueDepth);
+}
+
+void test_KineticSession_Create_should_start_adaptive_window_at_default_depth(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    session.config.queueDepth = 64;
+    session.config.adaptiveQueueDepth = true;
+    KineticWindow * window = (KineticWindow *)0x1234;
+
+    KineticCountingSemaphore_Create_ExpectAndReturn(64, &Semaphore);
+    KineticWindow_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, 64, window);
+    KineticCountingSemaphore_SetLimit_Expect(&Semaphore, KINETIC_DEFAULT_QUEUE_DEPTH);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, 64, true);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+    TEST_ASSERT_EQUAL_PTR(window, session.window);
+
+    KineticCountingSemaphore_Destroy_Expect(&Semaphore);
+    KineticWindow_Destroy_Expect(window);
+    KineticAllocator_FreeOperationPool_Expect(&session);
+    KineticAllocator_FreeSession_Expect(&session);
+
+    status = KineticSession_Destroy(&session);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS, status);
+}
+
+void test_KineticSession_Create_should_fail_if_operation_pool_cannot_be_allocated(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+
+    KineticCountingSemaphore_Create_ExpectAndReturn(KINETIC_DEFAULT_QUEUE_DEPTH, &Semaphore);
+    KineticAllocator_NewOperationPool_ExpectAndReturn(&session, KINETIC_DEFAULT_QUEUE_DEPTH, false);
+    KineticCountingSemaphore_Destroy_Expect(&Semaphore);
+
+    KineticStatus status = KineticSession_Create(&session, &Client);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_MEMORY_ERROR, status);
+}
+
 void test_KineticSession_Connect_should_return_KINETIC_SESSION_EMPTY_upon_NULL_session(void)
 {
     KineticStatus status = KineticSession_Connect(NULL);
@@ -284,3 +439,32 @@ void test_KineticSession_Connect_should_connect_to_specified_host(void)
     TEST_ASSERT_EQUAL_INT64(expected.config.identity, session.config.identity);
     TEST_ASSERT_EQUAL_ByteArray(expected.config.hmacKey, session.config.hmacKey);
 }
+
+void test_KineticSession_SetConnectionID_should_build_the_request_template_once(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    session.config.clusterVersion = 7;
+    session.config.identity = 3;
+
+    KineticEncoder_InitTemplate_Expect(&session.requestTemplate, 7, 1234, 3);
+    KineticSession_SetConnectionID(&session, 1234);
+    TEST_ASSERT_EQUAL_INT64(1234, session.connectionID);
+
+    // A later ID no longer matches the template, so requests are
+    // encoded without it; the template is not rewritten under readers.
+    session.requestTemplate.ready = true;
+    KineticSession_SetConnectionID(&session, 5678);
+    TEST_ASSERT_EQUAL_INT64(5678, session.connectionID);
+}
+
+void test_KineticSession_GetNextSequenceCounts_should_reserve_consecutive_counts(void)
+{
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+    session.sequence = 10;
+
+    TEST_ASSERT_EQUAL_INT64(10, KineticSession_GetNextSequenceCount(&session));
+    TEST_ASSERT_EQUAL_INT64(11, KineticSession_GetNextSequenceCounts(&session, 5));
+    TEST_ASSERT_EQUAL_INT64(16, KineticSession_GetNextSequenceCount(&session));
+}
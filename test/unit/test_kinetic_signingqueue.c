@@ -0,0 +1,130 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_signingqueue.h"
+#include "kinetic.pb-c.h"
+#include "kinetic_hmac.h"
+#include "kinetic_hmac_mb.h"
+#include "kinetic_nbo.h"
+#include "kinetic_logger.h"
+#include "kinetic_types_internal.h"
+#include "byte_array.h"
+#include "protobuf-c/protobuf-c.h"
+#include <string.h>
+#include <pthread.h>
+
+#define NUM_SENDERS (8)
+#define SIGNS_PER_SENDER (500)
+#define COMMAND_LEN (48)
+
+static KineticHMACKey HmacKey;
+static ByteArray Key;
+static KineticSigningQueue * Queue;
+
+typedef struct {
+    pthread_t thread;
+    int id;
+    int failures;
+} sender;
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    Key = ByteArray_CreateWithCString("asdfasdf");
+    memset(&HmacKey, 0, sizeof(HmacKey));
+    KineticHMAC_InitKey(&HmacKey, Key);
+    Queue = KineticSigningQueue_Create(&HmacKey);
+    TEST_ASSERT_NOT_NULL(Queue);
+}
+
+void tearDown(void)
+{
+    KineticSigningQueue_Destroy(Queue);
+    KineticLogger_Close();
+}
+
+static void init_message(Com__Seagate__Kinetic__Proto__Message * msg,
+    Com__Seagate__Kinetic__Proto__Message__HMACauth * hmacAuth,
+    uint8_t * hmacData, uint8_t * command, size_t len)
+{
+    com__seagate__kinetic__proto__message__init(msg);
+    com__seagate__kinetic__proto__message__hmacauth__init(hmacAuth);
+    hmacAuth->hmac = (ProtobufCBinaryData) {.data = hmacData, .len = KINETIC_HMAC_SHA1_LEN};
+    msg->hmacauth = hmacAuth;
+    msg->has_commandbytes = true;
+    msg->commandbytes = (ProtobufCBinaryData) {.data = command, .len = len};
+}
+
+static bool sign_and_check(int seed)
+{
+    Com__Seagate__Kinetic__Proto__Message msg;
+    Com__Seagate__Kinetic__Proto__Message__HMACauth hmacAuth;
+    uint8_t hmacData[KINETIC_HMAC_SHA1_LEN];
+    uint8_t command[COMMAND_LEN + 16];
+    size_t len = COMMAND_LEN + (seed % 16);
+    for (size_t i = 0; i < len; i++) { command[i] = (uint8_t)(seed + i); }
+    init_message(&msg, &hmacAuth, hmacData, command, len);
+
+    KineticHMAC hmac;
+    KineticSigningQueue_Sign(Queue, &hmac, &msg);
+
+    KineticHMAC expected;
+    uint8_t expectedData[KINETIC_HMAC_SHA1_LEN];
+    hmacAuth.hmac.data = expectedData;
+    KineticHMAC_PopulateWithKey(&expected, &msg, &HmacKey);
+
+    return hmacAuth.has_hmac &&
+        memcmp(expected.data, hmac.data, KINETIC_HMAC_SHA1_LEN) == 0 &&
+        memcmp(expectedData, hmacData, KINETIC_HMAC_SHA1_LEN) == 0;
+}
+
+void test_KineticSigningQueue_Sign_should_sign_a_lone_request(void)
+{
+    TEST_ASSERT_TRUE(sign_and_check(1));
+    TEST_ASSERT_TRUE(sign_and_check(2));
+}
+
+static void* sender_thread(void* arg)
+{
+    sender * s = arg;
+    for (int i = 0; i < SIGNS_PER_SENDER; i++) {
+        if (!sign_and_check(s->id * SIGNS_PER_SENDER + i)) { s->failures++; }
+    }
+    return NULL;
+}
+
+void test_KineticSigningQueue_Sign_should_sign_every_request_from_concurrent_senders(void)
+{
+    sender senders[NUM_SENDERS];
+    memset(senders, 0, sizeof(senders));
+
+    for (int i = 0; i < NUM_SENDERS; i++) {
+        senders[i].id = i;
+        TEST_ASSERT_EQUAL(0, pthread_create(&senders[i].thread, NULL, sender_thread, &senders[i]));
+    }
+    for (int i = 0; i < NUM_SENDERS; i++) {
+        pthread_join(senders[i].thread, NULL);
+    }
+    for (int i = 0; i < NUM_SENDERS; i++) {
+        TEST_ASSERT_EQUAL(0, senders[i].failures);
+    }
+}
@@ -0,0 +1,153 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+#include "unity.h"
+#include "kinetic_sim_store.h"
+#include <string.h>
+
+static KineticSimStore *Store;
+
+#define KEY(S) (const uint8_t *)(S), strlen(S)
+
+static KineticSimStoreStatus put(const char *key, const char *version,
+    const char *dbVersion, bool force)
+{
+    KineticSimEntry *entry = KineticSimStore_NewEntry(KEY(key), KEY(version),
+        KEY("tag"), true, 1, KEY("value"));
+    TEST_ASSERT_NOT_NULL(entry);
+    return KineticSimStore_Put(Store, entry,
+        (const uint8_t *)dbVersion, dbVersion ? strlen(dbVersion) : 0, force);
+}
+
+static void assert_entry_key(const char *expected, KineticSimEntry *entry)
+{
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(strlen(expected), entry->keyLen);
+    TEST_ASSERT_EQUAL_MEMORY(expected, entry->key, entry->keyLen);
+    KineticSimStore_Release(entry);
+}
+
+void setUp(void)
+{
+    Store = KineticSimStore_Create();
+    TEST_ASSERT_NOT_NULL(Store);
+}
+
+void tearDown(void)
+{
+    KineticSimStore_Free(Store);
+}
+
+void test_KineticSimStore_Put_should_store_entry_retrievable_by_Get(void)
+{
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_SUCCESS, put("key", "v1", NULL, false));
+    TEST_ASSERT_EQUAL(1, KineticSimStore_Count(Store));
+
+    KineticSimEntry *entry = KineticSimStore_Get(Store, KEY("key"));
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(2, entry->versionLen);
+    TEST_ASSERT_EQUAL_MEMORY("v1", entry->version, 2);
+    TEST_ASSERT_EQUAL(5, entry->valueLen);
+    TEST_ASSERT_EQUAL_MEMORY("value", entry->value, 5);
+    TEST_ASSERT_TRUE(entry->hasAlgorithm);
+    KineticSimStore_Release(entry);
+
+    TEST_ASSERT_NULL(KineticSimStore_Get(Store, KEY("missing")));
+}
+
+void test_KineticSimStore_Put_should_check_dbVersion_unless_forced(void)
+{
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_SUCCESS, put("key", "v1", NULL, false));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_VERSION_MISMATCH, put("key", "v2", NULL, false));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_VERSION_MISMATCH, put("key", "v2", "v0", false));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_SUCCESS, put("key", "v2", "v1", false));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_SUCCESS, put("key", "v3", NULL, true));
+    TEST_ASSERT_EQUAL(1, KineticSimStore_Count(Store));
+
+    KineticSimEntry *entry = KineticSimStore_Get(Store, KEY("key"));
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL_MEMORY("v3", entry->version, 2);
+    KineticSimStore_Release(entry);
+}
+
+void test_KineticSimStore_GetNext_and_GetPrevious_should_walk_keys_in_order(void)
+{
+    put("b", "v", NULL, false);
+    put("d", "v", NULL, false);
+    put("c", "v", NULL, false);
+
+    assert_entry_key("b", KineticSimStore_GetNext(Store, KEY("a")));
+    assert_entry_key("c", KineticSimStore_GetNext(Store, KEY("b")));
+    assert_entry_key("d", KineticSimStore_GetNext(Store, KEY("c")));
+    TEST_ASSERT_NULL(KineticSimStore_GetNext(Store, KEY("d")));
+
+    assert_entry_key("c", KineticSimStore_GetPrevious(Store, KEY("d")));
+    assert_entry_key("d", KineticSimStore_GetPrevious(Store, KEY("e")));
+    TEST_ASSERT_NULL(KineticSimStore_GetPrevious(Store, KEY("b")));
+}
+
+void test_KineticSimStore_GetKeyRange_should_honor_bounds_direction_and_limit(void)
+{
+    const char *keys[] = {"k1", "k2", "k3", "k4", "k5"};
+    for (size_t i = 0; i < 5; i++) { put(keys[i], "v", NULL, false); }
+    KineticSimEntry *out[5];
+
+    size_t count = KineticSimStore_GetKeyRange(Store,
+        KEY("k2"), true, KEY("k4"), true, false, 5, out);
+    TEST_ASSERT_EQUAL(3, count);
+    assert_entry_key("k2", out[0]);
+    assert_entry_key("k3", out[1]);
+    assert_entry_key("k4", out[2]);
+
+    count = KineticSimStore_GetKeyRange(Store,
+        KEY("k2"), false, KEY("k4"), false, false, 5, out);
+    TEST_ASSERT_EQUAL(1, count);
+    assert_entry_key("k3", out[0]);
+
+    count = KineticSimStore_GetKeyRange(Store,
+        KEY("k1"), true, NULL, 0, false, true, 2, out);
+    TEST_ASSERT_EQUAL(2, count);
+    assert_entry_key("k5", out[0]);
+    assert_entry_key("k4", out[1]);
+}
+
+void test_KineticSimStore_Delete_should_check_dbVersion_unless_forced(void)
+{
+    put("a", "v1", NULL, false);
+    put("b", "v1", NULL, false);
+
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_VERSION_MISMATCH,
+        KineticSimStore_Delete(Store, KEY("a"), KEY("v0"), false));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_SUCCESS,
+        KineticSimStore_Delete(Store, KEY("a"), KEY("v1"), false));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_SUCCESS,
+        KineticSimStore_Delete(Store, KEY("b"), NULL, 0, true));
+    TEST_ASSERT_EQUAL(KINETIC_SIM_STORE_NOT_FOUND,
+        KineticSimStore_Delete(Store, KEY("b"), NULL, 0, true));
+    TEST_ASSERT_EQUAL(0, KineticSimStore_Count(Store));
+}
+
+void test_KineticSimStore_Get_reference_should_outlive_overwrite(void)
+{
+    put("key", "v1", NULL, false);
+    KineticSimEntry *entry = KineticSimStore_Get(Store, KEY("key"));
+    put("key", "v2", NULL, true);
+    TEST_ASSERT_EQUAL_MEMORY("v1", entry->version, 2);
+    KineticSimStore_Release(entry);
+}
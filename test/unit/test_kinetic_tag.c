@@ -0,0 +1,235 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_tag.h"
+#include "kinetic_logger.h"
+#include "kinetic_types_internal.h"
+#include "byte_array.h"
+#include "protobuf-c/protobuf-c.h"
+#include "kinetic.pb-c.h"
+#include <string.h>
+
+#define LONG_VALUE_LEN (5000)
+
+static uint8_t LongValue[LONG_VALUE_LEN];
+static uint8_t TagData[KINETIC_TAG_MAX_LEN];
+static uint8_t CopyData[LONG_VALUE_LEN + 1];
+static ByteBuffer Tag;
+static ByteArray Check;
+
+void setUp(void)
+{
+    KineticLogger_Init("stdout", 3);
+    for (size_t i = 0; i < LONG_VALUE_LEN; i++) {
+        LongValue[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    memset(TagData, 0, sizeof(TagData));
+    Tag = ByteBuffer_Create(TagData, sizeof(TagData), 0);
+    Check = ByteArray_CreateWithCString("123456789");
+}
+
+void tearDown(void)
+{
+    KineticLogger_Close();
+}
+
+// Bit-at-a-time reference for the reflected CRCs
+static uint64_t reference_crc(uint64_t reflectedPoly, uint64_t mask,
+                              uint8_t const * data, size_t len)
+{
+    uint64_t crc = mask;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ reflectedPoly : (crc >> 1);
+        }
+    }
+    return crc ^ mask;
+}
+
+static uint64_t tag_value(void)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < Tag.bytesUsed; i++) {
+        value = (value << 8) | TagData[i];
+    }
+    return value;
+}
+
+void test_KineticTag_Length_should_return_the_tag_length_for_each_algorithm(void)
+{
+    TEST_ASSERT_EQUAL(20, KineticTag_Length(KINETIC_ALGORITHM_SHA1));
+    TEST_ASSERT_EQUAL(32, KineticTag_Length(KINETIC_ALGORITHM_SHA2));
+    TEST_ASSERT_EQUAL(4, KineticTag_Length(KINETIC_ALGORITHM_CRC32));
+    TEST_ASSERT_EQUAL(8, KineticTag_Length(KINETIC_ALGORITHM_CRC64));
+    TEST_ASSERT_EQUAL(0, KineticTag_Length(KINETIC_ALGORITHM_SHA3));
+    TEST_ASSERT_EQUAL(0, KineticTag_Length(KINETIC_ALGORITHM_INVALID));
+}
+
+void test_KineticTag_Compute_should_compute_SHA1(void)
+{
+    uint8_t expected[] = {
+        0xf7, 0xc3, 0xbc, 0x1d, 0x80, 0x8e, 0x04, 0x73, 0x2a, 0xdf,
+        0x67, 0x99, 0x65, 0xcc, 0xc3, 0x4c, 0xa7, 0xae, 0x34, 0x41,
+    };
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticTag_Compute(KINETIC_ALGORITHM_SHA1, Check, &Tag));
+
+    TEST_ASSERT_EQUAL(sizeof(expected), Tag.bytesUsed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, TagData, sizeof(expected));
+}
+
+void test_KineticTag_Compute_should_compute_SHA2_as_SHA256(void)
+{
+    uint8_t expected[] = {
+        0x15, 0xe2, 0xb0, 0xd3, 0xc3, 0x38, 0x91, 0xeb, 0xb0, 0xf1, 0xef,
+        0x60, 0x9e, 0xc4, 0x19, 0x42, 0x0c, 0x20, 0xe3, 0x20, 0xce, 0x94,
+        0xc6, 0x5f, 0xbc, 0x8c, 0x33, 0x12, 0x44, 0x8e, 0xb2, 0x25,
+    };
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticTag_Compute(KINETIC_ALGORITHM_SHA2, Check, &Tag));
+
+    TEST_ASSERT_EQUAL(sizeof(expected), Tag.bytesUsed);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, TagData, sizeof(expected));
+}
+
+void test_KineticTag_Compute_should_compute_CRC32_big_endian(void)
+{
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticTag_Compute(KINETIC_ALGORITHM_CRC32, Check, &Tag));
+
+    TEST_ASSERT_EQUAL(4, Tag.bytesUsed);
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, (uint32_t)tag_value());
+}
+
+void test_KineticTag_Compute_should_compute_CRC64_big_endian(void)
+{
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+        KineticTag_Compute(KINETIC_ALGORITHM_CRC64, Check, &Tag));
+
+    TEST_ASSERT_EQUAL(8, Tag.bytesUsed);
+    TEST_ASSERT_TRUE(tag_value() == 0x995DC9BBDF1939FAull);
+}
+
+void test_KineticTag_Compute_should_match_reference_CRCs_for_all_lengths_and_alignments(void)
+{
+    // Covers the table-only lengths, and the folded bulk with every tail length
+    for (size_t len = 0; len < 300; len++) {
+        uint8_t const * const data = &LongValue[len % 8];
+        ByteArray value = ByteArray_Create((void*)data, len);
+
+        KineticTag_Compute(KINETIC_ALGORITHM_CRC32, value, &Tag);
+        TEST_ASSERT_EQUAL_HEX32(reference_crc(0xEDB88320, 0xFFFFFFFF, data, len),
+            (uint32_t)tag_value());
+
+        KineticTag_Compute(KINETIC_ALGORITHM_CRC64, value, &Tag);
+        TEST_ASSERT_TRUE(reference_crc(0xC96C5795D7870F42ull, ~0ull, data, len) == tag_value());
+    }
+}
+
+void test_KineticTag_Compute_should_match_reference_CRCs_for_long_values(void)
+{
+    ByteArray value = ByteArray_Create(LongValue, LONG_VALUE_LEN);
+
+    KineticTag_Compute(KINETIC_ALGORITHM_CRC32, value, &Tag);
+    TEST_ASSERT_EQUAL_HEX32(reference_crc(0xEDB88320, 0xFFFFFFFF, LongValue, LONG_VALUE_LEN),
+        (uint32_t)tag_value());
+
+    KineticTag_Compute(KINETIC_ALGORITHM_CRC64, value, &Tag);
+    TEST_ASSERT_TRUE(reference_crc(0xC96C5795D7870F42ull, ~0ull, LongValue, LONG_VALUE_LEN) ==
+        tag_value());
+}
+
+void test_KineticTag_Compute_should_return_BUFFER_OVERRUN_if_the_tag_does_not_fit(void)
+{
+    ByteBuffer small = ByteBuffer_Create(TagData, 19, 0);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN,
+        KineticTag_Compute(KINETIC_ALGORITHM_SHA1, Check, &small));
+    TEST_ASSERT_EQUAL(0, small.bytesUsed);
+}
+
+void test_KineticTag_Compute_should_return_INVALID_REQUEST_for_unsupported_algorithms(void)
+{
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticTag_Compute(KINETIC_ALGORITHM_SHA3, Check, &Tag));
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_INVALID_REQUEST,
+        KineticTag_Compute(KINETIC_ALGORITHM_INVALID, Check, &Tag));
+}
+
+void test_KineticTag_AppendAndVerify_should_append_the_value_and_accept_a_matching_tag(void)
+{
+    KineticAlgorithm algorithms[] = {
+        KINETIC_ALGORITHM_SHA1, KINETIC_ALGORITHM_SHA2,
+        KINETIC_ALGORITHM_CRC32, KINETIC_ALGORITHM_CRC64,
+    };
+    ByteArray value = ByteArray_Create(LongValue, LONG_VALUE_LEN);
+
+    for (size_t i = 0; i < sizeof(algorithms) / sizeof(algorithms[0]); i++) {
+        KineticTag_Compute(algorithms[i], value, &Tag);
+        ByteBuffer dest = ByteBuffer_Create(CopyData, sizeof(CopyData), 0);
+        ByteBuffer_Append(&dest, "x", 1);
+
+        TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_SUCCESS,
+            KineticTag_AppendAndVerify(algorithms[i], &dest, value,
+                ByteArray_Create(TagData, Tag.bytesUsed)));
+
+        TEST_ASSERT_EQUAL(LONG_VALUE_LEN + 1, dest.bytesUsed);
+        TEST_ASSERT_EQUAL_HEX8('x', CopyData[0]);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(LongValue, &CopyData[1], LONG_VALUE_LEN);
+    }
+}
+
+void test_KineticTag_AppendAndVerify_should_return_DATA_ERROR_if_the_tag_does_not_match(void)
+{
+    ByteArray value = ByteArray_Create(LongValue, LONG_VALUE_LEN);
+    KineticTag_Compute(KINETIC_ALGORITHM_CRC32, value, &Tag);
+    TagData[3] ^= 0x01;
+    ByteBuffer dest = ByteBuffer_Create(CopyData, sizeof(CopyData), 0);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR,
+        KineticTag_AppendAndVerify(KINETIC_ALGORITHM_CRC32, &dest, value,
+            ByteArray_Create(TagData, Tag.bytesUsed)));
+}
+
+void test_KineticTag_AppendAndVerify_should_return_DATA_ERROR_if_the_tag_length_is_wrong(void)
+{
+    KineticTag_Compute(KINETIC_ALGORITHM_SHA1, Check, &Tag);
+    ByteBuffer dest = ByteBuffer_Create(CopyData, sizeof(CopyData), 0);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_DATA_ERROR,
+        KineticTag_AppendAndVerify(KINETIC_ALGORITHM_SHA1, &dest, Check,
+            ByteArray_Create(TagData, Tag.bytesUsed - 1)));
+}
+
+void test_KineticTag_AppendAndVerify_should_return_BUFFER_OVERRUN_without_appending_if_the_value_does_not_fit(void)
+{
+    KineticTag_Compute(KINETIC_ALGORITHM_CRC64, Check, &Tag);
+    ByteBuffer dest = ByteBuffer_Create(CopyData, Check.len - 1, 0);
+
+    TEST_ASSERT_EQUAL_KineticStatus(KINETIC_STATUS_BUFFER_OVERRUN,
+        KineticTag_AppendAndVerify(KINETIC_ALGORITHM_CRC64, &dest, Check,
+            ByteArray_Create(TagData, Tag.bytesUsed)));
+    TEST_ASSERT_EQUAL(0, dest.bytesUsed);
+}
@@ -92,6 +92,82 @@ void test_KineticRequest_Init_should_set_the_exchange_fields_in_the_embedded_pro
     TEST_ASSERT_EQUAL_INT64(KINETIC_SEQUENCE_NOT_YET_BOUND, request.message.header.sequence);
 }
 
+void test_KineticRequest_Init_should_use_the_session_request_template_once_it_is_ready(void)
+{
+    KineticRequest request;
+    KineticSession session;
+    memset(&session, 0, sizeof(session));
+
+    KineticRequest_Init(&request, &session);
+    TEST_ASSERT_NULL(request.encoderTemplate);
+
+    session.requestTemplate.ready = true;
+    KineticRequest_Init(&request, &session);
+    TEST_ASSERT_EQUAL_PTR(&session.requestTemplate, request.encoderTemplate);
+}
+
+void test_KineticRequest_Init_should_point_at_the_sessions_HMAC_key_once_ready(void)
+{
+    KineticSession session;
+    KineticRequest request;
+    memset(&session, 0, sizeof(session));
+
+    KineticRequest_Init(&request, &session);
+    TEST_ASSERT_NULL(request.hmacKey);
+
+    session.hmacKey.ready = true;
+    KineticRequest_Init(&request, &session);
+    TEST_ASSERT_EQUAL_PTR(&session.hmacKey, request.hmacKey);
+}
+
+void test_KineticRequest_Init_should_use_the_sessions_signing_queue(void)
+{
+    KineticSession session;
+    KineticRequest request;
+    memset(&session, 0, sizeof(session));
+
+    KineticRequest_Init(&request, &session);
+    TEST_ASSERT_NULL(request.signingQueue);
+
+    session.signingQueue = (KineticSigningQueue *)0x1234;
+    KineticRequest_Init(&request, &session);
+    TEST_ASSERT_EQUAL_PTR(session.signingQueue, request.signingQueue);
+}
+
+void test_KineticRequest_Reset_should_clear_the_previous_command_for_reuse(void)
+{
+    KineticSession session;
+    KineticRequest request;
+    memset(&session, 0, sizeof(session));
+    session.connectionID = 8765432;
+    KineticRequest_Init(&request, &session);
+
+    // Leave behind a key/value command, signed and sequenced
+    request.command->body = &request.message.body;
+    request.command->body->keyvalue = &request.message.keyValue;
+    request.message.keyValue.has_force = true;
+    request.message.keyValue.force = true;
+    request.message.header.sequence = 42;
+    request.message.message.hmacauth = &request.message.hmacAuth;
+    request.message.hmacAuth.has_identity = true;
+    request.pinAuth = true;
+
+    session.requestTemplate.ready = true;
+    KineticRequest_Reset(&request, &session);
+
+    TEST_ASSERT_EQUAL_PTR(&request.message.command, request.command);
+    TEST_ASSERT_EQUAL_PTR(&request.message.header, request.command->header);
+    TEST_ASSERT_NULL(request.command->body);
+    TEST_ASSERT_NULL(request.message.body.keyvalue);
+    TEST_ASSERT_FALSE(request.message.keyValue.has_force);
+    TEST_ASSERT_NULL(request.message.message.hmacauth);
+    TEST_ASSERT_FALSE(request.message.hmacAuth.has_identity);
+    TEST_ASSERT_FALSE(request.pinAuth);
+    TEST_ASSERT_EQUAL_INT64(KINETIC_SEQUENCE_NOT_YET_BOUND, request.message.header.sequence);
+    TEST_ASSERT_EQUAL_INT64(8765432, request.message.header.connectionid);
+    TEST_ASSERT_EQUAL_PTR(&session.requestTemplate, request.encoderTemplate);
+}
+
 void test_KineticProtoStatusCode_to_KineticStatus_should_map_from_internal_to_public_type(void)
 {
     // These status codes have a one-to-one mapping for clarity
@@ -0,0 +1,128 @@
+/*
+* kinetic-c
+* Copyright (C) 2015 Seagate Technology.
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*
+*/
+
+#include "kinetic_window.h"
+#include "unity.h"
+#include "unity_helper.h"
+#include "kinetic_logger.h"
+#include <stdlib.h>
+
+static KineticWindow * Window;
+
+void setUp(void)
+{
+    Window = NULL;
+}
+
+void tearDown(void)
+{
+    if (Window != NULL) { KineticWindow_Destroy(Window); }
+}
+
+static void complete(int count, int64_t latencyUsec, bool busy)
+{
+    for (int i = 0; i < count; i++) {
+        KineticWindow_Update(Window, latencyUsec, busy);
+    }
+}
+
+void test_KineticWindow_Create_should_clamp_initial_size(void)
+{
+    Window = KineticWindow_Create(0, 8);
+    TEST_ASSERT_EQUAL(1, KineticWindow_Size(Window));
+    KineticWindow_Destroy(Window);
+
+    Window = KineticWindow_Create(20, 8);
+    TEST_ASSERT_EQUAL(8, KineticWindow_Size(Window));
+}
+
+void test_KineticWindow_Update_should_grow_about_one_per_window_while_latency_is_flat(void)
+{
+    Window = KineticWindow_Create(4, 100);
+
+    complete(4, 1000, false);
+    TEST_ASSERT_EQUAL(4, KineticWindow_Size(Window));
+    complete(1, 1000, false);
+    TEST_ASSERT_EQUAL(5, KineticWindow_Size(Window));
+
+    complete(1000, 1000, false);
+    TEST_ASSERT_TRUE(KineticWindow_Size(Window) > 40);
+}
+
+void test_KineticWindow_Update_should_not_grow_past_max(void)
+{
+    Window = KineticWindow_Create(4, 6);
+    complete(1000, 1000, false);
+    TEST_ASSERT_EQUAL(6, KineticWindow_Size(Window));
+}
+
+void test_KineticWindow_Update_should_halve_once_per_window_when_device_is_busy(void)
+{
+    Window = KineticWindow_Create(16, 100);
+
+    TEST_ASSERT_EQUAL(16, KineticWindow_Update(Window, 1000, false));
+    complete(15, 1000, true);
+    TEST_ASSERT_EQUAL(8, KineticWindow_Size(Window));
+
+    // Busy responses already in flight at the larger window count only once
+    complete(7, 1000, true);
+    TEST_ASSERT_EQUAL(8, KineticWindow_Size(Window));
+    complete(1, 1000, true);
+    TEST_ASSERT_EQUAL(4, KineticWindow_Size(Window));
+}
+
+void test_KineticWindow_Update_should_back_off_when_latency_spikes(void)
+{
+    Window = KineticWindow_Create(16, 100);
+    complete(32, 1000, false);
+    uint32_t grown = KineticWindow_Size(Window);
+    TEST_ASSERT_TRUE(grown > 16);
+
+    complete(32, 20000, false);
+    TEST_ASSERT_TRUE(KineticWindow_Size(Window) < grown);
+}
+
+void test_KineticWindow_Update_should_rebase_after_latency_rises_for_good(void)
+{
+    Window = KineticWindow_Create(4, 100);
+    complete(64, 1000, false);
+
+    complete(64, 20000, false);
+    uint32_t backedOff = KineticWindow_Size(Window);
+
+    // Once the baseline catches up, the slower latency is the new normal
+    complete(2000, 20000, false);
+    TEST_ASSERT_TRUE(KineticWindow_Size(Window) > backedOff + 10);
+}
+
+void test_KineticWindow_Update_should_ignore_small_latency_jitter(void)
+{
+    Window = KineticWindow_Create(16, 100);
+    complete(16, 50, false);
+    complete(100, 150, false);
+    TEST_ASSERT_TRUE(KineticWindow_Size(Window) > 16);
+}
+
+void test_KineticWindow_Update_should_never_shrink_below_one(void)
+{
+    Window = KineticWindow_Create(2, 100);
+    complete(100, 1000, true);
+    TEST_ASSERT_EQUAL(1, KineticWindow_Size(Window));
+}